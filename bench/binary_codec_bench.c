@@ -0,0 +1,141 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+/*
+ * Control call / exec reply as JSON text versus the compact binary form:
+ * bytes on the wire and encode/decode cost for each, then end-to-end calls
+ * against a local stand-in root server with YAI_RPC_CAP_BINARY granted and
+ * refused.
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <yai_sdk/public.h>
+#include <yai_sdk/rpc.h>
+
+#include <cJSON.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "bench_util.h"
+#include "../src/protocol/binary_codec.h"
+#include "../tests/support/stub_server.h"
+
+#define BENCH_ITERS 200000
+#define BENCH_CALLS 20000
+
+static const char k_call[] =
+    "{\"type\":\"yai.control.call.v1\",\"command_id\":\"yai.kernel.ws_status\",\"target_plane\":\"kernel\","
+    "\"argv\":[\"--ws-id\",\"ws_bench\",\"--json\"]}";
+
+static const char k_reply[] =
+    "{\"type\":\"yai.exec.reply.v1\",\"status\":\"ok\",\"code\":\"OK\",\"reason\":\"accepted\","
+    "\"summary\":\"Workspace status reported.\",\"command_id\":\"yai.kernel.ws_status\","
+    "\"trace_id\":\"bench-000000000042\",\"target_plane\":\"kernel\","
+    "\"hints\":[\"Use --json for machine output.\",\"See yai help ws.\"],"
+    "\"details\":{\"ws\":\"ws_bench\",\"state\":\"ready\",\"generation\":17}}";
+
+#define S(lit) {(lit), sizeof(lit) - 1}
+
+static const yai_bin_str_t k_argv[] = {S("--ws-id"), S("ws_bench"), S("--json")};
+static const yai_bin_str_t k_hints[] = {S("Use --json for machine output."), S("See yai help ws.")};
+
+static const yai_bin_call_t k_bin_call = {
+    .command_id = S("yai.kernel.ws_status"), .target_plane = S("kernel"), .argc = 3, .argv = k_argv};
+
+static const yai_bin_reply_t k_bin_reply = {
+    .status = S("ok"),
+    .code = S("OK"),
+    .reason = S("accepted"),
+    .summary = S("Workspace status reported."),
+    .command_id = S("yai.kernel.ws_status"),
+    .trace_id = S("bench-000000000042"),
+    .target_plane = S("kernel"),
+    .hint_count = 2,
+    .hints = k_hints,
+    .details = S("{\"ws\":\"ws_bench\",\"state\":\"ready\",\"generation\":17}")};
+
+static double per_iter(uint64_t t0) { return (double)(bench_now_ns() - t0) / BENCH_ITERS; }
+
+static int bench_calls(int binary)
+{
+  stub_server_opts_t so = {.caps_refused = binary ? 0 : YAI_RPC_CAP_BINARY};
+  yai_sdk_client_opts_t opts = {.ws_id = "bench", .auto_handshake = 1, .binary_codec = 1};
+  yai_sdk_client_t *c = NULL;
+  stub_server_t *srv = NULL;
+  yai_sdk_reply_t out;
+  uint64_t t0;
+
+  if (stub_server_start(&srv, &so) != 0 || yai_sdk_client_open(&c, &opts) != YAI_SDK_OK) {
+    fprintf(stderr, "binary_codec_bench: setup failed\n");
+    stub_server_stop(srv);
+    return 1;
+  }
+  t0 = bench_now_ns();
+  for (int i = 0; i < BENCH_CALLS; i++) {
+    if (yai_sdk_client_call_json(c, k_call, &out) != YAI_SDK_OK) return 2;
+    yai_sdk_reply_free(&out);
+  }
+  printf("call    %-6s calls=%d us/call=%.1f binary_frames=%llu\n", binary ? "binary" : "json", BENCH_CALLS,
+         (double)(bench_now_ns() - t0) / BENCH_CALLS / 1e3, (unsigned long long)stub_server_binary_calls(srv));
+  yai_sdk_client_close(c);
+  stub_server_stop(srv);
+  return 0;
+}
+
+int main(void)
+{
+  yai_bin_intern_t tx, rx;
+  yai_bin_call_t call;
+  yai_bin_reply_t reply;
+  uint8_t buf[1024];
+  char json[1024];
+  size_t first, steady = 0, rlen = 0;
+  uint64_t t0;
+  volatile size_t sink = 0;
+
+  /* call: first frame spells the command id, later ones reference it */
+  yai_bin_intern_reset(&tx);
+  first = yai_bin_call_encode(&k_bin_call, &tx, buf, sizeof(buf));
+  t0 = bench_now_ns();
+  for (int i = 0; i < BENCH_ITERS; i++) {
+    cJSON *root = cJSON_ParseWithLength(k_call, sizeof(k_call) - 1);
+    char *txt = cJSON_PrintUnformatted(root);
+    sink += strlen(txt);
+    cJSON_free(txt);
+    cJSON_Delete(root);
+  }
+  printf("call    json   bytes=%zu parse+print ns=%.0f\n", sizeof(k_call) - 1, per_iter(t0));
+  t0 = bench_now_ns();
+  for (int i = 0; i < BENCH_ITERS; i++) steady = yai_bin_call_encode(&k_bin_call, &tx, buf, sizeof(buf));
+  printf("call    binary bytes=%zu (first %zu) encode ns=%.0f\n", steady, first, per_iter(t0));
+  yai_bin_intern_reset(&rx);
+  yai_bin_call_decode(buf, first, &rx, &call);
+  t0 = bench_now_ns();
+  for (int i = 0; i < BENCH_ITERS; i++) sink += (size_t)yai_bin_call_decode(buf, steady, &rx, &call);
+  printf("call    binary decode ns=%.0f\n", per_iter(t0));
+
+  /* reply: JSON tree decode versus binary decode, and binary back to JSON */
+  t0 = bench_now_ns();
+  for (int i = 0; i < BENCH_ITERS; i++) {
+    cJSON *root = cJSON_ParseWithLength(k_reply, sizeof(k_reply) - 1);
+    sink += (size_t)(root != NULL);
+    cJSON_Delete(root);
+  }
+  printf("reply   json   bytes=%zu tree decode ns=%.0f\n", sizeof(k_reply) - 1, per_iter(t0));
+  t0 = bench_now_ns();
+  for (int i = 0; i < BENCH_ITERS; i++) rlen = yai_bin_reply_encode(&k_bin_reply, &tx, buf, sizeof(buf));
+  printf("reply   binary bytes=%zu encode ns=%.0f\n", rlen, per_iter(t0));
+  t0 = bench_now_ns();
+  for (int i = 0; i < BENCH_ITERS; i++) sink += (size_t)yai_bin_reply_decode(buf, rlen, &rx, &reply);
+  printf("reply   binary decode ns=%.0f\n", per_iter(t0));
+  t0 = bench_now_ns();
+  for (int i = 0; i < BENCH_ITERS; i++) sink += yai_bin_reply_to_json(&reply, json, sizeof(json));
+  printf("reply   binary to_json ns=%.0f\n", per_iter(t0));
+  (void)sink;
+
+  if (bench_calls(0) != 0 || bench_calls(1) != 0) return 1;
+  return 0;
+}
@@ -0,0 +1,68 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+/*
+ * Reconciliation sweep: 10k yai.kernel.ws_status calls, one
+ * yai_sdk_client_call_json round trip each versus one
+ * yai_sdk_client_call_batch.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <yai_sdk/public.h>
+
+#include <stdio.h>
+#include <time.h>
+
+#include "bench_util.h"
+#include "../tests/support/stub_server.h"
+
+#define BENCH_CALLS 10000
+
+int main(void)
+{
+  static char bufs[BENCH_CALLS][128];
+  static const char *reqs[BENCH_CALLS];
+  static yai_sdk_reply_t outs[BENCH_CALLS];
+  yai_sdk_client_opts_t opts = {.ws_id = "bench", .auto_handshake = 1};
+  yai_sdk_client_t *c = NULL;
+  stub_server_t *srv = NULL;
+  uint64_t t0;
+  double serial_s;
+  double batch_s;
+
+  for (int i = 0; i < BENCH_CALLS; i++) {
+    snprintf(bufs[i], sizeof(bufs[i]),
+             "{\"type\":\"yai.control.call.v1\",\"command_id\":\"yai.kernel.ws_status\",\"argv\":[\"--ws-id\",\"ws_%d\"]}", i);
+    reqs[i] = bufs[i];
+  }
+  if (stub_server_start(&srv, NULL) != 0 || yai_sdk_client_open(&c, &opts) != YAI_SDK_OK) {
+    fprintf(stderr, "call_batch_bench: setup failed\n");
+    stub_server_stop(srv);
+    return 1;
+  }
+
+  t0 = bench_now_ns();
+  for (int i = 0; i < BENCH_CALLS; i++) {
+    if (yai_sdk_client_call_json(c, reqs[i], &outs[i]) != YAI_SDK_OK) {
+      fprintf(stderr, "call_batch_bench: serial call %d failed\n", i);
+      return 2;
+    }
+    yai_sdk_reply_free(&outs[i]);
+  }
+  serial_s = (double)(bench_now_ns() - t0) / 1e9;
+
+  t0 = bench_now_ns();
+  if (yai_sdk_client_call_batch(c, reqs, BENCH_CALLS, outs) != YAI_SDK_OK) {
+    fprintf(stderr, "call_batch_bench: batch failed\n");
+    return 2;
+  }
+  batch_s = (double)(bench_now_ns() - t0) / 1e9;
+  for (int i = 0; i < BENCH_CALLS; i++) yai_sdk_reply_free(&outs[i]);
+
+  printf("serial  calls=%d total=%.1fms calls/s=%.0f\n", BENCH_CALLS, serial_s * 1e3, BENCH_CALLS / serial_s);
+  printf("batch   calls=%d total=%.1fms calls/s=%.0f\n", BENCH_CALLS, batch_s * 1e3, BENCH_CALLS / batch_s);
+
+  yai_sdk_client_close(c);
+  stub_server_stop(srv);
+  return 0;
+}
@@ -0,0 +1,420 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+/*
+ * Command catalog lookups over a synthetic 50k-command registry: load
+ * time, then ns per lookup through the hash indexes and through a scan
+ * of the same catalog (its index detached), and shell completion of each
+ * path level, and filtered queries. Then the footprint of the command
+ * refs against the index's compact copy, the catalog's total footprint
+ * without and with the index, the same for a compact load before and
+ * after lookups fill in refs, and alias resolution over alias-heavy
+ * registries of growing size.
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <yai_sdk/public.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "bench_util.h"
+#include "../src/catalog/catalog_internal.h"
+
+#define BENCH_GROUPS 500
+#define BENCH_PER_GROUP 100
+#define BENCH_COMMANDS (BENCH_GROUPS * BENCH_PER_GROUP)
+#define BENCH_LOOKUPS 200000
+#define BENCH_SCANS 200
+#define BENCH_ALIASES 4
+#define BENCH_QUERIES 2000
+
+static const char *k_entrypoints[] = {"run", "ws", "gov", "data", "net", "sys", "dev", "ops"};
+static const char *k_surfaces[] = {"surface", "ancillary", "plumbing"};
+static const char *k_stabilities[] = {"stable", "experimental", "planned", "deprecated"};
+
+static char *fmt(const char *f, size_t a, size_t b, const char *s)
+{
+  char buf[160];
+  snprintf(buf, sizeof(buf), f, s ? s : "", a, b);
+  return strdup(buf);
+}
+
+/*
+ * groups gNNN, each with commands cNNN under one entrypoint; topic = group,
+ * op = name. With aliases, command k gets BENCH_ALIASES - 1 aliases of its
+ * own ("kN.J") and one it shares with its neighbour ("pN", ambiguous).
+ */
+static void synth_registry(yai_law_registry_t *reg, size_t groups, int aliases)
+{
+  size_t n = groups * BENCH_PER_GROUP;
+  yai_law_command_t *cmds = (yai_law_command_t *)calloc(n, sizeof(*cmds));
+
+  for (size_t g = 0; g < groups; g++) {
+    for (size_t i = 0; i < BENCH_PER_GROUP; i++) {
+      size_t k = g * BENCH_PER_GROUP + i;
+      yai_law_command_t *c = &cmds[k];
+      const char *ep = k_entrypoints[g % 8];
+      c->group = fmt("%sg%03zu", g, 0, NULL);
+      c->name = fmt("%sc%03zu", i, 0, NULL);
+      c->id = fmt("yai.%sg%03zu.c%03zu", g, i, NULL);
+      c->entrypoint = ep;
+      c->topic = c->group;
+      c->op = c->name;
+      c->canonical_path = fmt("%s g%03zu c%03zu", g, i, ep);
+      c->surface = k_surfaces[i % 3];
+      c->stability = k_stabilities[(i / 3) % 4];
+      c->hidden = (i % 10 == 0);
+      c->deprecated = (i % 17 == 0);
+      if (aliases) {
+        const char **a = (const char **)calloc(BENCH_ALIASES, sizeof(*a));
+        for (size_t j = 0; j + 1 < BENCH_ALIASES; j++) a[j] = fmt("%sk%zu.%zu", k, j, NULL);
+        a[BENCH_ALIASES - 1] = fmt("%sp%zu", k / 2, 0, NULL);
+        c->aliases = a;
+        c->aliases_len = BENCH_ALIASES;
+      }
+    }
+  }
+  memset(reg, 0, sizeof(*reg));
+  reg->commands = cmds;
+  reg->commands_len = n;
+}
+
+static void free_registry(yai_law_registry_t *reg)
+{
+  yai_law_command_t *cmds = (yai_law_command_t *)reg->commands;
+
+  for (size_t k = 0; k < reg->commands_len; k++) {
+    free((void *)cmds[k].group);
+    free((void *)cmds[k].name);
+    free((void *)cmds[k].id);
+    free((void *)cmds[k].canonical_path);
+    for (size_t j = 0; j < cmds[k].aliases_len; j++) free((void *)cmds[k].aliases[j]);
+    free((void *)cmds[k].aliases);
+  }
+  free(cmds);
+}
+
+typedef const yai_sdk_command_ref_t *(*lookup_fn)(const yai_sdk_command_catalog_t *cat, size_t k);
+
+static volatile size_t g_hits;
+/* what a lookup without a ref of its own returns for a hit */
+static const yai_sdk_command_ref_t g_hit;
+
+static const yai_sdk_command_ref_t *by_id(const yai_sdk_command_catalog_t *cat, size_t k)
+{
+  char id[64];
+  snprintf(id, sizeof(id), "yai.g%03zu.c%03zu", (k / BENCH_PER_GROUP) % BENCH_GROUPS, k % BENCH_PER_GROUP);
+  return yai_sdk_command_catalog_find_by_id(cat, id);
+}
+
+static const yai_sdk_command_ref_t *by_command(const yai_sdk_command_catalog_t *cat, size_t k)
+{
+  char group[16], name[16];
+  snprintf(group, sizeof(group), "g%03zu", (k / BENCH_PER_GROUP) % BENCH_GROUPS);
+  snprintf(name, sizeof(name), "c%03zu", k % BENCH_PER_GROUP);
+  return yai_sdk_command_catalog_find_command(cat, group, name);
+}
+
+static const yai_sdk_command_ref_t *by_canonical(const yai_sdk_command_catalog_t *cat, size_t k)
+{
+  char path[64];
+  size_t g = (k / BENCH_PER_GROUP) % BENCH_GROUPS;
+  snprintf(path, sizeof(path), "%s g%03zu c%03zu", k_entrypoints[g % 8], g, k % BENCH_PER_GROUP);
+  return yai_sdk_command_catalog_find_by_canonical_path(cat, path, NULL);
+}
+
+static const yai_sdk_command_ref_t *by_path(const yai_sdk_command_catalog_t *cat, size_t k)
+{
+  char topic[16], op[16];
+  size_t g = (k / BENCH_PER_GROUP) % BENCH_GROUPS;
+  snprintf(topic, sizeof(topic), "g%03zu", g);
+  snprintf(op, sizeof(op), "c%03zu", k % BENCH_PER_GROUP);
+  return yai_sdk_command_catalog_find_by_path(cat, k_entrypoints[g % 8], topic, op, 0);
+}
+
+static const yai_sdk_command_ref_t *by_resolve(const yai_sdk_command_catalog_t *cat, size_t k)
+{
+  char topic[16], op[16];
+  size_t g = (k / BENCH_PER_GROUP) % BENCH_GROUPS;
+  const char *tokens[3] = {k_entrypoints[g % 8], topic, op};
+  yai_sdk_catalog_resolve_status_t st;
+  snprintf(topic, sizeof(topic), "g%03zu", g);
+  snprintf(op, sizeof(op), "c%03zu", k % BENCH_PER_GROUP);
+  return yai_sdk_command_catalog_resolve_path(cat, tokens, 3, NULL, &st);
+}
+
+static const yai_sdk_command_ref_t *by_unknown_topic(const yai_sdk_command_catalog_t *cat, size_t k)
+{
+  const char *tokens[3] = {k_entrypoints[k % 8], "no-such-topic", "c000"};
+  yai_sdk_catalog_resolve_status_t st;
+  (void)yai_sdk_command_catalog_resolve_path(cat, tokens, 3, NULL, &st);
+  return (st == YAI_SDK_CATALOG_RESOLVE_UNKNOWN_TOPIC) ? &g_hit : NULL;
+}
+
+/* a hit is a non-empty completion */
+static const yai_sdk_command_ref_t *complete(const yai_sdk_command_catalog_t *cat, const char **tokens, size_t depth,
+                                             const char *prefix)
+{
+  const char *out[16];
+  return yai_sdk_command_catalog_complete(cat, tokens, depth, prefix, NULL, out, 16) ? &g_hit : NULL;
+}
+
+static const yai_sdk_command_ref_t *complete_ep(const yai_sdk_command_catalog_t *cat, size_t k)
+{
+  (void)k;
+  return complete(cat, NULL, 0, "");
+}
+
+static const yai_sdk_command_ref_t *complete_topic(const yai_sdk_command_catalog_t *cat, size_t k)
+{
+  char prefix[8];
+  size_t g = (k / BENCH_PER_GROUP) % BENCH_GROUPS;
+  const char *tokens[1] = {k_entrypoints[g % 8]};
+  snprintf(prefix, sizeof(prefix), "g%zu", g / 100);
+  return complete(cat, tokens, 1, prefix);
+}
+
+static const yai_sdk_command_ref_t *complete_op(const yai_sdk_command_catalog_t *cat, size_t k)
+{
+  char topic[16], prefix[8];
+  size_t g = (k / BENCH_PER_GROUP) % BENCH_GROUPS;
+  const char *tokens[2] = {k_entrypoints[g % 8], topic};
+  snprintf(topic, sizeof(topic), "g%03zu", g);
+  snprintf(prefix, sizeof(prefix), "c0%zu", (k % BENCH_PER_GROUP) / 10);
+  return complete(cat, tokens, 2, prefix);
+}
+
+static size_t g_alias_commands = BENCH_COMMANDS;
+
+static const yai_sdk_command_ref_t *by_alias(const yai_sdk_command_catalog_t *cat, size_t k)
+{
+  char alias[32];
+  k %= g_alias_commands;
+  snprintf(alias, sizeof(alias), "k%zu.%zu", k, k % (BENCH_ALIASES - 1));
+  return yai_sdk_command_catalog_find_by_alias(cat, alias, NULL);
+}
+
+static const yai_sdk_command_ref_t *by_ambiguous_alias(const yai_sdk_command_catalog_t *cat, size_t k)
+{
+  char alias[32];
+  int ambiguous = 0;
+  snprintf(alias, sizeof(alias), "p%zu", (k % g_alias_commands) / 2);
+  (void)yai_sdk_command_catalog_find_by_alias(cat, alias, &ambiguous);
+  /* a hit is a reported ambiguity */
+  return ambiguous ? &g_hit : NULL;
+}
+
+static const yai_sdk_command_ref_t *by_resolve_alias(const yai_sdk_command_catalog_t *cat, size_t k)
+{
+  char alias[32];
+  const char *tokens[1] = {alias};
+  yai_sdk_catalog_resolve_status_t st;
+  k %= g_alias_commands;
+  snprintf(alias, sizeof(alias), "k%zu.0", k);
+  return yai_sdk_command_catalog_resolve_path(cat, tokens, 1, NULL, &st);
+}
+
+static double run(const yai_sdk_command_catalog_t *cat, lookup_fn fn, size_t n)
+{
+  uint64_t t0 = bench_now_ns();
+  for (size_t i = 0; i < n; i++) {
+    /* stride through the catalog so consecutive lookups miss the cache */
+    if (fn(cat, (i * 7919u) % BENCH_COMMANDS)) g_hits++;
+  }
+  return (double)(bench_now_ns() - t0) / (double)n;
+}
+
+static void bench_n(const yai_sdk_command_catalog_t *cat, const char *label, lookup_fn fn, size_t lookups)
+{
+  yai_sdk_command_catalog_t scan = *cat;
+  size_t before = g_hits;
+  double indexed, scanned;
+
+  scan.index = NULL;
+  indexed = run(cat, fn, lookups);
+  scanned = run(&scan, fn, BENCH_SCANS);
+  printf("lookup  %-14s indexed_ns=%-8.0f scan_ns=%-10.0f hits=%zu\n", label, indexed, scanned, g_hits - before);
+}
+
+static void bench(const yai_sdk_command_catalog_t *cat, const char *label, lookup_fn fn)
+{
+  bench_n(cat, label, fn, BENCH_LOOKUPS);
+}
+
+/* filtered queries: k picks the filter, and an entrypoint for odd k */
+static const yai_sdk_command_ref_t *query(const yai_sdk_command_catalog_t *cat, size_t k, int count_only)
+{
+  static const yai_sdk_command_ref_t *out[BENCH_COMMANDS];
+  yai_sdk_catalog_filter_t f = {0};
+
+  f.surface_mask = (k & 2) ? YAI_SDK_CATALOG_SURFACE_SURFACE : YAI_SDK_CATALOG_SURFACE_ALL;
+  f.stability_mask = YAI_SDK_CATALOG_STABILITY_STABLE | YAI_SDK_CATALOG_STABILITY_EXPERIMENTAL;
+  f.include_hidden = (k & 4) != 0;
+  f.entrypoint = (k & 1) ? k_entrypoints[(k >> 3) % 8] : NULL;
+  if (yai_sdk_command_catalog_query(cat, &f, count_only ? NULL : out, count_only ? 0 : BENCH_COMMANDS) == 0) return NULL;
+  return &g_hit;
+}
+
+static const yai_sdk_command_ref_t *query_all(const yai_sdk_command_catalog_t *cat, size_t k)
+{
+  return query(cat, k & ~(size_t)1, 0);
+}
+
+static const yai_sdk_command_ref_t *query_entrypoint(const yai_sdk_command_catalog_t *cat, size_t k)
+{
+  return query(cat, k | 1, 0);
+}
+
+static const yai_sdk_command_ref_t *query_count(const yai_sdk_command_catalog_t *cat, size_t k)
+{
+  return query(cat, k & ~(size_t)1, 1);
+}
+
+/* a topic without an entrypoint visits every command: refs vs the compact copy */
+static const yai_sdk_command_ref_t *query_topic(const yai_sdk_command_catalog_t *cat, size_t k)
+{
+  static const yai_sdk_command_ref_t *out[64];
+  char topic[16];
+  yai_sdk_catalog_filter_t f = {0};
+
+  snprintf(topic, sizeof(topic), "g%03zu", (k / BENCH_PER_GROUP) % BENCH_GROUPS);
+  f.topic = topic;
+  f.include_hidden = 1;
+  return yai_sdk_command_catalog_query(cat, &f, out, 64) ? out[0] : NULL;
+}
+
+static void bench_layout(const yai_sdk_command_catalog_t *cat)
+{
+  size_t refs = cat->command_count * (sizeof(yai_sdk_command_ref_t) + sizeof(yai_sdk_command_ref_t *)) +
+                cat->group_count * sizeof(yai_sdk_command_group_t);
+  size_t compact = yai_catalog_index_compact_bytes(cat);
+  size_t index = yai_catalog_index_bytes(cat);
+
+  printf("layout  refs_bytes=%zu (%zu/command) compact_bytes=%zu (%zu/command) index_bytes=%zu\n", refs,
+         refs / cat->command_count, compact, compact / cat->command_count, index);
+  /* the compact copy sits next to the refs, it does not replace them */
+  printf("layout  total refs_only=%zu (%zu/command) refs_and_index=%zu (%zu/command)\n", refs,
+         refs / cat->command_count, refs + index, (refs + index) / cat->command_count);
+  bench_n(cat, "scan_topic", query_topic, BENCH_QUERIES);
+}
+
+/* refs a compact catalog has filled in so far */
+static size_t filled_bytes(const yai_sdk_command_catalog_t *cat)
+{
+  size_t bytes = 0;
+  for (size_t g = 0; g < cat->group_count; g++) {
+    if (cat->groups[g].commands) bytes += cat->groups[g].command_count * sizeof(yai_sdk_command_ref_t);
+  }
+  return bytes;
+}
+
+static void compact_footprint(const yai_sdk_command_catalog_t *cat, const char *when)
+{
+  size_t base = yai_catalog_index_bytes(cat) + cat->group_count * sizeof(yai_sdk_command_group_t);
+  size_t refs = filled_bytes(cat);
+
+  printf("compact %-14s index_and_groups=%zu refs_bytes=%zu total=%zu (%zu/command)\n", when, base, refs, base + refs,
+         (base + refs) / cat->command_count);
+}
+
+static void bench_compact_lookup(const yai_sdk_command_catalog_t *cat, const char *label, lookup_fn fn, size_t n)
+{
+  size_t before = g_hits;
+  double ns = run(cat, fn, n);
+  printf("compact %-14s indexed_ns=%-8.0f hits=%zu\n", label, ns, g_hits - before);
+}
+
+/* the same registry, loaded compact: no refs until a lookup hands one out */
+static int bench_compact(const yai_law_registry_t *reg)
+{
+  yai_sdk_command_catalog_t cat;
+  uint64_t t0 = bench_now_ns();
+
+  if (yai_catalog_load_compact_from(&cat, reg) != 0) {
+    fprintf(stderr, "catalog_bench: compact load failed\n");
+    return 1;
+  }
+  printf("compact load commands=%zu groups=%zu ms=%.1f\n", cat.command_count, cat.group_count,
+         (double)(bench_now_ns() - t0) / 1e6);
+  compact_footprint(&cat, "at_load");
+  bench_compact_lookup(&cat, "complete_op", complete_op, BENCH_LOOKUPS);
+  bench_compact_lookup(&cat, "query_count", query_count, BENCH_QUERIES);
+  compact_footprint(&cat, "after_counts");
+  bench_compact_lookup(&cat, "find_by_id", by_id, BENCH_LOOKUPS);
+  bench_compact_lookup(&cat, "find_command", by_command, BENCH_LOOKUPS);
+  bench_compact_lookup(&cat, "resolve_path", by_resolve, BENCH_LOOKUPS);
+  bench_compact_lookup(&cat, "query_all", query_all, BENCH_QUERIES);
+  compact_footprint(&cat, "after_lookups");
+  yai_sdk_command_catalog_free(&cat);
+  return 0;
+}
+
+static int bench_alias_scaling(size_t groups)
+{
+  yai_law_registry_t reg;
+  yai_sdk_command_catalog_t cat;
+  uint64_t t0;
+
+  synth_registry(&reg, groups, 1);
+  t0 = bench_now_ns();
+  if (yai_catalog_load_from(&cat, &reg) != 0) {
+    fprintf(stderr, "catalog_bench: alias load failed\n");
+    free_registry(&reg);
+    return 1;
+  }
+  g_alias_commands = cat.command_count;
+  printf("aliases commands=%zu aliases=%zu ms=%.1f\n", cat.command_count, cat.command_count * BENCH_ALIASES,
+         (double)(bench_now_ns() - t0) / 1e6);
+  bench(&cat, "find_by_alias", by_alias);
+  bench(&cat, "ambiguous", by_ambiguous_alias);
+  bench(&cat, "resolve_alias", by_resolve_alias);
+  yai_sdk_command_catalog_free(&cat);
+  free_registry(&reg);
+  return 0;
+}
+
+int main(void)
+{
+  static const size_t alias_groups[] = {10, 100, BENCH_GROUPS};
+  yai_law_registry_t reg;
+  yai_sdk_command_catalog_t cat;
+  uint64_t t0;
+
+  synth_registry(&reg, BENCH_GROUPS, 0);
+  t0 = bench_now_ns();
+  if (yai_catalog_load_from(&cat, &reg) != 0) {
+    fprintf(stderr, "catalog_bench: load failed\n");
+    return 1;
+  }
+  printf("load    commands=%zu groups=%zu ms=%.1f\n", cat.command_count, cat.group_count,
+         (double)(bench_now_ns() - t0) / 1e6);
+
+  bench(&cat, "find_by_id", by_id);
+  bench(&cat, "find_command", by_command);
+  bench(&cat, "canonical_path", by_canonical);
+  bench(&cat, "find_by_path", by_path);
+  bench(&cat, "resolve_path", by_resolve);
+  bench(&cat, "unknown_topic", by_unknown_topic);
+  bench(&cat, "complete_ep", complete_ep);
+  bench(&cat, "complete_topic", complete_topic);
+  bench(&cat, "complete_op", complete_op);
+  bench_n(&cat, "query_all", query_all, BENCH_QUERIES);
+  bench_n(&cat, "query_ep", query_entrypoint, BENCH_QUERIES);
+  bench_n(&cat, "query_count", query_count, BENCH_QUERIES);
+  bench_layout(&cat);
+  yai_sdk_command_catalog_free(&cat);
+
+  if (bench_compact(&reg) != 0) {
+    free_registry(&reg);
+    return 1;
+  }
+  free_registry(&reg);
+
+  for (size_t i = 0; i < sizeof(alias_groups) / sizeof(alias_groups[0]); i++) {
+    if (bench_alias_scaling(alias_groups[i]) != 0) return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,122 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+/*
+ * LZ4 block codec on a catalog-shaped JSON document (ratio, compress and
+ * decompress MB/s), then the per-call effect of payload compression: the
+ * same calls against a local stand-in root server with
+ * YAI_RPC_CAP_COMPRESSION granted and refused, at several reply sizes.
+ * The stub pads replies with a single repeated byte, so the end-to-end
+ * numbers show the best case; the codec numbers are the realistic ones.
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <yai_sdk/public.h>
+#include <yai_sdk/rpc.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "bench_util.h"
+#include "../src/platform/lz4_block.h"
+#include "../tests/support/stub_server.h"
+
+#define BENCH_DOC_BYTES (1024u * 1024u)
+#define BENCH_CODEC_ROUNDS 200
+#define BENCH_CALLS 2000
+
+/* Command entries like the ones a catalog listing returns. */
+static size_t fill_doc(char *doc, size_t cap)
+{
+  static const char *groups[] = {"kernel", "root", "workspace", "law", "audit", "session"};
+  static const char *verbs[] = {"status", "list", "open", "close", "inspect", "attach", "sync"};
+  size_t n = (size_t)snprintf(doc, cap, "{\"commands\":[");
+  for (unsigned i = 0; n + 512 < cap; i++) {
+    const char *g = groups[i % 6];
+    const char *v = verbs[(i / 6) % 7];
+    n += (size_t)snprintf(doc + n, cap - n,
+                          "{\"id\":\"yai.%s.%s_%u\",\"group\":\"%s\",\"summary\":\"%s the %s resource %u\","
+                          "\"side_effect\":%s,\"args\":[{\"name\":\"ws_id\",\"required\":true}]},",
+                          g, v, i, g, v, g, i * 2654435761u % 100000u, (i & 1) ? "true" : "false");
+  }
+  n += (size_t)snprintf(doc + n, cap - n, "{}]}");
+  return n;
+}
+
+static int bench_codec(void)
+{
+  char *doc = (char *)malloc(BENCH_DOC_BYTES);
+  size_t bound = yai_lz4_bound(BENCH_DOC_BYTES);
+  unsigned char *z = (unsigned char *)malloc(bound);
+  char *back = (char *)malloc(BENCH_DOC_BYTES);
+  size_t n;
+  size_t zn = 0;
+  uint64_t t0;
+  double c_ns;
+  double d_ns;
+
+  if (!doc || !z || !back) return 1;
+  n = fill_doc(doc, BENCH_DOC_BYTES);
+
+  t0 = bench_now_ns();
+  for (int i = 0; i < BENCH_CODEC_ROUNDS; i++) zn = yai_lz4_compress(doc, n, z, bound);
+  c_ns = (double)(bench_now_ns() - t0);
+  t0 = bench_now_ns();
+  for (int i = 0; i < BENCH_CODEC_ROUNDS; i++) {
+    if (yai_lz4_decompress(z, zn, back, n) != 0) return 2;
+  }
+  d_ns = (double)(bench_now_ns() - t0);
+  if (zn == 0 || memcmp(doc, back, n) != 0) return 3;
+
+  printf("codec   doc=%zu compressed=%zu ratio=%.2f compress MB/s=%.0f decompress MB/s=%.0f\n", n, zn,
+         (double)n / (double)zn, (double)n * BENCH_CODEC_ROUNDS / c_ns * 1e3,
+         (double)n * BENCH_CODEC_ROUNDS / d_ns * 1e3);
+  free(doc);
+  free(z);
+  free(back);
+  return 0;
+}
+
+static int bench_calls(int compress, size_t pad)
+{
+  stub_server_opts_t so = {.reply_pad = pad, .caps_refused = compress ? 0 : YAI_RPC_CAP_COMPRESSION};
+  yai_sdk_client_opts_t opts = {.ws_id = "bench", .auto_handshake = 1};
+  const char *req = "{\"type\":\"yai.control.call.v1\",\"command_id\":\"yai.kernel.ws_status\",\"argv\":[]}";
+  yai_sdk_client_t *c = NULL;
+  stub_server_t *srv = NULL;
+  yai_sdk_reply_t out;
+  uint64_t t0;
+
+  if (stub_server_start(&srv, &so) != 0 || yai_sdk_client_open(&c, &opts) != YAI_SDK_OK) {
+    fprintf(stderr, "compression_bench: setup failed\n");
+    stub_server_stop(srv);
+    return 1;
+  }
+  t0 = bench_now_ns();
+  for (int i = 0; i < BENCH_CALLS; i++) {
+    if (yai_sdk_client_call_json(c, req, &out) != YAI_SDK_OK) return 2;
+    yai_sdk_reply_free(&out);
+  }
+  printf("call    compression=%-3s reply_pad=%-8zu calls=%d us/call=%.2f compressed_frames=%llu\n",
+         compress ? "on" : "off", pad, BENCH_CALLS, (double)(bench_now_ns() - t0) / BENCH_CALLS / 1e3,
+         (unsigned long long)stub_server_compressed_frames(srv));
+  yai_sdk_client_close(c);
+  stub_server_stop(srv);
+  return 0;
+}
+
+int main(void)
+{
+  static const size_t pads[] = {1024, 16 * 1024, 256 * 1024, 1024 * 1024};
+
+  if (bench_codec() != 0) {
+    fprintf(stderr, "compression_bench: codec round trip failed\n");
+    return 1;
+  }
+  for (size_t i = 0; i < sizeof(pads) / sizeof(pads[0]); i++) {
+    if (bench_calls(0, pads[i]) != 0 || bench_calls(1, pads[i]) != 0) return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,106 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+/*
+ * Connect setup cost: runtime location lookups and the root socket
+ * connect itself, cold (the location cache dropped before every call, as
+ * each call resolved from scratch before the cache) and warm.
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <yai_sdk/public.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "bench_util.h"
+#include "../tests/support/stub_server.h"
+
+#define BENCH_LOOKUPS 200000
+#define BENCH_CONNECTS 20000
+
+typedef int (*locate_fn)(char *out, size_t cap);
+
+static void bench_locate(const char *label, locate_fn fn)
+{
+  char buf[4096];
+  uint64_t cold = 0;
+  uint64_t t0;
+
+  for (int i = 0; i < BENCH_LOOKUPS; i++) {
+    yai_path_cache_invalidate();
+    t0 = bench_now_ns();
+    (void)fn(buf, sizeof(buf));
+    cold += bench_now_ns() - t0;
+  }
+  t0 = bench_now_ns();
+  for (int i = 0; i < BENCH_LOOKUPS; i++) (void)fn(buf, sizeof(buf));
+  printf("locate  %-12s cold_ns=%-8.0f warm_ns=%.0f\n", label, (double)cold / BENCH_LOOKUPS,
+         (double)(bench_now_ns() - t0) / BENCH_LOOKUPS);
+}
+
+static int bench_connect(void)
+{
+  yai_rpc_client_t c;
+  uint64_t cold = 0;
+  uint64_t t0;
+
+  for (int i = 0; i < BENCH_CONNECTS; i++) {
+    yai_path_cache_invalidate();
+    t0 = bench_now_ns();
+    if (yai_rpc_connect(&c, "bench") != 0) return 1;
+    cold += bench_now_ns() - t0;
+    yai_rpc_close(&c);
+  }
+  t0 = bench_now_ns();
+  for (int i = 0; i < BENCH_CONNECTS; i++) {
+    if (yai_rpc_connect(&c, "bench") != 0) return 1;
+    yai_rpc_close(&c);
+  }
+  /* warm includes the close; cold does not */
+  printf("connect %-12s cold_us=%-8.2f warm_us=%.2f (with close)\n", "root", (double)cold / BENCH_CONNECTS / 1e3,
+         (double)(bench_now_ns() - t0) / BENCH_CONNECTS / 1e3);
+  return 0;
+}
+
+int main(void)
+{
+  char dir[] = "/tmp/yai-connect-bench-XXXXXX";
+  char bin[128];
+  stub_server_t *srv = NULL;
+  FILE *f;
+  int rc;
+
+  /* a runtime binary found through PATH, behind a missing install root */
+  if (!mkdtemp(dir)) return 1;
+  snprintf(bin, sizeof(bin), "%s/yai-engine", dir);
+  f = fopen(bin, "w");
+  if (!f) return 1;
+  fclose(f);
+  chmod(bin, 0755);
+  setenv("YAI_INSTALL_ROOT", "/nonexistent", 1);
+  setenv("PATH", "/usr/local/sbin:/usr/local/bin:/usr/sbin:/usr/bin:/sbin", 1);
+  {
+    char path[512];
+    snprintf(path, sizeof(path), "%s:%s", getenv("PATH"), dir);
+    setenv("PATH", path, 1);
+  }
+
+  bench_locate("runtime_home", yai_path_runtime_home);
+  bench_locate("root_sock", yai_path_root_sock);
+  bench_locate("engine_bin", yai_path_engine_bin);
+
+  if (stub_server_start(&srv, NULL) != 0) {
+    fprintf(stderr, "connect_bench: setup failed\n");
+    return 1;
+  }
+  rc = bench_connect();
+  stub_server_stop(srv);
+  unlink(bin);
+  rmdir(dir);
+  return rc;
+}
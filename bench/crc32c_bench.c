@@ -0,0 +1,86 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+/*
+ * CRC32C throughput per kernel (GB/s at several buffer sizes), then the
+ * per-call cost of envelope checksums: the same calls against a local
+ * stand-in root server with YAI_RPC_CAP_CHECKSUM granted and refused.
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <yai_sdk/public.h>
+#include <yai_sdk/rpc.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "bench_util.h"
+#include "../src/platform/crc32c.h"
+#include "../tests/support/stub_server.h"
+
+#define BENCH_BYTES (256u * 1024u * 1024u)
+#define BENCH_CALLS 5000
+
+static int bench_calls(int checksum, size_t pad)
+{
+  stub_server_opts_t so = {.reply_pad = pad, .caps_refused = checksum ? 0 : YAI_RPC_CAP_CHECKSUM};
+  yai_sdk_client_opts_t opts = {.ws_id = "bench", .auto_handshake = 1};
+  const char *req = "{\"type\":\"yai.control.call.v1\",\"command_id\":\"yai.kernel.ws_status\",\"argv\":[]}";
+  yai_sdk_client_t *c = NULL;
+  stub_server_t *srv = NULL;
+  yai_sdk_reply_t out;
+  uint64_t t0;
+
+  if (stub_server_start(&srv, &so) != 0 || yai_sdk_client_open(&c, &opts) != YAI_SDK_OK) {
+    fprintf(stderr, "crc32c_bench: setup failed\n");
+    stub_server_stop(srv);
+    return 1;
+  }
+  t0 = bench_now_ns();
+  for (int i = 0; i < BENCH_CALLS; i++) {
+    if (yai_sdk_client_call_json(c, req, &out) != YAI_SDK_OK) return 2;
+    yai_sdk_reply_free(&out);
+  }
+  printf("call    checksum=%-3s reply_pad=%-6zu calls=%d us/call=%.2f\n", checksum ? "on" : "off", pad,
+         BENCH_CALLS, (double)(bench_now_ns() - t0) / BENCH_CALLS / 1e3);
+  yai_sdk_client_close(c);
+  stub_server_stop(srv);
+  return 0;
+}
+
+int main(void)
+{
+  static const char *kernels[] = {"bytewise", "slice8", "sse4.2", "armv8"};
+  static const size_t sizes[] = {64, 1024, 16384, 1048576};
+  uint8_t *buf = (uint8_t *)malloc(sizes[3]);
+  volatile uint32_t sink = 0;
+
+  if (!buf) return 1;
+  for (size_t i = 0; i < sizes[3]; i++) buf[i] = (uint8_t)(i * 2654435761u >> 13);
+
+  printf("active kernel: %s\n", yai_crc32c_active());
+  for (size_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++) {
+    yai_crc32c_fn fn = yai_crc32c_kernel(kernels[k]);
+    if (!fn) {
+      printf("kernel  %-8s unavailable\n", kernels[k]);
+      continue;
+    }
+    for (size_t z = 0; z < sizeof(sizes) / sizeof(sizes[0]); z++) {
+      /* the byte-at-a-time reference gets a smaller budget */
+      size_t total = (k == 0) ? BENCH_BYTES / 16 : BENCH_BYTES;
+      size_t iters = total / sizes[z];
+      uint64_t t0 = bench_now_ns();
+      for (size_t i = 0; i < iters; i++) sink ^= fn(sink, buf, sizes[z]);
+      double ns = (double)(bench_now_ns() - t0);
+      printf("kernel  %-8s size=%-8zu GB/s=%.2f\n", kernels[k], sizes[z], (double)(iters * sizes[z]) / ns);
+    }
+  }
+  (void)sink;
+  free(buf);
+
+  if (bench_calls(0, 0) != 0 || bench_calls(1, 0) != 0) return 1;
+  if (bench_calls(0, 256 * 1024) != 0 || bench_calls(1, 256 * 1024) != 0) return 1;
+  return 0;
+}
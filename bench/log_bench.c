@@ -0,0 +1,130 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+/*
+ * Cost per log event: disabled by level, delivered to a structured handler,
+ * formatted for a string handler, and queued on the async ring. Then whole
+ * calls against a local stand-in root server with DEBUG transport tracing
+ * off, synchronous and asynchronous.
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <yai_sdk/public.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "bench_util.h"
+#include "../src/platform/log_internal.h"
+#include "../tests/support/stub_server.h"
+
+#define BENCH_EVENTS 2000000
+#define BENCH_CALLS 5000
+
+static volatile size_t g_sink;
+
+static void on_event(const yai_sdk_log_event_t *ev, void *user)
+{
+  (void)user;
+  g_sink += ev->field_count;
+}
+
+static void on_text(yai_sdk_log_level_t level, const char *component, const char *message, void *user)
+{
+  (void)level;
+  (void)component;
+  (void)user;
+  g_sink += message[0];
+}
+
+static uint64_t emit(int events)
+{
+  const char *ws = "ws_bench";
+  uint64_t t0 = bench_now_ns();
+
+  for (int i = 0; i < events; i++) {
+    YAI_LOG(YAI_SDK_LOG_DEBUG, "rpc", "call", YAI_LOG_UINT("command", 259), YAI_LOG_STR("ws_id", ws),
+            YAI_LOG_INT("rc", 0), YAI_LOG_UINT("tx_bytes", 180 + (i & 63)), YAI_LOG_UINT("rx_bytes", 412));
+  }
+  return bench_now_ns() - t0;
+}
+
+static void bench_events(const char *label, int events)
+{
+  printf("event   %-10s events=%-8d ns/event=%.1f\n", label, events, (double)emit(events) / events);
+}
+
+/* Bursts no larger than the ring, with pauses for the drain thread, so the
+   number is the emitting thread's cost once its ring is warm. */
+static void bench_async(int bursts, int burst)
+{
+  struct timespec pause = {0, 5000000L};
+  uint64_t ns = 0;
+
+  emit(burst);
+  nanosleep(&pause, NULL);
+  for (int b = 0; b < bursts; b++) {
+    ns += emit(burst);
+    nanosleep(&pause, NULL);
+  }
+  printf("event   %-10s events=%-8d ns/event=%.1f\n", "async", bursts * burst, (double)ns / ((double)bursts * burst));
+}
+
+static int bench_calls(const char *label)
+{
+  yai_sdk_client_opts_t opts = {.ws_id = "bench", .auto_handshake = 1};
+  const char *req = "{\"type\":\"yai.control.call.v1\",\"command_id\":\"yai.kernel.ws_status\",\"argv\":[]}";
+  yai_sdk_client_t *c = NULL;
+  stub_server_t *srv = NULL;
+  yai_sdk_reply_t out;
+  uint64_t t0;
+
+  if (stub_server_start(&srv, NULL) != 0 || yai_sdk_client_open(&c, &opts) != YAI_SDK_OK) {
+    fprintf(stderr, "log_bench: setup failed\n");
+    stub_server_stop(srv);
+    return 1;
+  }
+  t0 = bench_now_ns();
+  for (int i = 0; i < BENCH_CALLS; i++) {
+    if (yai_sdk_client_call_json(c, req, &out) != YAI_SDK_OK) return 2;
+    yai_sdk_reply_free(&out);
+  }
+  printf("call    %-10s calls=%d us/call=%.2f\n", label, BENCH_CALLS, (double)(bench_now_ns() - t0) / BENCH_CALLS / 1e3);
+  yai_sdk_client_close(c);
+  stub_server_stop(srv);
+  return 0;
+}
+
+int main(void)
+{
+  int rc;
+
+  yai_sdk_set_log_level(YAI_SDK_LOG_WARN);
+  yai_sdk_set_log_event_handler(on_event, NULL);
+  bench_events("disabled", BENCH_EVENTS);
+
+  yai_sdk_set_log_level(YAI_SDK_LOG_DEBUG);
+  bench_events("structured", BENCH_EVENTS);
+  yai_sdk_set_log_event_handler(NULL, NULL);
+  yai_sdk_set_log_handler(on_text, NULL);
+  bench_events("formatted", BENCH_EVENTS / 4);
+
+  yai_sdk_set_log_handler(NULL, NULL);
+  yai_sdk_set_log_event_handler(on_event, NULL);
+  yai_sdk_log_async_start(4096);
+  bench_async(64, 4096);
+  yai_sdk_log_async_stop();
+  printf("async   dropped=%llu\n", (unsigned long long)yai_sdk_log_async_dropped());
+
+  yai_sdk_set_log_level(YAI_SDK_LOG_WARN);
+  rc = bench_calls("debug-off");
+  yai_sdk_set_log_level(YAI_SDK_LOG_DEBUG);
+  if (rc == 0) rc = bench_calls("debug-sync");
+  yai_sdk_log_async_start(0);
+  if (rc == 0) rc = bench_calls("debug-async");
+  yai_sdk_log_async_stop();
+  yai_sdk_set_log_event_handler(NULL, NULL);
+  return rc;
+}
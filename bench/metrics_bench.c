@@ -0,0 +1,112 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+/*
+ * Cost of call metrics: ns per recorded phase and per finished call, on
+ * one thread and with several threads sharing the process totals, then
+ * whole calls against a local stand-in root server with the latency
+ * breakdown the client recorded for them.
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <yai_sdk/public.h>
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "bench_util.h"
+#include "../src/platform/metrics_internal.h"
+#include "../tests/support/stub_server.h"
+
+#define BENCH_RECORDS 2000000
+#define BENCH_THREADS 4
+#define BENCH_CALLS 5000
+
+static yai_metrics_t g_local[BENCH_THREADS];
+
+/* What one call records: four phases and the call itself. */
+static void *record_loop(void *arg)
+{
+  yai_metrics_t *m = (yai_metrics_t *)arg;
+  for (uint64_t i = 0; i < BENCH_RECORDS; i++) {
+    uint64_t ns = 20000u + (i & 4095u);
+    yai_metrics_phase(m, YAI_SDK_PHASE_SEND, ns / 8u);
+    yai_metrics_phase(m, YAI_SDK_PHASE_WAIT, ns);
+    yai_metrics_phase(m, YAI_SDK_PHASE_PARSE, ns / 16u);
+    yai_metrics_phase(m, YAI_SDK_PHASE_CALL, ns + ns / 4u);
+    yai_metrics_call(m, "yai.kernel.ws_status", 0, ns, 96, 256);
+  }
+  return NULL;
+}
+
+static void bench_record(int threads)
+{
+  pthread_t th[BENCH_THREADS];
+  uint64_t t0 = bench_now_ns();
+
+  for (int i = 0; i < threads; i++) pthread_create(&th[i], NULL, record_loop, &g_local[i]);
+  for (int i = 0; i < threads; i++) pthread_join(th[i], NULL);
+  double ns = (double)(bench_now_ns() - t0);
+  /* wall time over all calls: flat as threads are added unless they contend */
+  printf("record  threads=%d calls/thread=%d ns/call=%.1f (5 records each)\n", threads, BENCH_RECORDS,
+         ns / ((double)BENCH_RECORDS * threads));
+}
+
+static int bench_calls(void)
+{
+  yai_sdk_client_opts_t opts = {.ws_id = "bench", .auto_handshake = 1};
+  const char *req = "{\"type\":\"yai.control.call.v1\",\"command_id\":\"yai.kernel.ws_status\",\"argv\":[]}";
+  yai_sdk_client_t *c = NULL;
+  stub_server_t *srv = NULL;
+  yai_sdk_reply_t out;
+  static yai_sdk_metrics_t m;
+  uint64_t t0;
+
+  if (stub_server_start(&srv, NULL) != 0 || yai_sdk_client_open(&c, &opts) != YAI_SDK_OK) {
+    fprintf(stderr, "metrics_bench: setup failed\n");
+    stub_server_stop(srv);
+    return 1;
+  }
+  t0 = bench_now_ns();
+  for (int i = 0; i < BENCH_CALLS; i++) {
+    if (yai_sdk_client_call_json(c, req, &out) != YAI_SDK_OK) return 2;
+    yai_sdk_reply_free(&out);
+  }
+  printf("call    calls=%d us/call=%.2f\n", BENCH_CALLS, (double)(bench_now_ns() - t0) / BENCH_CALLS / 1e3);
+
+  yai_sdk_client_metrics(c, &m);
+  for (int p = YAI_SDK_PHASE_SEND; p < YAI_SDK_PHASE_COUNT; p++) {
+    const yai_sdk_histogram_t *h = &m.phase[p];
+    printf("phase   %-9s count=%-6llu mean_us=%-7.2f p50_us=%-7.2f p99_us=%-7.2f max_us=%.2f\n",
+           yai_sdk_phase_name((yai_sdk_phase_t)p), (unsigned long long)h->count,
+           h->count ? (double)h->sum_ns / (double)h->count / 1e3 : 0.0,
+           (double)yai_sdk_histogram_quantile(h, 0.5) / 1e3, (double)yai_sdk_histogram_quantile(h, 0.99) / 1e3,
+           (double)h->max_ns / 1e3);
+  }
+  yai_sdk_client_close(c);
+  stub_server_stop(srv);
+  return 0;
+}
+
+int main(void)
+{
+  static yai_sdk_metrics_t m;
+  static char text[16384];
+  uint64_t t0;
+
+  bench_record(1);
+  bench_record(BENCH_THREADS);
+
+  yai_sdk_metrics_global(&m);
+  t0 = bench_now_ns();
+  for (int i = 0; i < 1000; i++) yai_sdk_metrics_global(&m);
+  printf("snapshot ns=%.0f\n", (double)(bench_now_ns() - t0) / 1000);
+  t0 = bench_now_ns();
+  for (int i = 0; i < 1000; i++) yai_sdk_metrics_format(&m, text, sizeof(text));
+  printf("format   ns=%.0f bytes=%zu\n", (double)(bench_now_ns() - t0) / 1000, strlen(text));
+
+  return bench_calls();
+}
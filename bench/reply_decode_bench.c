@@ -0,0 +1,141 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+/*
+ * Exec reply decoding: the cJSON tree decode the client used to run on every
+ * reply versus the single-pass scan behind yai_sdk_reply_parse. Heap calls
+ * are counted by interposing the libc allocator; only the measuring thread
+ * is counted, so the in-process server threads do not skew the numbers.
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <yai_sdk/public.h>
+
+#include <cJSON.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "bench_util.h"
+#include "../tests/support/stub_server.h"
+
+#define BENCH_ITERS 200000
+#define BENCH_CALLS 5000
+
+extern void *__libc_malloc(size_t n);
+extern void *__libc_calloc(size_t n, size_t sz);
+extern void *__libc_realloc(void *p, size_t n);
+extern void __libc_free(void *p);
+
+static _Thread_local int g_counting;
+static _Thread_local uint64_t g_allocs;
+
+void *malloc(size_t n) { g_allocs += (uint64_t)g_counting; return __libc_malloc(n); }
+void *calloc(size_t n, size_t sz) { g_allocs += (uint64_t)g_counting; return __libc_calloc(n, sz); }
+void *realloc(void *p, size_t n) { g_allocs += (uint64_t)g_counting; return __libc_realloc(p, n); }
+void free(void *p) { __libc_free(p); }
+
+static const char k_reply[] =
+    "{\"type\":\"yai.exec.reply.v1\",\"status\":\"ok\",\"code\":\"OK\",\"reason\":\"accepted\","
+    "\"summary\":\"Workspace status reported.\",\"command_id\":\"yai.kernel.ws_status\","
+    "\"trace_id\":\"bench-000000000042\",\"target_plane\":\"kernel\","
+    "\"hints\":[\"Use --json for machine output.\",\"See yai help ws.\"],"
+    "\"details\":{\"ws\":\"ws_bench\",\"state\":\"ready\",\"generation\":17},"
+    "\"data\":{\"sessions\":[{\"id\":1,\"role\":\"operator\"},{\"id\":2,\"role\":\"viewer\"}]}}";
+
+/* What yai_sdk_client_call_json did per reply before the scanner. */
+static int tree_decode(const char *json, size_t len, yai_sdk_reply_t *out)
+{
+  cJSON *resp = cJSON_ParseWithLength(json, len);
+  const cJSON *type;
+  const cJSON *it;
+  if (!resp) return -1;
+  type = cJSON_GetObjectItemCaseSensitive(resp, "type");
+  if (!cJSON_IsString(type) || strcmp(type->valuestring, "yai.exec.reply.v1") != 0) {
+    cJSON_Delete(resp);
+    return -1;
+  }
+#define TAKE(name) \
+  it = cJSON_GetObjectItemCaseSensitive(resp, #name); \
+  snprintf(out->name, sizeof(out->name), "%s", cJSON_IsString(it) ? it->valuestring : "");
+  TAKE(status) TAKE(code) TAKE(reason) TAKE(summary) TAKE(command_id) TAKE(trace_id) TAKE(target_plane)
+#undef TAKE
+  it = cJSON_GetObjectItemCaseSensitive(resp, "hints");
+  out->hint_count = 0;
+  for (int i = 0; i < 2 && cJSON_IsString(cJSON_GetArrayItem(it, i)); i++) {
+    snprintf(out->hints[i], sizeof(out->hints[i]), "%s", cJSON_GetArrayItem(it, i)->valuestring);
+    out->hint_count = i + 1;
+  }
+  it = cJSON_GetObjectItemCaseSensitive(resp, "details");
+  if (cJSON_IsObject(it)) {
+    char *tmp = cJSON_PrintUnformatted((cJSON *)it);
+    snprintf(out->details, sizeof(out->details), "%s", tmp ? tmp : "");
+    free(tmp);
+  }
+  cJSON_Delete(resp);
+  return 0;
+}
+
+int main(void)
+{
+  yai_sdk_reply_t out;
+  yai_sdk_reply_t tree;
+  yai_sdk_client_opts_t opts = {.ws_id = "bench", .auto_handshake = 1};
+  yai_sdk_client_t *c = NULL;
+  stub_server_t *srv = NULL;
+  const char *req = "{\"type\":\"yai.control.call.v1\",\"command_id\":\"yai.kernel.ws_status\",\"argv\":[]}";
+  uint64_t t0, a0;
+  double tree_ns, scan_ns, tree_allocs, scan_allocs;
+
+  memset(&tree, 0, sizeof(tree));
+  if (tree_decode(k_reply, sizeof(k_reply) - 1, &tree) != 0 ||
+      yai_sdk_reply_parse(k_reply, sizeof(k_reply) - 1, &out) != YAI_SDK_OK ||
+      strcmp(tree.details, out.details) != 0 || strcmp(tree.hints[1], out.hints[1]) != 0 ||
+      strcmp(tree.trace_id, out.trace_id) != 0) {
+    fprintf(stderr, "reply_decode_bench: decoders disagree\n");
+    return 1;
+  }
+
+  g_counting = 1;
+  a0 = g_allocs;
+  t0 = bench_now_ns();
+  for (int i = 0; i < BENCH_ITERS; i++) tree_decode(k_reply, sizeof(k_reply) - 1, &tree);
+  tree_ns = (double)(bench_now_ns() - t0) / BENCH_ITERS;
+  tree_allocs = (double)(g_allocs - a0) / BENCH_ITERS;
+
+  a0 = g_allocs;
+  t0 = bench_now_ns();
+  for (int i = 0; i < BENCH_ITERS; i++) yai_sdk_reply_parse(k_reply, sizeof(k_reply) - 1, &out);
+  scan_ns = (double)(bench_now_ns() - t0) / BENCH_ITERS;
+  scan_allocs = (double)(g_allocs - a0) / BENCH_ITERS;
+  g_counting = 0;
+
+  printf("tree    bytes=%zu ns/reply=%.0f allocs/reply=%.1f\n", sizeof(k_reply) - 1, tree_ns, tree_allocs);
+  printf("scan    bytes=%zu ns/reply=%.0f allocs/reply=%.1f\n", sizeof(k_reply) - 1, scan_ns, scan_allocs);
+
+  if (stub_server_start(&srv, NULL) != 0 || yai_sdk_client_open(&c, &opts) != YAI_SDK_OK ||
+      yai_sdk_client_call_json(c, req, &out) != YAI_SDK_OK) {
+    fprintf(stderr, "reply_decode_bench: setup failed\n");
+    stub_server_stop(srv);
+    return 1;
+  }
+  yai_sdk_reply_free(&out);
+
+  g_counting = 1;
+  a0 = g_allocs;
+  for (int i = 0; i < BENCH_CALLS; i++) {
+    if (yai_sdk_client_call_json(c, req, &out) != YAI_SDK_OK) {
+      fprintf(stderr, "reply_decode_bench: call %d failed\n", i);
+      return 2;
+    }
+    yai_sdk_reply_free(&out);
+  }
+  g_counting = 0;
+  printf("call    calls=%d allocs/call=%.1f\n", BENCH_CALLS, (double)(g_allocs - a0) / BENCH_CALLS);
+
+  yai_sdk_client_close(c);
+  stub_server_stop(srv);
+  return 0;
+}
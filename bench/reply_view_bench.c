@@ -0,0 +1,102 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+/*
+ * Fixed-array replies (yai_sdk_client_call_json) versus arena-backed views
+ * (yai_sdk_client_call_view) against a local stand-in root server, plus the
+ * decode step alone. Heap calls of the measuring thread are counted by
+ * interposing the libc allocator.
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <yai_sdk/public.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "bench_util.h"
+#include "../tests/support/stub_server.h"
+
+#define BENCH_ITERS 200000
+#define BENCH_CALLS 20000
+
+extern void *__libc_malloc(size_t n);
+extern void *__libc_calloc(size_t n, size_t sz);
+extern void *__libc_realloc(void *p, size_t n);
+extern void __libc_free(void *p);
+
+static _Thread_local int g_counting;
+static _Thread_local uint64_t g_allocs;
+
+void *malloc(size_t n) { g_allocs += (uint64_t)g_counting; return __libc_malloc(n); }
+void *calloc(size_t n, size_t sz) { g_allocs += (uint64_t)g_counting; return __libc_calloc(n, sz); }
+void *realloc(void *p, size_t n) { g_allocs += (uint64_t)g_counting; return __libc_realloc(p, n); }
+void free(void *p) { __libc_free(p); }
+
+static const char k_reply[] =
+    "{\"type\":\"yai.exec.reply.v1\",\"status\":\"ok\",\"code\":\"OK\",\"reason\":\"accepted\","
+    "\"summary\":\"Workspace status reported.\",\"command_id\":\"yai.kernel.ws_status\","
+    "\"trace_id\":\"bench-000000000042\",\"target_plane\":\"kernel\","
+    "\"hints\":[\"Use --json for machine output.\",\"See yai help ws.\",\"Run yai ws ls to list.\"],"
+    "\"details\":{\"ws\":\"ws_bench\",\"state\":\"ready\",\"generation\":17}}";
+
+int main(void)
+{
+  yai_sdk_reply_t fixed;
+  yai_sdk_reply_view_t view;
+  yai_sdk_arena_t *arena = NULL;
+  yai_sdk_client_opts_t opts = {.ws_id = "bench", .auto_handshake = 1};
+  yai_sdk_client_t *c = NULL;
+  stub_server_t *srv = NULL;
+  const char *req = "{\"type\":\"yai.control.call.v1\",\"command_id\":\"yai.kernel.ws_status\",\"argv\":[]}";
+  uint64_t t0, a0;
+
+  if (yai_sdk_arena_create(&arena, 0) != YAI_SDK_OK) return 1;
+
+  g_counting = 1;
+  t0 = bench_now_ns();
+  for (int i = 0; i < BENCH_ITERS; i++) yai_sdk_reply_parse(k_reply, sizeof(k_reply) - 1, &fixed);
+  printf("decode  fixed ns/reply=%.0f\n", (double)(bench_now_ns() - t0) / BENCH_ITERS);
+  a0 = g_allocs;
+  t0 = bench_now_ns();
+  for (int i = 0; i < BENCH_ITERS; i++) {
+    yai_sdk_arena_reset(arena);
+    yai_sdk_reply_view_parse(k_reply, sizeof(k_reply) - 1, arena, &view);
+  }
+  printf("decode  view  ns/reply=%.0f allocs/reply=%.1f hints=%zu\n",
+         (double)(bench_now_ns() - t0) / BENCH_ITERS, (double)(g_allocs - a0) / BENCH_ITERS, view.hint_count);
+  g_counting = 0;
+
+  if (stub_server_start(&srv, NULL) != 0 || yai_sdk_client_open(&c, &opts) != YAI_SDK_OK ||
+      yai_sdk_client_call_view(c, req, NULL, &view) != YAI_SDK_OK) {
+    fprintf(stderr, "reply_view_bench: setup failed\n");
+    stub_server_stop(srv);
+    return 1;
+  }
+
+  g_counting = 1;
+  a0 = g_allocs;
+  t0 = bench_now_ns();
+  for (int i = 0; i < BENCH_CALLS; i++) {
+    if (yai_sdk_client_call_json(c, req, &fixed) != YAI_SDK_OK) return 2;
+    yai_sdk_reply_free(&fixed);
+  }
+  printf("call    fixed calls=%d us/call=%.1f allocs/call=%.1f\n", BENCH_CALLS,
+         (double)(bench_now_ns() - t0) / BENCH_CALLS / 1e3, (double)(g_allocs - a0) / BENCH_CALLS);
+
+  a0 = g_allocs;
+  t0 = bench_now_ns();
+  for (int i = 0; i < BENCH_CALLS; i++) {
+    if (yai_sdk_client_call_view(c, req, NULL, &view) != YAI_SDK_OK) return 2;
+  }
+  printf("call    view  calls=%d us/call=%.1f allocs/call=%.1f\n", BENCH_CALLS,
+         (double)(bench_now_ns() - t0) / BENCH_CALLS / 1e3, (double)(g_allocs - a0) / BENCH_CALLS);
+  g_counting = 0;
+
+  yai_sdk_arena_destroy(arena);
+  yai_sdk_client_close(c);
+  stub_server_stop(srv);
+  return 0;
+}
@@ -0,0 +1,92 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+/*
+ * Pipelined control-call throughput against a local stand-in root server,
+ * sweeping the in-flight window. Window 1 is the blocking baseline.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <yai_sdk/rpc.h>
+
+#include <yai_protocol_ids.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "bench_util.h"
+#include "../tests/support/stub_server.h"
+
+#define BENCH_CALLS 50000
+
+static int run_blocking(yai_rpc_client_t *c, const char *req, uint32_t len)
+{
+  static char out[8192];
+  for (int i = 0; i < BENCH_CALLS; i++) {
+    uint32_t out_len = 0;
+    if (yai_rpc_call_raw(c, YAI_CMD_CONTROL_CALL, req, len, out, sizeof(out), &out_len) != 0) return -1;
+  }
+  return 0;
+}
+
+static int run_pipelined(yai_rpc_client_t *c, size_t window, const char *req, uint32_t len)
+{
+  yai_rpc_pipeline_t *p = NULL;
+  int submitted = 0;
+  int drained = 0;
+
+  if (yai_rpc_pipeline_open(&p, c, window) != 0) return -1;
+  while (drained < BENCH_CALLS) {
+    yai_rpc_reply_t r;
+    while (submitted < BENCH_CALLS &&
+           yai_rpc_pipeline_submit(p, YAI_CMD_CONTROL_CALL, req, len, NULL) == 0) {
+      submitted++;
+    }
+    if (yai_rpc_pipeline_next(p, &r) != 0) {
+      yai_rpc_pipeline_close(p);
+      return -1;
+    }
+    drained++;
+  }
+  yai_rpc_pipeline_close(p);
+  return 0;
+}
+
+int main(void)
+{
+  static const size_t windows[] = {1, 2, 4, 8, 16, 32, 64, 128, 256};
+  stub_server_t *srv = NULL;
+  yai_rpc_client_t c;
+  const char *req =
+      "{\"type\":\"yai.control.call.v1\",\"target_plane\":\"kernel\","
+      "\"command_id\":\"yai.kernel.ws_status\",\"argv\":[\"--ws-id\",\"bench\"]}";
+  uint32_t len = (uint32_t)strlen(req);
+  uint64_t t0;
+
+  if (stub_server_start(&srv, NULL) != 0 || yai_rpc_connect(&c, "bench") != 0) {
+    fprintf(stderr, "rpc_pipeline_bench: setup failed\n");
+    stub_server_stop(srv);
+    return 1;
+  }
+
+  t0 = bench_now_ns();
+  if (run_blocking(&c, req, len) != 0) {
+    fprintf(stderr, "rpc_pipeline_bench: blocking run failed\n");
+    return 2;
+  }
+  printf("blocking      calls/s=%.0f\n", BENCH_CALLS / ((double)(bench_now_ns() - t0) / 1e9));
+
+  for (size_t i = 0; i < sizeof(windows) / sizeof(windows[0]); i++) {
+    t0 = bench_now_ns();
+    if (run_pipelined(&c, windows[i], req, len) != 0) {
+      fprintf(stderr, "rpc_pipeline_bench: window=%zu failed\n", windows[i]);
+      return 2;
+    }
+    printf("window=%-6zu calls/s=%.0f\n", windows[i], BENCH_CALLS / ((double)(bench_now_ns() - t0) / 1e9));
+  }
+
+  yai_rpc_close(&c);
+  stub_server_stop(srv);
+  return 0;
+}
@@ -0,0 +1,142 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+/*
+ * Vectored vs legacy envelope+payload round trip over a local stand-in
+ * root server. Socket I/O syscalls are counted by interposing the libc
+ * wrappers below; only the measuring thread is counted, so the in-process
+ * server threads do not skew the numbers.
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <yai_sdk/rpc.h>
+
+#include <transport.h>
+#include <yai_protocol_ids.h>
+
+#include <errno.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "bench_util.h"
+#include "../tests/support/stub_server.h"
+
+#define BENCH_ITERS 20000
+
+static _Thread_local int g_counting;
+static _Thread_local uint64_t g_syscalls;
+
+#define COUNTED(call) (g_syscalls += (uint64_t)g_counting, (call))
+
+ssize_t read(int fd, void *buf, size_t n) { return COUNTED(syscall(SYS_read, fd, buf, n)); }
+ssize_t write(int fd, const void *buf, size_t n) { return COUNTED(syscall(SYS_write, fd, buf, n)); }
+ssize_t readv(int fd, const struct iovec *iov, int n) { return COUNTED(syscall(SYS_readv, fd, iov, n)); }
+ssize_t writev(int fd, const struct iovec *iov, int n) { return COUNTED(syscall(SYS_writev, fd, iov, n)); }
+ssize_t sendmsg(int fd, const struct msghdr *m, int f) { return COUNTED(syscall(SYS_sendmsg, fd, m, f)); }
+ssize_t recvmsg(int fd, struct msghdr *m, int f) { return COUNTED(syscall(SYS_recvmsg, fd, m, f)); }
+int poll(struct pollfd *p, nfds_t n, int t) { return (int)COUNTED(syscall(SYS_ppoll, p, n, t < 0 ? NULL : &(struct timespec){t / 1000, (long)(t % 1000) * 1000000L}, NULL, 0)); }
+
+static uint64_t thread_syscalls(void)
+{
+  g_counting = 1;
+  return g_syscalls;
+}
+
+static int io_exact(int fd, void *buf, size_t n, int writing)
+{
+  unsigned char *p = (unsigned char *)buf;
+  size_t off = 0;
+  while (off < n) {
+    ssize_t r = writing ? write(fd, p + off, n - off) : read(fd, p + off, n - off);
+    if (r < 0 && errno == EINTR) continue;
+    if (r <= 0) return -1;
+    off += (size_t)r;
+  }
+  return 0;
+}
+
+/* The pre-vectored path: two writes out, two reads back. */
+static int legacy_call(yai_rpc_client_t *c, const char *payload, uint32_t len, char *out, size_t cap)
+{
+  yai_rpc_envelope_t env;
+  yai_rpc_envelope_t resp;
+  memset(&env, 0, sizeof(env));
+  env.magic = YAI_FRAME_MAGIC;
+  env.version = YAI_PROTOCOL_IDS_VERSION;
+  env.command_id = YAI_CMD_CONTROL_CALL;
+  env.payload_len = len;
+  snprintf(env.ws_id, sizeof(env.ws_id), "%.*s", (int)sizeof(env.ws_id) - 1, c->ws_id);
+  snprintf(env.trace_id, sizeof(env.trace_id), "legacy-%u", ++c->trace_seq);
+  if (io_exact(c->fd, &env, sizeof(env), 1) != 0) return -1;
+  if (io_exact(c->fd, (void *)payload, len, 1) != 0) return -1;
+  if (io_exact(c->fd, &resp, sizeof(resp), 0) != 0) return -1;
+  if (resp.payload_len > cap) return -1;
+  return io_exact(c->fd, out, resp.payload_len, 0);
+}
+
+static void report(const char *name, uint64_t *lat, uint64_t syscalls)
+{
+  qsort(lat, BENCH_ITERS, sizeof(lat[0]), bench_cmp_u64);
+  printf("%-10s syscalls/call=%.2f p50=%.2fus p99=%.2fus\n",
+         name,
+         (double)syscalls / BENCH_ITERS,
+         (double)lat[BENCH_ITERS / 2] / 1000.0,
+         (double)lat[(BENCH_ITERS * 99) / 100] / 1000.0);
+}
+
+int main(void)
+{
+  stub_server_t *srv = NULL;
+  yai_rpc_client_t c;
+  static uint64_t lat[BENCH_ITERS];
+  static char out[8192];
+  const char *payload =
+      "{\"type\":\"yai.control.call.v1\",\"target_plane\":\"kernel\","
+      "\"command_id\":\"yai.kernel.ws_status\",\"argv\":[\"--ws-id\",\"bench\"]}";
+  uint32_t len = (uint32_t)strlen(payload);
+  uint64_t sc0;
+
+  if (stub_server_start(&srv, NULL) != 0) {
+    fprintf(stderr, "rpc_vectored_bench: stub server start failed\n");
+    return 1;
+  }
+  if (yai_rpc_connect(&c, "bench") != 0) {
+    fprintf(stderr, "rpc_vectored_bench: connect failed\n");
+    stub_server_stop(srv);
+    return 1;
+  }
+
+  sc0 = thread_syscalls();
+  for (int i = 0; i < BENCH_ITERS; i++) {
+    uint64_t t0 = bench_now_ns();
+    if (legacy_call(&c, payload, len, out, sizeof(out)) != 0) {
+      fprintf(stderr, "rpc_vectored_bench: legacy call failed\n");
+      return 2;
+    }
+    lat[i] = bench_now_ns() - t0;
+  }
+  report("legacy", lat, thread_syscalls() - sc0);
+
+  sc0 = thread_syscalls();
+  for (int i = 0; i < BENCH_ITERS; i++) {
+    uint32_t out_len = 0;
+    uint64_t t0 = bench_now_ns();
+    if (yai_rpc_call_raw(&c, YAI_CMD_CONTROL_CALL, payload, len, out, sizeof(out), &out_len) != 0) {
+      fprintf(stderr, "rpc_vectored_bench: vectored call failed\n");
+      return 2;
+    }
+    lat[i] = bench_now_ns() - t0;
+  }
+  report("vectored", lat, thread_syscalls() - sc0);
+
+  yai_rpc_close(&c);
+  stub_server_stop(srv);
+  return 0;
+}
@@ -0,0 +1,103 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+/*
+ * Contention sweep, 1..64 caller threads: one client per thread versus a
+ * shared client multiplexing every thread over 1 or 4 root connections.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <yai_sdk/public.h>
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "bench_util.h"
+#include "../tests/support/stub_server.h"
+
+#define BENCH_CALLS 40000
+
+static const char *k_req =
+    "{\"type\":\"yai.control.call.v1\",\"target_plane\":\"kernel\","
+    "\"command_id\":\"yai.kernel.ws_status\",\"argv\":[\"--ws-id\",\"bench\"]}";
+
+typedef struct job {
+  yai_sdk_shared_client_t *shared; /* NULL: own client */
+  int calls;
+  int failed;
+} job_t;
+
+static void *job_main(void *arg)
+{
+  job_t *j = (job_t *)arg;
+  yai_sdk_client_opts_t opts = {.ws_id = "bench", .auto_handshake = 1};
+  yai_sdk_client_t *own = NULL;
+
+  if (!j->shared && yai_sdk_client_open(&own, &opts) != YAI_SDK_OK) {
+    j->failed = 1;
+    return NULL;
+  }
+  for (int i = 0; i < j->calls && !j->failed; i++) {
+    yai_sdk_reply_t r;
+    int rc = j->shared ? yai_sdk_shared_client_call_json(j->shared, k_req, &r)
+                       : yai_sdk_client_call_json(own, k_req, &r);
+    if (rc != YAI_SDK_OK) j->failed = 1;
+    yai_sdk_reply_free(&r);
+  }
+  yai_sdk_client_close(own);
+  return NULL;
+}
+
+static int run(const char *name, int threads, size_t connections, stub_server_t *srv)
+{
+  yai_sdk_shared_client_opts_t so = {.ws_id = "bench", .connections = connections};
+  yai_sdk_shared_client_t *shared = NULL;
+  pthread_t th[64];
+  job_t jobs[64];
+  uint64_t acc0 = stub_server_accepts(srv);
+  uint64_t t0;
+  int failed = 0;
+
+  if (connections && yai_sdk_shared_client_open(&shared, &so) != YAI_SDK_OK) return -1;
+  t0 = bench_now_ns();
+  for (int i = 0; i < threads; i++) {
+    jobs[i].shared = shared;
+    jobs[i].calls = BENCH_CALLS / threads;
+    jobs[i].failed = 0;
+    pthread_create(&th[i], NULL, job_main, &jobs[i]);
+  }
+  for (int i = 0; i < threads; i++) {
+    pthread_join(th[i], NULL);
+    failed |= jobs[i].failed;
+  }
+  printf("%-10s threads=%-3d sockets=%-3llu calls/s=%.0f\n",
+         name, threads,
+         (unsigned long long)(stub_server_accepts(srv) - acc0),
+         (double)(BENCH_CALLS / threads * threads) / ((double)(bench_now_ns() - t0) / 1e9));
+  yai_sdk_shared_client_close(shared);
+  return failed ? -1 : 0;
+}
+
+int main(void)
+{
+  static const int threads[] = {1, 2, 4, 8, 16, 32, 64};
+  stub_server_t *srv = NULL;
+  int rc = 0;
+
+  if (stub_server_start(&srv, NULL) != 0) {
+    fprintf(stderr, "shared_client_bench: stub server start failed\n");
+    return 1;
+  }
+  for (size_t i = 0; i < sizeof(threads) / sizeof(threads[0]) && rc == 0; i++) {
+    if (run("per_thread", threads[i], 0, srv) != 0 ||
+        run("shared_x1", threads[i], 1, srv) != 0 ||
+        run("shared_x4", threads[i], 4, srv) != 0) {
+      fprintf(stderr, "shared_client_bench: threads=%d failed\n", threads[i]);
+      rc = 2;
+    }
+  }
+  stub_server_stop(srv);
+  return rc;
+}
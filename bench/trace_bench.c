@@ -0,0 +1,103 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+/*
+ * Cost of trace context: ns per new span id (the per-thread PRNG), per
+ * envelope trace_id and per traceparent, then whole calls against a local
+ * stand-in root server with span reporting off and on.
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <yai_sdk/public.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "bench_util.h"
+#include "../src/platform/trace_internal.h"
+#include "../tests/support/stub_server.h"
+
+#define BENCH_IDS 5000000
+#define BENCH_CALLS 5000
+
+static volatile uint64_t g_sink;
+
+static void on_span(const yai_sdk_span_t *span, void *user)
+{
+  (void)user;
+  g_sink += span->duration_ns;
+}
+
+static void bench_ids(void)
+{
+  yai_sdk_trace_ctx_t parent, ctx;
+  char text[YAI_SDK_TRACEPARENT_LEN + 1];
+  uint64_t t0;
+
+  yai_trace_start(&parent, NULL);
+  t0 = bench_now_ns();
+  for (int i = 0; i < BENCH_IDS; i++) {
+    yai_trace_start(&ctx, NULL);
+    g_sink += ctx.span_id[0];
+  }
+  printf("id      %-12s n=%d ns/op=%.1f\n", "new-trace", BENCH_IDS, (double)(bench_now_ns() - t0) / BENCH_IDS);
+  t0 = bench_now_ns();
+  for (int i = 0; i < BENCH_IDS; i++) {
+    yai_trace_start(&ctx, &parent);
+    g_sink += ctx.span_id[0];
+  }
+  printf("id      %-12s n=%d ns/op=%.1f\n", "child-span", BENCH_IDS, (double)(bench_now_ns() - t0) / BENCH_IDS);
+  t0 = bench_now_ns();
+  for (int i = 0; i < BENCH_IDS; i++) {
+    ctx.span_id[0] = (uint8_t)i;
+    yai_trace_to_wire(&ctx, text);
+    g_sink += (uint8_t)text[31];
+  }
+  printf("format  %-12s n=%d ns/op=%.1f\n", "wire", BENCH_IDS, (double)(bench_now_ns() - t0) / BENCH_IDS);
+  t0 = bench_now_ns();
+  for (int i = 0; i < BENCH_IDS; i++) {
+    ctx.span_id[0] = (uint8_t)i;
+    yai_sdk_trace_format(&ctx, text, sizeof(text));
+    g_sink += (uint8_t)text[54];
+  }
+  printf("format  %-12s n=%d ns/op=%.1f\n", "traceparent", BENCH_IDS, (double)(bench_now_ns() - t0) / BENCH_IDS);
+}
+
+static int bench_calls(const char *label)
+{
+  yai_sdk_client_opts_t opts = {.ws_id = "bench", .auto_handshake = 1};
+  const char *req = "{\"type\":\"yai.control.call.v1\",\"command_id\":\"yai.kernel.ws_status\",\"argv\":[]}";
+  yai_sdk_client_t *c = NULL;
+  stub_server_t *srv = NULL;
+  yai_sdk_reply_t out;
+  uint64_t t0;
+
+  if (stub_server_start(&srv, NULL) != 0 || yai_sdk_client_open(&c, &opts) != YAI_SDK_OK) {
+    fprintf(stderr, "trace_bench: setup failed\n");
+    stub_server_stop(srv);
+    return 1;
+  }
+  t0 = bench_now_ns();
+  for (int i = 0; i < BENCH_CALLS; i++) {
+    if (yai_sdk_client_call_json(c, req, &out) != YAI_SDK_OK) return 2;
+    yai_sdk_reply_free(&out);
+  }
+  printf("call    %-12s calls=%d us/call=%.2f\n", label, BENCH_CALLS, (double)(bench_now_ns() - t0) / BENCH_CALLS / 1e3);
+  yai_sdk_client_close(c);
+  stub_server_stop(srv);
+  return 0;
+}
+
+int main(void)
+{
+  int rc;
+
+  bench_ids();
+  rc = bench_calls("spans-off");
+  yai_sdk_set_span_handler(on_span, NULL);
+  if (rc == 0) rc = bench_calls("spans-on");
+  yai_sdk_set_span_handler(NULL, NULL);
+  return rc;
+}
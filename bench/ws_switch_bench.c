@@ -0,0 +1,72 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+/*
+ * Multi-tenant worker pattern: every request targets another workspace.
+ * Compares yai_sdk_client_set_ws reconnecting (default) with in-place
+ * switching on one handshaken root connection.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <yai_sdk/public.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "bench_util.h"
+#include "../tests/support/stub_server.h"
+
+#define BENCH_HOPS 5000
+#define BENCH_WORKSPACES 8
+
+static int run(const char *name, int in_place, stub_server_t *srv, uint64_t *lat)
+{
+  yai_sdk_client_opts_t opts = {.ws_id = "tenant_0", .auto_handshake = 1, .ws_switch_in_place = in_place};
+  yai_sdk_client_t *c = NULL;
+  const char *req = "{\"type\":\"yai.control.call.v1\",\"command_id\":\"yai.kernel.ws_status\"}";
+  uint64_t acc0 = stub_server_accepts(srv);
+
+  if (yai_sdk_client_open(&c, &opts) != YAI_SDK_OK) return -1;
+  for (int i = 0; i < BENCH_HOPS; i++) {
+    yai_sdk_reply_t r = {0};
+    char ws[32];
+    uint64_t t0;
+    snprintf(ws, sizeof(ws), "tenant_%d", (i + 1) % BENCH_WORKSPACES);
+    t0 = bench_now_ns();
+    if (yai_sdk_client_set_ws(c, ws) != YAI_SDK_OK || yai_sdk_client_call_json(c, req, &r) != YAI_SDK_OK) {
+      fprintf(stderr, "ws_switch_bench: %s hop %d failed\n", name, i);
+      yai_sdk_reply_free(&r);
+      yai_sdk_client_close(c);
+      return -1;
+    }
+    lat[i] = bench_now_ns() - t0;
+    yai_sdk_reply_free(&r);
+  }
+  yai_sdk_client_close(c);
+
+  qsort(lat, BENCH_HOPS, sizeof(lat[0]), bench_cmp_u64);
+  printf("%-10s connects/hop=%.2f p50=%.2fus p99=%.2fus\n",
+         name,
+         (double)(stub_server_accepts(srv) - acc0) / BENCH_HOPS,
+         (double)lat[BENCH_HOPS / 2] / 1000.0,
+         (double)lat[(BENCH_HOPS * 99) / 100] / 1000.0);
+  return 0;
+}
+
+int main(void)
+{
+  static uint64_t lat[BENCH_HOPS];
+  stub_server_t *srv = NULL;
+  int rc = 0;
+
+  if (stub_server_start(&srv, NULL) != 0) {
+    fprintf(stderr, "ws_switch_bench: stub server start failed\n");
+    return 1;
+  }
+  if (run("reconnect", 0, srv, lat) != 0) rc = 2;
+  if (rc == 0 && run("in_place", 1, srv, lat) != 0) rc = 2;
+  stub_server_stop(srv);
+  return rc;
+}
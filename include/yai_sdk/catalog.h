@@ -66,6 +66,13 @@ typedef struct yai_sdk_command_catalog {
   size_t group_count;
   yai_sdk_command_ref_t **commands_sorted;
   size_t command_count;
+  /* lookup indexes over a compact copy of the commands, built by
+     yai_sdk_command_catalog_load (internal), held in addition to the refs
+     above; lookups on a catalog without them scan. A catalog from
+     yai_sdk_command_catalog_load_compact has only these: commands_sorted
+     is NULL and a group's commands stay NULL until a lookup hands out
+     one of them (or the group) */
+  struct yai_sdk_catalog_index *index;
 } yai_sdk_command_catalog_t;
 
 typedef yai_sdk_command_catalog_t yai_catalog_t;
@@ -115,6 +122,16 @@ typedef struct yai_sdk_help_index {
 } yai_sdk_help_index_t;
 
 int yai_sdk_command_catalog_load(yai_sdk_command_catalog_t *out);
+/*
+ * Opt-in compact load: the same lookups and answers as
+ * yai_sdk_command_catalog_load, but without the ~1 KB ref per command.
+ * Filters, queries that only count, completion and entrypoint
+ * collection read the compact copy; refs are filled in a group at a time,
+ * from the process registry, the first time a lookup returns a command of
+ * that group, find_group returns the group, or list_groups runs. That is
+ * safe from concurrent lookups. Free with yai_sdk_command_catalog_free.
+ */
+int yai_sdk_command_catalog_load_compact(yai_sdk_command_catalog_t *out);
 void yai_sdk_command_catalog_free(yai_sdk_command_catalog_t *cat);
 
 const yai_sdk_command_group_t *yai_sdk_command_catalog_find_group(
@@ -165,6 +182,22 @@ const yai_sdk_command_ref_t *yai_sdk_command_catalog_resolve_path(
     const yai_sdk_catalog_filter_t *filter,
     yai_sdk_catalog_resolve_status_t *status);
 
+/*
+ * Completion of the next path token for shells: the distinct entrypoints
+ * (token_count 0), topics (1: under tokens[0]) or ops (2) starting with
+ * prefix (NULL for all) that have a command passing filter, in strcmp
+ * order. Returns how many there are; the first out_cap go to out and
+ * point into the catalog.
+ */
+size_t yai_sdk_command_catalog_complete(
+    const yai_sdk_command_catalog_t *cat,
+    const char **tokens,
+    size_t token_count,
+    const char *prefix,
+    const yai_sdk_catalog_filter_t *filter,
+    const char **out,
+    size_t out_cap);
+
 size_t yai_sdk_command_catalog_collect_entrypoints(
     const yai_sdk_command_catalog_t *cat,
     int surface_mask,
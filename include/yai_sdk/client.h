@@ -5,6 +5,9 @@
 extern "C" {
 #endif
 
+#include <stddef.h>
+#include <stdint.h>
+
 /**
  * @brief Opaque SDK client handle.
  *
@@ -27,8 +30,51 @@ typedef struct yai_sdk_client_opts {
     const char *role;
     /** If non-zero, perform handshake lazily before first call. */
     int auto_handshake;
-    /** Optional correlation id prefix used for trace generation. */
+    /** Optional correlation id, reported on this client's spans (trace ids are W3C ids, see trace.h). */
     const char *correlation_id;
+    /** Connect budget in milliseconds (0 = no deadline). */
+    int connect_timeout_ms;
+    /** Handshake round-trip budget in milliseconds (0 = no deadline). */
+    int handshake_timeout_ms;
+    /**
+     * Per-call budget in milliseconds (0 = no deadline).
+     * A call that exceeds it returns YAI_SDK_TIMEOUT and closes the
+     * connection; the next call reconnects.
+     */
+    int call_timeout_ms;
+    /**
+     * If non-zero, yai_sdk_client_set_ws keeps the live, handshaken root
+     * connection and only changes the workspace carried by later requests,
+     * instead of reconnecting.
+     */
+    int ws_switch_in_place;
+    /**
+     * Retries per call after a lost or refused root connection (0 = never).
+     * Only commands the registry lists with no side effects are retried,
+     * each time on a fresh connection after a jittered exponential backoff;
+     * any other command fails with YAI_SDK_SERVER_OFF and the next call
+     * reconnects. call_timeout_ms bounds each attempt, not the sum.
+     */
+    int retry_max;
+    /** Backoff before the first retry in milliseconds, doubled per retry (0 = 20). */
+    int retry_backoff_ms;
+    /** Backoff ceiling in milliseconds (0 = 1000). */
+    int retry_backoff_max_ms;
+    /**
+     * If non-zero, also request YAI_RPC_CAP_BINARY: plain control calls go
+     * out in the compact binary form. Each binary reply is then rebuilt
+     * into exec_reply_json, one extra allocation and copy per call.
+     */
+    int binary_codec;
+    /**
+     * If non-zero, a reconnect to an endpoint whose handshake is cached
+     * sends the handshake in the same write as the next call instead of
+     * waiting for its ack. This saves a round trip, but that call reaches a
+     * server that may then refuse the handshake (the call fails with
+     * YAI_SDK_RUNTIME_NOT_READY). yai_sdk_client_capabilities stays 0
+     * until the ack has been read.
+     */
+    int handshake_defer;
 } yai_sdk_client_opts_t;
 
 typedef struct yai_sdk_reply {
@@ -43,8 +89,23 @@ typedef struct yai_sdk_reply {
     char command_id[128];
     char trace_id[128];
     char target_plane[16];
+    /** Whole call as the caller saw it (monotonic, retries included), in ns. */
+    uint64_t duration_ns;
+    /** W3C traceparent of the call's span (see trace.h); empty for batch items. */
+    char traceparent[56];
 } yai_sdk_reply_t;
 
+/** Largest reply yai_sdk_client_call_json buffers; use the stream API beyond it. */
+#define YAI_SDK_MAX_REPLY_BYTES (16u * 1024u * 1024u)
+
+/**
+ * @brief Reply chunk sink for yai_sdk_client_call_stream.
+ *
+ * Receives `len` bytes at `offset` of a `total`-byte exec reply, in order.
+ * Return non-zero to stop; the rest of the reply is then drained.
+ */
+typedef int (*yai_sdk_reply_chunk_fn)(void *user, const void *chunk, size_t len, size_t offset, size_t total);
+
 int yai_sdk_client_open(yai_sdk_client_t **out, const yai_sdk_client_opts_t *opts);
 void yai_sdk_client_close(yai_sdk_client_t *c);
 
@@ -52,11 +113,59 @@ int yai_sdk_client_set_authority(yai_sdk_client_t *c, int arming, const char *ro
 int yai_sdk_client_set_ws(yai_sdk_client_t *c, const char *ws_id);
 int yai_sdk_client_set_correlation_id(yai_sdk_client_t *c, const char *correlation_id);
 int yai_sdk_client_handshake(yai_sdk_client_t *c);
+/** Transport capabilities granted at the last handshake (YAI_RPC_CAP_*), 0 before one. */
+uint32_t yai_sdk_client_capabilities(const yai_sdk_client_t *c);
 
 int yai_sdk_client_call_json(yai_sdk_client_t *c, const char *control_call_json, yai_sdk_reply_t *out);
+/**
+ * @brief Control call whose raw exec reply is streamed to on_chunk.
+ *
+ * Memory use stays bounded regardless of reply size. Returns YAI_SDK_IO
+ * when on_chunk stops early; the connection remains usable.
+ */
+int yai_sdk_client_call_stream(yai_sdk_client_t *c,
+                               const char *control_call_json,
+                               yai_sdk_reply_chunk_fn on_chunk,
+                               void *user);
 int yai_sdk_client_ping(yai_sdk_client_t *c, const char *command_id, yai_sdk_reply_t *out);
+
+/**
+ * @brief What a batch does after an item fails.
+ */
+typedef enum yai_sdk_batch_policy {
+    /** Send every item regardless of earlier failures. */
+    YAI_SDK_BATCH_CONTINUE = 0,
+    /** Stop sending after the first failed item; items still in flight are
+     *  completed, unsent ones get code NOT_SENT and YAI_SDK_RPC. */
+    YAI_SDK_BATCH_FAIL_FAST = 1
+} yai_sdk_batch_policy_t;
+
+/**
+ * @brief Pipelines n control calls and fills outs[i] for requests[i].
+ *
+ * Every outs[i] must be released with yai_sdk_reply_free. Returns the
+ * first non-OK item code in request order, YAI_SDK_OK if all succeeded.
+ * Same as yai_sdk_client_call_batch_ex with YAI_SDK_BATCH_CONTINUE.
+ */
+int yai_sdk_client_call_batch(yai_sdk_client_t *c, const char **requests, size_t n, yai_sdk_reply_t *outs);
+/** Like yai_sdk_client_call_batch; rcs (optional, n entries) gets each item's code. */
+int yai_sdk_client_call_batch_ex(yai_sdk_client_t *c,
+                                 const char **requests,
+                                 size_t n,
+                                 yai_sdk_reply_t *outs,
+                                 int *rcs,
+                                 yai_sdk_batch_policy_t policy);
 void yai_sdk_reply_free(yai_sdk_reply_t *r);
 
+/**
+ * @brief Decodes len bytes of yai.exec.reply.v1 JSON into *out.
+ *
+ * Single pass over the caller's buffer, no heap allocation. out->exec_reply_json
+ * is left NULL: the buffer is not copied or taken over. Returns the reply's SDK
+ * code, YAI_SDK_PROTOCOL when the payload is not an exec reply.
+ */
+int yai_sdk_reply_parse(const char *exec_reply_json, size_t len, yai_sdk_reply_t *out);
+
 #ifdef __cplusplus
 }
 #endif
@@ -3,6 +3,8 @@
 
 #include <stddef.h>
 
+#include <yai_sdk/pool.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -43,6 +45,12 @@ typedef struct yai_sdk_workspace_info {
 /* Runtime-backed workspace descriptor using yai.kernel.ws_status. */
 int yai_sdk_workspace_describe(const char *ws_id, yai_sdk_workspace_info_t *out);
 
+/* Same as yai_sdk_workspace_describe, but leases the operator connection
+ * from pool instead of opening one per call. pool may be NULL. */
+int yai_sdk_workspace_describe_with(yai_sdk_pool_t *pool,
+                                    const char *ws_id,
+                                    yai_sdk_workspace_info_t *out);
+
 /* Validates current binding against runtime state.
  * Returns 0 when current binding exists and runtime confirms a valid workspace. */
 int yai_sdk_context_validate_current_workspace(yai_sdk_workspace_info_t *out);
@@ -47,6 +47,9 @@ typedef enum
     /** Runtime endpoint unavailable (ENOTCONN-compatible class). */
     YAI_SDK_SERVER_OFF = 107,
 
+    /** Connect, handshake or call deadline exceeded (ETIMEDOUT-compatible class). */
+    YAI_SDK_TIMEOUT = 110,
+
     /** Generic not implemented class for compatibility. */
     YAI_SDK_NOT_IMPLEMENTED = 99
 } yai_sdk_err_t;
@@ -82,6 +85,8 @@ static inline const char *yai_sdk_err_str(yai_sdk_err_t code)
         return "protocol";
     case YAI_SDK_SERVER_OFF:
         return "server_off";
+    case YAI_SDK_TIMEOUT:
+        return "timeout";
     case YAI_SDK_NOT_IMPLEMENTED:
         return "not_implemented";
     default:
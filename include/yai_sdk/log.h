@@ -5,6 +5,9 @@
 extern "C" {
 #endif
 
+#include <stddef.h>
+#include <stdint.h>
+
 /** Log levels for SDK-internal diagnostics callbacks. */
 typedef enum yai_sdk_log_level {
     YAI_SDK_LOG_DEBUG = 0,
@@ -31,6 +34,73 @@ void yai_sdk_set_log_level(yai_sdk_log_level_t level);
 /** Get current minimum log level. */
 yai_sdk_log_level_t yai_sdk_get_log_level(void);
 
+/** Value types of structured log fields. */
+typedef enum yai_sdk_log_field_kind {
+    YAI_SDK_LOG_FIELD_STR = 0,
+    YAI_SDK_LOG_FIELD_INT = 1,
+    YAI_SDK_LOG_FIELD_UINT = 2,
+} yai_sdk_log_field_kind_t;
+
+/** One key/value pair of a log event (e.g. rc, command_id, ws_id, bytes). */
+typedef struct yai_sdk_log_field {
+    const char *key;
+    yai_sdk_log_field_kind_t kind;
+    union {
+        const char *str;
+        int64_t i64;
+        uint64_t u64;
+    } v;
+} yai_sdk_log_field_t;
+
+/**
+ * A log event as the SDK emitted it. Nothing is formatted: the fields are
+ * typed values, and every pointer is only valid during the callback.
+ */
+typedef struct yai_sdk_log_event {
+    yai_sdk_log_level_t level;
+    const char *component;
+    const char *message;
+    const yai_sdk_log_field_t *fields;
+    size_t field_count;
+    /** CLOCK_REALTIME at the emit, in ns. */
+    uint64_t time_ns;
+} yai_sdk_log_event_t;
+
+typedef void (*yai_sdk_log_event_handler_t)(const yai_sdk_log_event_t *ev, void *user_data);
+
+/**
+ * Register a structured log handler. When set it receives every event at
+ * or above the log level and the string handler is not called; pass NULL
+ * to go back to the string handler.
+ */
+void yai_sdk_set_log_event_handler(yai_sdk_log_event_handler_t handler, void *user_data);
+
+/**
+ * Formats ev as `message key=value ...` (strings with spaces or quotes are
+ * quoted). snprintf semantics: returns the length needed and writes at most
+ * cap bytes including the terminator. This is what the string handler gets.
+ */
+size_t yai_sdk_log_format(const yai_sdk_log_event_t *ev, char *buf, size_t cap);
+
+/**
+ * Asynchronous delivery. Events are copied into a ring owned by the
+ * emitting thread (lock-free, no allocation after a thread's first event)
+ * and a background thread hands them to the handler. The component,
+ * message and string values are copied and truncated to fit a ring slot
+ * (256 bytes together); a full ring drops the event and counts it.
+ * ring_events is rounded up to a power of two (0 picks 256). Handlers
+ * then run on the background thread.
+ * Returns YAI_SDK_BAD_ARGS when already running, YAI_SDK_IO when the
+ * thread cannot be started.
+ */
+int yai_sdk_log_async_start(size_t ring_events);
+
+/** Delivers what is queued, then stops the background thread. */
+void yai_sdk_log_async_stop(void);
+
+/** Events dropped on full rings since the process started. */
+uint64_t yai_sdk_log_async_dropped(void);
+
 #ifdef __cplusplus
 }
 #endif
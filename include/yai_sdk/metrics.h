@@ -0,0 +1,111 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <yai_sdk/client.h>
+
+/**
+ * @brief Call phases timed by yai_sdk_client_t.
+ *
+ * SEND is the request write; WAIT runs from the end of the write to the
+ * last reply byte, so it includes the root's own time. CALL is the whole
+ * public call as the caller saw it, retries included.
+ */
+typedef enum yai_sdk_phase {
+    YAI_SDK_PHASE_CONNECT = 0,
+    YAI_SDK_PHASE_HANDSHAKE,
+    YAI_SDK_PHASE_SEND,
+    YAI_SDK_PHASE_WAIT,
+    YAI_SDK_PHASE_PARSE,
+    YAI_SDK_PHASE_CALL,
+    YAI_SDK_PHASE_COUNT
+} yai_sdk_phase_t;
+
+/** @brief Outcome classes calls are counted under (from the returned yai_sdk_err_t). */
+typedef enum yai_sdk_call_class {
+    YAI_SDK_CALL_OK = 0,
+    YAI_SDK_CALL_BAD_ARGS,
+    YAI_SDK_CALL_UNAUTHORIZED,
+    YAI_SDK_CALL_NOT_READY,
+    YAI_SDK_CALL_SERVER_OFF,
+    YAI_SDK_CALL_TIMEOUT,
+    YAI_SDK_CALL_PROTOCOL,
+    YAI_SDK_CALL_RPC,
+    YAI_SDK_CALL_IO,
+    YAI_SDK_CALL_OTHER,
+    YAI_SDK_CALL_CLASS_COUNT
+} yai_sdk_call_class_t;
+
+/**
+ * Log-linear buckets: values below 4 ns get one bucket each, then every
+ * power of two is split in 4, so a bucket is at most 25% wide. The last
+ * bucket also takes everything above ~32 minutes.
+ */
+#define YAI_SDK_HIST_BUCKETS 160
+
+/** @brief Latency histogram in nanoseconds. */
+typedef struct yai_sdk_histogram {
+    uint64_t count;
+    uint64_t sum_ns;
+    uint64_t max_ns;
+    uint64_t buckets[YAI_SDK_HIST_BUCKETS];
+} yai_sdk_histogram_t;
+
+/** @brief Snapshot of one client's, or the whole process's, counters. */
+typedef struct yai_sdk_metrics {
+    yai_sdk_histogram_t phase[YAI_SDK_PHASE_COUNT];
+    uint64_t calls[YAI_SDK_CALL_CLASS_COUNT];
+    /** Wire bytes (envelopes included, after compression). */
+    uint64_t bytes_sent;
+    uint64_t bytes_received;
+} yai_sdk_metrics_t;
+
+/** @brief Process-wide counters for one command id. */
+typedef struct yai_sdk_command_metrics {
+    char command_id[96];
+    uint64_t calls[YAI_SDK_CALL_CLASS_COUNT];
+    uint64_t bytes_sent;
+    uint64_t bytes_received;
+    /** Sum of CALL-phase time, for a mean per command. */
+    uint64_t call_ns;
+} yai_sdk_command_metrics_t;
+
+/**
+ * Recording is lock-free and always on. Snapshots may be taken from any
+ * thread at any time; fields are read one by one, so a snapshot taken
+ * during calls can be off by the calls in flight.
+ */
+int yai_sdk_client_metrics(const yai_sdk_client_t *c, yai_sdk_metrics_t *out);
+void yai_sdk_metrics_global(yai_sdk_metrics_t *out);
+
+/**
+ * Copies up to cap per-command entries into out and returns how many
+ * command ids are tracked. Ids beyond the table's capacity (1024) are
+ * counted under "(other)".
+ */
+size_t yai_sdk_metrics_commands(yai_sdk_command_metrics_t *out, size_t cap);
+
+/** Upper bound, in ns, of the bucket holding quantile q (0..1); 0 when empty. */
+uint64_t yai_sdk_histogram_quantile(const yai_sdk_histogram_t *h, double q);
+/** Largest value, in ns, that lands in bucket i. */
+uint64_t yai_sdk_histogram_bucket_max(size_t i);
+
+const char *yai_sdk_phase_name(yai_sdk_phase_t phase);
+const char *yai_sdk_call_class_name(yai_sdk_call_class_t cls);
+
+/**
+ * Writes m as Prometheus-style text (counters, then per-phase count, sum
+ * and p50/p90/p99/max). snprintf semantics: returns the length needed,
+ * writes at most cap bytes including the terminator.
+ */
+size_t yai_sdk_metrics_format(const yai_sdk_metrics_t *m, char *buf, size_t cap);
+
+#ifdef __cplusplus
+}
+#endif
@@ -30,6 +30,12 @@ int yai_path_engine_bin(char *out, size_t cap);
 /* Root endpoint (machine plane). */
 int yai_path_root_sock(char *out, size_t cap);
 
+/* Resolved locations above are cached process-wide and resolved again
+ * when an environment variable they derive from changes. Binaries are
+ * only cached once found. Call this after the runtime moved on disk
+ * (e.g. a binary was installed or removed) to drop the cache. */
+void yai_path_cache_invalidate(void);
+
 /* Workspace paths (tenant plane). */
 int yai_path_ws_sock(const char *ws_id, char *out, size_t cap);
 int yai_path_ws_run_dir(const char *ws_id, char *out, size_t cap);
@@ -0,0 +1,82 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+#pragma once
+
+#include <stddef.h>
+
+#include <yai_sdk/client.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Thread-safe cache of open, handshaken clients.
+ *
+ * Connections are keyed by (ws_id, role, arming). A leased client belongs
+ * to the caller until it is released; the pool itself may be shared by
+ * any number of threads.
+ */
+typedef struct yai_sdk_pool yai_sdk_pool_t;
+
+/**
+ * @brief Pool options. Zero-initialised options select the defaults.
+ */
+typedef struct yai_sdk_pool_opts {
+    /** Idle connections kept across all keys (0 = 64). */
+    size_t max_idle;
+    /** Open connections (idle + leased) per key (0 = 8). */
+    size_t max_per_key;
+    /** Idle connections older than this are closed instead of reused (0 = no limit). */
+    int idle_timeout_ms;
+    /** Idle connections older than this are PINGed before reuse (0 = never). */
+    int health_check_after_ms;
+    /** How long acquire waits for a free slot on a full key (0 = fail at once, <0 = forever). */
+    int acquire_timeout_ms;
+    /** Budgets applied to connections the pool opens; see yai_sdk_client_opts_t. */
+    int connect_timeout_ms;
+    int handshake_timeout_ms;
+    int call_timeout_ms;
+} yai_sdk_pool_opts_t;
+
+typedef struct yai_sdk_pool_stats {
+    size_t idle;
+    size_t leased;
+    /** Connections opened (connect + handshake) since creation. */
+    unsigned long long opened;
+    /** Acquires served from an idle connection. */
+    unsigned long long reused;
+    /** Idle connections dropped after a failed PING. */
+    unsigned long long health_failures;
+} yai_sdk_pool_stats_t;
+
+int yai_sdk_pool_create(yai_sdk_pool_t **out, const yai_sdk_pool_opts_t *opts);
+
+/** Closes idle connections. Every leased client must be released first. */
+void yai_sdk_pool_destroy(yai_sdk_pool_t *pool);
+
+/**
+ * @brief Lease a handshaken client for (ws_id, role, arming).
+ *
+ * role NULL/empty means "operator", as in yai_sdk_client_open. Returns
+ * YAI_SDK_TIMEOUT when the key stays at max_per_key for acquire_timeout_ms.
+ */
+int yai_sdk_pool_acquire(yai_sdk_pool_t *pool,
+                         const char *ws_id,
+                         const char *role,
+                         int arming,
+                         yai_sdk_client_t **out);
+
+/**
+ * @brief Return a leased client.
+ *
+ * Pass reusable = 0 after a transport error; the connection is then
+ * closed instead of being kept idle. So is a client whose workspace or
+ * authority was changed while it was leased.
+ */
+void yai_sdk_pool_release(yai_sdk_pool_t *pool, yai_sdk_client_t *client, int reusable);
+
+void yai_sdk_pool_get_stats(yai_sdk_pool_t *pool, yai_sdk_pool_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
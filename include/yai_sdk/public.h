@@ -5,7 +5,7 @@
 extern "C" {
 #endif
 
-#define YAI_SDK_ABI_VERSION 1
+#define YAI_SDK_ABI_VERSION 2
 
 int yai_sdk_abi_version(void);
 const char *yai_sdk_version(void);
@@ -14,10 +14,15 @@ const char *yai_sdk_version(void);
 #include <yai_sdk/paths.h>
 #include <yai_sdk/context.h>
 #include <yai_sdk/client.h>
+#include <yai_sdk/pool.h>
+#include <yai_sdk/shared_client.h>
+#include <yai_sdk/reply_view.h>
 #include <yai_sdk/catalog.h>
 #include <yai_sdk/protocol.h>
 #include <yai_sdk/rpc.h>
 #include <yai_sdk/log.h>
+#include <yai_sdk/metrics.h>
+#include <yai_sdk/trace.h>
 #include <yai_sdk/reply/reply.h>
 #include <yai_sdk/reply/reply_builder.h>
 #include <yai_sdk/reply/reply_json.h>
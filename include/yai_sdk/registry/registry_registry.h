@@ -8,7 +8,8 @@ extern "C" {
 #endif
 
 // Init builds indexes (id -> command, group -> list) on first use.
-// Returns 0 on success.
+// Loads once per process and is safe to call from any thread; every call
+// returns the result of that load. Returns 0 on success.
 int yai_law_registry_init(void);
 
 // Registry pointers (cache is immutable; indexes live in process memory).
@@ -0,0 +1,88 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+
+#include <yai_sdk/client.h>
+
+/**
+ * @brief Borrowed byte range. Not NUL-terminated unless stated otherwise.
+ */
+typedef struct yai_sdk_str {
+    const char *ptr;
+    size_t len;
+} yai_sdk_str_t;
+
+/**
+ * @brief Bump allocator backing reply views.
+ *
+ * Not thread-safe. Memory is only released by reset or destroy; a reset
+ * keeps the capacity reached so far, so a steady workload stops allocating.
+ */
+typedef struct yai_sdk_arena yai_sdk_arena_t;
+
+/** initial_bytes = 0 picks a small default; the arena grows on demand. */
+int yai_sdk_arena_create(yai_sdk_arena_t **out, size_t initial_bytes);
+/** Invalidates everything allocated from the arena. */
+void yai_sdk_arena_reset(yai_sdk_arena_t *a);
+void yai_sdk_arena_destroy(yai_sdk_arena_t *a);
+/** max_align_t-aligned block, NULL when out of memory. */
+void *yai_sdk_arena_alloc(yai_sdk_arena_t *a, size_t n);
+
+/**
+ * @brief Exec reply exposed as views into the raw reply bytes.
+ *
+ * Fields point into `raw` where the JSON string needs no unescaping, into
+ * the arena where it does, and at static defaults when a member is absent.
+ * Nothing is truncated: every string hint is listed and `details` is the
+ * object's JSON text as sent.
+ */
+typedef struct yai_sdk_reply_view {
+    /** Whole exec reply (NUL-terminated; empty for transport errors). */
+    yai_sdk_str_t raw;
+    yai_sdk_str_t status;
+    yai_sdk_str_t code;
+    yai_sdk_str_t reason;
+    yai_sdk_str_t summary;
+    const yai_sdk_str_t *hints;
+    size_t hint_count;
+    /** JSON object text, empty when the reply has no details object. */
+    yai_sdk_str_t details;
+    yai_sdk_str_t command_id;
+    yai_sdk_str_t trace_id;
+    yai_sdk_str_t target_plane;
+    /** Whole call as the caller saw it (monotonic, retries included), in ns. */
+    uint64_t duration_ns;
+} yai_sdk_reply_view_t;
+
+/**
+ * @brief Control call decoded into views.
+ *
+ * With arena == NULL the client's own arena is reset and used: the view
+ * stays valid until the next yai_sdk_client_call_view on this client. With
+ * a caller arena, nothing is reset; the view lives until the caller resets
+ * or destroys it. Returns the same codes as yai_sdk_client_call_json.
+ */
+int yai_sdk_client_call_view(yai_sdk_client_t *c,
+                             const char *control_call_json,
+                             yai_sdk_arena_t *arena,
+                             yai_sdk_reply_view_t *out);
+
+/**
+ * @brief Decodes len bytes of exec reply JSON into views.
+ *
+ * Views borrow exec_reply_json, which must outlive them; the arena only
+ * holds unescaped strings and the hint list.
+ */
+int yai_sdk_reply_view_parse(const char *exec_reply_json,
+                             size_t len,
+                             yai_sdk_arena_t *arena,
+                             yai_sdk_reply_view_t *out);
+
+#ifdef __cplusplus
+}
+#endif
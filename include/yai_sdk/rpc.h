@@ -8,6 +8,40 @@ extern "C" {
 #include <stddef.h>
 #include <stdint.h>
 
+#include <yai_sdk/trace.h>
+
+/*
+ * Transport capability bits negotiated by the handshake. The client asks
+ * for caps_requested; caps_granted is what the server accepted (always a
+ * subset). Features stay off unless granted.
+ */
+#define YAI_RPC_CAP_PIPELINE (1u << 0)     /* several requests in flight, trace_id matched */
+#define YAI_RPC_CAP_COMPRESSION (1u << 1)  /* compressed payloads */
+#define YAI_RPC_CAP_LARGE_FRAMES (1u << 2) /* replies beyond 4 KiB (else -8) */
+#define YAI_RPC_CAP_BINARY (1u << 3)       /* binary payload codec */
+#define YAI_RPC_CAP_CHECKSUM (1u << 4)     /* envelope checksum verified */
+
+/*
+ * What yai_rpc_connect requests. YAI_RPC_CAP_BINARY is left out: the SDK
+ * client has to rebuild exec_reply_json from every binary reply, so it is
+ * requested only on opt-in (yai_sdk_client_opts_t.binary_codec).
+ */
+#define YAI_RPC_CAPS_DEFAULT                                                                      \
+    (YAI_RPC_CAP_PIPELINE | YAI_RPC_CAP_COMPRESSION | YAI_RPC_CAP_LARGE_FRAMES | YAI_RPC_CAP_CHECKSUM)
+
+/*
+ * Per-frame flags, carried in the reserved `_pad` byte of the yai-law
+ * envelope, which stays zero until a capability is granted. A request with
+ * a flag whose capability was not granted (next_flags) fails with -19
+ * before anything is sent. A reply with an unknown bit, or a flag the
+ * connection did not negotiate, fails with -19 and closes the connection.
+ */
+#define YAI_RPC_FLAG_BINARY (1u << 0)     /* payload uses the binary codec */
+#define YAI_RPC_FLAG_COMPRESSED (1u << 1) /* payload is u32 LE raw length + one LZ4 block */
+
+/* Requests of at least this many bytes are compressed by default. */
+#define YAI_RPC_COMPRESS_MIN_DEFAULT (8u * 1024u)
+
 typedef struct yai_rpc_client {
     int fd;
     char ws_id[128];
@@ -15,11 +49,57 @@ typedef struct yai_rpc_client {
     uint8_t arming;
     char correlation_id[64];
     uint32_t trace_seq;
+    int timeout_ms;
+    uint32_t caps_requested;
+    uint32_t caps_granted;
+    /* handshake answered from cache, not yet sent (internal) */
+    int hs_deferred;
+    /* a cached handshake may ride on the next call (yai_rpc_set_handshake_defer) */
+    int hs_defer;
+    /* resolved socket path, the handshake cache key */
+    char endpoint[108];
+    /* YAI_RPC_FLAG_* for the next call_raw/call_stream request; cleared once sent */
+    uint8_t next_flags;
+    /* YAI_RPC_FLAG_* of the last reply read by call_raw/call_stream */
+    uint8_t reply_flags;
+    /* request payloads this large are compressed once granted; 0 never */
+    uint32_t compress_min;
+    /* timing and wire bytes of the last call_raw/call_stream, in ns: SEND is
+       the request write, WAIT the rest up to the last reply byte */
+    uint64_t last_send_ns;
+    uint64_t last_wait_ns;
+    uint64_t last_tx_bytes;
+    uint64_t last_rx_bytes;
+    /* monotonic time the last call_raw/call_stream write started, in ns */
+    uint64_t last_start_ns;
+    /* trace context for the next request envelope; cleared once used.
+       Without one each envelope starts a trace of its own */
+    yai_sdk_trace_ctx_t next_trace;
+    int next_trace_set;
 } yai_rpc_client_t;
 
 int yai_rpc_connect(yai_rpc_client_t *c, const char *ws_id);
+/* Like yai_rpc_connect, giving up with -15 after timeout_ms (<= 0: no limit). */
+int yai_rpc_connect_timeout(yai_rpc_client_t *c, const char *ws_id, int timeout_ms);
 void yai_rpc_close(yai_rpc_client_t *c);
+
+/*
+ * Deadline for each following call (request write + reply read), in ms;
+ * <= 0 disables it. A call that runs out of time returns -15 and closes
+ * the connection, since its reply may still arrive later.
+ */
+void yai_rpc_set_timeout(yai_rpc_client_t *c, int timeout_ms);
+/*
+ * Retargets following requests to another workspace. The socket always
+ * leads to the root server and ws_id only travels in the envelope, so the
+ * connection and its handshake stay in place. -99 for an invalid ws_id.
+ */
+int yai_rpc_set_ws(yai_rpc_client_t *c, const char *ws_id);
 void yai_rpc_set_authority(yai_rpc_client_t *c, int arming, const char *role_str);
+/*
+ * The correlation id is not sent: envelopes carry W3C trace context. It is
+ * reported as the correlation_id field of this client's "call" log events.
+ */
 void yai_rpc_set_correlation_id(yai_rpc_client_t *c, const char *correlation_id);
 
 int yai_rpc_call_raw(
@@ -31,7 +111,164 @@ int yai_rpc_call_raw(
     size_t out_cap,
     uint32_t *out_len);
 
+/*
+ * Reply chunk sink: `len` bytes at `offset` of a `total`-byte payload.
+ * Chunks arrive in order; returning non-zero stops delivery.
+ */
+typedef int (*yai_rpc_chunk_fn)(void *user, const void *chunk, size_t len, size_t offset, uint32_t total);
+
+/*
+ * Like yai_rpc_call_raw, but hands the reply payload to on_chunk as it
+ * arrives, through a fixed-size buffer, so memory use does not grow with
+ * the reply. If on_chunk stops early, the rest of the reply is drained and
+ * -16 is returned; the connection stays usable. (yai_rpc_call_raw likewise
+ * drains a reply larger than out_cap before returning -8.)
+ *
+ * With YAI_RPC_CAP_CHECKSUM granted, requests carry the CRC32C of their
+ * payload in the envelope and replies are verified: a mismatch returns -17
+ * and closes the connection. A streamed reply is only known bad once it is
+ * complete, so on_chunk has already seen it by then. Pipelined and async
+ * replies are verified the same way before they are handed out. Reply
+ * flags are checked before on_chunk sees any byte.
+ */
+int yai_rpc_call_stream(
+    yai_rpc_client_t *c,
+    uint32_t command_id,
+    const void *payload,
+    uint32_t payload_len,
+    yai_rpc_chunk_fn on_chunk,
+    void *user,
+    uint32_t *out_len);
+
+/*
+ * Compression threshold for requests (default YAI_RPC_COMPRESS_MIN_DEFAULT,
+ * 0 turns it off). With YAI_RPC_CAP_COMPRESSION granted, a request payload
+ * of at least min_bytes goes out compressed when that makes it smaller;
+ * compressed replies are handed out inflated, so out_len and chunk totals
+ * count raw bytes. Without it granted, a reply flagged compressed is -18
+ * and is never inflated. A compressed streamed reply is
+ * inflated as it arrives, holding only the 64 KiB LZ4 match window and one
+ * chunk, so yai_rpc_call_stream stays bounded with compression granted.
+ * Bad compressed data is -18 too; like a checksum mismatch, it may only
+ * show once on_chunk has seen part of the reply.
+ */
+void yai_rpc_set_compression_min(yai_rpc_client_t *c, uint32_t min_bytes);
+
+/* Capabilities to request at the next handshake (default YAI_RPC_CAPS_DEFAULT). */
+void yai_rpc_set_capabilities(yai_rpc_client_t *c, uint32_t caps);
+
+/*
+ * Negotiates capabilities and records caps_granted, one round trip.
+ *
+ * With deferral turned on (off after each connect) and the same endpoint
+ * having accepted the same request within the cache TTL, no round trip
+ * happens here: the handshake is sent in front of the next call on the
+ * client and its ack is checked there, saving one round trip per
+ * reconnect. That call is then written before the server has acked, so a
+ * server that is not ready, or that refuses the handshake, still receives
+ * it; the call returns -20..-22 and the connection is closed. Until the
+ * ack is read caps_granted stays 0, so the call it carries is sent without
+ * optional features; the grant is then taken from the ack, and a cache
+ * entry the ack disagrees with is dropped.
+ */
 int yai_rpc_handshake(yai_rpc_client_t *c);
+/* Lets cache hits defer the handshake onto the next call (see above). */
+void yai_rpc_set_handshake_defer(yai_rpc_client_t *c, int on);
+
+/* Process-wide handshake cache (thread-safe). TTL <= 0 disables it; default 30 s. */
+void yai_rpc_handshake_cache_set_ttl(int ttl_ms);
+void yai_rpc_handshake_cache_clear(void);
+
+/*
+ * Pipelined calls on an open client: submit up to `window` requests, then
+ * drain their replies. Replies are matched to requests by envelope trace_id
+ * and may complete in any order. Without YAI_RPC_CAP_PIPELINE granted the
+ * window is 1, so requests go out one at a time, each after the previous
+ * reply. The blocking calls above must not be used on the same client while
+ * a pipeline still has requests in flight.
+ */
+typedef struct yai_rpc_pipeline yai_rpc_pipeline_t;
+
+typedef struct yai_rpc_reply {
+    /** Command id of the matching request. */
+    uint32_t command_id;
+    /** Cookie passed to yai_rpc_pipeline_submit. */
+    void *cookie;
+    /** Reply payload; valid until the next call on the pipeline. */
+    const void *payload;
+    uint32_t payload_len;
+} yai_rpc_reply_t;
+
+int yai_rpc_pipeline_open(yai_rpc_pipeline_t **out, yai_rpc_client_t *c, size_t window);
+void yai_rpc_pipeline_close(yai_rpc_pipeline_t *p);
+
+/* Queues one request. Returns -13 when the in-flight window is full. */
+int yai_rpc_pipeline_submit(
+    yai_rpc_pipeline_t *p,
+    uint32_t command_id,
+    const void *payload,
+    uint32_t payload_len,
+    void *cookie);
+
+/* Writes all queued requests to the socket. */
+int yai_rpc_pipeline_flush(yai_rpc_pipeline_t *p);
+
+/* Flushes, then blocks for the next reply, bounded by the client timeout.
+ * Returns 0 with *out filled, 1 when nothing is in flight, <0 on error
+ * (-15 on timeout; the pipeline and connection should then be closed). A
+ * framing, checksum or decode error closes the connection itself; -8 with
+ * out->cookie set is a reply over the negotiated size and leaves it open. */
+int yai_rpc_pipeline_next(yai_rpc_pipeline_t *p, yai_rpc_reply_t *out);
+
+size_t yai_rpc_pipeline_in_flight(const yai_rpc_pipeline_t *p);
+
+/*
+ * Non-blocking client for event loops. Takes over the socket of a connected
+ * (and usually handshaken) yai_rpc_client_t and switches it to O_NONBLOCK.
+ * Register yai_rpc_async_fd() with poll/epoll using yai_rpc_async_want(),
+ * call on_writable/on_readable when the fd is ready, then drain finished
+ * replies with poll_completion. Nothing here blocks, so one thread can drive
+ * many connections. Without YAI_RPC_CAP_PIPELINE granted the window is 1.
+ * A handle is not safe for concurrent use.
+ */
+typedef struct yai_rpc_client_async yai_rpc_client_async_t;
+
+#define YAI_RPC_WANT_READ 0x1u
+#define YAI_RPC_WANT_WRITE 0x2u
+
+/* On success c->fd is set to -1; the async handle owns the connection. */
+int yai_rpc_async_open(yai_rpc_client_async_t **out, yai_rpc_client_t *c, size_t window);
+void yai_rpc_async_close(yai_rpc_client_async_t *a);
+
+int yai_rpc_async_fd(const yai_rpc_client_async_t *a);
+
+/* Current interest set: YAI_RPC_WANT_READ and/or YAI_RPC_WANT_WRITE. */
+unsigned yai_rpc_async_want(const yai_rpc_client_async_t *a);
+
+/* Queues one request without writing. Returns -13 when the window is full. */
+int yai_rpc_async_submit(
+    yai_rpc_client_async_t *a,
+    uint32_t command_id,
+    const void *payload,
+    uint32_t payload_len,
+    void *cookie);
+
+/* Writes queued bytes until the socket would block. */
+int yai_rpc_async_on_writable(yai_rpc_client_async_t *a);
+
+/* Reads available bytes until the socket would block. -5 on EOF; replies
+ * already buffered can still be drained with poll_completion. */
+int yai_rpc_async_on_readable(yai_rpc_client_async_t *a);
+
+/* Returns 0 with *out filled, 1 when no complete reply is buffered, <0 on
+ * error. -8 with out->cookie set is a reply over the negotiated size; the
+ * handle stays usable. The payload view is valid until the next call on the
+ * handle. */
+int yai_rpc_async_poll_completion(yai_rpc_client_async_t *a, yai_rpc_reply_t *out);
+
+size_t yai_rpc_async_in_flight(const yai_rpc_client_async_t *a);
+/* Window the handle was opened with: 1 without YAI_RPC_CAP_PIPELINE granted. */
+size_t yai_rpc_async_window(const yai_rpc_client_async_t *a);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,68 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+#pragma once
+
+#include <stddef.h>
+
+#include <yai_sdk/client.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Client handle that any number of threads may call concurrently.
+ *
+ * Calls from all threads are multiplexed over a few pipelined root
+ * connections driven by one internal I/O thread. Each caller blocks only
+ * on its own request; replies are matched back by envelope trace_id.
+ */
+typedef struct yai_sdk_shared_client yai_sdk_shared_client_t;
+
+/**
+ * @brief Shared client options. Zero-initialised options select the defaults.
+ */
+typedef struct yai_sdk_shared_client_opts {
+    /** Workspace every call targets (NULL/empty = "default"). */
+    const char *ws_id;
+    /** Authority role string (NULL/empty = "operator"). */
+    const char *role;
+    /** Authority arming flag (0/1). */
+    int arming;
+    /** Correlation id (NULL/empty = "sdk"), reported on this client's log events; envelope trace ids are W3C ids, see trace.h. */
+    const char *correlation_id;
+    /** Root connections calls are spread over (0 = 1). */
+    size_t connections;
+    /** Requests in flight per connection; callers beyond it queue (0 = 128). */
+    size_t window;
+    /** Budgets; see yai_sdk_client_opts_t. A timed-out call leaves its connection open. */
+    int connect_timeout_ms;
+    int handshake_timeout_ms;
+    int call_timeout_ms;
+} yai_sdk_shared_client_opts_t;
+
+typedef struct yai_sdk_shared_client_stats {
+    /** Calls completed, successfully or not. */
+    unsigned long long calls;
+    /** Connections opened (connect + handshake) since creation. */
+    unsigned long long connects;
+    /** Connections dropped after a transport error. */
+    unsigned long long failures;
+} yai_sdk_shared_client_stats_t;
+
+/**
+ * Connects and handshakes every connection before returning. A connection
+ * dropped later is reopened by the next caller, on the caller's thread.
+ */
+int yai_sdk_shared_client_open(yai_sdk_shared_client_t **out, const yai_sdk_shared_client_opts_t *opts);
+
+/** Stops the I/O thread. No call may be in progress or started afterwards. */
+void yai_sdk_shared_client_close(yai_sdk_shared_client_t *c);
+
+/** Thread-safe; same contract as yai_sdk_client_call_json. */
+int yai_sdk_shared_client_call_json(yai_sdk_shared_client_t *c, const char *control_call_json, yai_sdk_reply_t *out);
+
+void yai_sdk_shared_client_get_stats(yai_sdk_shared_client_t *c, yai_sdk_shared_client_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,89 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <yai_sdk/client.h>
+
+/**
+ * @brief W3C trace context (https://www.w3.org/TR/trace-context/).
+ *
+ * Ids come from a per-thread PRNG seeded once per thread; generating one
+ * makes no system call. All-zero ids are never generated.
+ */
+typedef struct yai_sdk_trace_ctx {
+    uint8_t trace_id[16];
+    uint8_t span_id[8];
+    /** Trace flags; bit 0 is "sampled". */
+    uint8_t flags;
+} yai_sdk_trace_ctx_t;
+
+/** Length of a `traceparent` header value, without the terminator. */
+#define YAI_SDK_TRACEPARENT_LEN 55
+/** Length of the wire form carried in the request envelope's trace_id. */
+#define YAI_SDK_TRACE_WIRE_LEN 32
+
+/**
+ * Writes ctx as `00-<trace id>-<span id>-<flags>`. snprintf semantics;
+ * the full value needs YAI_SDK_TRACEPARENT_LEN + 1 bytes.
+ */
+size_t yai_sdk_trace_format(const yai_sdk_trace_ctx_t *ctx, char *buf, size_t cap);
+
+/** Parses a `traceparent` value; YAI_SDK_BAD_ARGS if it is not a valid one. */
+int yai_sdk_trace_parse(const char *traceparent, yai_sdk_trace_ctx_t *out);
+
+/**
+ * Decodes an envelope trace_id (as echoed in reply trace_id fields): the
+ * 16-byte trace id and the 8-byte id of the SDK call span, in unpadded
+ * base64url. The envelope field is too short for the hex form.
+ * YAI_SDK_BAD_ARGS for anything else.
+ */
+int yai_sdk_trace_from_wire(const char *wire, yai_sdk_trace_ctx_t *out);
+
+/** @brief A finished span, as handed to the span handler. */
+typedef struct yai_sdk_span {
+    /** "call" for a public client call; "connect", "handshake", "send",
+     *  "wait" or "parse" for its phases. */
+    const char *name;
+    yai_sdk_trace_ctx_t ctx;
+    /** All zero for a root span. */
+    uint8_t parent_span_id[8];
+    /** The call's command id (NULL for connects and handshakes outside a call). */
+    const char *command_id;
+    const char *ws_id;
+    /** yai_sdk_err_t of a call span; 0 for phases. */
+    int rc;
+    /** Wall-clock start (CLOCK_REALTIME), in ns. */
+    uint64_t start_unix_ns;
+    /** Monotonic duration, in ns. */
+    uint64_t duration_ns;
+    /** The client's correlation id. */
+    const char *correlation_id;
+} yai_sdk_span_t;
+
+/**
+ * Makes parent the parent of each following call's span on c: the calls
+ * join its trace. NULL clears it; each call then starts a trace of its own.
+ */
+int yai_sdk_client_set_trace_parent(yai_sdk_client_t *c, const yai_sdk_trace_ctx_t *parent);
+
+/** Called once per finished span; every pointer is only valid during the call. */
+typedef void (*yai_sdk_span_fn)(const yai_sdk_span_t *span, void *user_data);
+
+/**
+ * Register the process-wide span handler; NULL (the default) turns span
+ * reporting off. The handler and user_data are published together, so it
+ * may be swapped while calls run: a span already being reported may still
+ * reach the previous pair. Each swap keeps a few bytes allocated for the
+ * life of the process.
+ */
+void yai_sdk_set_span_handler(yai_sdk_span_fn handler, void *user_data);
+
+#ifdef __cplusplus
+}
+#endif
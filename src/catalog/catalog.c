@@ -3,6 +3,9 @@
 #include "yai_sdk/catalog.h"
 #include "yai_sdk/registry/registry_registry.h"
 
+#include "catalog_internal.h"
+
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -50,15 +53,21 @@ static int cmp_entrypoint_cstr(const void *a, const void *b)
   return strcmp(*ea, *eb);
 }
 
-static int find_counter_slot(group_counter_t *counters, size_t len, const char *group)
+static int find_counter_slot(const yai_cat_table_t *t, const group_counter_t *counters, uint32_t h, const char *group)
 {
-  if (!counters || !group || !group[0]) return -1;
-  for (size_t i = 0; i < len; i++) {
-    if (strcmp(counters[i].group, group) == 0) return (int)i;
+  for (uint32_t i = h & t->mask; t->slots[i].ref; i = (i + 1) & t->mask) {
+    if (t->slots[i].hash == h && strcmp(counters[t->slots[i].ref - 1].group, group) == 0) {
+      return (int)(t->slots[i].ref - 1);
+    }
   }
   return -1;
 }
 
+static uint32_t group_hash(const char *group)
+{
+  return yai_cat_hash_end(yai_cat_hash_part(YAI_CAT_HASH_INIT, group));
+}
+
 static void build_fallback_path(char *dst, size_t dst_sz,
                                 const char *entrypoint,
                                 const char *topic,
@@ -82,61 +91,76 @@ static void build_fallback_path(char *dst, size_t dst_sz,
   }
 }
 
-static int surface_matches(const char *surface, int mask)
+unsigned char yai_cat_surface_class(const char *surface)
 {
-  if (!surface || !surface[0]) return (mask & YAI_SDK_CATALOG_SURFACE_PLUMBING) != 0;
-  if (strcmp(surface, "surface") == 0 || strcmp(surface, "user") == 0) {
-    return (mask & YAI_SDK_CATALOG_SURFACE_SURFACE) != 0;
-  }
-  if (strcmp(surface, "ancillary") == 0 || strcmp(surface, "tool") == 0) {
-    return (mask & YAI_SDK_CATALOG_SURFACE_ANCILLARY) != 0;
-  }
-  if (strcmp(surface, "plumbing") == 0 || strcmp(surface, "internal") == 0) {
-    return (mask & YAI_SDK_CATALOG_SURFACE_PLUMBING) != 0;
-  }
-  return 0;
+  if (!surface || !surface[0]) return YAI_SDK_CATALOG_SURFACE_PLUMBING;
+  if (strcmp(surface, "surface") == 0 || strcmp(surface, "user") == 0) return YAI_SDK_CATALOG_SURFACE_SURFACE;
+  if (strcmp(surface, "ancillary") == 0 || strcmp(surface, "tool") == 0) return YAI_SDK_CATALOG_SURFACE_ANCILLARY;
+  if (strcmp(surface, "plumbing") == 0 || strcmp(surface, "internal") == 0) return YAI_SDK_CATALOG_SURFACE_PLUMBING;
+  return YAI_CAT_CLASS_UNKNOWN;
 }
 
-static int stability_matches(const char *stability, int mask)
+unsigned char yai_cat_stability_class(const char *stability)
 {
-  if (!stability || !stability[0]) return (mask & YAI_SDK_CATALOG_STABILITY_PLANNED) != 0;
-  if (strcmp(stability, "stable") == 0) return (mask & YAI_SDK_CATALOG_STABILITY_STABLE) != 0;
+  if (!stability || !stability[0]) return YAI_SDK_CATALOG_STABILITY_PLANNED;
+  if (strcmp(stability, "stable") == 0) return YAI_SDK_CATALOG_STABILITY_STABLE;
   if (strcmp(stability, "experimental") == 0 || strcmp(stability, "beta") == 0) {
-    return (mask & YAI_SDK_CATALOG_STABILITY_EXPERIMENTAL) != 0;
+    return YAI_SDK_CATALOG_STABILITY_EXPERIMENTAL;
   }
-  if (strcmp(stability, "planned") == 0) return (mask & YAI_SDK_CATALOG_STABILITY_PLANNED) != 0;
-  if (strcmp(stability, "deprecated") == 0) return (mask & YAI_SDK_CATALOG_STABILITY_DEPRECATED) != 0;
-  return 0;
+  if (strcmp(stability, "planned") == 0) return YAI_SDK_CATALOG_STABILITY_PLANNED;
+  if (strcmp(stability, "deprecated") == 0) return YAI_SDK_CATALOG_STABILITY_DEPRECATED;
+  return YAI_CAT_CLASS_UNKNOWN;
+}
+
+/* What filters read of commands_sorted[pos]: from the index's compact
+   copy (a compact catalog has no refs to read), or from the ref on a
+   catalog without one. */
+static void command_view(const yai_sdk_command_catalog_t *cat, size_t pos, yai_cat_view_t *v)
+{
+  const yai_sdk_command_ref_t *c;
+  if (yai_catalog_index_view(cat, pos, v)) return;
+  c = cat->commands_sorted[pos];
+  v->entrypoint = c->entrypoint;
+  v->topic = c->topic;
+  v->op = c->op;
+  v->surface = yai_cat_surface_class(c->surface);
+  v->stability = yai_cat_stability_class(c->stability);
+  v->hidden = c->hidden;
+  v->deprecated = c->deprecated;
 }
 
-static int command_matches_filter(const yai_sdk_command_ref_t *c, const yai_sdk_catalog_filter_t *filter)
+static int command_matches_filter(const yai_sdk_command_catalog_t *cat,
+                                  size_t pos,
+                                  const yai_sdk_catalog_filter_t *filter)
 {
+  yai_cat_view_t v;
   int surface_mask = YAI_SDK_CATALOG_SURFACE_ALL;
   int stability_mask = YAI_SDK_CATALOG_STABILITY_ALL;
   int include_hidden = 1;
   int include_deprecated = 1;
 
-  if (!c) return 0;
+  command_view(cat, pos, &v);
   if (filter) {
     if (filter->surface_mask != 0) surface_mask = filter->surface_mask;
     if (filter->stability_mask != 0) stability_mask = filter->stability_mask;
     include_hidden = filter->include_hidden ? 1 : 0;
     include_deprecated = filter->include_deprecated ? 1 : 0;
 
-    if (filter->entrypoint && filter->entrypoint[0] && strcmp(c->entrypoint, filter->entrypoint) != 0) return 0;
-    if (filter->topic && filter->topic[0] && strcmp(c->topic, filter->topic) != 0) return 0;
+    if (filter->entrypoint && filter->entrypoint[0] && strcmp(v.entrypoint, filter->entrypoint) != 0) return 0;
+    if (filter->topic && filter->topic[0] && strcmp(v.topic, filter->topic) != 0) return 0;
   }
 
-  if (!surface_matches(c->surface, surface_mask)) return 0;
-  if (!stability_matches(c->stability, stability_mask)) return 0;
-  if (!include_hidden && c->hidden) return 0;
-  if (!include_deprecated && c->deprecated) return 0;
+  if ((v.surface & surface_mask & YAI_SDK_CATALOG_SURFACE_ALL) == 0) return 0;
+  if ((v.stability & stability_mask & YAI_SDK_CATALOG_STABILITY_ALL) == 0) return 0;
+  if (!include_hidden && v.hidden) return 0;
+  if (!include_deprecated && v.deprecated) return 0;
   return 1;
 }
 
 static void free_partial(yai_sdk_command_catalog_t *out)
 {
   if (!out) return;
+  yai_catalog_index_free(out);
   free(out->commands_sorted);
   out->commands_sorted = NULL;
   out->command_count = 0;
@@ -152,34 +176,97 @@ static void free_partial(yai_sdk_command_catalog_t *out)
   out->group_count = 0;
 }
 
+void yai_catalog_ref_fill(yai_sdk_command_ref_t *ref, const yai_law_command_t *c)
+{
+  const char *group = (c->group && c->group[0]) ? c->group : "legacy";
+
+  snprintf(ref->group, sizeof(ref->group), "%s", group);
+  snprintf(ref->name, sizeof(ref->name), "%s", c->name);
+  snprintf(ref->id, sizeof(ref->id), "%s", c->id);
+
+  snprintf(ref->surface, sizeof(ref->surface), "%s",
+           (c->surface && c->surface[0]) ? c->surface : "plumbing");
+  snprintf(ref->entrypoint, sizeof(ref->entrypoint), "%s",
+           (c->entrypoint && c->entrypoint[0]) ? c->entrypoint : "run");
+  snprintf(ref->topic, sizeof(ref->topic), "%s",
+           (c->topic && c->topic[0]) ? c->topic : group);
+  snprintf(ref->op, sizeof(ref->op), "%s",
+           (c->op && c->op[0]) ? c->op : c->name);
+  snprintf(ref->domain, sizeof(ref->domain), "%s",
+           (c->domain && c->domain[0]) ? c->domain : "internal");
+  snprintf(ref->layer, sizeof(ref->layer), "%s",
+           (c->layer && c->layer[0]) ? c->layer : "root");
+  snprintf(ref->stability, sizeof(ref->stability), "%s",
+           (c->stability && c->stability[0]) ? c->stability : "planned");
+
+  if (c->canonical_path && c->canonical_path[0]) {
+    snprintf(ref->canonical_path, sizeof(ref->canonical_path), "%s", c->canonical_path);
+  } else {
+    build_fallback_path(ref->canonical_path, sizeof(ref->canonical_path),
+                        ref->entrypoint, ref->topic, ref->op);
+  }
+
+  ref->help_order = c->help_order;
+  ref->hidden = c->hidden ? 1 : 0;
+  ref->deprecated = c->deprecated ? 1 : 0;
+  if (c->replaced_by && c->replaced_by[0]) {
+    snprintf(ref->replaced_by, sizeof(ref->replaced_by), "%s", c->replaced_by);
+  }
+
+  ref->aliases = c->aliases;
+  ref->aliases_len = c->aliases_len;
+  ref->outputs = c->outputs;
+  ref->outputs_len = c->outputs_len;
+  ref->side_effects = c->side_effects;
+  ref->side_effects_len = c->side_effects_len;
+
+  if (c->summary && c->summary[0]) {
+    snprintf(ref->summary, sizeof(ref->summary), "%s", c->summary);
+  } else {
+    snprintf(ref->summary, sizeof(ref->summary), "No description.");
+  }
+}
+
 int yai_sdk_command_catalog_load(yai_sdk_command_catalog_t *out)
 {
-  const yai_law_registry_t *reg;
+  if (!out) return 1;
+  memset(out, 0, sizeof(*out));
+
+  if (yai_law_registry_init() != 0) return 2;
+  return yai_catalog_load_from(out, yai_law_registry());
+}
+
+int yai_catalog_load_from(yai_sdk_command_catalog_t *out, const yai_law_registry_t *reg)
+{
   group_counter_t *counters = NULL;
+  yai_cat_table_t counter_index = {NULL, 0};
   size_t counter_len = 0;
   size_t total_commands = 0;
 
   if (!out) return 1;
   memset(out, 0, sizeof(*out));
-
-  if (yai_law_registry_init() != 0) return 2;
-  reg = yai_law_registry();
   if (!reg || !reg->commands || reg->commands_len == 0) return 3;
 
   counters = (group_counter_t *)calloc(reg->commands_len, sizeof(*counters));
-  if (!counters) return 4;
+  if (!counters || yai_cat_table_init(&counter_index, reg->commands_len) != 0) {
+    free(counters);
+    return 4;
+  }
 
   for (size_t i = 0; i < reg->commands_len; i++) {
     const yai_law_command_t *c = &reg->commands[i];
     const char *group = (c && c->group && c->group[0]) ? c->group : "legacy";
     int slot;
+    uint32_t h;
 
     if (!c || !c->name || !c->id) continue;
     total_commands++;
 
-    slot = find_counter_slot(counters, counter_len, group);
+    h = group_hash(group);
+    slot = find_counter_slot(&counter_index, counters, h, group);
     if (slot < 0) {
       slot = (int)counter_len++;
+      yai_cat_table_put(&counter_index, h, (uint32_t)slot);
       snprintf(counters[(size_t)slot].group, sizeof(counters[(size_t)slot].group), "%s", group);
       counters[(size_t)slot].count = 0;
       counters[(size_t)slot].write_cursor = 0;
@@ -189,12 +276,14 @@ int yai_sdk_command_catalog_load(yai_sdk_command_catalog_t *out)
 
   if (counter_len == 0 || total_commands == 0) {
     free(counters);
+    yai_cat_table_free(&counter_index);
     return 5;
   }
 
   out->groups = (yai_sdk_command_group_t *)calloc(counter_len, sizeof(*out->groups));
   if (!out->groups) {
     free(counters);
+    yai_cat_table_free(&counter_index);
     return 6;
   }
   out->group_count = counter_len;
@@ -205,6 +294,7 @@ int yai_sdk_command_catalog_load(yai_sdk_command_catalog_t *out)
     out->groups[i].commands = (yai_sdk_command_ref_t *)calloc(counters[i].count, sizeof(yai_sdk_command_ref_t));
     if (!out->groups[i].commands) {
       free(counters);
+      yai_cat_table_free(&counter_index);
       free_partial(out);
       return 7;
     }
@@ -215,65 +305,20 @@ int yai_sdk_command_catalog_load(yai_sdk_command_catalog_t *out)
     const char *group = (c && c->group && c->group[0]) ? c->group : "legacy";
     int cslot;
     size_t w;
-    yai_sdk_command_ref_t *ref;
 
     if (!c || !c->name || !c->id) continue;
-    cslot = find_counter_slot(counters, counter_len, group);
+    cslot = find_counter_slot(&counter_index, counters, group_hash(group), group);
     if (cslot < 0) continue;
 
     w = counters[(size_t)cslot].write_cursor++;
     if (w >= out->groups[(size_t)cslot].command_count) {
       free(counters);
+      yai_cat_table_free(&counter_index);
       free_partial(out);
       return 8;
     }
 
-    ref = &out->groups[(size_t)cslot].commands[w];
-    snprintf(ref->group, sizeof(ref->group), "%s", group);
-    snprintf(ref->name, sizeof(ref->name), "%s", c->name);
-    snprintf(ref->id, sizeof(ref->id), "%s", c->id);
-
-    snprintf(ref->surface, sizeof(ref->surface), "%s",
-             (c->surface && c->surface[0]) ? c->surface : "plumbing");
-    snprintf(ref->entrypoint, sizeof(ref->entrypoint), "%s",
-             (c->entrypoint && c->entrypoint[0]) ? c->entrypoint : "run");
-    snprintf(ref->topic, sizeof(ref->topic), "%s",
-             (c->topic && c->topic[0]) ? c->topic : group);
-    snprintf(ref->op, sizeof(ref->op), "%s",
-             (c->op && c->op[0]) ? c->op : c->name);
-    snprintf(ref->domain, sizeof(ref->domain), "%s",
-             (c->domain && c->domain[0]) ? c->domain : "internal");
-    snprintf(ref->layer, sizeof(ref->layer), "%s",
-             (c->layer && c->layer[0]) ? c->layer : "root");
-    snprintf(ref->stability, sizeof(ref->stability), "%s",
-             (c->stability && c->stability[0]) ? c->stability : "planned");
-
-    if (c->canonical_path && c->canonical_path[0]) {
-      snprintf(ref->canonical_path, sizeof(ref->canonical_path), "%s", c->canonical_path);
-    } else {
-      build_fallback_path(ref->canonical_path, sizeof(ref->canonical_path),
-                          ref->entrypoint, ref->topic, ref->op);
-    }
-
-    ref->help_order = c->help_order;
-    ref->hidden = c->hidden ? 1 : 0;
-    ref->deprecated = c->deprecated ? 1 : 0;
-    if (c->replaced_by && c->replaced_by[0]) {
-      snprintf(ref->replaced_by, sizeof(ref->replaced_by), "%s", c->replaced_by);
-    }
-
-    ref->aliases = c->aliases;
-    ref->aliases_len = c->aliases_len;
-    ref->outputs = c->outputs;
-    ref->outputs_len = c->outputs_len;
-    ref->side_effects = c->side_effects;
-    ref->side_effects_len = c->side_effects_len;
-
-    if (c->summary && c->summary[0]) {
-      snprintf(ref->summary, sizeof(ref->summary), "%s", c->summary);
-    } else {
-      snprintf(ref->summary, sizeof(ref->summary), "No description.");
-    }
+    yai_catalog_ref_fill(&out->groups[(size_t)cslot].commands[w], c);
   }
 
   for (size_t i = 0; i < out->group_count; i++) {
@@ -287,6 +332,7 @@ int yai_sdk_command_catalog_load(yai_sdk_command_catalog_t *out)
   out->commands_sorted = (yai_sdk_command_ref_t **)calloc(total_commands, sizeof(yai_sdk_command_ref_t *));
   if (!out->commands_sorted) {
     free(counters);
+    yai_cat_table_free(&counter_index);
     free_partial(out);
     return 9;
   }
@@ -305,7 +351,55 @@ int yai_sdk_command_catalog_load(yai_sdk_command_catalog_t *out)
           cmp_command_ptr_canonical);
   }
 
+  if (yai_catalog_index_build(out) != 0) {
+    free(counters);
+    yai_cat_table_free(&counter_index);
+    free_partial(out);
+    return 10;
+  }
+
   free(counters);
+  yai_cat_table_free(&counter_index);
+  return 0;
+}
+
+int yai_sdk_command_catalog_load_compact(yai_sdk_command_catalog_t *out)
+{
+  if (!out) return 1;
+  memset(out, 0, sizeof(*out));
+
+  if (yai_law_registry_init() != 0) return 2;
+  return yai_catalog_load_compact_from(out, yai_law_registry());
+}
+
+int yai_catalog_load_compact_from(yai_sdk_command_catalog_t *out, const yai_law_registry_t *reg)
+{
+  uint32_t *rows;
+  size_t n = 0;
+
+  if (!out) return 1;
+  memset(out, 0, sizeof(*out));
+  if (!reg || !reg->commands || reg->commands_len == 0) return 3;
+  if (reg->commands_len >= UINT32_MAX) return 4;
+
+  rows = (uint32_t *)malloc(reg->commands_len * sizeof(uint32_t));
+  if (!rows) return 4;
+  for (size_t i = 0; i < reg->commands_len; i++) {
+    const yai_law_command_t *c = &reg->commands[i];
+    if (!c->name || !c->id) continue;
+    rows[n++] = (uint32_t)i;
+  }
+  if (n == 0) {
+    free(rows);
+    return 5;
+  }
+
+  if (yai_catalog_index_build_compact(out, reg, rows, n) != 0) {
+    free(rows);
+    free_partial(out);
+    return 10;
+  }
+  free(rows);
   return 0;
 }
 
@@ -319,7 +413,13 @@ const yai_sdk_command_group_t *yai_sdk_command_catalog_find_group(
     const yai_sdk_command_catalog_t *cat,
     const char *group)
 {
+  const yai_sdk_command_group_t *found = NULL;
   if (!cat || !group || !group[0]) return NULL;
+  if (yai_catalog_index_group(cat, group, &found)) {
+    /* a compact catalog's group is handed out with its refs */
+    if (found && yai_catalog_group_refs(cat, (size_t)(found - cat->groups)) != 0) return NULL;
+    return found;
+  }
   for (size_t i = 0; i < cat->group_count; i++) {
     if (strcmp(cat->groups[i].group, group) == 0) return &cat->groups[i];
   }
@@ -331,7 +431,12 @@ const yai_sdk_command_ref_t *yai_sdk_command_catalog_find_command(
     const char *group,
     const char *name)
 {
-  const yai_sdk_command_group_t *g = yai_sdk_command_catalog_find_group(cat, group);
+  const yai_sdk_command_ref_t *found = NULL;
+  const yai_sdk_command_group_t *g;
+  if (cat && group && group[0] && name && name[0] && yai_catalog_index_command(cat, group, name, &found)) {
+    return found;
+  }
+  g = yai_sdk_command_catalog_find_group(cat, group);
   if (!g || !name || !name[0]) return NULL;
   for (size_t i = 0; i < g->command_count; i++) {
     if (strcmp(g->commands[i].name, name) == 0) return &g->commands[i];
@@ -343,7 +448,9 @@ const yai_sdk_command_ref_t *yai_sdk_command_catalog_find_by_id(
     const yai_sdk_command_catalog_t *cat,
     const char *canonical_id)
 {
+  const yai_sdk_command_ref_t *found = NULL;
   if (!cat || !canonical_id || !canonical_id[0]) return NULL;
+  if (yai_catalog_index_id(cat, canonical_id, &found)) return found;
   for (size_t i = 0; i < cat->command_count; i++) {
     const yai_sdk_command_ref_t *c = cat->commands_sorted[i];
     if (strcmp(c->id, canonical_id) == 0) return c;
@@ -359,6 +466,8 @@ const yai_sdk_command_ref_t *yai_sdk_command_catalog_find_by_path(
     int surface_mask)
 {
   yai_sdk_catalog_filter_t f = {0};
+  size_t begin;
+  size_t end;
   if (!cat || !entrypoint || !entrypoint[0]) return NULL;
 
   f.surface_mask = (surface_mask == 0) ? YAI_SDK_CATALOG_SURFACE_ALL : surface_mask;
@@ -368,11 +477,15 @@ const yai_sdk_command_ref_t *yai_sdk_command_catalog_find_by_path(
   f.include_hidden = 1;
   f.include_deprecated = 1;
 
-  for (size_t i = 0; i < cat->command_count; i++) {
-    const yai_sdk_command_ref_t *c = cat->commands_sorted[i];
-    if (!command_matches_filter(c, &f)) continue;
-    if (op && op[0] && strcmp(c->op, op) != 0) continue;
-    return c;
+  /* only the run of this entrypoint (and topic, and op) can match */
+  yai_catalog_index_run(cat, entrypoint, (topic && topic[0]) ? topic : NULL,
+                        (topic && topic[0] && op && op[0]) ? op : NULL, &begin, &end);
+  for (size_t i = begin; i < end; i++) {
+    yai_cat_view_t v;
+    if (!command_matches_filter(cat, i, &f)) continue;
+    command_view(cat, i, &v);
+    if (op && op[0] && strcmp(v.op, op) != 0) continue;
+    return yai_catalog_command_at(cat, i);
   }
   return NULL;
 }
@@ -382,10 +495,17 @@ const yai_sdk_command_ref_t *yai_sdk_command_catalog_find_by_canonical_path(
     const char *canonical_path,
     const yai_sdk_catalog_filter_t *filter)
 {
+  size_t pos;
   if (!cat || !canonical_path || !canonical_path[0]) return NULL;
+  if (yai_catalog_index_canonical(cat, canonical_path, &pos)) {
+    for (; pos != SIZE_MAX; pos = yai_catalog_index_canonical_next(cat, pos)) {
+      if (command_matches_filter(cat, pos, filter)) return yai_catalog_command_at(cat, pos);
+    }
+    return NULL;
+  }
   for (size_t i = 0; i < cat->command_count; i++) {
     const yai_sdk_command_ref_t *c = cat->commands_sorted[i];
-    if (!command_matches_filter(c, filter)) continue;
+    if (!command_matches_filter(cat, i, filter)) continue;
     if (strcmp(c->canonical_path, canonical_path) == 0) return c;
   }
   return NULL;
@@ -397,9 +517,14 @@ const yai_sdk_command_ref_t *yai_sdk_command_catalog_find_by_alias(
     int *ambiguous)
 {
   const yai_sdk_command_ref_t *found = NULL;
+  int dup = 0;
   if (ambiguous) *ambiguous = 0;
   if (!cat || !alias || !alias[0]) return NULL;
 
+  if (yai_catalog_index_alias(cat, alias, &found, &dup)) {
+    if (ambiguous) *ambiguous = dup;
+    return found;
+  }
   for (size_t i = 0; i < cat->command_count; i++) {
     const yai_sdk_command_ref_t *c = cat->commands_sorted[i];
     for (size_t j = 0; j < c->aliases_len; j++) {
@@ -451,15 +576,52 @@ size_t yai_sdk_command_catalog_query(
   size_t n = 0;
   if (!cat) return 0;
 
+  /* attributes through the bitsets, entrypoint and topic through the trie */
+  if (cat->index) {
+    yai_sdk_catalog_filter_t f = {0};
+
+    f.surface_mask = YAI_SDK_CATALOG_SURFACE_ALL;
+    f.stability_mask = YAI_SDK_CATALOG_STABILITY_ALL;
+    f.include_hidden = 1;
+    f.include_deprecated = 1;
+    if (filter) {
+      if (filter->surface_mask != 0) f.surface_mask = filter->surface_mask;
+      if (filter->stability_mask != 0) f.stability_mask = filter->stability_mask;
+      f.include_hidden = filter->include_hidden ? 1 : 0;
+      f.include_deprecated = filter->include_deprecated ? 1 : 0;
+      f.entrypoint = filter->entrypoint;
+      f.topic = filter->topic;
+    }
+    return yai_catalog_index_query(cat, &f, out_matches, out_cap);
+  }
+
   for (size_t i = 0; i < cat->command_count; i++) {
     const yai_sdk_command_ref_t *c = cat->commands_sorted[i];
-    if (!command_matches_filter(c, filter)) continue;
+    if (!command_matches_filter(cat, i, filter)) continue;
     if (out_matches && n < out_cap) out_matches[n] = c;
     n++;
   }
   return n;
 }
 
+/* Position of the first command of commands_sorted[begin, end) passing
+   filter (and with this op, when not NULL), or SIZE_MAX. */
+static size_t first_match(const yai_sdk_command_catalog_t *cat,
+                          size_t begin,
+                          size_t end,
+                          const yai_sdk_catalog_filter_t *filter,
+                          const char *op)
+{
+  for (size_t i = begin; i < end; i++) {
+    yai_cat_view_t v;
+    if (!command_matches_filter(cat, i, filter)) continue;
+    command_view(cat, i, &v);
+    if (op && strcmp(v.op, op) != 0) continue;
+    return i;
+  }
+  return SIZE_MAX;
+}
+
 const yai_sdk_command_ref_t *yai_sdk_command_catalog_resolve_path(
     const yai_sdk_command_catalog_t *cat,
     const char **tokens,
@@ -470,9 +632,11 @@ const yai_sdk_command_ref_t *yai_sdk_command_catalog_resolve_path(
   yai_sdk_catalog_filter_t local_filter;
   const yai_sdk_command_ref_t *found = NULL;
   int ambiguous_alias = 0;
-  int seen_entrypoint = 0;
-  int seen_topic = 0;
   char path_buf[192];
+  size_t path_len = 0;
+  size_t begin;
+  size_t end;
+  size_t pos = SIZE_MAX;
 
   if (status) *status = YAI_SDK_CATALOG_RESOLVE_BAD_ARGS;
   if (!cat || !tokens || token_count == 0 || !tokens[0] || !tokens[0][0]) return NULL;
@@ -482,34 +646,19 @@ const yai_sdk_command_ref_t *yai_sdk_command_catalog_resolve_path(
   if (local_filter.surface_mask == 0) local_filter.surface_mask = YAI_SDK_CATALOG_SURFACE_ALL;
   if (local_filter.stability_mask == 0) local_filter.stability_mask = YAI_SDK_CATALOG_STABILITY_ALL;
   local_filter.entrypoint = tokens[0];
+  local_filter.topic = NULL;
 
-  if (token_count > 1 && tokens[1] && tokens[1][0]) {
+  /* the trie node of the tokens is their run: only it can match */
+  if (token_count == 2) {
     local_filter.topic = tokens[1];
+    yai_catalog_index_run(cat, tokens[0], tokens[1], NULL, &begin, &end);
+    pos = first_match(cat, begin, end, &local_filter, NULL);
+  } else if (token_count > 2) {
+    local_filter.topic = tokens[1];
+    yai_catalog_index_run(cat, tokens[0], tokens[1], tokens[2], &begin, &end);
+    pos = first_match(cat, begin, end, &local_filter, tokens[2]);
   }
-
-  for (size_t i = 0; i < cat->command_count; i++) {
-    const yai_sdk_command_ref_t *c = cat->commands_sorted[i];
-    if (!command_matches_filter(c, &local_filter)) continue;
-    seen_entrypoint = 1;
-    if (token_count > 1 && strcmp(c->topic, tokens[1]) == 0) seen_topic = 1;
-
-    if (token_count == 1) {
-      continue;
-    }
-    if (token_count == 2) {
-      if (strcmp(c->topic, tokens[1]) == 0) {
-        found = c;
-        break;
-      }
-      continue;
-    }
-
-    if (strcmp(c->topic, tokens[1]) == 0 && strcmp(c->op, tokens[2]) == 0) {
-      found = c;
-      break;
-    }
-  }
-
+  if (pos != SIZE_MAX) found = yai_catalog_command_at(cat, pos);
   if (found) {
     if (status) *status = YAI_SDK_CATALOG_RESOLVE_OK;
     return found;
@@ -517,9 +666,14 @@ const yai_sdk_command_ref_t *yai_sdk_command_catalog_resolve_path(
 
   path_buf[0] = '\0';
   for (size_t i = 0; i < token_count && i < 3; i++) {
+    size_t len;
     if (!tokens[i] || !tokens[i][0]) continue;
-    if (path_buf[0]) strncat(path_buf, " ", sizeof(path_buf) - strlen(path_buf) - 1);
-    strncat(path_buf, tokens[i], sizeof(path_buf) - strlen(path_buf) - 1);
+    len = strlen(tokens[i]);
+    if (path_len > 0 && path_len + 1 < sizeof(path_buf)) path_buf[path_len++] = ' ';
+    if (len > sizeof(path_buf) - 1 - path_len) len = sizeof(path_buf) - 1 - path_len;
+    memcpy(path_buf + path_len, tokens[i], len);
+    path_len += len;
+    path_buf[path_len] = '\0';
   }
 
   found = yai_sdk_command_catalog_find_by_canonical_path(cat, path_buf, filter);
@@ -539,13 +693,20 @@ const yai_sdk_command_ref_t *yai_sdk_command_catalog_resolve_path(
     return NULL;
   }
 
-  if (!seen_entrypoint) {
+  /* a miss: report the deepest level the tokens did not reach */
+  local_filter.topic = NULL;
+  yai_catalog_index_run(cat, tokens[0], NULL, NULL, &begin, &end);
+  if (first_match(cat, begin, end, &local_filter, NULL) == SIZE_MAX) {
     if (status) *status = YAI_SDK_CATALOG_RESOLVE_UNKNOWN_ENTRYPOINT;
     return NULL;
   }
-  if (token_count > 1 && !seen_topic) {
-    if (status) *status = YAI_SDK_CATALOG_RESOLVE_UNKNOWN_TOPIC;
-    return NULL;
+  if (token_count > 1) {
+    local_filter.topic = tokens[1];
+    if (tokens[1][0]) yai_catalog_index_run(cat, tokens[0], tokens[1], NULL, &begin, &end);
+    if (!tokens[1][0] || first_match(cat, begin, end, &local_filter, NULL) == SIZE_MAX) {
+      if (status) *status = YAI_SDK_CATALOG_RESOLVE_UNKNOWN_TOPIC;
+      return NULL;
+    }
   }
   if (token_count > 2) {
     if (status) *status = YAI_SDK_CATALOG_RESOLVE_UNKNOWN_OP;
@@ -556,6 +717,59 @@ const yai_sdk_command_ref_t *yai_sdk_command_catalog_resolve_path(
   return NULL;
 }
 
+size_t yai_sdk_command_catalog_complete(
+    const yai_sdk_command_catalog_t *cat,
+    const char **tokens,
+    size_t token_count,
+    const char *prefix,
+    const yai_sdk_catalog_filter_t *filter,
+    const char **out,
+    size_t out_cap)
+{
+  const char *last = NULL;
+  size_t node = 0;
+  size_t prefix_len;
+  size_t lo;
+  size_t hi;
+  size_t n = 0;
+
+  if (!cat || token_count > 2 || (token_count > 0 && !tokens)) return 0;
+  for (size_t i = 0; i < token_count; i++) {
+    if (!tokens[i]) return 0;
+  }
+  if (!prefix) prefix = "";
+
+  if (cat->index) {
+    for (size_t i = 0; i < token_count; i++) {
+      node = yai_catalog_index_child(cat, YAI_CAT_ROOT + (int)i, node, tokens[i]);
+      if (node == SIZE_MAX) return 0;
+    }
+    yai_catalog_index_children(cat, YAI_CAT_ROOT + (int)token_count, node, prefix, &lo, &hi);
+    for (size_t i = lo; i < hi; i++) {
+      const yai_cat_node_t *child = yai_catalog_index_node(cat, YAI_CAT_EP + (int)token_count, i);
+      if (first_match(cat, child->begin, child->end, filter, NULL) == SIZE_MAX) continue;
+      if (out && n < out_cap) out[n] = yai_catalog_index_token(cat, YAI_CAT_EP + (int)token_count, i);
+      n++;
+    }
+    return n;
+  }
+
+  prefix_len = strlen(prefix);
+  for (size_t i = 0; i < cat->command_count; i++) {
+    const yai_sdk_command_ref_t *c = cat->commands_sorted[i];
+    const char *tok = yai_cat_level_token(c, YAI_CAT_EP + (int)token_count);
+    if (token_count > 0 && strcmp(c->entrypoint, tokens[0]) != 0) continue;
+    if (token_count > 1 && strcmp(c->topic, tokens[1]) != 0) continue;
+    if (strncmp(tok, prefix, prefix_len) != 0) continue;
+    if (last && strcmp(last, tok) == 0) continue;
+    if (!command_matches_filter(cat, i, filter)) continue;
+    if (out && n < out_cap) out[n] = tok;
+    last = tok;
+    n++;
+  }
+  return n;
+}
+
 size_t yai_sdk_command_catalog_collect_entrypoints(
     const yai_sdk_command_catalog_t *cat,
     int surface_mask,
@@ -567,17 +781,18 @@ size_t yai_sdk_command_catalog_collect_entrypoints(
   if (surface_mask == 0) surface_mask = YAI_SDK_CATALOG_SURFACE_ALL;
 
   for (size_t i = 0; i < cat->command_count; i++) {
-    const yai_sdk_command_ref_t *c = cat->commands_sorted[i];
+    yai_cat_view_t v;
     int seen = 0;
-    if (!surface_matches(c->surface, surface_mask)) continue;
+    command_view(cat, i, &v);
+    if ((v.surface & surface_mask & YAI_SDK_CATALOG_SURFACE_ALL) == 0) continue;
     for (size_t k = 0; k < n; k++) {
-      if (strcmp(out_entrypoints[k], c->entrypoint) == 0) {
+      if (strcmp(out_entrypoints[k], v.entrypoint) == 0) {
         seen = 1;
         break;
       }
     }
     if (seen) continue;
-    if (n < out_cap) out_entrypoints[n] = c->entrypoint;
+    if (n < out_cap) out_entrypoints[n] = v.entrypoint;
     n++;
   }
 
@@ -627,6 +842,13 @@ int yai_sdk_help_index_build(
     yai_sdk_help_topic_t *t = NULL;
     yai_sdk_help_op_t *slot;
 
+    if (!c) {
+      /* a compact catalog could not fill in its refs */
+      free(matches);
+      yai_sdk_help_index_free(out);
+      return 2;
+    }
+
     for (size_t ei = 0; ei < out->entrypoint_count; ei++) {
       if (strcmp(out->entrypoints[ei].entrypoint, c->entrypoint) == 0) {
         e = &out->entrypoints[ei];
@@ -756,10 +978,14 @@ size_t yai_catalog_list_groups(
     const yai_catalog_t *cat,
     const yai_catalog_group_t **out_groups)
 {
-  if (out_groups) {
-    *out_groups = (cat && cat->group_count > 0) ? cat->groups : NULL;
+  if (out_groups) *out_groups = NULL;
+  if (!cat) return 0;
+  /* the caller may walk every group's commands */
+  for (size_t g = 0; g < cat->group_count; g++) {
+    if (yai_catalog_group_refs(cat, g) != 0) return 0;
   }
-  return (cat) ? cat->group_count : 0;
+  if (out_groups && cat->group_count > 0) *out_groups = cat->groups;
+  return cat->group_count;
 }
 
 size_t yai_catalog_list_commands(
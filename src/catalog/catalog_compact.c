@@ -0,0 +1,220 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include "catalog_internal.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ============================================================
+   COMPACT LAYOUT
+   - one allocation: per-field offset arrays, the intern table, the
+     attribute bytes, then the pool of distinct NUL-terminated strings
+   - interned, so equal strings have equal offsets: a command's
+     entrypoint or topic is compared as one uint32_t
+   ============================================================ */
+
+enum { FIELD_ID = 0, FIELD_NAME, FIELD_GROUP, FIELD_EP, FIELD_TOPIC, FIELD_OP, FIELD_CANONICAL, FIELD_COUNT };
+
+static const char *field_of(const yai_sdk_command_ref_t *c, int field)
+{
+  switch (field) {
+  case FIELD_ID: return c->id;
+  case FIELD_NAME: return c->name;
+  case FIELD_GROUP: return c->group;
+  case FIELD_EP: return c->entrypoint;
+  case FIELD_TOPIC: return c->topic;
+  case FIELD_OP: return c->op;
+  default: return c->canonical_path;
+  }
+}
+
+static uint32_t str_hash(const char *s)
+{
+  return yai_cat_hash_end(yai_cat_hash_part(YAI_CAT_HASH_INIT, s));
+}
+
+static uint32_t intern(yai_cat_table_t *t, char *pool, size_t *len, const char *s)
+{
+  uint32_t h = str_hash(s);
+  size_t n;
+
+  for (uint32_t i = h & t->mask; t->slots[i].ref; i = (i + 1) & t->mask) {
+    if (t->slots[i].hash == h && strcmp(pool + t->slots[i].ref - 1, s) == 0) return t->slots[i].ref - 1;
+  }
+  n = strlen(s) + 1;
+  memcpy(pool + *len, s, n);
+  yai_cat_table_put(t, h, (uint32_t)*len);
+  *len += n;
+  return (uint32_t)(*len - n);
+}
+
+/*
+ * Reads each ref once, command by command: its fields go to a staging
+ * buffer (offs[f * n + k] their offsets in it), its classes and flags to
+ * attrs. Returns the buffer, *len bytes of it used, or NULL.
+ */
+static char *stage_commands(size_t n, yai_cat_compact_src_fn src, void *ctx, uint32_t *offs, unsigned char *attrs,
+                            size_t *len)
+{
+  yai_sdk_command_ref_t *scratch = (yai_sdk_command_ref_t *)malloc(sizeof(*scratch));
+  size_t cap = 4096;
+  char *stage = (char *)malloc(cap);
+
+  *len = 0;
+  if (!scratch || !stage) {
+    free(scratch);
+    free(stage);
+    return NULL;
+  }
+  for (size_t k = 0; k < n; k++) {
+    const yai_sdk_command_ref_t *c = src(ctx, k, scratch);
+    for (int f = 0; f < FIELD_COUNT; f++) {
+      const char *v = field_of(c, f);
+      size_t vlen = strlen(v) + 1;
+      if (*len + vlen > cap) {
+        char *grown;
+        while (*len + vlen > cap) cap *= 2;
+        grown = (char *)realloc(stage, cap);
+        if (!grown || cap >= UINT32_MAX) {
+          free(grown ? grown : stage);
+          free(scratch);
+          return NULL;
+        }
+        stage = grown;
+      }
+      memcpy(stage + *len, v, vlen);
+      offs[(size_t)f * n + k] = (uint32_t)*len;
+      *len += vlen;
+    }
+    attrs[k] = yai_cat_surface_class(c->surface);
+    attrs[n + k] = yai_cat_stability_class(c->stability);
+    attrs[2 * n + k] = (unsigned char)((c->hidden ? YAI_CAT_FLAG_HIDDEN : 0) | (c->deprecated ? YAI_CAT_FLAG_DEPRECATED : 0));
+  }
+  free(scratch);
+  return stage;
+}
+
+int yai_cat_compact_build(yai_cat_compact_t *out, size_t n, yai_cat_compact_src_fn src, void *ctx)
+{
+  size_t stage_len = 0;
+  size_t pool_len = 0;
+  size_t slots;
+  size_t offs;
+  yai_cat_table_t strings = {0};
+  uint32_t *tmp_offs;
+  unsigned char *tmp_attrs;
+  char *stage = NULL;
+  char *tmp_pool = NULL;
+  unsigned char *base;
+
+  memset(out, 0, sizeof(*out));
+  tmp_offs = (uint32_t *)malloc((n ? n : 1) * FIELD_COUNT * sizeof(uint32_t));
+  tmp_attrs = (unsigned char *)malloc((n ? n : 1) * 3);
+  if (tmp_offs && tmp_attrs) stage = stage_commands(n, src, ctx, tmp_offs, tmp_attrs, &stage_len);
+  if (stage) tmp_pool = (char *)malloc(stage_len ? stage_len : 1);
+  if (!tmp_pool || yai_cat_table_init(&strings, n * FIELD_COUNT) != 0) {
+    free(tmp_offs);
+    free(tmp_attrs);
+    free(stage);
+    free(tmp_pool);
+    return -1;
+  }
+  /* then field by field, so a field's distinct strings sit together */
+  for (int f = 0; f < FIELD_COUNT; f++) {
+    for (size_t k = 0; k < n; k++) {
+      uint32_t *off = &tmp_offs[(size_t)f * n + k];
+      *off = intern(&strings, tmp_pool, &pool_len, stage + *off);
+    }
+  }
+  free(stage);
+
+  slots = (size_t)strings.mask + 1;
+  offs = (size_t)FIELD_COUNT * n * sizeof(uint32_t);
+  out->bytes = offs + slots * sizeof(yai_cat_slot_t) + 3 * n + pool_len;
+  base = (unsigned char *)malloc(out->bytes);
+  if (!base) {
+    free(tmp_offs);
+    free(tmp_attrs);
+    free(tmp_pool);
+    yai_cat_table_free(&strings);
+    out->bytes = 0;
+    return -1;
+  }
+  memcpy(base, tmp_offs, offs);
+  memcpy(base + offs, strings.slots, slots * sizeof(yai_cat_slot_t));
+  out->count = n;
+  out->id = (uint32_t *)base;
+  out->name = out->id + n;
+  out->group = out->name + n;
+  out->entrypoint = out->group + n;
+  out->topic = out->entrypoint + n;
+  out->op = out->topic + n;
+  out->canonical_path = out->op + n;
+  out->strings.slots = (yai_cat_slot_t *)(base + offs);
+  out->strings.mask = strings.mask;
+  out->surface_class = base + offs + slots * sizeof(yai_cat_slot_t);
+  out->stability_class = out->surface_class + n;
+  out->flags = out->stability_class + n;
+  out->pool = (char *)(out->flags + n);
+  memcpy(out->surface_class, tmp_attrs, 3 * n);
+  memcpy(out->pool, tmp_pool, pool_len);
+
+  free(tmp_offs);
+  free(tmp_attrs);
+  free(tmp_pool);
+  yai_cat_table_free(&strings);
+  return 0;
+}
+
+int yai_cat_compact_permute(yai_cat_compact_t *c, const uint32_t *from)
+{
+  uint32_t *fields[FIELD_COUNT];
+  unsigned char *attrs[3];
+  size_t n = c->count;
+  uint32_t *tmp = (uint32_t *)malloc((n ? n : 1) * sizeof(uint32_t));
+
+  if (!tmp) return -1;
+  fields[FIELD_ID] = c->id;
+  fields[FIELD_NAME] = c->name;
+  fields[FIELD_GROUP] = c->group;
+  fields[FIELD_EP] = c->entrypoint;
+  fields[FIELD_TOPIC] = c->topic;
+  fields[FIELD_OP] = c->op;
+  fields[FIELD_CANONICAL] = c->canonical_path;
+  attrs[0] = c->surface_class;
+  attrs[1] = c->stability_class;
+  attrs[2] = c->flags;
+  for (int f = 0; f < FIELD_COUNT; f++) {
+    for (size_t k = 0; k < n; k++) tmp[k] = fields[f][from[k]];
+    memcpy(fields[f], tmp, n * sizeof(uint32_t));
+  }
+  for (int a = 0; a < 3; a++) {
+    unsigned char *bytes = (unsigned char *)tmp;
+    for (size_t k = 0; k < n; k++) bytes[k] = attrs[a][from[k]];
+    memcpy(attrs[a], bytes, n);
+  }
+  free(tmp);
+  return 0;
+}
+
+void yai_cat_compact_free(yai_cat_compact_t *c)
+{
+  if (!c) return;
+  free(c->id); /* the start of the one allocation */
+  memset(c, 0, sizeof(*c));
+}
+
+uint32_t yai_cat_compact_find(const yai_cat_compact_t *c, const char *s)
+{
+  uint32_t h;
+
+  if (!c->strings.slots || !s) return UINT32_MAX;
+  h = str_hash(s);
+  for (uint32_t i = h & c->strings.mask; c->strings.slots[i].ref; i = (i + 1) & c->strings.mask) {
+    if (c->strings.slots[i].hash == h && strcmp(c->pool + c->strings.slots[i].ref - 1, s) == 0) {
+      return c->strings.slots[i].ref - 1;
+    }
+  }
+  return UINT32_MAX;
+}
@@ -0,0 +1,880 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include "catalog_internal.h"
+
+#include <yai_sdk/registry/registry_types.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ============================================================
+   TABLE
+   ============================================================ */
+
+int yai_cat_table_init(yai_cat_table_t *t, size_t keys)
+{
+  size_t cap = 16;
+  while (cap < keys * 2) cap <<= 1;
+  if (cap > UINT32_MAX) return -1;
+  t->slots = (yai_cat_slot_t *)calloc(cap, sizeof(*t->slots));
+  t->mask = (uint32_t)(cap - 1);
+  return t->slots ? 0 : -1;
+}
+
+void yai_cat_table_free(yai_cat_table_t *t)
+{
+  free(t->slots);
+  t->slots = NULL;
+  t->mask = 0;
+}
+
+void yai_cat_table_put(yai_cat_table_t *t, uint32_t hash, uint32_t item)
+{
+  uint32_t i = hash & t->mask;
+  while (t->slots[i].ref) i = (i + 1) & t->mask;
+  t->slots[i].hash = hash;
+  t->slots[i].ref = item + 1;
+}
+
+/* ============================================================
+   CATALOG INDEX
+   - id, canonical_path, group and (group, name) map to their first
+     command in the order a linear scan would meet them
+   - a trie of entrypoint -> topic -> op over commands_sorted, which is
+     sorted by exactly those keys: every node is a run of it, and a node's
+     children are consecutive and in token order
+   - each distinct alias maps to its first command, with its ambiguity
+     (another command id sharing it) settled at build time
+   - one bitset per surface, per stability, and for hidden and deprecated,
+     bit k for commands_sorted[k]
+   - all of it reads keys and attributes from the compact copy, where
+     equal strings share an offset, not from the ~1 KB command refs
+   - a compact catalog has no refs until asked for one: the index keeps
+     the registry row of each command, and the first lookup to return a
+     command of a group fills in that group's refs
+   ============================================================ */
+
+/* bitsets: surfaces, then stabilities, then hidden and deprecated */
+enum {
+  SET_SURFACE = 0,
+  SET_STABILITY = 3,
+  SET_HIDDEN = 7,
+  SET_DEPRECATED,
+  SET_COUNT
+};
+
+/* words ANDed per step of a query: a fixed-length inner loop the
+   compiler can keep in vector registers */
+#define QUERY_BLOCK 8
+
+typedef struct cat_alias {
+  const char *alias;
+  uint32_t first;     /* position in commands_sorted */
+  uint32_t ambiguous; /* 1: a command with another id has it too */
+} cat_alias_t;
+
+struct yai_sdk_catalog_index {
+  yai_cat_compact_t cx;
+  yai_cat_table_t by_id;
+  yai_cat_table_t by_canonical;
+  yai_cat_table_t by_group;
+  yai_cat_table_t by_name;
+  yai_cat_table_t by_alias;
+  /* next position with the same canonical_path; UINT32_MAX ends the chain */
+  uint32_t *canonical_next;
+  /* by_name items number commands in group order ("flat"): group g
+     starts at group_first[g]; group_count + 1 entries */
+  uint32_t *group_first;
+  uint32_t *pos_flat; /* commands_sorted position -> flat */
+  uint32_t *flat_pos;
+  /* compact catalog: the registry its refs are filled in from, and each
+     flat command's row in it */
+  const yai_law_registry_t *reg;
+  uint32_t *rows;
+  yai_cat_node_t *nodes[YAI_CAT_LEVELS];
+  uint32_t node_count[YAI_CAT_LEVELS];
+  cat_alias_t *aliases;
+  /* SET_COUNT bitsets of `words` 64-bit words each, one after another */
+  uint64_t *bits;
+  size_t words;
+};
+
+typedef struct yai_sdk_catalog_index cat_index_t;
+
+static uint32_t hash1(const char *a)
+{
+  return yai_cat_hash_end(yai_cat_hash_part(YAI_CAT_HASH_INIT, a));
+}
+
+static uint32_t hash2(const char *a, const char *b)
+{
+  return yai_cat_hash_end(yai_cat_hash_part(yai_cat_hash_part(YAI_CAT_HASH_INIT, a), b));
+}
+
+#define CX_STR(ix, field, k) yai_cat_compact_str(&(ix)->cx, (ix)->cx.field[k])
+
+/* Pool offsets of the commands' tokens at a trie level. */
+static const uint32_t *level_offsets(const cat_index_t *ix, int level)
+{
+  return (level == YAI_CAT_EP) ? ix->cx.entrypoint : (level == YAI_CAT_TOPIC) ? ix->cx.topic : ix->cx.op;
+}
+
+static int same_node(const cat_index_t *ix, size_t a, size_t b, int level)
+{
+  for (int l = YAI_CAT_EP; l <= level; l++) {
+    if (level_offsets(ix, l)[a] != level_offsets(ix, l)[b]) return 0;
+  }
+  return 1;
+}
+
+/* Item stored under hash whose key matches, or UINT32_MAX. */
+#define TABLE_FIND(t, h, item, match)                                        \
+  do {                                                                       \
+    for (uint32_t i_ = (h) & (t)->mask; (t)->slots[i_].ref; i_ = (i_ + 1) & (t)->mask) { \
+      if ((t)->slots[i_].hash != (h)) continue;                              \
+      (item) = (t)->slots[i_].ref - 1;                                       \
+      if (match) break;                                                      \
+      (item) = UINT32_MAX;                                                   \
+    }                                                                        \
+  } while (0)
+
+void yai_catalog_index_free(yai_sdk_command_catalog_t *cat)
+{
+  cat_index_t *ix = cat ? cat->index : NULL;
+  if (!ix) return;
+  yai_cat_compact_free(&ix->cx);
+  yai_cat_table_free(&ix->by_id);
+  yai_cat_table_free(&ix->by_canonical);
+  yai_cat_table_free(&ix->by_group);
+  yai_cat_table_free(&ix->by_name);
+  for (int l = 0; l < YAI_CAT_LEVELS; l++) free(ix->nodes[l]);
+  yai_cat_table_free(&ix->by_alias);
+  free(ix->aliases);
+  free(ix->bits);
+  free(ix->canonical_next);
+  free(ix->group_first);
+  free(ix->pos_flat);
+  free(ix->flat_pos);
+  free(ix->rows);
+  free(ix);
+  cat->index = NULL;
+}
+
+/* by_name item is a command of group g named name. */
+static int name_match(const cat_index_t *ix, size_t g, uint32_t item, const char *name)
+{
+  if (item < ix->group_first[g] || item >= ix->group_first[g + 1]) return 0;
+  return strcmp(CX_STR(ix, name, ix->flat_pos[item]), name) == 0;
+}
+
+/* The group of flat command item. */
+static size_t flat_group(const yai_sdk_command_catalog_t *cat, uint32_t item)
+{
+  const cat_index_t *ix = cat->index;
+  size_t lo = 0, hi = cat->group_count;
+  while (hi - lo > 1) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (ix->group_first[mid] <= item) {
+      lo = mid;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+static const yai_sdk_command_ref_t *flat_ref(const yai_sdk_command_catalog_t *cat, uint32_t item)
+{
+  size_t g = flat_group(cat, item);
+  if (yai_catalog_group_refs(cat, g) != 0) return NULL;
+  return &cat->groups[g].commands[item - cat->index->group_first[g]];
+}
+
+static int build_trie(yai_sdk_command_catalog_t *cat)
+{
+  cat_index_t *ix = cat->index;
+  size_t n = cat->command_count;
+
+  ix->nodes[YAI_CAT_ROOT] = (yai_cat_node_t *)calloc(1, sizeof(yai_cat_node_t));
+  if (!ix->nodes[YAI_CAT_ROOT]) return -1;
+  ix->nodes[YAI_CAT_ROOT]->end = (uint32_t)n;
+  ix->node_count[YAI_CAT_ROOT] = 1;
+
+  for (int l = YAI_CAT_EP; l < YAI_CAT_LEVELS; l++) {
+    yai_cat_node_t *nodes = (yai_cat_node_t *)calloc(n ? n : 1, sizeof(yai_cat_node_t));
+    uint32_t count = 0;
+
+    if (!nodes) return -1;
+    ix->nodes[l] = nodes;
+    for (size_t k = 0; k < n; k++) {
+      if (count > 0 && same_node(ix, nodes[count - 1].begin, k, l)) {
+        nodes[count - 1].end = (uint32_t)k + 1;
+        continue;
+      }
+      nodes[count].begin = (uint32_t)k;
+      nodes[count].end = (uint32_t)k + 1;
+      count++;
+    }
+    ix->node_count[l] = count;
+  }
+
+  /* a level's nodes split its parents' runs in order */
+  for (int l = YAI_CAT_ROOT; l + 1 < YAI_CAT_LEVELS; l++) {
+    uint32_t j = 0;
+    for (uint32_t i = 0; i < ix->node_count[l]; i++) {
+      yai_cat_node_t *node = &ix->nodes[l][i];
+      node->child_first = j;
+      while (j < ix->node_count[l + 1] && ix->nodes[l + 1][j].begin < node->end) j++;
+      node->child_end = j;
+    }
+  }
+  return 0;
+}
+
+/* The aliases of commands_sorted[k]: its ref's, or its registry row's
+   (the same array) on a compact catalog. */
+static const char **aliases_of(const yai_sdk_command_catalog_t *cat, size_t k, size_t *len)
+{
+  const cat_index_t *ix = cat->index;
+  if (ix->reg) {
+    const yai_law_command_t *c = &ix->reg->commands[ix->rows[ix->pos_flat[k]]];
+    *len = c->aliases_len;
+    return c->aliases;
+  }
+  *len = cat->commands_sorted[k]->aliases_len;
+  return cat->commands_sorted[k]->aliases;
+}
+
+static int build_aliases(yai_sdk_command_catalog_t *cat)
+{
+  cat_index_t *ix = cat->index;
+  size_t total = 0;
+  uint32_t count = 0;
+
+  for (size_t k = 0; k < cat->command_count; k++) {
+    size_t len;
+    (void)aliases_of(cat, k, &len);
+    total += len;
+  }
+  if (total >= UINT32_MAX) return -1;
+  ix->aliases = (cat_alias_t *)malloc((total ? total : 1) * sizeof(cat_alias_t));
+  if (!ix->aliases || yai_cat_table_init(&ix->by_alias, total) != 0) return -1;
+
+  for (size_t k = 0; k < cat->command_count; k++) {
+    size_t len;
+    const char **aliases = aliases_of(cat, k, &len);
+    for (size_t j = 0; j < len; j++) {
+      const char *alias = aliases[j];
+      uint32_t item = UINT32_MAX;
+      uint32_t h;
+
+      if (!alias || !alias[0]) continue;
+      h = hash1(alias);
+      TABLE_FIND(&ix->by_alias, h, item, strcmp(ix->aliases[item].alias, alias) == 0);
+      if (item == UINT32_MAX) {
+        ix->aliases[count].alias = alias;
+        ix->aliases[count].first = (uint32_t)k;
+        ix->aliases[count].ambiguous = 0;
+        yai_cat_table_put(&ix->by_alias, h, count++);
+      } else if (ix->cx.id[ix->aliases[item].first] != ix->cx.id[k]) {
+        ix->aliases[item].ambiguous = 1;
+      }
+    }
+  }
+  return 0;
+}
+
+static void set_bit(cat_index_t *ix, int set, size_t k)
+{
+  ix->bits[(size_t)set * ix->words + k / 64] |= 1ull << (k % 64);
+}
+
+static int build_bitsets(yai_sdk_command_catalog_t *cat)
+{
+  cat_index_t *ix = cat->index;
+
+  /* whole blocks, so a query never reads past a set */
+  ix->words = (cat->command_count + 63) / 64;
+  ix->words = ((ix->words + QUERY_BLOCK - 1) / QUERY_BLOCK) * QUERY_BLOCK;
+  if (ix->words == 0) ix->words = QUERY_BLOCK;
+  ix->bits = (uint64_t *)calloc(SET_COUNT * ix->words, sizeof(uint64_t));
+  if (!ix->bits) return -1;
+
+  for (size_t k = 0; k < cat->command_count; k++) {
+    for (int b = 0; b < SET_STABILITY - SET_SURFACE; b++) {
+      if (ix->cx.surface_class[k] == (1u << b)) set_bit(ix, SET_SURFACE + b, k);
+    }
+    for (int b = 0; b < SET_HIDDEN - SET_STABILITY; b++) {
+      if (ix->cx.stability_class[k] == (1u << b)) set_bit(ix, SET_STABILITY + b, k);
+    }
+    if (ix->cx.flags[k] & YAI_CAT_FLAG_HIDDEN) set_bit(ix, SET_HIDDEN, k);
+    if (ix->cx.flags[k] & YAI_CAT_FLAG_DEPRECATED) set_bit(ix, SET_DEPRECATED, k);
+  }
+  return 0;
+}
+
+static int build_by_group(yai_sdk_command_catalog_t *cat)
+{
+  cat_index_t *ix = cat->index;
+  if (yai_cat_table_init(&ix->by_group, cat->group_count) != 0) return -1;
+  for (size_t g = 0; g < cat->group_count; g++) {
+    yai_cat_table_put(&ix->by_group, hash1(cat->groups[g].group), (uint32_t)g);
+  }
+  return 0;
+}
+
+/* Everything but the compact copy, by_group and the flat numbering. */
+static int build_tables(yai_sdk_command_catalog_t *cat)
+{
+  cat_index_t *ix = cat->index;
+  size_t n = cat->command_count;
+  uint32_t *tail;
+
+  ix->canonical_next = (uint32_t *)malloc((n ? n : 1) * sizeof(uint32_t));
+  /* last position of each canonical_path chain, by its head */
+  tail = (uint32_t *)malloc((n ? n : 1) * sizeof(uint32_t));
+  if (!tail || !ix->canonical_next || yai_cat_table_init(&ix->by_id, n) != 0 ||
+      yai_cat_table_init(&ix->by_canonical, n) != 0 || yai_cat_table_init(&ix->by_name, n) != 0) {
+    free(tail);
+    return -1;
+  }
+
+  /* in scan order, so the first command of each key is the one kept */
+  for (size_t k = 0; k < n; k++) {
+    uint32_t h = hash1(CX_STR(ix, id, k));
+    uint32_t item = UINT32_MAX;
+
+    /* interned: equal keys are equal offsets */
+    TABLE_FIND(&ix->by_id, h, item, ix->cx.id[item] == ix->cx.id[k]);
+    if (item == UINT32_MAX) yai_cat_table_put(&ix->by_id, h, (uint32_t)k);
+
+    ix->canonical_next[k] = UINT32_MAX;
+    h = hash1(CX_STR(ix, canonical_path, k));
+    item = UINT32_MAX;
+    TABLE_FIND(&ix->by_canonical, h, item, ix->cx.canonical_path[item] == ix->cx.canonical_path[k]);
+    if (item == UINT32_MAX) {
+      yai_cat_table_put(&ix->by_canonical, h, (uint32_t)k);
+      tail[k] = (uint32_t)k;
+    } else {
+      ix->canonical_next[tail[item]] = (uint32_t)k;
+      tail[item] = (uint32_t)k;
+    }
+  }
+  free(tail);
+
+  for (size_t g = 0; g < cat->group_count; g++) {
+    for (uint32_t flat = ix->group_first[g]; flat < ix->group_first[g + 1]; flat++) {
+      const char *name = CX_STR(ix, name, ix->flat_pos[flat]);
+      uint32_t h = hash2(cat->groups[g].group, name);
+      uint32_t item = UINT32_MAX;
+      TABLE_FIND(&ix->by_name, h, item, name_match(ix, g, item, name));
+      if (item == UINT32_MAX) yai_cat_table_put(&ix->by_name, h, flat);
+    }
+  }
+
+  if (build_trie(cat) != 0 || build_aliases(cat) != 0 || build_bitsets(cat) != 0) return -1;
+  return 0;
+}
+
+static const yai_sdk_command_ref_t *sorted_ref(void *ctx, size_t k, yai_sdk_command_ref_t *scratch)
+{
+  (void)scratch;
+  return ((const yai_sdk_command_catalog_t *)ctx)->commands_sorted[k];
+}
+
+int yai_catalog_index_build(yai_sdk_command_catalog_t *cat)
+{
+  cat_index_t *ix;
+  size_t n;
+  size_t flat = 0;
+  size_t mapped = SIZE_MAX;
+
+  if (!cat) return -1;
+  n = cat->command_count;
+  if (n >= UINT32_MAX || cat->group_count >= UINT32_MAX) return -1;
+  ix = (cat_index_t *)calloc(1, sizeof(*ix));
+  if (!ix) return -1;
+  cat->index = ix;
+
+  ix->group_first = (uint32_t *)malloc((cat->group_count + 1) * sizeof(uint32_t));
+  ix->pos_flat = (uint32_t *)malloc((n ? n : 1) * sizeof(uint32_t));
+  ix->flat_pos = (uint32_t *)malloc((n ? n : 1) * sizeof(uint32_t));
+  if (!ix->group_first || !ix->pos_flat || !ix->flat_pos || yai_cat_compact_build(&ix->cx, n, sorted_ref, cat) != 0 ||
+      build_by_group(cat) != 0) {
+    yai_catalog_index_free(cat);
+    return -1;
+  }
+
+  for (size_t g = 0; g < cat->group_count; g++) {
+    ix->group_first[g] = (uint32_t)flat;
+    flat += cat->groups[g].command_count;
+  }
+  ix->group_first[cat->group_count] = (uint32_t)flat;
+  /* each sorted ref points into its group's array */
+  if (flat == n && (n == 0 || cat->commands_sorted)) {
+    for (mapped = 0; mapped < n; mapped++) {
+      const yai_sdk_command_ref_t *c = cat->commands_sorted[mapped];
+      const yai_sdk_command_group_t *g = NULL;
+
+      yai_catalog_index_group(cat, c->group, &g);
+      if (!g || c < g->commands || c >= g->commands + g->command_count) break;
+      ix->pos_flat[mapped] = ix->group_first[g - cat->groups] + (uint32_t)(c - g->commands);
+      ix->flat_pos[ix->pos_flat[mapped]] = (uint32_t)mapped;
+    }
+  }
+  if (mapped != n || build_tables(cat) != 0) {
+    yai_catalog_index_free(cat);
+    return -1;
+  }
+  return 0;
+}
+
+typedef struct row_src {
+  const yai_law_registry_t *reg;
+  const uint32_t *rows;
+} row_src_t;
+
+static const yai_sdk_command_ref_t *row_ref(void *ctx, size_t k, yai_sdk_command_ref_t *scratch)
+{
+  const row_src_t *src = (const row_src_t *)ctx;
+  memset(scratch, 0, sizeof(*scratch));
+  yai_catalog_ref_fill(scratch, &src->reg->commands[src->rows[k]]);
+  return scratch;
+}
+
+/* Sort key of command k: up to five strings, then k. */
+typedef struct cat_key {
+  const char *part[5];
+  uint32_t k;
+} cat_key_t;
+
+static int cmp_key(const void *a, const void *b)
+{
+  const cat_key_t *ka = (const cat_key_t *)a;
+  const cat_key_t *kb = (const cat_key_t *)b;
+  for (int i = 0; i < 5; i++) {
+    int d = strcmp(ka->part[i], kb->part[i]);
+    if (d != 0) return d;
+  }
+  return (ka->k > kb->k) - (ka->k < kb->k);
+}
+
+int yai_catalog_index_build_compact(yai_sdk_command_catalog_t *cat, const yai_law_registry_t *reg,
+                                    const uint32_t *rows, size_t n)
+{
+  row_src_t src = {reg, rows};
+  cat_index_t *ix;
+  cat_key_t *keys;
+  uint32_t *from;
+  size_t groups = 0;
+
+  if (!cat || n == 0 || n >= UINT32_MAX) return -1;
+  ix = (cat_index_t *)calloc(1, sizeof(*ix));
+  if (!ix) return -1;
+  cat->index = ix;
+  cat->command_count = n;
+  ix->reg = reg;
+
+  keys = (cat_key_t *)malloc(n * sizeof(*keys));
+  from = (uint32_t *)malloc(n * sizeof(uint32_t));
+  ix->pos_flat = (uint32_t *)malloc(n * sizeof(uint32_t));
+  ix->flat_pos = (uint32_t *)malloc(n * sizeof(uint32_t));
+  ix->rows = (uint32_t *)malloc(n * sizeof(uint32_t));
+  if (!keys || !from || !ix->pos_flat || !ix->flat_pos || !ix->rows ||
+      yai_cat_compact_build(&ix->cx, n, row_ref, &src) != 0) {
+    free(keys);
+    free(from);
+    yai_catalog_index_free(cat);
+    return -1;
+  }
+
+  /* commands_sorted order, as load sorts the refs */
+  for (size_t k = 0; k < n; k++) {
+    cat_key_t key = {{CX_STR(ix, entrypoint, k), CX_STR(ix, topic, k), CX_STR(ix, op, k),
+                      CX_STR(ix, canonical_path, k), CX_STR(ix, id, k)}, (uint32_t)k};
+    keys[k] = key;
+  }
+  qsort(keys, n, sizeof(keys[0]), cmp_key);
+  for (size_t k = 0; k < n; k++) from[k] = keys[k].k;
+  if (yai_cat_compact_permute(&ix->cx, from) != 0) {
+    free(keys);
+    free(from);
+    yai_catalog_index_free(cat);
+    return -1;
+  }
+
+  /* group order: groups by name, their commands by name */
+  for (size_t k = 0; k < n; k++) {
+    cat_key_t key = {{CX_STR(ix, group, k), CX_STR(ix, name, k), "", "", ""}, (uint32_t)k};
+    keys[k] = key;
+  }
+  qsort(keys, n, sizeof(keys[0]), cmp_key);
+  for (size_t f = 0; f < n; f++) {
+    /* interned: a new group is a new pool string */
+    if (f == 0 || keys[f].part[0] != keys[f - 1].part[0]) groups++;
+  }
+  cat->groups = (yai_sdk_command_group_t *)calloc(groups, sizeof(*cat->groups));
+  ix->group_first = (uint32_t *)malloc((groups + 1) * sizeof(uint32_t));
+  if (!cat->groups || !ix->group_first) {
+    free(keys);
+    free(from);
+    yai_catalog_index_free(cat);
+    return -1;
+  }
+  cat->group_count = groups;
+  groups = 0;
+  for (size_t f = 0; f < n; f++) {
+    uint32_t pos = keys[f].k;
+    if (f == 0 || keys[f].part[0] != keys[f - 1].part[0]) {
+      yai_sdk_command_group_t *g = &cat->groups[groups];
+      snprintf(g->group, sizeof(g->group), "%s", keys[f].part[0]);
+      ix->group_first[groups++] = (uint32_t)f;
+    }
+    cat->groups[groups - 1].command_count++;
+    ix->flat_pos[f] = pos;
+    ix->pos_flat[pos] = (uint32_t)f;
+    ix->rows[f] = rows[from[pos]];
+  }
+  ix->group_first[groups] = (uint32_t)n;
+  free(keys);
+  free(from);
+
+  if (build_by_group(cat) != 0 || build_tables(cat) != 0) {
+    yai_catalog_index_free(cat);
+    return -1;
+  }
+  return 0;
+}
+
+/* ============================================================
+   REFS
+   ============================================================ */
+
+const yai_sdk_command_ref_t *yai_catalog_command_at(const yai_sdk_command_catalog_t *cat, size_t pos)
+{
+  if (cat->commands_sorted) return cat->commands_sorted[pos];
+  return flat_ref(cat, cat->index->pos_flat[pos]);
+}
+
+int yai_catalog_group_refs(const yai_sdk_command_catalog_t *cat, size_t g)
+{
+  yai_sdk_command_group_t *grp = &cat->groups[g];
+  const cat_index_t *ix = cat->index;
+  yai_sdk_command_ref_t *refs;
+  yai_sdk_command_ref_t *none = NULL;
+
+  /* commands is a plain public field: published with the builtins,
+     read by lookups that race to fill it in */
+  if (grp->command_count == 0 || __atomic_load_n(&grp->commands, __ATOMIC_ACQUIRE)) return 0;
+  if (!ix || !ix->reg) return -1;
+  refs = (yai_sdk_command_ref_t *)calloc(grp->command_count, sizeof(*refs));
+  if (!refs) return -1;
+  for (size_t j = 0; j < grp->command_count; j++) {
+    yai_catalog_ref_fill(&refs[j], &ix->reg->commands[ix->rows[ix->group_first[g] + j]]);
+  }
+  /* another thread filled it in first: keep theirs */
+  if (!__atomic_compare_exchange_n(&grp->commands, &none, refs, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) free(refs);
+  return 0;
+}
+
+/* ============================================================
+   LOOKUPS
+   ============================================================ */
+
+int yai_catalog_index_group(const yai_sdk_command_catalog_t *cat, const char *group,
+                            const yai_sdk_command_group_t **out)
+{
+  const cat_index_t *ix = cat->index;
+  uint32_t item = UINT32_MAX;
+  uint32_t h;
+
+  if (!ix) return 0;
+  h = hash1(group);
+  TABLE_FIND(&ix->by_group, h, item, strcmp(cat->groups[item].group, group) == 0);
+  *out = (item != UINT32_MAX) ? &cat->groups[item] : NULL;
+  return 1;
+}
+
+int yai_catalog_index_command(const yai_sdk_command_catalog_t *cat, const char *group, const char *name,
+                              const yai_sdk_command_ref_t **out)
+{
+  const yai_sdk_command_group_t *g = NULL;
+  const cat_index_t *ix = cat->index;
+  uint32_t item = UINT32_MAX;
+  uint32_t h;
+  size_t gi;
+
+  if (!ix) return 0;
+  *out = NULL;
+  yai_catalog_index_group(cat, group, &g);
+  if (!g) return 1;
+  gi = (size_t)(g - cat->groups);
+  h = hash2(group, name);
+  TABLE_FIND(&ix->by_name, h, item, name_match(ix, gi, item, name));
+  if (item != UINT32_MAX) *out = flat_ref(cat, item);
+  return 1;
+}
+
+int yai_catalog_index_id(const yai_sdk_command_catalog_t *cat, const char *id, const yai_sdk_command_ref_t **out)
+{
+  const cat_index_t *ix = cat->index;
+  uint32_t item = UINT32_MAX;
+  uint32_t h;
+
+  if (!ix) return 0;
+  h = hash1(id);
+  TABLE_FIND(&ix->by_id, h, item, strcmp(CX_STR(ix, id, item), id) == 0);
+  *out = (item != UINT32_MAX) ? yai_catalog_command_at(cat, item) : NULL;
+  return 1;
+}
+
+int yai_catalog_index_canonical(const yai_sdk_command_catalog_t *cat, const char *canonical_path, size_t *first)
+{
+  const cat_index_t *ix = cat->index;
+  uint32_t item = UINT32_MAX;
+  uint32_t h;
+
+  if (!ix) return 0;
+  h = hash1(canonical_path);
+  TABLE_FIND(&ix->by_canonical, h, item, strcmp(CX_STR(ix, canonical_path, item), canonical_path) == 0);
+  *first = (item != UINT32_MAX) ? (size_t)item : SIZE_MAX;
+  return 1;
+}
+
+int yai_catalog_index_alias(const yai_sdk_command_catalog_t *cat, const char *alias,
+                            const yai_sdk_command_ref_t **out, int *ambiguous)
+{
+  const cat_index_t *ix = cat->index;
+  uint32_t item = UINT32_MAX;
+  uint32_t h;
+
+  if (!ix) return 0;
+  *out = NULL;
+  *ambiguous = 0;
+  h = hash1(alias);
+  TABLE_FIND(&ix->by_alias, h, item, strcmp(ix->aliases[item].alias, alias) == 0);
+  if (item == UINT32_MAX) return 1;
+  if (ix->aliases[item].ambiguous) {
+    *ambiguous = 1;
+  } else {
+    *out = yai_catalog_command_at(cat, ix->aliases[item].first);
+  }
+  return 1;
+}
+
+size_t yai_catalog_index_canonical_next(const yai_sdk_command_catalog_t *cat, size_t pos)
+{
+  uint32_t next = cat->index->canonical_next[pos];
+  return (next != UINT32_MAX) ? (size_t)next : SIZE_MAX;
+}
+
+size_t yai_catalog_index_query(const yai_sdk_command_catalog_t *cat,
+                               const yai_sdk_catalog_filter_t *filter,
+                               const yai_sdk_command_ref_t **out,
+                               size_t out_cap)
+{
+  const cat_index_t *ix = cat->index;
+  const uint64_t *any_of[2][4]; /* surface, stability: the sets a command may be in */
+  size_t any_len[2] = {0, 0};
+  const char *ep = (filter->entrypoint && filter->entrypoint[0]) ? filter->entrypoint : NULL;
+  const char *topic = (filter->topic && filter->topic[0]) ? filter->topic : NULL;
+  uint32_t topic_off = UINT32_MAX; /* a topic without an entrypoint: no single node */
+  size_t begin;
+  size_t end;
+  size_t n = 0;
+
+  yai_catalog_index_run(cat, ep, ep ? topic : NULL, NULL, &begin, &end);
+  if (topic && !ep) {
+    topic_off = yai_cat_compact_find(&ix->cx, topic);
+    if (topic_off == UINT32_MAX) return 0;
+  }
+  if (begin >= end) return 0;
+  for (int b = 0; b < SET_STABILITY - SET_SURFACE; b++) {
+    if (filter->surface_mask & (1 << b)) any_of[0][any_len[0]++] = ix->bits + (SET_SURFACE + b) * ix->words;
+  }
+  for (int b = 0; b < SET_HIDDEN - SET_STABILITY; b++) {
+    if (filter->stability_mask & (1 << b)) any_of[1][any_len[1]++] = ix->bits + (SET_STABILITY + b) * ix->words;
+  }
+  if (any_len[0] == 0 || any_len[1] == 0) return 0;
+
+  for (size_t w0 = begin / 64 / QUERY_BLOCK * QUERY_BLOCK; w0 * 64 < end; w0 += QUERY_BLOCK) {
+    uint64_t acc[QUERY_BLOCK];
+    uint64_t alt[QUERY_BLOCK];
+
+    for (int i = 0; i < QUERY_BLOCK; i++) acc[i] = any_of[0][0][w0 + i];
+    for (size_t s = 1; s < any_len[0]; s++) {
+      for (int i = 0; i < QUERY_BLOCK; i++) acc[i] |= any_of[0][s][w0 + i];
+    }
+    for (int i = 0; i < QUERY_BLOCK; i++) alt[i] = any_of[1][0][w0 + i];
+    for (size_t s = 1; s < any_len[1]; s++) {
+      for (int i = 0; i < QUERY_BLOCK; i++) alt[i] |= any_of[1][s][w0 + i];
+    }
+    for (int i = 0; i < QUERY_BLOCK; i++) acc[i] &= alt[i];
+    if (!filter->include_hidden) {
+      const uint64_t *hidden = ix->bits + SET_HIDDEN * ix->words + w0;
+      for (int i = 0; i < QUERY_BLOCK; i++) acc[i] &= ~hidden[i];
+    }
+    if (!filter->include_deprecated) {
+      const uint64_t *deprecated = ix->bits + SET_DEPRECATED * ix->words + w0;
+      for (int i = 0; i < QUERY_BLOCK; i++) acc[i] &= ~deprecated[i];
+    }
+
+    for (int i = 0; i < QUERY_BLOCK; i++) {
+      size_t base = (w0 + i) * 64;
+      uint64_t word = acc[i];
+      if (base + 64 <= begin || base >= end) continue;
+      if (base < begin) word &= ~0ull << (begin - base);
+      if (end - base < 64) word &= (1ull << (end - base)) - 1;
+      if ((!out || n >= out_cap) && topic_off == UINT32_MAX) {
+        n += (size_t)__builtin_popcountll(word);
+        continue;
+      }
+      for (; word; word &= word - 1) {
+        size_t k = base + (size_t)__builtin_ctzll(word);
+        if (topic_off != UINT32_MAX && ix->cx.topic[k] != topic_off) continue;
+        if (out && n < out_cap) out[n] = yai_catalog_command_at(cat, k);
+        n++;
+      }
+    }
+  }
+  return n;
+}
+
+int yai_catalog_index_view(const yai_sdk_command_catalog_t *cat, size_t pos, yai_cat_view_t *out)
+{
+  const cat_index_t *ix = cat->index;
+  if (!ix) return 0;
+  out->entrypoint = CX_STR(ix, entrypoint, pos);
+  out->topic = CX_STR(ix, topic, pos);
+  out->op = CX_STR(ix, op, pos);
+  out->surface = ix->cx.surface_class[pos];
+  out->stability = ix->cx.stability_class[pos];
+  out->hidden = (ix->cx.flags[pos] & YAI_CAT_FLAG_HIDDEN) != 0;
+  out->deprecated = (ix->cx.flags[pos] & YAI_CAT_FLAG_DEPRECATED) != 0;
+  return 1;
+}
+
+size_t yai_catalog_index_bytes(const yai_sdk_command_catalog_t *cat)
+{
+  const cat_index_t *ix = cat ? cat->index : NULL;
+  const yai_cat_table_t *tables[5];
+  size_t bytes;
+
+  if (!ix) return 0;
+  tables[0] = &ix->by_id;
+  tables[1] = &ix->by_canonical;
+  tables[2] = &ix->by_group;
+  tables[3] = &ix->by_name;
+  tables[4] = &ix->by_alias;
+  bytes = sizeof(*ix) + ix->cx.bytes + SET_COUNT * ix->words * sizeof(uint64_t);
+  for (int t = 0; t < 5; t++) bytes += ((size_t)tables[t]->mask + 1) * sizeof(yai_cat_slot_t);
+  for (int l = 0; l < YAI_CAT_LEVELS; l++) bytes += ix->node_count[l] * sizeof(yai_cat_node_t);
+  /* canonical_next, pos_flat, flat_pos and a compact catalog's rows */
+  bytes += (ix->rows ? 4 : 3) * cat->command_count * sizeof(uint32_t) + (cat->group_count + 1) * sizeof(uint32_t);
+  return bytes;
+}
+
+size_t yai_catalog_index_compact_bytes(const yai_sdk_command_catalog_t *cat)
+{
+  return (cat && cat->index) ? cat->index->cx.bytes : 0;
+}
+
+const yai_cat_node_t *yai_catalog_index_node(const yai_sdk_command_catalog_t *cat, int level, size_t node)
+{
+  const cat_index_t *ix = cat->index;
+  if (!ix || level < 0 || level >= YAI_CAT_LEVELS || node >= ix->node_count[level]) return NULL;
+  return &ix->nodes[level][node];
+}
+
+static const char *node_token(const yai_sdk_command_catalog_t *cat, int level, uint32_t node)
+{
+  const cat_index_t *ix = cat->index;
+  return yai_cat_compact_str(&ix->cx, level_offsets(ix, level)[ix->nodes[level][node].begin]);
+}
+
+size_t yai_catalog_index_child(const yai_sdk_command_catalog_t *cat, int level, size_t node, const char *token)
+{
+  const yai_cat_node_t *parent = yai_catalog_index_node(cat, level, node);
+  uint32_t lo, hi;
+
+  if (!parent || level + 1 >= YAI_CAT_LEVELS) return SIZE_MAX;
+  lo = parent->child_first;
+  hi = parent->child_end;
+  while (lo < hi) {
+    uint32_t mid = lo + (hi - lo) / 2;
+    int d = strcmp(node_token(cat, level + 1, mid), token);
+    if (d == 0) return mid;
+    if (d < 0) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return SIZE_MAX;
+}
+
+/* First child in [lo, hi) whose token's prefix compares above (or, with
+   or_equal, at or above) prefix. */
+static uint32_t prefix_bound(const yai_sdk_command_catalog_t *cat, int level, uint32_t lo, uint32_t hi,
+                             const char *prefix, size_t len, int or_equal)
+{
+  while (lo < hi) {
+    uint32_t mid = lo + (hi - lo) / 2;
+    int d = strncmp(node_token(cat, level, mid), prefix, len);
+    if (d > 0 || (or_equal && d == 0)) {
+      hi = mid;
+    } else {
+      lo = mid + 1;
+    }
+  }
+  return lo;
+}
+
+void yai_catalog_index_children(const yai_sdk_command_catalog_t *cat, int level, size_t node, const char *prefix,
+                                size_t *lo, size_t *hi)
+{
+  const yai_cat_node_t *parent = yai_catalog_index_node(cat, level, node);
+  size_t len = prefix ? strlen(prefix) : 0;
+  uint32_t first;
+
+  *lo = *hi = 0;
+  if (!parent || level + 1 >= YAI_CAT_LEVELS) return;
+  first = prefix_bound(cat, level + 1, parent->child_first, parent->child_end, prefix, len, 1);
+  *lo = first;
+  *hi = prefix_bound(cat, level + 1, first, parent->child_end, prefix, len, 0);
+}
+
+const char *yai_catalog_index_token(const yai_sdk_command_catalog_t *cat, int level, size_t node)
+{
+  if (!yai_catalog_index_node(cat, level, node) || level == YAI_CAT_ROOT) return NULL;
+  return node_token(cat, level, (uint32_t)node);
+}
+
+void yai_catalog_index_run(const yai_sdk_command_catalog_t *cat,
+                           const char *entrypoint,
+                           const char *topic,
+                           const char *op,
+                           size_t *begin,
+                           size_t *end)
+{
+  const char *path[3] = {entrypoint, topic, op};
+  const yai_cat_node_t *node;
+  size_t at = 0;
+  int level = YAI_CAT_ROOT;
+
+  *begin = 0;
+  *end = cat->command_count;
+  if (!cat->index) return;
+  for (; level < YAI_CAT_OP && path[level]; level++) {
+    at = yai_catalog_index_child(cat, level, at, path[level]);
+    if (at == SIZE_MAX) {
+      *end = 0;
+      return;
+    }
+  }
+  node = yai_catalog_index_node(cat, level, at);
+  *begin = node->begin;
+  *end = node->end;
+}
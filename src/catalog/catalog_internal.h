@@ -0,0 +1,224 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+#pragma once
+
+#include <yai_sdk/catalog.h>
+#include <yai_sdk/registry/registry_types.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Open-addressing hash table with linear probing. A slot is 8 bytes, so
+ * a probe sequence usually stays within one cache line; the stored hash
+ * is compared before any key string is touched.
+ */
+typedef struct yai_cat_slot {
+  uint32_t hash;
+  uint32_t ref; /* item + 1; 0 marks an empty slot */
+} yai_cat_slot_t;
+
+typedef struct yai_cat_table {
+  yai_cat_slot_t *slots;
+  uint32_t mask;
+} yai_cat_table_t;
+
+#define YAI_CAT_HASH_INIT 0xcbf29ce484222325ull
+
+/* Folds s into a running key hash; parts are separated, so ("ab","c") != ("a","bc"). */
+static inline uint64_t yai_cat_hash_part(uint64_t h, const char *s)
+{
+  for (; *s; s++) h = (h ^ (uint8_t)*s) * 0x100000001b3ull;
+  return (h ^ 0x1fu) * 0x100000001b3ull;
+}
+
+/* Final mix to the stored 32-bit hash. */
+static inline uint32_t yai_cat_hash_end(uint64_t h)
+{
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdull;
+  h ^= h >> 33;
+  return (uint32_t)h;
+}
+
+/* Room for `keys` keys at a load factor of at most 1/2; 0 or -1. */
+int yai_cat_table_init(yai_cat_table_t *t, size_t keys);
+void yai_cat_table_free(yai_cat_table_t *t);
+/* Appends item under hash; callers check for an existing key first. */
+void yai_cat_table_put(yai_cat_table_t *t, uint32_t hash, uint32_t item);
+
+/*
+ * Builds cat from reg (what yai_sdk_command_catalog_load does with the
+ * process registry), lookup indexes included.
+ */
+int yai_catalog_load_from(yai_sdk_command_catalog_t *out, const yai_law_registry_t *reg);
+/*
+ * The same catalog without its refs (yai_sdk_command_catalog_load_compact):
+ * no commands_sorted, and groups whose commands are NULL until
+ * yai_catalog_group_refs fills them in from reg, which must outlive cat.
+ */
+int yai_catalog_load_compact_from(yai_sdk_command_catalog_t *out, const yai_law_registry_t *reg);
+
+/* A command's ref as the catalog hands it out: defaults applied, strings
+   truncated to the ref's fields. */
+void yai_catalog_ref_fill(yai_sdk_command_ref_t *ref, const yai_law_command_t *c);
+
+int yai_catalog_index_build(yai_sdk_command_catalog_t *cat);
+/* Index and groups of a compact catalog over the registry rows
+   reg->commands[rows[0..n)], in any order. */
+int yai_catalog_index_build_compact(yai_sdk_command_catalog_t *cat, const yai_law_registry_t *reg,
+                                    const uint32_t *rows, size_t n);
+void yai_catalog_index_free(yai_sdk_command_catalog_t *cat);
+
+/*
+ * The ref of the command at pos in commands_sorted order. A compact
+ * catalog fills in the ref's whole group on first use, once, whichever
+ * thread gets there; NULL when that allocation fails.
+ */
+const yai_sdk_command_ref_t *yai_catalog_command_at(const yai_sdk_command_catalog_t *cat, size_t pos);
+/* Fills in the refs of cat->groups[g] if they are not yet: 0 or -1. */
+int yai_catalog_group_refs(const yai_sdk_command_catalog_t *cat, size_t g);
+
+/*
+ * Indexed lookups: 1 with the answer in *out (NULL when there is none), or
+ * 0 when cat has no index (a catalog not built by load) and the caller
+ * has to scan.
+ */
+int yai_catalog_index_group(const yai_sdk_command_catalog_t *cat, const char *group,
+                            const yai_sdk_command_group_t **out);
+int yai_catalog_index_command(const yai_sdk_command_catalog_t *cat, const char *group, const char *name,
+                              const yai_sdk_command_ref_t **out);
+int yai_catalog_index_id(const yai_sdk_command_catalog_t *cat, const char *id, const yai_sdk_command_ref_t **out);
+/* The command with this alias; NULL with *ambiguous set when commands
+ * with different ids share it. */
+int yai_catalog_index_alias(const yai_sdk_command_catalog_t *cat, const char *alias,
+                            const yai_sdk_command_ref_t **out, int *ambiguous);
+/* Position in commands_sorted of the first command with this
+ * canonical_path (SIZE_MAX for none); canonical_next walks the others in
+ * order, up to SIZE_MAX. */
+int yai_catalog_index_canonical(const yai_sdk_command_catalog_t *cat, const char *canonical_path, size_t *first);
+size_t yai_catalog_index_canonical_next(const yai_sdk_command_catalog_t *cat, size_t pos);
+
+/*
+ * Compact copy of a catalog's commands, in commands_sorted order: string
+ * fields as offsets into a pool of interned strings, attributes as bytes,
+ * all in one allocation of `bytes` (yai_sdk_command_ref_t is ~1 KB of
+ * mostly padding per command). The index keeps one, so its key compares,
+ * trie walks and attribute scans stay within a few dense arrays.
+ */
+#define YAI_CAT_FLAG_HIDDEN 0x1u
+#define YAI_CAT_FLAG_DEPRECATED 0x2u
+
+typedef struct yai_cat_compact {
+  size_t count;
+  size_t bytes;
+  uint32_t *id;
+  uint32_t *name;
+  uint32_t *group;
+  uint32_t *entrypoint;
+  uint32_t *topic;
+  uint32_t *op;
+  uint32_t *canonical_path;
+  unsigned char *surface_class;
+  unsigned char *stability_class;
+  unsigned char *flags; /* YAI_CAT_FLAG_* */
+  yai_cat_table_t strings; /* interned string -> pool offset */
+  char *pool;
+} yai_cat_compact_t;
+
+/* The ref of command k, or one filled into scratch. */
+typedef const yai_sdk_command_ref_t *(*yai_cat_compact_src_fn)(void *ctx, size_t k, yai_sdk_command_ref_t *scratch);
+
+/* Compact copy of the n commands src yields, reading each ref once. */
+int yai_cat_compact_build(yai_cat_compact_t *out, size_t n, yai_cat_compact_src_fn src, void *ctx);
+/* Reorders the commands: the new command k is the old from[k]; 0 or -1. */
+int yai_cat_compact_permute(yai_cat_compact_t *c, const uint32_t *from);
+void yai_cat_compact_free(yai_cat_compact_t *c);
+/* Pool offset of s, or UINT32_MAX when no command has it. */
+uint32_t yai_cat_compact_find(const yai_cat_compact_t *c, const char *s);
+
+static inline const char *yai_cat_compact_str(const yai_cat_compact_t *c, uint32_t off)
+{
+  return c->pool + off;
+}
+
+/* Bytes held by cat's index, the compact copy included (0 without one);
+   the refs of a compact catalog's groups are not counted. */
+size_t yai_catalog_index_bytes(const yai_sdk_command_catalog_t *cat);
+/* Bytes of cat's compact copy alone. */
+size_t yai_catalog_index_compact_bytes(const yai_sdk_command_catalog_t *cat);
+
+/* Class of a surface / stability string: its mask bit, or
+   YAI_CAT_CLASS_UNKNOWN when no mask bit stands for it. */
+#define YAI_CAT_CLASS_UNKNOWN 0x80u
+
+unsigned char yai_cat_surface_class(const char *surface);
+unsigned char yai_cat_stability_class(const char *stability);
+
+/* What filters read of a command: its path tokens and its classes and
+   flags as classified at load. */
+typedef struct yai_cat_view {
+  const char *entrypoint;
+  const char *topic;
+  const char *op;
+  int surface;
+  int stability;
+  int hidden;
+  int deprecated;
+} yai_cat_view_t;
+
+/* View of commands_sorted[pos] from the compact copy, strings in its
+   pool: 1, or 0 when cat has no index and the caller reads the ref. */
+int yai_catalog_index_view(const yai_sdk_command_catalog_t *cat, size_t pos, yai_cat_view_t *out);
+
+/*
+ * Commands passing filter (masks already defaulted: non-zero), in
+ * commands_sorted order: entrypoint and topic narrow to a trie node (a
+ * topic alone is compared by interned offset), the attributes come from
+ * one bitset per value. Returns their count and fills the first out_cap.
+ */
+size_t yai_catalog_index_query(const yai_sdk_command_catalog_t *cat,
+                               const yai_sdk_catalog_filter_t *filter,
+                               const yai_sdk_command_ref_t **out,
+                               size_t out_cap);
+
+/*
+ * Command trie: the root (node 0 of YAI_CAT_ROOT), then entrypoints,
+ * topics and ops. A node is the run of commands_sorted sharing its path;
+ * its children are nodes [child_first, child_end) one level down, in
+ * strcmp order of their tokens.
+ */
+enum { YAI_CAT_ROOT = 0, YAI_CAT_EP, YAI_CAT_TOPIC, YAI_CAT_OP, YAI_CAT_LEVELS };
+
+typedef struct yai_cat_node {
+  uint32_t begin;
+  uint32_t end;
+  uint32_t child_first;
+  uint32_t child_end;
+} yai_cat_node_t;
+
+/* The token a command has at a trie level. */
+static inline const char *yai_cat_level_token(const yai_sdk_command_ref_t *c, int level)
+{
+  return (level == YAI_CAT_EP) ? c->entrypoint : (level == YAI_CAT_TOPIC) ? c->topic : c->op;
+}
+
+/* NULL when cat has no index or there is no such node. */
+const yai_cat_node_t *yai_catalog_index_node(const yai_sdk_command_catalog_t *cat, int level, size_t node);
+/* The child of node named token, or SIZE_MAX. */
+size_t yai_catalog_index_child(const yai_sdk_command_catalog_t *cat, int level, size_t node, const char *token);
+/* The children of node whose token starts with prefix: [*lo, *hi). */
+void yai_catalog_index_children(const yai_sdk_command_catalog_t *cat, int level, size_t node, const char *prefix,
+                                size_t *lo, size_t *hi);
+const char *yai_catalog_index_token(const yai_sdk_command_catalog_t *cat, int level, size_t node);
+
+/*
+ * Commands sharing entrypoint (and topic, and op, when not NULL) are
+ * contiguous in commands_sorted: their run is [*begin, *end), empty when
+ * there is none. Without an index the run is the whole catalog.
+ */
+void yai_catalog_index_run(const yai_sdk_command_catalog_t *cat,
+                           const char *entrypoint,
+                           const char *topic,
+                           const char *op,
+                           size_t *begin,
+                           size_t *end);
@@ -1,20 +1,31 @@
 /* SPDX-License-Identifier: Apache-2.0 */
 
+#define _POSIX_C_SOURCE 200809L
+
 #include <yai_sdk/client.h>
 #include <yai_sdk/errors.h>
+#include <yai_sdk/metrics.h>
+#include <yai_sdk/trace.h>
+#include <yai_sdk/registry/registry_registry.h>
 
 #include "client_internal.h"
 #include "../protocol/reply_map.h"
+#include "../protocol/binary_codec.h"
+#include "../protocol/reply_scan.h"
 #include "../platform/log_internal.h"
+#include "../platform/trace_internal.h"
 
 #include <cJSON.h>
 #include <yai_protocol_ids.h>
 
+#include <errno.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <time.h>
 
-static const char *summary_for_code(const char *code)
+const char *yai_client_summary_for_code(const char *code)
 {
     if (!code || !code[0]) return "Command failed.";
     if (strcmp(code, "OK") == 0) return "Command completed.";
@@ -22,11 +33,13 @@ static const char *summary_for_code(const char *code)
     if (strcmp(code, "BAD_ARGS") == 0) return "Invalid command arguments.";
     if (strcmp(code, "SERVER_UNAVAILABLE") == 0) return "Runtime endpoint is unreachable.";
     if (strcmp(code, "RUNTIME_NOT_READY") == 0) return "Runtime handshake is not ready.";
+    if (strcmp(code, "TIMEOUT") == 0) return "Runtime did not answer within the deadline.";
+    if (strcmp(code, "NOT_SENT") == 0) return "Not sent: an earlier batch item failed.";
     if (strcmp(code, "UNAUTHORIZED") == 0 || strcmp(code, "DENIED") == 0) return "Operation denied by authority policy.";
     return "Command failed.";
 }
 
-static void reply_zero(yai_sdk_reply_t *r)
+void yai_client_reply_zero(yai_sdk_reply_t *r)
 {
     if (!r) {
         return;
@@ -56,7 +69,7 @@ static void reply_set(yai_sdk_reply_t *r,
     snprintf(r->code, sizeof(r->code), "%s", (code && code[0]) ? code : "INTERNAL_ERROR");
     snprintf(r->reason, sizeof(r->reason), "%s", (reason && reason[0]) ? reason : "internal_error");
     snprintf(r->summary, sizeof(r->summary), "%s",
-             (summary && summary[0]) ? summary : summary_for_code(code));
+             (summary && summary[0]) ? summary : yai_client_summary_for_code(code));
     r->hint_count = 0;
     r->hints[0][0] = '\0';
     r->hints[1][0] = '\0';
@@ -68,6 +81,23 @@ static void reply_set(yai_sdk_reply_t *r,
              (target_plane && target_plane[0]) ? target_plane : "kernel");
 }
 
+/* Reply for a failure that never produced a server reply (connect/timeout/transport). */
+void yai_client_reply_transport_error(yai_sdk_reply_t *r, int rc, const char *command_id, const char *plane)
+{
+    if (rc == YAI_SDK_TIMEOUT) {
+        reply_set(r, "error", "TIMEOUT", "deadline_exceeded",
+                  "Runtime did not answer within the deadline.", command_id, "", plane);
+        return;
+    }
+    if (rc == YAI_SDK_RPC) {
+        reply_set(r, "error", "PROTOCOL_ERROR", "rpc_call_failed",
+                  "RPC request failed.", command_id, "", plane);
+        return;
+    }
+    reply_set(r, "error", "SERVER_UNAVAILABLE", "server_unavailable",
+              "Runtime endpoint is unreachable.", command_id, "", plane);
+}
+
 static char *dup_bytes(const char *s, size_t n)
 {
     char *out = (char *)malloc(n + 1);
@@ -81,8 +111,10 @@ static char *dup_bytes(const char *s, size_t n)
     return out;
 }
 
-static void parse_command_id_from_request(const char *control_call_json, char *out, size_t out_sz)
+void yai_client_request_command_id(const char *control_call_json, char *out, size_t out_sz)
 {
+    yai_jspan_t command_id;
+
     if (!out || out_sz == 0) {
         return;
     }
@@ -91,15 +123,60 @@ static void parse_command_id_from_request(const char *control_call_json, char *o
         return;
     }
 
-    cJSON *req = cJSON_Parse(control_call_json);
-    if (!req) {
-        return;
+    if (yai_jspan_find(control_call_json, strlen(control_call_json), "command_id", &command_id) == 0 &&
+        command_id.kind == YAI_JSPAN_STRING && command_id.len > 0) {
+        yai_jspan_copy(&command_id, out, out_sz);
+    }
+}
+
+/* (Re)connects c->rpc and reapplies authority, correlation and call budget. */
+static int client_connect(yai_sdk_client_t *c)
+{
+    uint64_t t0 = yai_metrics_now_ns();
+    int rc = yai_rpc_connect_timeout(&c->rpc, c->ws_id, c->connect_timeout_ms);
+    yai_client_phase(c, YAI_SDK_PHASE_CONNECT, t0, yai_metrics_now_ns() - t0);
+    if (rc != 0) {
+        if (rc == -15) {
+            YAI_LOG(YAI_SDK_LOG_ERROR, "client", "rpc connect timed out",
+                    YAI_LOG_STR("ws_id", c->ws_id), YAI_LOG_INT("timeout_ms", c->connect_timeout_ms));
+            return YAI_SDK_TIMEOUT;
+        }
+        YAI_LOG(YAI_SDK_LOG_ERROR, "client", "rpc connect failed",
+                YAI_LOG_STR("ws_id", c->ws_id), YAI_LOG_INT("rc", rc));
+        return YAI_SDK_SERVER_OFF;
     }
-    const cJSON *command_id = cJSON_GetObjectItemCaseSensitive(req, "command_id");
-    if (cJSON_IsString(command_id) && command_id->valuestring && command_id->valuestring[0]) {
-        snprintf(out, out_sz, "%s", command_id->valuestring);
+    c->is_open = 1;
+    c->handshaken = 0;
+    c->hs_riding = 0;
+    /* interned command ids live and die with the connection */
+    yai_bin_intern_reset(c->bin_intern);
+    yai_rpc_set_authority(&c->rpc, c->arming, c->role);
+    yai_rpc_set_correlation_id(&c->rpc, c->correlation_id);
+    yai_rpc_set_timeout(&c->rpc, c->call_timeout_ms);
+    yai_rpc_set_handshake_defer(&c->rpc, c->handshake_defer);
+    if (c->binary_codec) {
+        yai_rpc_set_capabilities(&c->rpc, YAI_RPC_CAPS_DEFAULT | YAI_RPC_CAP_BINARY);
     }
-    cJSON_Delete(req);
+    return YAI_SDK_OK;
+}
+
+/* A timed-out call has already closed the socket; the next call reconnects. */
+static void client_mark_timed_out(yai_sdk_client_t *c)
+{
+    yai_rpc_close(&c->rpc);
+    c->is_open = 0;
+    c->handshaken = 0;
+    YAI_LOG(YAI_SDK_LOG_WARN, "client", "deadline exceeded, connection closed",
+            YAI_LOG_STR("ws_id", c->ws_id), YAI_LOG_INT("timeout_ms", c->call_timeout_ms));
+}
+
+/* Distinct per client and per process, so restarted fleets do not retry in step. */
+static uint64_t retry_seed(const yai_sdk_client_t *c)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    uint64_t x = (uint64_t)(uintptr_t)c ^ ((uint64_t)ts.tv_sec << 32) ^ (uint64_t)ts.tv_nsec;
+    return x ? x : 0x9E3779B97F4A7C15ull;
 }
 
 int yai_sdk_client_open(yai_sdk_client_t **out, const yai_sdk_client_opts_t *opts)
@@ -122,16 +199,24 @@ int yai_sdk_client_open(yai_sdk_client_t **out, const yai_sdk_client_opts_t *opt
              (opts && opts->correlation_id && opts->correlation_id[0]) ? opts->correlation_id : "sdk");
     c->arming = (opts) ? (opts->arming ? 1 : 0) : 1;
     c->auto_handshake = (opts) ? (opts->auto_handshake ? 1 : 0) : 1;
+    c->connect_timeout_ms = (opts && opts->connect_timeout_ms > 0) ? opts->connect_timeout_ms : 0;
+    c->handshake_timeout_ms = (opts && opts->handshake_timeout_ms > 0) ? opts->handshake_timeout_ms : 0;
+    c->call_timeout_ms = (opts && opts->call_timeout_ms > 0) ? opts->call_timeout_ms : 0;
+    c->ws_switch_in_place = (opts) ? (opts->ws_switch_in_place ? 1 : 0) : 0;
+    c->binary_codec = (opts) ? (opts->binary_codec ? 1 : 0) : 0;
+    c->handshake_defer = (opts) ? (opts->handshake_defer ? 1 : 0) : 0;
+    c->retry_max = (opts && opts->retry_max > 0) ? opts->retry_max : 0;
+    c->retry_backoff_ms = (opts && opts->retry_backoff_ms > 0) ? opts->retry_backoff_ms : 20;
+    c->retry_backoff_max_ms = (opts && opts->retry_backoff_max_ms > 0) ? opts->retry_backoff_max_ms : 1000;
+    c->retry_jitter = retry_seed(c);
 
-    if (yai_rpc_connect(&c->rpc, c->ws_id) != 0) {
-        yai_sdk_log_emit(YAI_SDK_LOG_ERROR, "client", "rpc connect failed");
+    int rc = client_connect(c);
+    if (rc != YAI_SDK_OK) {
         free(c);
-        return YAI_SDK_SERVER_OFF;
+        return rc;
     }
-    c->is_open = 1;
-    yai_rpc_set_authority(&c->rpc, c->arming, c->role);
-    yai_rpc_set_correlation_id(&c->rpc, c->correlation_id);
-    yai_sdk_log_emit(YAI_SDK_LOG_INFO, "client", "client opened");
+    YAI_LOG(YAI_SDK_LOG_INFO, "client", "client opened",
+            YAI_LOG_STR("ws_id", c->ws_id), YAI_LOG_STR("role", c->role));
     *out = c;
     return YAI_SDK_OK;
 }
@@ -144,6 +229,8 @@ void yai_sdk_client_close(yai_sdk_client_t *c)
     if (c->is_open) {
         yai_rpc_close(&c->rpc);
     }
+    yai_sdk_arena_destroy(c->reply_arena);
+    free(c->bin_intern);
     free(c);
 }
 
@@ -163,18 +250,19 @@ int yai_sdk_client_set_ws(yai_sdk_client_t *c, const char *ws_id)
     if (!c || !ws_id || !ws_id[0]) {
         return YAI_SDK_BAD_ARGS;
     }
+    if (c->ws_switch_in_place && c->is_open) {
+        /* same root socket: only the envelope ws_id changes */
+        if (yai_rpc_set_ws(&c->rpc, ws_id) != 0) {
+            return YAI_SDK_BAD_ARGS;
+        }
+        snprintf(c->ws_id, sizeof(c->ws_id), "%s", ws_id);
+        return YAI_SDK_OK;
+    }
     yai_rpc_close(&c->rpc);
     c->is_open = 0;
     c->handshaken = 0;
     snprintf(c->ws_id, sizeof(c->ws_id), "%s", ws_id);
-    if (yai_rpc_connect(&c->rpc, c->ws_id) != 0) {
-        yai_sdk_log_emit(YAI_SDK_LOG_ERROR, "client", "rpc reconnect failed");
-        return YAI_SDK_SERVER_OFF;
-    }
-    c->is_open = 1;
-    yai_rpc_set_authority(&c->rpc, c->arming, c->role);
-    yai_rpc_set_correlation_id(&c->rpc, c->correlation_id);
-    return YAI_SDK_OK;
+    return client_connect(c);
 }
 
 int yai_sdk_client_set_correlation_id(yai_sdk_client_t *c, const char *correlation_id)
@@ -192,77 +280,361 @@ int yai_sdk_client_handshake(yai_sdk_client_t *c)
     if (!c || !c->is_open) {
         return YAI_SDK_BAD_ARGS;
     }
-    if (yai_rpc_handshake(&c->rpc) != 0) {
+    yai_rpc_set_timeout(&c->rpc, c->handshake_timeout_ms);
+    uint64_t t0 = yai_metrics_now_ns();
+    int rc = yai_rpc_handshake(&c->rpc);
+    yai_client_phase(c, YAI_SDK_PHASE_HANDSHAKE, t0, yai_metrics_now_ns() - t0);
+    if (!c->rpc.hs_deferred) {
+        /* a round trip of its own; a cached one rides on the next call */
+        yai_metrics_bytes(&c->metrics, c->rpc.last_tx_bytes, c->rpc.last_rx_bytes);
+    }
+    yai_rpc_set_timeout(&c->rpc, c->call_timeout_ms);
+    if (rc == -15) {
+        client_mark_timed_out(c);
+        return YAI_SDK_TIMEOUT;
+    }
+    if (rc != 0) {
         c->handshaken = 0;
         return YAI_SDK_RUNTIME_NOT_READY;
     }
-    c->handshaken = 1;
+    /* a deferred handshake only counts once the next call has read its ack */
+    c->hs_riding = c->rpc.hs_deferred;
+    c->handshaken = !c->hs_riding;
     return YAI_SDK_OK;
 }
 
-int yai_sdk_client_call_json(yai_sdk_client_t *c, const char *control_call_json, yai_sdk_reply_t *out)
+uint32_t yai_sdk_client_capabilities(const yai_sdk_client_t *c)
 {
-    char fallback_command_id[128];
-    if (!c || !control_call_json || !control_call_json[0] || !out) {
-        return YAI_SDK_BAD_ARGS;
-    }
+    return (c && c->is_open && c->handshaken) ? c->rpc.caps_granted : 0;
+}
 
-    reply_zero(out);
-    parse_command_id_from_request(control_call_json, fallback_command_id, sizeof(fallback_command_id));
+/* Opens (if a timeout closed it) and handshakes before a call. */
+int yai_client_prepare_call(yai_sdk_client_t *c, yai_sdk_reply_t *out, const char *cid, const char *plane)
+{
+    if (!c->is_open) {
+        int orc = client_connect(c);
+        if (orc != YAI_SDK_OK) {
+            yai_client_reply_transport_error(out, orc, cid, plane);
+            return orc;
+        }
+    }
 
-    if (c->auto_handshake && !c->handshaken) {
+    if (c->auto_handshake && !c->handshaken && !c->hs_riding) {
         int hrc = yai_sdk_client_handshake(c);
+        if (hrc == YAI_SDK_TIMEOUT) {
+            yai_client_reply_transport_error(out, hrc, cid, plane);
+            return hrc;
+        }
         if (hrc != 0) {
-            yai_sdk_log_emit(YAI_SDK_LOG_WARN, "client", "handshake not ready");
+            YAI_LOG(YAI_SDK_LOG_WARN, "client", "handshake not ready",
+                    YAI_LOG_STR("command_id", cid), YAI_LOG_STR("ws_id", c->ws_id));
             reply_set(out, "error", "RUNTIME_NOT_READY", "runtime_not_ready",
-                      "Runtime handshake is not ready.",
-                      fallback_command_id, "", "kernel");
+                      "Runtime handshake is not ready.", cid, "", plane);
             return hrc;
         }
     }
+    if (c->in_call) {
+        /* the request carries the call's span; set only now so that a
+           handshake round trip above does not take it */
+        c->rpc.next_trace = c->trace_call;
+        c->rpc.next_trace_set = 1;
+    }
+    return YAI_SDK_OK;
+}
 
-    char raw[4096];
-    uint32_t out_len = 0;
-    int rc = yai_rpc_call_raw(
-        &c->rpc,
-        YAI_CMD_CONTROL_CALL,
-        control_call_json,
-        (uint32_t)strlen(control_call_json),
-        raw,
-        sizeof(raw) - 1,
-        &out_len);
+/* Maps a failed rpc control call to an SDK error and fills *out. */
+int yai_client_call_failed(yai_sdk_client_t *c, int rc, yai_sdk_reply_t *out, const char *cid)
+{
+    if (rc == -15) {
+        client_mark_timed_out(c);
+        yai_client_reply_transport_error(out, YAI_SDK_TIMEOUT, cid, "kernel");
+        return YAI_SDK_TIMEOUT;
+    }
+    if (rc == -5 || rc == -3) {
+        /* the root went away (EOF, or a write into a closed socket): drop the
+           dead socket so the next call reconnects */
+        yai_rpc_close(&c->rpc);
+        c->is_open = 0;
+        c->handshaken = 0;
+        YAI_LOG(YAI_SDK_LOG_ERROR, "client", "server unavailable",
+                YAI_LOG_STR("command_id", cid), YAI_LOG_STR("ws_id", c->ws_id), YAI_LOG_INT("rc", rc));
+        reply_set(out, "error", "SERVER_UNAVAILABLE", "server_unavailable",
+                  "Runtime endpoint is unreachable.", cid, "", "kernel");
+        return YAI_SDK_SERVER_OFF;
+    }
+    if (rc == -20 || rc == -21 || rc == -22) {
+        /* a deferred handshake was refused, by the ack read with this call
+           or by the round trip that settled it */
+        yai_rpc_close(&c->rpc);
+        c->is_open = 0;
+        c->handshaken = 0;
+        YAI_LOG(YAI_SDK_LOG_WARN, "client", "handshake not ready",
+                YAI_LOG_STR("command_id", cid), YAI_LOG_STR("ws_id", c->ws_id), YAI_LOG_INT("rc", rc));
+        reply_set(out, "error", "RUNTIME_NOT_READY", "runtime_not_ready",
+                  "Runtime handshake is not ready.", cid, "", "kernel");
+        return YAI_SDK_RUNTIME_NOT_READY;
+    }
+    if (rc == -17) {
+        /* rpc closed the connection; the next call reconnects */
+        c->is_open = 0;
+        c->handshaken = 0;
+        YAI_LOG(YAI_SDK_LOG_ERROR, "client", "reply checksum mismatch",
+                YAI_LOG_STR("command_id", cid), YAI_LOG_STR("ws_id", c->ws_id));
+        reply_set(out, "error", "PROTOCOL_ERROR", "checksum_mismatch",
+                  "Reply failed its integrity check.", cid, "", "kernel");
+        return YAI_SDK_PROTOCOL;
+    }
+    if (rc == -18) {
+        /* rpc closed the connection; the next call reconnects */
+        c->is_open = 0;
+        c->handshaken = 0;
+        YAI_LOG(YAI_SDK_LOG_ERROR, "client", "reply decompression failed",
+                YAI_LOG_STR("command_id", cid), YAI_LOG_STR("ws_id", c->ws_id));
+        reply_set(out, "error", "PROTOCOL_ERROR", "decompress_failed",
+                  "Compressed reply could not be decoded.", cid, "", "kernel");
+        return YAI_SDK_PROTOCOL;
+    }
+    if (rc == -19) {
+        /* a reply with bad flags closed the connection; a request with
+           ungranted flags was never sent */
+        if (c->rpc.fd < 0) {
+            c->is_open = 0;
+            c->handshaken = 0;
+        }
+        YAI_LOG(YAI_SDK_LOG_ERROR, "client", "frame flags not negotiated",
+                YAI_LOG_STR("command_id", cid), YAI_LOG_STR("ws_id", c->ws_id));
+        reply_set(out, "error", "PROTOCOL_ERROR", "bad_frame_flags",
+                  "Frame flags were not negotiated for this connection.", cid, "", "kernel");
+        return YAI_SDK_PROTOCOL;
+    }
+    if (rc == -16) {
+        YAI_LOG(YAI_SDK_LOG_ERROR, "client", "reply too large",
+                YAI_LOG_STR("command_id", cid), YAI_LOG_STR("ws_id", c->ws_id));
+        reply_set(out, "error", "PROTOCOL_ERROR", "reply_too_large",
+                  "Reply exceeds the SDK reply size limit.", cid, "", "kernel");
+        return YAI_SDK_PROTOCOL;
+    }
+    if (c->rpc.fd < 0) {
+        /* a framing error: rpc closed the desynced connection */
+        c->is_open = 0;
+        c->handshaken = 0;
+    }
+    YAI_LOG(YAI_SDK_LOG_ERROR, "client", "rpc call failed",
+            YAI_LOG_STR("command_id", cid), YAI_LOG_STR("ws_id", c->ws_id), YAI_LOG_INT("rc", rc));
+    reply_set(out, "error", "PROTOCOL_ERROR", "rpc_call_failed",
+              "RPC request failed.", cid, "", "kernel");
+    return YAI_SDK_RPC;
+}
 
-    if (rc != 0) {
-        if (rc == -5) {
-            yai_sdk_log_emit(YAI_SDK_LOG_ERROR, "client", "server unavailable");
-            reply_set(out, "error", "SERVER_UNAVAILABLE", "server_unavailable",
-                      "Runtime endpoint is unreachable.",
-                      fallback_command_id, "", "kernel");
-            return YAI_SDK_SERVER_OFF;
-        }
-        yai_sdk_log_emit(YAI_SDK_LOG_ERROR, "client", "rpc call failed");
-        reply_set(out, "error", "PROTOCOL_ERROR", "rpc_call_failed",
-                  "RPC request failed.",
-                  fallback_command_id, "", "kernel");
-        return YAI_SDK_RPC;
+/* ============================================================
+   RETRY
+   ============================================================ */
+
+/* Only a command the registry knows to have no side effects may run twice. */
+static int retry_allowed(const char *cid)
+{
+    const yai_law_command_t *cmd = yai_law_cmd_by_id(cid);
+    return cmd && cmd->side_effects_len == 0;
+}
+
+static void retry_sleep_ms(uint64_t ms)
+{
+    struct timespec ts;
+    ts.tv_sec = (time_t)(ms / 1000u);
+    ts.tv_nsec = (long)(ms % 1000u) * 1000000L;
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {
     }
+}
 
-    if (out_len >= sizeof(raw)) {
-        out_len = (uint32_t)(sizeof(raw) - 1);
+int yai_client_retry_backoff(yai_sdk_client_t *c, int rc, const char *cid, int attempt)
+{
+    if (rc != YAI_SDK_SERVER_OFF || attempt >= c->retry_max || !retry_allowed(cid)) {
+        return 0;
     }
-    raw[out_len] = '\0';
 
-    out->exec_reply_json = dup_bytes(raw, out_len);
-    if (!out->exec_reply_json) {
-        reply_set(out, "error", "INTERNAL_ERROR", "alloc_failed",
-                  "Reply allocation failed.",
-                  fallback_command_id, "", "kernel");
-        return YAI_SDK_IO;
+    /* exponential up to the ceiling; the jitter keeps the back half of the
+       window random so clients cut off together do not reconnect together */
+    uint64_t window = (uint64_t)c->retry_backoff_ms << (attempt < 20 ? attempt : 20);
+    if (window > (uint64_t)c->retry_backoff_max_ms) {
+        window = (uint64_t)c->retry_backoff_max_ms;
+    }
+    c->retry_jitter ^= c->retry_jitter << 13;
+    c->retry_jitter ^= c->retry_jitter >> 7;
+    c->retry_jitter ^= c->retry_jitter << 17;
+    uint64_t wait_ms = window / 2 + c->retry_jitter % (window - window / 2 + 1);
+
+    YAI_LOG(YAI_SDK_LOG_WARN, "client", "connection lost, retrying",
+            YAI_LOG_STR("command_id", cid), YAI_LOG_INT("attempt", attempt + 1), YAI_LOG_UINT("wait_ms", wait_ms));
+    retry_sleep_ms(wait_ms);
+    return 1;
+}
+
+/* ============================================================
+   METRICS
+   ============================================================ */
+
+static uint64_t unix_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/* Wall-clock time of the monotonic instant mono_ns. */
+static uint64_t client_unix_at(const yai_sdk_client_t *c, uint64_t mono_ns)
+{
+    if (c->in_call && c->call_unix_ns && mono_ns >= c->call_t0) {
+        return c->call_unix_ns + (mono_ns - c->call_t0);
+    }
+    return unix_now_ns() - (yai_metrics_now_ns() - mono_ns);
+}
+
+static void client_span(const yai_sdk_client_t *c,
+                        const char *name,
+                        const yai_sdk_trace_ctx_t *ctx,
+                        const uint8_t *parent_span_id,
+                        int rc,
+                        uint64_t start_ns,
+                        uint64_t ns)
+{
+    yai_sdk_span_t span;
+
+    memset(&span, 0, sizeof(span));
+    span.name = name;
+    span.ctx = *ctx;
+    if (parent_span_id) {
+        memcpy(span.parent_span_id, parent_span_id, sizeof(span.parent_span_id));
+    }
+    span.command_id = c->in_call ? c->call_cid : NULL;
+    span.ws_id = c->ws_id;
+    span.rc = rc;
+    span.start_unix_ns = client_unix_at(c, start_ns);
+    span.duration_ns = ns;
+    span.correlation_id = c->correlation_id;
+    yai_trace_emit(&span);
+}
+
+uint64_t yai_client_call_begin(yai_sdk_client_t *c, const char *cid)
+{
+    c->call_sent = 0;
+    c->call_received = 0;
+    yai_trace_start(&c->trace_call, c->has_trace_parent ? &c->trace_parent : NULL);
+    c->in_call = 1;
+    c->call_cid = cid;
+    c->call_t0 = yai_metrics_now_ns();
+    c->call_unix_ns = yai_trace_enabled() ? unix_now_ns() : 0;
+    return c->call_t0;
+}
+
+void yai_client_phase(yai_sdk_client_t *c, yai_sdk_phase_t phase, uint64_t start_ns, uint64_t ns)
+{
+    yai_metrics_phase(&c->metrics, phase, ns);
+    if (!yai_trace_enabled()) {
+        return;
+    }
+    /* outside a public call, a connect or handshake is a span of its own */
+    const yai_sdk_trace_ctx_t *parent = c->in_call ? &c->trace_call : c->has_trace_parent ? &c->trace_parent : NULL;
+    yai_sdk_trace_ctx_t ctx;
+    yai_trace_start(&ctx, parent);
+    client_span(c, yai_sdk_phase_name(phase), &ctx, parent ? parent->span_id : NULL, 0, start_ns, ns);
+}
+
+/* A deferred handshake went out with the last rpc call: acked if the
+   connection survived it. */
+static void client_hs_settled(yai_sdk_client_t *c)
+{
+    if (c->hs_riding && !c->rpc.hs_deferred) {
+        c->hs_riding = 0;
+        c->handshaken = c->rpc.fd >= 0;
+    }
+}
+
+void yai_client_note_rpc(yai_sdk_client_t *c)
+{
+    client_hs_settled(c);
+    if (c->rpc.last_tx_bytes == 0) {
+        return; /* nothing went out */
+    }
+    yai_client_phase(c, YAI_SDK_PHASE_SEND, c->rpc.last_start_ns, c->rpc.last_send_ns);
+    if (c->rpc.last_wait_ns > 0) {
+        yai_client_phase(c, YAI_SDK_PHASE_WAIT, c->rpc.last_start_ns + c->rpc.last_send_ns, c->rpc.last_wait_ns);
+    }
+    c->call_sent += c->rpc.last_tx_bytes;
+    c->call_received += c->rpc.last_rx_bytes;
+}
+
+uint64_t yai_client_call_end(yai_sdk_client_t *c, const char *cid, int rc, uint64_t t0)
+{
+    uint64_t ns = yai_metrics_now_ns() - t0;
+    yai_metrics_phase(&c->metrics, YAI_SDK_PHASE_CALL, ns);
+    yai_metrics_call(&c->metrics, cid, rc, ns, c->call_sent, c->call_received);
+    if (yai_trace_enabled()) {
+        client_span(c, "call", &c->trace_call, c->has_trace_parent ? c->trace_parent.span_id : NULL, rc, t0, ns);
     }
+    c->in_call = 0;
+    c->call_cid = NULL;
+    /* unused when the call failed before sending; the next call sets its own */
+    c->rpc.next_trace_set = 0;
+    return ns;
+}
+
+void yai_client_reply_stamp(const yai_sdk_client_t *c, yai_sdk_reply_t *out, uint64_t ns)
+{
+    out->duration_ns = ns;
+    yai_sdk_trace_format(&c->trace_call, out->traceparent, sizeof(out->traceparent));
+}
 
-    cJSON *resp = cJSON_Parse(out->exec_reply_json);
+int yai_sdk_client_set_trace_parent(yai_sdk_client_t *c, const yai_sdk_trace_ctx_t *parent)
+{
+    if (!c) {
+        return YAI_SDK_BAD_ARGS;
+    }
+    c->has_trace_parent = parent != NULL;
+    if (parent) {
+        c->trace_parent = *parent;
+    }
+    return YAI_SDK_OK;
+}
+
+int yai_sdk_client_metrics(const yai_sdk_client_t *c, yai_sdk_metrics_t *out)
+{
+    if (!c || !out) {
+        return YAI_SDK_BAD_ARGS;
+    }
+    yai_metrics_snapshot(&c->metrics, out);
+    return YAI_SDK_OK;
+}
+
+/* Whole-reply collector: one exact-size allocation, sized from the envelope. */
+typedef struct reply_collect {
+    char *buf;
+    int oom;
+} reply_collect_t;
+
+static int collect_chunk(void *user, const void *chunk, size_t len, size_t offset, uint32_t total)
+{
+    reply_collect_t *rc = (reply_collect_t *)user;
+    if (!rc->buf) {
+        if (total > YAI_SDK_MAX_REPLY_BYTES) {
+            return 1;
+        }
+        rc->buf = (char *)malloc((size_t)total + 1);
+        if (!rc->buf) {
+            rc->oom = 1;
+            return 1;
+        }
+    }
+    memcpy(rc->buf + offset, chunk, len);
+    return 0;
+}
+
+/* Tree decode for replies the scanner gives up on (malformed or very deep). */
+static int reply_decode_cjson(yai_sdk_reply_t *out, const char *json, size_t len, const char *fallback_command_id)
+{
+    cJSON *resp = cJSON_ParseWithLength(json, len);
     if (!resp) {
-        yai_sdk_log_emit(YAI_SDK_LOG_ERROR, "client", "response parse failed");
+        YAI_LOG(YAI_SDK_LOG_ERROR, "client", "response parse failed",
+                YAI_LOG_STR("command_id", fallback_command_id), YAI_LOG_UINT("bytes", len));
         reply_set(out, "error", "PROTOCOL_ERROR", "response_parse_failed",
                   "Reply parsing failed.",
                   fallback_command_id, "", "kernel");
@@ -330,40 +702,378 @@ int yai_sdk_client_call_json(yai_sdk_client_t *c, const char *control_call_json,
     return yai_reply_map_rc(out->status, out->code);
 }
 
-int yai_sdk_client_ping(yai_sdk_client_t *c, const char *command_id, yai_sdk_reply_t *out)
+/* Copies a scanned string member; absent/non-string and empty ones get their defaults. */
+static void reply_take(char *dst, size_t cap, const yai_jspan_t *s, const char *if_absent, const char *if_empty)
 {
-    char buf[256];
+    if (s->kind == YAI_JSPAN_STRING && yai_jspan_copy(s, dst, cap) > 0) {
+        return;
+    }
+    snprintf(dst, cap, "%s", (s->kind == YAI_JSPAN_STRING) ? if_empty : if_absent);
+}
+
+/* Fields of a scanned (or binary-decoded) exec reply; defaults match the tree decode. */
+static int reply_fill(yai_sdk_reply_t *out, const yai_reply_scan_t *s, const char *fallback_command_id)
+{
+    reply_take(out->status, sizeof(out->status), &s->status, "error", "error");
+    reply_take(out->code, sizeof(out->code), &s->code, "PROTOCOL_ERROR", "INTERNAL_ERROR");
+    reply_take(out->reason, sizeof(out->reason), &s->reason, "missing_reason", "internal_error");
+    reply_take(out->summary, sizeof(out->summary), &s->summary,
+               yai_client_summary_for_code(out->code), yai_client_summary_for_code(out->code));
+    reply_take(out->command_id, sizeof(out->command_id), &s->command_id,
+               (fallback_command_id && fallback_command_id[0]) ? fallback_command_id : "yai.unknown.unknown",
+               "yai.unknown.unknown");
+    reply_take(out->trace_id, sizeof(out->trace_id), &s->trace_id, "", "");
+    reply_take(out->target_plane, sizeof(out->target_plane), &s->target_plane, "kernel", "kernel");
+    out->hint_count = 0;
+    out->hints[0][0] = '\0';
+    out->hints[1][0] = '\0';
+    out->details[0] = '\0';
+
+    const yai_jspan_t *harr = (s->hints.kind == YAI_JSPAN_ARRAY) ? &s->hints
+                              : (s->hint.kind == YAI_JSPAN_ARRAY) ? &s->hint
+                                                                  : NULL;
+    if (harr)
+    {
+        yai_jspan_t h;
+        if (yai_jspan_array_item(harr, 0, &h) == 0 && h.kind == YAI_JSPAN_STRING &&
+            yai_jspan_copy(&h, out->hints[0], sizeof(out->hints[0])) > 0)
+        {
+            out->hint_count = 1;
+        }
+        if (yai_jspan_array_item(harr, 1, &h) == 0 && h.kind == YAI_JSPAN_STRING &&
+            yai_jspan_copy(&h, out->hints[1], sizeof(out->hints[1])) > 0)
+        {
+            out->hint_count = 2;
+        }
+    }
+    if (s->details.kind == YAI_JSPAN_OBJECT)
+    {
+        yai_jspan_copy_compact(&s->details, out->details, sizeof(out->details));
+    }
+
+    return yai_reply_map_rc(out->status, out->code);
+}
+
+/*
+ * Fills *out from len bytes of exec reply with one scan and no allocation,
+ * unescaping straight into the reply fields. Defaults match reply_set as fed
+ * by the tree decode.
+ */
+int yai_client_reply_decode_bytes(yai_sdk_reply_t *out,
+                                 const char *json,
+                                 size_t len,
+                                 const char *fallback_command_id)
+{
+    yai_reply_scan_t s;
+
+    if (yai_reply_scan(json, len, &s) != 0) {
+        return reply_decode_cjson(out, json, len, fallback_command_id);
+    }
+    if (!yai_jspan_equals(&s.type, "yai.exec.reply.v1")) {
+        reply_set(out, "error", "PROTOCOL_ERROR", "bad_response_type",
+                  "Reply envelope type is invalid.",
+                  fallback_command_id, "", "kernel");
+        return YAI_SDK_PROTOCOL;
+    }
+    return reply_fill(out, &s, fallback_command_id);
+}
+
+/* Fills *out from the len-byte exec reply already stored in out->exec_reply_json. */
+int yai_client_reply_decode(yai_sdk_reply_t *out, size_t len, const char *fallback_command_id)
+{
+    return yai_client_reply_decode_bytes(out, out->exec_reply_json, len, fallback_command_id);
+}
+
+int yai_sdk_reply_parse(const char *exec_reply_json, size_t len, yai_sdk_reply_t *out)
+{
+    if (!exec_reply_json || !out) {
+        return YAI_SDK_BAD_ARGS;
+    }
+    yai_client_reply_zero(out);
+    return yai_client_reply_decode_bytes(out, exec_reply_json, len, NULL);
+}
+
+/* ============================================================
+   BINARY CODEC (YAI_RPC_CAP_BINARY)
+   ============================================================ */
+
+/* Control calls that do not fit go out as JSON. */
+#define CLIENT_BIN_MAX 4096u
+#define CLIENT_BIN_ARGV_MAX 64u
+
+enum {
+    BIN_SEEN_TYPE = 1,
+    BIN_SEEN_COMMAND = 2,
+    BIN_SEEN_PLANE = 4,
+    BIN_SEEN_ARGV = 8
+};
+
+typedef struct bin_request {
+    yai_bin_call_t call;
+    yai_bin_str_t argv[CLIENT_BIN_ARGV_MAX];
+    /* unescaped copies of escaped strings */
+    char scratch[CLIENT_BIN_MAX];
+    size_t used;
+    unsigned seen;
+} bin_request_t;
+
+static int bin_take(bin_request_t *r, const yai_jspan_t *v, yai_bin_str_t *dst)
+{
+    if (v->kind != YAI_JSPAN_STRING) {
+        return -1;
+    }
+    if (!v->escaped) {
+        dst->p = v->p;
+        dst->len = v->len;
+        return 0;
+    }
+    if (sizeof(r->scratch) - r->used < v->len + 1) {
+        return -1;
+    }
+    dst->p = r->scratch + r->used;
+    dst->len = yai_jspan_copy(v, r->scratch + r->used, v->len + 1);
+    r->used += dst->len + 1;
+    return 0;
+}
+
+/* Accepts exactly the members the binary call schema carries; 1 stops the walk. */
+static int bin_on_member(void *user, const yai_jspan_t *key, const yai_jspan_t *val)
+{
+    bin_request_t *r = (bin_request_t *)user;
+    unsigned bit;
+    int bad;
+
+    if (yai_jspan_equals(key, "type")) {
+        bit = BIN_SEEN_TYPE;
+        bad = !yai_jspan_equals(val, "yai.control.call.v1");
+    } else if (yai_jspan_equals(key, "command_id")) {
+        bit = BIN_SEEN_COMMAND;
+        bad = bin_take(r, val, &r->call.command_id) != 0 || r->call.command_id.len == 0;
+    } else if (yai_jspan_equals(key, "target_plane")) {
+        bit = BIN_SEEN_PLANE;
+        bad = bin_take(r, val, &r->call.target_plane) != 0;
+    } else if (yai_jspan_equals(key, "argv") && val->kind == YAI_JSPAN_ARRAY) {
+        yai_jspan_t item;
+        size_t pos = 0;
+        int arc;
+        bit = BIN_SEEN_ARGV;
+        bad = 0;
+        while (!bad && (arc = yai_jspan_array_next(val, &pos, &item)) == 0) {
+            bad = r->call.argc == CLIENT_BIN_ARGV_MAX || bin_take(r, &item, &r->argv[r->call.argc++]) != 0;
+        }
+        bad = bad || arc < 0;
+    } else {
+        bit = 0;
+        bad = 1;
+    }
+    if (bad || (r->seen & bit)) {
+        r->seen = 0;
+        return 1;
+    }
+    r->seen |= bit;
+    return 0;
+}
+
+/* Binary form of a JSON control call, 0 when it has to go out as JSON. */
+static size_t client_bin_request(yai_sdk_client_t *c, const char *json, uint8_t *dst, size_t cap)
+{
+    bin_request_t r;
+
+    if (!c->handshaken || !(c->rpc.caps_granted & YAI_RPC_CAP_BINARY)) {
+        return 0;
+    }
+    if (!c->bin_intern) {
+        c->bin_intern = (yai_bin_intern_t *)calloc(1, sizeof(*c->bin_intern));
+        if (!c->bin_intern) {
+            return 0;
+        }
+    }
+    memset(&r.call, 0, sizeof(r.call));
+    r.call.argv = r.argv;
+    r.used = 0;
+    r.seen = 0;
+    if (yai_jspan_each(json, strlen(json), bin_on_member, &r) != 0 || !(r.seen & BIN_SEEN_COMMAND)) {
+        return 0;
+    }
+    return yai_bin_call_encode(&r.call, c->bin_intern, dst, cap);
+}
+
+static void bin_span(yai_jspan_t *dst, const yai_bin_str_t *s)
+{
+    dst->p = s->p;
+    dst->len = s->len;
+    dst->kind = (s->len > 0) ? YAI_JSPAN_STRING : YAI_JSPAN_ABSENT;
+    dst->escaped = 0;
+}
+
+/* Decodes a binary exec reply (takes buf) and rebuilds exec_reply_json for readers of the raw reply. */
+static int client_bin_reply(yai_sdk_client_t *c, yai_sdk_reply_t *out, char *buf, size_t len, const char *fallback)
+{
+    yai_bin_reply_t r;
+    yai_reply_scan_t s;
+    size_t cap;
+    char *json;
+    int rc;
+
+    if (!c->bin_intern || yai_bin_reply_decode((const uint8_t *)buf, len, c->bin_intern, &r) != 0) {
+        free(buf);
+        YAI_LOG(YAI_SDK_LOG_ERROR, "client", "binary reply decode failed",
+                YAI_LOG_STR("command_id", fallback), YAI_LOG_UINT("bytes", len));
+        reply_set(out, "error", "PROTOCOL_ERROR", "response_parse_failed",
+                  "Reply parsing failed.",
+                  fallback, "", "kernel");
+        return YAI_SDK_PROTOCOL;
+    }
+    cap = yai_bin_reply_json_size(&r);
+    json = (char *)malloc(cap);
+    if (!json) {
+        free(buf);
+        reply_set(out, "error", "INTERNAL_ERROR", "alloc_failed",
+                  "Reply allocation failed.",
+                  fallback, "", "kernel");
+        return YAI_SDK_IO;
+    }
+    yai_bin_reply_to_json(&r, json, cap);
+
+    memset(&s, 0, sizeof(s));
+    bin_span(&s.status, &r.status);
+    bin_span(&s.code, &r.code);
+    bin_span(&s.reason, &r.reason);
+    bin_span(&s.summary, &r.summary);
+    bin_span(&s.command_id, &r.command_id);
+    bin_span(&s.trace_id, &r.trace_id);
+    bin_span(&s.target_plane, &r.target_plane);
+    bin_span(&s.details, &r.details);
+    if (r.details.len > 0 && r.details.p[0] == '{') {
+        s.details.kind = YAI_JSPAN_OBJECT;
+    }
+    rc = reply_fill(out, &s, fallback);
+
+    /* same rule as the JSON hints: entries 0 and 1, if non-empty */
+    const uint8_t *cur = r.hints_raw;
+    yai_bin_str_t h;
+    for (int i = 0; i < 2 && yai_bin_next_str(&cur, r.hints_end, &h) == 0; i++) {
+        if (h.len == 0) {
+            continue;
+        }
+        size_t n = (h.len < sizeof(out->hints[i]) - 1) ? h.len : sizeof(out->hints[i]) - 1;
+        memcpy(out->hints[i], h.p, n);
+        out->hints[i][n] = '\0';
+        out->hint_count = i + 1;
+    }
+
+    free(buf);
+    out->exec_reply_json = json;
+    return rc;
+}
+
+/* One attempt of yai_sdk_client_call_json. */
+static int call_json_once(yai_sdk_client_t *c,
+                          const char *control_call_json,
+                          yai_sdk_reply_t *out,
+                          const char *fallback_command_id)
+{
+    int prc = yai_client_prepare_call(c, out, fallback_command_id, "kernel");
+    if (prc != YAI_SDK_OK) {
+        return prc;
+    }
+
+    uint8_t bin[CLIENT_BIN_MAX];
+    const void *payload = control_call_json;
+    size_t payload_len = client_bin_request(c, control_call_json, bin, sizeof(bin));
+    if (payload_len > 0) {
+        payload = bin;
+        c->rpc.next_flags = YAI_RPC_FLAG_BINARY;
+    } else {
+        payload_len = strlen(control_call_json);
+    }
+
+    reply_collect_t col = {NULL, 0};
     uint32_t out_len = 0;
-    const char *cid = (command_id && command_id[0]) ? command_id : "yai.root.ping";
-    const char *reason = (strcmp(cid, "yai.kernel.ping") == 0) ? "kernel_ping_ok" : "root_ping_ok";
-    const char *plane = (strcmp(cid, "yai.kernel.ping") == 0) ? "kernel" : "root";
-    if (!c || !out) {
+    int rc = yai_rpc_call_stream(
+        &c->rpc,
+        YAI_CMD_CONTROL_CALL,
+        payload,
+        (uint32_t)payload_len,
+        collect_chunk,
+        &col,
+        &out_len);
+    yai_client_note_rpc(c);
+
+    if (rc != 0) {
+        free(col.buf);
+        if (!col.oom) {
+            int frc = yai_client_call_failed(c, rc, out, fallback_command_id);
+            if (payload == bin && c->is_open) {
+                /* the root may or may not have interned the id: start both tables over */
+                yai_rpc_close(&c->rpc);
+                c->is_open = 0;
+                c->handshaken = 0;
+            }
+            return frc;
+        }
+        col.buf = NULL;
+    } else if (!col.buf) {
+        col.buf = dup_bytes("", 0); /* empty payload */
+        out_len = 0;
+    }
+    if (!col.buf) {
+        reply_set(out, "error", "INTERNAL_ERROR", "alloc_failed",
+                  "Reply allocation failed.",
+                  fallback_command_id, "", "kernel");
+        return YAI_SDK_IO;
+    }
+    col.buf[out_len] = '\0';
+
+    uint64_t t0 = yai_metrics_now_ns();
+    if (c->rpc.reply_flags & YAI_RPC_FLAG_BINARY) {
+        rc = client_bin_reply(c, out, col.buf, out_len, fallback_command_id);
+    } else {
+        out->exec_reply_json = col.buf;
+        rc = yai_client_reply_decode(out, out_len, fallback_command_id);
+    }
+    yai_client_phase(c, YAI_SDK_PHASE_PARSE, t0, yai_metrics_now_ns() - t0);
+    return rc;
+}
+
+int yai_sdk_client_call_json(yai_sdk_client_t *c, const char *control_call_json, yai_sdk_reply_t *out)
+{
+    char fallback_command_id[128];
+    if (!c || !control_call_json || !control_call_json[0] || !out) {
         return YAI_SDK_BAD_ARGS;
     }
-    reply_zero(out);
 
-    if (c->auto_handshake && !c->handshaken) {
-        int hrc = yai_sdk_client_handshake(c);
-        if (hrc != 0) {
-            reply_set(out, "error", "RUNTIME_NOT_READY", "runtime_not_ready",
-                      "Runtime handshake is not ready.", cid, "", plane);
-            snprintf(out->summary, sizeof(out->summary), "Runtime handshake is not ready.");
-            return hrc;
+    yai_client_request_command_id(control_call_json, fallback_command_id, sizeof(fallback_command_id));
+    uint64_t t0 = yai_client_call_begin(c, fallback_command_id);
+    for (int attempt = 0;; attempt++) {
+        yai_client_reply_zero(out);
+        int rc = call_json_once(c, control_call_json, out, fallback_command_id);
+        if (!yai_client_retry_backoff(c, rc, fallback_command_id, attempt)) {
+            yai_client_reply_stamp(c, out, yai_client_call_end(c, fallback_command_id, rc, t0));
+            return rc;
         }
     }
+}
+
+/* One attempt of yai_sdk_client_ping. */
+static int ping_once(yai_sdk_client_t *c, const char *cid, yai_sdk_reply_t *out)
+{
+    char buf[256];
+    uint32_t out_len = 0;
+    const char *reason = (strcmp(cid, "yai.kernel.ping") == 0) ? "kernel_ping_ok" : "root_ping_ok";
+    const char *plane = (strcmp(cid, "yai.kernel.ping") == 0) ? "kernel" : "root";
+
+    int prc = yai_client_prepare_call(c, out, cid, plane);
+    if (prc != YAI_SDK_OK) {
+        return prc;
+    }
 
     int rc = yai_rpc_call_raw(&c->rpc, YAI_CMD_PING, NULL, 0, buf, sizeof(buf) - 1, &out_len);
+    yai_client_note_rpc(c);
     if (rc != 0) {
-        if (rc == -5) {
-            reply_set(out, "error", "SERVER_UNAVAILABLE", "server_unavailable",
-                      "Runtime endpoint is unreachable.", cid, "", plane);
-            snprintf(out->summary, sizeof(out->summary), "Runtime endpoint is unreachable.");
-            return YAI_SDK_SERVER_OFF;
-        }
-        reply_set(out, "error", "PROTOCOL_ERROR", "rpc_call_failed",
-                  "RPC request failed.", cid, "", plane);
-        snprintf(out->summary, sizeof(out->summary), "RPC request failed.");
-        return YAI_SDK_RPC;
+        int frc = yai_client_call_failed(c, rc, out, cid);
+        snprintf(out->target_plane, sizeof(out->target_plane), "%s", plane);
+        return frc;
     }
     if (out_len >= sizeof(buf)) {
         out_len = (uint32_t)(sizeof(buf) - 1);
@@ -384,6 +1094,260 @@ int yai_sdk_client_ping(yai_sdk_client_t *c, const char *command_id, yai_sdk_rep
     return YAI_SDK_OK;
 }
 
+int yai_sdk_client_ping(yai_sdk_client_t *c, const char *command_id, yai_sdk_reply_t *out)
+{
+    const char *cid = (command_id && command_id[0]) ? command_id : "yai.root.ping";
+    if (!c || !out) {
+        return YAI_SDK_BAD_ARGS;
+    }
+    uint64_t t0 = yai_client_call_begin(c, cid);
+    for (int attempt = 0;; attempt++) {
+        yai_client_reply_zero(out);
+        int rc = ping_once(c, cid, out);
+        if (!yai_client_retry_backoff(c, rc, cid, attempt)) {
+            yai_client_reply_stamp(c, out, yai_client_call_end(c, cid, rc, t0));
+            return rc;
+        }
+    }
+}
+
+/* Adapts the public sink signature to the rpc one. */
+typedef struct stream_fwd {
+    yai_sdk_reply_chunk_fn fn;
+    void *user;
+    /* once the sink has seen bytes, the call can no longer be replayed */
+    int delivered;
+} stream_fwd_t;
+
+static int forward_chunk(void *user, const void *chunk, size_t len, size_t offset, uint32_t total)
+{
+    stream_fwd_t *f = (stream_fwd_t *)user;
+    f->delivered = 1;
+    return f->fn(f->user, chunk, len, offset, (size_t)total);
+}
+
+/* One attempt of yai_sdk_client_call_stream. */
+static int call_stream_once(yai_sdk_client_t *c,
+                            const char *control_call_json,
+                            stream_fwd_t *fwd,
+                            const char *fallback_command_id)
+{
+    yai_sdk_reply_t status;
+    yai_client_reply_zero(&status);
+
+    int prc = yai_client_prepare_call(c, &status, fallback_command_id, "kernel");
+    if (prc != YAI_SDK_OK) {
+        return prc;
+    }
+
+    int rc = yai_rpc_call_stream(
+        &c->rpc,
+        YAI_CMD_CONTROL_CALL,
+        control_call_json,
+        (uint32_t)strlen(control_call_json),
+        forward_chunk,
+        fwd,
+        NULL);
+    yai_client_note_rpc(c);
+    if (rc == -16) {
+        return YAI_SDK_IO; /* sink stopped; the rest was drained */
+    }
+    if (rc != 0) {
+        return yai_client_call_failed(c, rc, &status, fallback_command_id);
+    }
+    return YAI_SDK_OK;
+}
+
+int yai_sdk_client_call_stream(yai_sdk_client_t *c,
+                               const char *control_call_json,
+                               yai_sdk_reply_chunk_fn on_chunk,
+                               void *user)
+{
+    char fallback_command_id[128];
+    if (!c || !control_call_json || !control_call_json[0] || !on_chunk) {
+        return YAI_SDK_BAD_ARGS;
+    }
+
+    yai_client_request_command_id(control_call_json, fallback_command_id, sizeof(fallback_command_id));
+    stream_fwd_t fwd = {on_chunk, user, 0};
+    uint64_t t0 = yai_client_call_begin(c, fallback_command_id);
+    for (int attempt = 0;; attempt++) {
+        int rc = call_stream_once(c, control_call_json, &fwd, fallback_command_id);
+        if (fwd.delivered || !yai_client_retry_backoff(c, rc, fallback_command_id, attempt)) {
+            yai_client_call_end(c, fallback_command_id, rc, t0);
+            return rc;
+        }
+    }
+}
+
+/* ============================================================
+   BATCH
+   ============================================================ */
+
+#define BATCH_WINDOW 128
+#define BATCH_PENDING (-1)
+
+static void batch_set_not_sent(yai_sdk_reply_t *r, const char *cid)
+{
+    reply_set(r, "error", "NOT_SENT", "batch_aborted",
+              "Not sent: an earlier batch item failed.", cid, "", "kernel");
+}
+
+int yai_sdk_client_call_batch_ex(yai_sdk_client_t *c,
+                                 const char **requests,
+                                 size_t n,
+                                 yai_sdk_reply_t *outs,
+                                 int *rcs,
+                                 yai_sdk_batch_policy_t policy)
+{
+    yai_rpc_pipeline_t *p = NULL;
+    int *item_rc;
+    char cid[128];
+    size_t submitted = 0;
+    size_t done = 0;
+    int stop = 0;
+    int trc = 0; /* transport failure, ends the batch */
+    int first_rc = YAI_SDK_OK;
+
+    if (!c || (n > 0 && (!requests || !outs))) {
+        return YAI_SDK_BAD_ARGS;
+    }
+    for (size_t i = 0; i < n; i++) {
+        if (!requests[i] || !requests[i][0]) {
+            return YAI_SDK_BAD_ARGS;
+        }
+    }
+    if (n == 0) {
+        return YAI_SDK_OK;
+    }
+    item_rc = rcs ? rcs : (int *)malloc(n * sizeof(*item_rc));
+    if (!item_rc) {
+        return YAI_SDK_IO;
+    }
+    for (size_t i = 0; i < n; i++) {
+        yai_client_reply_zero(&outs[i]);
+        item_rc[i] = BATCH_PENDING;
+    }
+
+    yai_client_request_command_id(requests[0], cid, sizeof(cid));
+    int prc = yai_client_prepare_call(c, &outs[0], cid, "kernel");
+    if (prc == YAI_SDK_OK) {
+        /* opening settles a deferred handshake with a round trip */
+        int orc = yai_rpc_pipeline_open(&p, &c->rpc, n < BATCH_WINDOW ? n : BATCH_WINDOW);
+        if (orc == 0) {
+            client_hs_settled(c);
+        } else {
+            c->hs_riding = 0; /* not acked: the next call handshakes again */
+        }
+        if (orc == -2) {
+            reply_set(&outs[0], "error", "INTERNAL_ERROR", "alloc_failed",
+                      "Batch setup failed.", cid, "", "kernel");
+            prc = YAI_SDK_IO;
+        } else if (orc != 0) {
+            prc = yai_client_call_failed(c, orc, &outs[0], cid);
+        }
+    }
+    if (prc != YAI_SDK_OK) {
+        for (size_t i = 0; i < n; i++) {
+            if (i > 0) {
+                outs[i] = outs[0];
+                yai_client_request_command_id(requests[i], outs[i].command_id, sizeof(outs[i].command_id));
+            }
+            item_rc[i] = prc;
+            yai_metrics_call(&c->metrics, outs[i].command_id, prc, 0, 0, 0);
+        }
+        if (!rcs) {
+            free(item_rc);
+        }
+        return prc;
+    }
+
+    /* one pass keeps the window full: submit what fits, then take a reply */
+    while (done < submitted || (!stop && submitted < n)) {
+        while (!stop && submitted < n) {
+            trc = yai_rpc_pipeline_submit(p, YAI_CMD_CONTROL_CALL, requests[submitted],
+                                          (uint32_t)strlen(requests[submitted]),
+                                          (void *)(uintptr_t)submitted);
+            if (trc != 0) {
+                break;
+            }
+            submitted++;
+        }
+        if (trc == -13) {
+            trc = 0; /* window full: take a reply first */
+        } else if (trc != 0) {
+            break;
+        }
+
+        yai_rpc_reply_t rep;
+        trc = yai_rpc_pipeline_next(p, &rep);
+        if (trc != 0) {
+            break;
+        }
+
+        size_t i = (size_t)(uintptr_t)rep.cookie;
+        outs[i].exec_reply_json = dup_bytes((const char *)rep.payload, rep.payload_len);
+        if (!outs[i].exec_reply_json) {
+            reply_set(&outs[i], "error", "INTERNAL_ERROR", "alloc_failed",
+                      "Reply allocation failed.", NULL, "", "kernel");
+            item_rc[i] = YAI_SDK_IO;
+        } else {
+            item_rc[i] = yai_client_reply_decode(&outs[i], rep.payload_len, NULL);
+        }
+        /* the request is only parsed when the reply did not name its command */
+        if (strcmp(outs[i].command_id, "yai.unknown.unknown") == 0) {
+            yai_client_request_command_id(requests[i], outs[i].command_id, sizeof(outs[i].command_id));
+        }
+        if (item_rc[i] != YAI_SDK_OK && policy == YAI_SDK_BATCH_FAIL_FAST) {
+            stop = 1;
+        }
+        done++;
+    }
+    yai_rpc_pipeline_close(p);
+
+    if (trc != 0 && trc != -15) {
+        /* the reply stream is out of step; the next call reconnects */
+        yai_rpc_close(&c->rpc);
+        c->is_open = 0;
+        c->handshaken = 0;
+    }
+
+    /* unanswered items share the transport failure; unsent ones were skipped */
+    int trc_sdk = YAI_SDK_OK;
+    size_t trc_first = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (item_rc[i] == BATCH_PENDING) {
+            yai_client_request_command_id(requests[i], cid, sizeof(cid));
+            if (trc == 0) {
+                batch_set_not_sent(&outs[i], cid);
+                item_rc[i] = YAI_SDK_RPC;
+            } else if (trc_sdk == YAI_SDK_OK) {
+                trc_sdk = yai_client_call_failed(c, trc, &outs[i], cid);
+                trc_first = i;
+                item_rc[i] = trc_sdk;
+            } else {
+                outs[i] = outs[trc_first];
+                snprintf(outs[i].command_id, sizeof(outs[i].command_id), "%s", cid);
+                item_rc[i] = trc_sdk;
+            }
+        }
+        if (first_rc == YAI_SDK_OK) {
+            first_rc = item_rc[i];
+        }
+        /* items are counted, not timed: they share one pipelined exchange */
+        yai_metrics_call(&c->metrics, outs[i].command_id, item_rc[i], 0, 0, 0);
+    }
+    if (!rcs) {
+        free(item_rc);
+    }
+    return first_rc;
+}
+
+int yai_sdk_client_call_batch(yai_sdk_client_t *c, const char **requests, size_t n, yai_sdk_reply_t *outs)
+{
+    return yai_sdk_client_call_batch_ex(c, requests, n, outs, NULL, YAI_SDK_BATCH_CONTINUE);
+}
+
 void yai_sdk_reply_free(yai_sdk_reply_t *r)
 {
     if (!r) {
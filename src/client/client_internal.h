@@ -2,7 +2,11 @@
 #pragma once
 
 #include <yai_sdk/client.h>
+#include <yai_sdk/reply_view.h>
 #include <yai_sdk/rpc.h>
+#include <yai_sdk/trace.h>
+
+#include "../platform/metrics_internal.h"
 
 struct yai_sdk_client {
     yai_rpc_client_t rpc;
@@ -11,6 +15,76 @@ struct yai_sdk_client {
     char correlation_id[64];
     int arming;
     int auto_handshake;
+    int connect_timeout_ms;
+    int handshake_timeout_ms;
+    int call_timeout_ms;
+    int ws_switch_in_place;
+    int binary_codec;
+    int handshake_defer;
     int is_open;
+    /* set once the server has acked a handshake on this connection */
     int handshaken;
+    /* a deferred handshake waits to go out with the next call */
+    int hs_riding;
+    /* owning yai_sdk_pool_t bucket while pooled, else NULL */
+    void *pool_key;
+    /* backs yai_sdk_client_call_view without a caller arena; created lazily */
+    yai_sdk_arena_t *reply_arena;
+    /* command ids interned on this connection by the binary codec; lazy */
+    struct yai_bin_intern *bin_intern;
+    int retry_max;
+    int retry_backoff_ms;
+    int retry_backoff_max_ms;
+    /* xorshift state for the backoff jitter */
+    uint64_t retry_jitter;
+    yai_metrics_t metrics;
+    /* wire bytes of the public call in progress, over all its attempts */
+    uint64_t call_sent;
+    uint64_t call_received;
+    /* trace context of the public call in progress; span_id is the call
+       span's, which is also what its request envelopes carry */
+    yai_sdk_trace_ctx_t trace_call;
+    yai_sdk_trace_ctx_t trace_parent;
+    int has_trace_parent;
+    int in_call;
+    const char *call_cid;
+    /* monotonic and wall-clock call start; call_unix_ns is 0 while spans are off */
+    uint64_t call_t0;
+    uint64_t call_unix_ns;
 };
+
+/* Reply helpers shared by the client flavours (client.c). */
+void yai_client_reply_zero(yai_sdk_reply_t *r);
+/* TIMEOUT / SERVER_UNAVAILABLE / PROTOCOL_ERROR reply for an SDK error code. */
+void yai_client_reply_transport_error(yai_sdk_reply_t *r, int rc, const char *command_id, const char *plane);
+void yai_client_request_command_id(const char *control_call_json, char *out, size_t out_sz);
+int yai_client_reply_decode(yai_sdk_reply_t *out, size_t len, const char *fallback_command_id);
+/* Same, from a caller buffer; out->exec_reply_json is left untouched. */
+int yai_client_reply_decode_bytes(yai_sdk_reply_t *out,
+                                 const char *json,
+                                 size_t len,
+                                 const char *fallback_command_id);
+const char *yai_client_summary_for_code(const char *code);
+/* Opens (if a timeout closed it) and handshakes before a call; fills *out on failure. */
+int yai_client_prepare_call(yai_sdk_client_t *c, yai_sdk_reply_t *out, const char *cid, const char *plane);
+/* Maps a failed rpc control call to an SDK error and fills *out. */
+int yai_client_call_failed(yai_sdk_client_t *c, int rc, yai_sdk_reply_t *out, const char *cid);
+/* After attempt `attempt` (0 = first send) of cid failed with SDK code rc:
+ * sleeps the backoff and returns 1 when the call should be sent again, 0
+ * when rc stands (not a lost connection, budget spent, or a command with
+ * side effects). */
+int yai_client_retry_backoff(yai_sdk_client_t *c, int rc, const char *cid, int attempt);
+
+/* Starts a public call's accounting and its trace span; returns its start
+ * time for call_end. cid must outlive the call. */
+uint64_t yai_client_call_begin(yai_sdk_client_t *c, const char *cid);
+/* Records one phase that started at start_ns and took ns (monotonic), and
+ * reports it as a span: a child of the call's span inside a public call. */
+void yai_client_phase(yai_sdk_client_t *c, yai_sdk_phase_t phase, uint64_t start_ns, uint64_t ns);
+/* Records the SEND/WAIT phases and wire bytes of the rpc call just made. */
+void yai_client_note_rpc(yai_sdk_client_t *c);
+/* Records the finished public call: CALL time, outcome class and bytes, and
+ * its span. Returns the call's duration in ns. */
+uint64_t yai_client_call_end(yai_sdk_client_t *c, const char *cid, int rc, uint64_t t0);
+/* Stamps a reply with the finished call's duration and traceparent. */
+void yai_client_reply_stamp(const yai_sdk_client_t *c, yai_sdk_reply_t *out, uint64_t ns);
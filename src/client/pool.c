@@ -0,0 +1,408 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <yai_sdk/pool.h>
+#include <yai_sdk/errors.h>
+
+#include "client_internal.h"
+#include "../platform/log_internal.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define POOL_DEFAULT_MAX_IDLE 64
+#define POOL_DEFAULT_MAX_PER_KEY 8
+
+typedef struct pool_idle {
+    yai_sdk_client_t *client;
+    uint64_t since_ms;
+} pool_idle_t;
+
+/* One (ws_id, role, arming) bucket; idle[] is oldest-first, reuse pops the tail. */
+typedef struct pool_key {
+    uint32_t hash;
+    char ws_id[128];
+    char role[32];
+    int arming;
+    size_t open;
+    pool_idle_t *idle;
+    size_t idle_len;
+    size_t idle_cap;
+} pool_key_t;
+
+struct yai_sdk_pool {
+    yai_sdk_pool_opts_t opts;
+    pthread_mutex_t mu;
+    pthread_cond_t cv; /* signalled whenever a key may have a free slot */
+    pool_key_t **keys;
+    size_t key_count;
+    size_t key_cap;
+    size_t idle_total;
+    size_t leased_total;
+    unsigned long long opened;
+    unsigned long long reused;
+    unsigned long long health_failures;
+};
+
+static uint64_t now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u;
+}
+
+static uint32_t key_hash(const char *ws_id, const char *role, int arming)
+{
+    uint32_t h = 2166136261u;
+    for (const char *p = ws_id; *p; p++)
+        h = (h ^ (uint8_t)*p) * 16777619u;
+    h = (h ^ 0xffu) * 16777619u;
+    for (const char *p = role; *p; p++)
+        h = (h ^ (uint8_t)*p) * 16777619u;
+    return (h ^ (uint32_t)(arming ? 1 : 0)) * 16777619u;
+}
+
+static pool_key_t *key_find_or_add(yai_sdk_pool_t *p, const char *ws_id, const char *role, int arming)
+{
+    uint32_t h = key_hash(ws_id, role, arming);
+    pool_key_t *k;
+
+    for (size_t i = 0; i < p->key_count; i++)
+    {
+        k = p->keys[i];
+        if (k->hash == h && k->arming == arming &&
+            strcmp(k->ws_id, ws_id) == 0 && strcmp(k->role, role) == 0)
+            return k;
+    }
+
+    if (p->key_count == p->key_cap)
+    {
+        size_t ncap = p->key_cap ? p->key_cap * 2 : 16;
+        pool_key_t **nk = (pool_key_t **)realloc(p->keys, ncap * sizeof(*nk));
+        if (!nk)
+            return NULL;
+        p->keys = nk;
+        p->key_cap = ncap;
+    }
+    k = (pool_key_t *)calloc(1, sizeof(*k));
+    if (!k)
+        return NULL;
+    k->hash = h;
+    k->arming = arming;
+    snprintf(k->ws_id, sizeof(k->ws_id), "%s", ws_id);
+    snprintf(k->role, sizeof(k->role), "%s", role);
+    p->keys[p->key_count++] = k;
+    return k;
+}
+
+/* Drops idle[i] from its key; the caller closes the client. */
+static yai_sdk_client_t *idle_remove(yai_sdk_pool_t *p, pool_key_t *k, size_t i)
+{
+    yai_sdk_client_t *c = k->idle[i].client;
+    memmove(&k->idle[i], &k->idle[i + 1], (k->idle_len - i - 1) * sizeof(k->idle[0]));
+    k->idle_len--;
+    k->open--;
+    p->idle_total--;
+    return c;
+}
+
+/* Least recently returned idle connection across all keys. */
+static yai_sdk_client_t *evict_oldest_idle(yai_sdk_pool_t *p)
+{
+    pool_key_t *victim = NULL;
+    for (size_t i = 0; i < p->key_count; i++)
+    {
+        pool_key_t *k = p->keys[i];
+        if (k->idle_len > 0 && (!victim || k->idle[0].since_ms < victim->idle[0].since_ms))
+            victim = k;
+    }
+    return victim ? idle_remove(p, victim, 0) : NULL;
+}
+
+int yai_sdk_pool_create(yai_sdk_pool_t **out, const yai_sdk_pool_opts_t *opts)
+{
+    yai_sdk_pool_t *p;
+    pthread_condattr_t ca;
+
+    if (!out)
+        return YAI_SDK_BAD_ARGS;
+    *out = NULL;
+
+    p = (yai_sdk_pool_t *)calloc(1, sizeof(*p));
+    if (!p)
+        return YAI_SDK_IO;
+    if (opts)
+        p->opts = *opts;
+    if (p->opts.max_idle == 0)
+        p->opts.max_idle = POOL_DEFAULT_MAX_IDLE;
+    if (p->opts.max_per_key == 0)
+        p->opts.max_per_key = POOL_DEFAULT_MAX_PER_KEY;
+
+    pthread_mutex_init(&p->mu, NULL);
+    pthread_condattr_init(&ca);
+    pthread_condattr_setclock(&ca, CLOCK_MONOTONIC);
+    pthread_cond_init(&p->cv, &ca);
+    pthread_condattr_destroy(&ca);
+    *out = p;
+    return YAI_SDK_OK;
+}
+
+void yai_sdk_pool_destroy(yai_sdk_pool_t *p)
+{
+    if (!p)
+        return;
+    if (p->leased_total > 0)
+        yai_sdk_log_emit(YAI_SDK_LOG_WARN, "pool", "destroyed with leased clients outstanding");
+    for (size_t i = 0; i < p->key_count; i++)
+    {
+        pool_key_t *k = p->keys[i];
+        for (size_t j = 0; j < k->idle_len; j++)
+            yai_sdk_client_close(k->idle[j].client);
+        free(k->idle);
+        free(k);
+    }
+    free(p->keys);
+    pthread_cond_destroy(&p->cv);
+    pthread_mutex_destroy(&p->mu);
+    free(p);
+}
+
+/* Waits for a release on a full key. 0 = woken, YAI_SDK_TIMEOUT otherwise. */
+static int wait_slot(yai_sdk_pool_t *p, const struct timespec *until)
+{
+    if (p->opts.acquire_timeout_ms == 0)
+        return YAI_SDK_TIMEOUT;
+    if (p->opts.acquire_timeout_ms < 0)
+        return pthread_cond_wait(&p->cv, &p->mu) == 0 ? 0 : YAI_SDK_TIMEOUT;
+    return pthread_cond_timedwait(&p->cv, &p->mu, until) == ETIMEDOUT ? YAI_SDK_TIMEOUT : 0;
+}
+
+static int open_leased(yai_sdk_pool_t *p, pool_key_t *k, yai_sdk_client_t **out)
+{
+    yai_sdk_client_opts_t o;
+    yai_sdk_client_t *c = NULL;
+    int rc;
+
+    memset(&o, 0, sizeof(o));
+    o.ws_id = k->ws_id;
+    o.role = k->role;
+    o.arming = k->arming;
+    o.auto_handshake = 1;
+    o.connect_timeout_ms = p->opts.connect_timeout_ms;
+    o.handshake_timeout_ms = p->opts.handshake_timeout_ms;
+    o.call_timeout_ms = p->opts.call_timeout_ms;
+
+    rc = yai_sdk_client_open(&c, &o);
+    if (rc == YAI_SDK_OK)
+    {
+        rc = yai_sdk_client_handshake(c);
+        if (rc != YAI_SDK_OK)
+        {
+            yai_sdk_client_close(c);
+            c = NULL;
+        }
+    }
+    if (c)
+        c->pool_key = k;
+    *out = c;
+    return rc;
+}
+
+static int health_ok(yai_sdk_client_t *c)
+{
+    yai_sdk_reply_t r;
+    int rc;
+    memset(&r, 0, sizeof(r));
+    rc = yai_sdk_client_ping(c, NULL, &r);
+    yai_sdk_reply_free(&r);
+    return rc == YAI_SDK_OK && c->is_open;
+}
+
+int yai_sdk_pool_acquire(yai_sdk_pool_t *p,
+                         const char *ws_id,
+                         const char *role,
+                         int arming,
+                         yai_sdk_client_t **out)
+{
+    struct timespec until;
+    pool_key_t *k;
+
+    if (!out)
+        return YAI_SDK_BAD_ARGS;
+    *out = NULL;
+    if (!p || !ws_id || !ws_id[0])
+        return YAI_SDK_BAD_ARGS;
+    if (!role || !role[0])
+        role = "operator";
+    arming = arming ? 1 : 0;
+
+    if (p->opts.acquire_timeout_ms > 0)
+    {
+        clock_gettime(CLOCK_MONOTONIC, &until);
+        until.tv_sec += p->opts.acquire_timeout_ms / 1000;
+        until.tv_nsec += (long)(p->opts.acquire_timeout_ms % 1000) * 1000000L;
+        if (until.tv_nsec >= 1000000000L)
+        {
+            until.tv_sec++;
+            until.tv_nsec -= 1000000000L;
+        }
+    }
+
+    pthread_mutex_lock(&p->mu);
+    k = key_find_or_add(p, ws_id, role, arming);
+    if (!k)
+    {
+        pthread_mutex_unlock(&p->mu);
+        return YAI_SDK_IO;
+    }
+
+    for (;;)
+    {
+        uint64_t now = now_ms();
+
+        while (k->idle_len > 0)
+        {
+            pool_idle_t it = k->idle[k->idle_len - 1];
+            uint64_t age = now - it.since_ms;
+            yai_sdk_client_t *c = idle_remove(p, k, k->idle_len - 1);
+
+            if (p->opts.idle_timeout_ms > 0 && age >= (uint64_t)p->opts.idle_timeout_ms)
+            {
+                yai_sdk_client_close(c);
+                continue;
+            }
+
+            /* still counted as open while leased for the health check */
+            k->open++;
+            p->leased_total++;
+            if (p->opts.health_check_after_ms > 0 && age >= (uint64_t)p->opts.health_check_after_ms)
+            {
+                int ok;
+                pthread_mutex_unlock(&p->mu);
+                ok = health_ok(c);
+                pthread_mutex_lock(&p->mu);
+                if (!ok)
+                {
+                    k->open--;
+                    p->leased_total--;
+                    p->health_failures++;
+                    pthread_cond_broadcast(&p->cv);
+                    yai_sdk_client_close(c);
+                    now = now_ms();
+                    continue;
+                }
+            }
+            p->reused++;
+            pthread_mutex_unlock(&p->mu);
+            *out = c;
+            return YAI_SDK_OK;
+        }
+
+        if (k->open < p->opts.max_per_key)
+        {
+            yai_sdk_client_t *c = NULL;
+            int rc;
+
+            k->open++;
+            p->leased_total++;
+            pthread_mutex_unlock(&p->mu);
+            rc = open_leased(p, k, &c);
+            pthread_mutex_lock(&p->mu);
+            if (rc != YAI_SDK_OK)
+            {
+                k->open--;
+                p->leased_total--;
+                pthread_cond_broadcast(&p->cv);
+                pthread_mutex_unlock(&p->mu);
+                return rc;
+            }
+            p->opened++;
+            pthread_mutex_unlock(&p->mu);
+            *out = c;
+            return YAI_SDK_OK;
+        }
+
+        if (wait_slot(p, &until) != 0)
+        {
+            pthread_mutex_unlock(&p->mu);
+            return YAI_SDK_TIMEOUT;
+        }
+    }
+}
+
+void yai_sdk_pool_release(yai_sdk_pool_t *p, yai_sdk_client_t *c, int reusable)
+{
+    yai_sdk_client_t *drop = NULL;
+    yai_sdk_client_t *evicted = NULL;
+    pool_key_t *k;
+
+    if (!p || !c)
+        return;
+
+    pthread_mutex_lock(&p->mu);
+    k = (pool_key_t *)c->pool_key;
+    p->leased_total--;
+
+    /* a client re-pointed at another workspace or authority no longer
+       matches its key */
+    if (!reusable || !c->is_open || !k || strcmp(c->ws_id, k->ws_id) != 0 ||
+        strcmp(c->role, k->role) != 0 || c->arming != k->arming)
+    {
+        drop = c;
+    }
+    else
+    {
+        if (p->idle_total >= p->opts.max_idle)
+            evicted = evict_oldest_idle(p);
+        if (k->idle_len == k->idle_cap)
+        {
+            size_t ncap = k->idle_cap ? k->idle_cap * 2 : 4;
+            pool_idle_t *ni = (pool_idle_t *)realloc(k->idle, ncap * sizeof(*ni));
+            if (ni)
+            {
+                k->idle = ni;
+                k->idle_cap = ncap;
+            }
+        }
+        if (k->idle_len < k->idle_cap)
+        {
+            k->idle[k->idle_len].client = c;
+            k->idle[k->idle_len].since_ms = now_ms();
+            k->idle_len++;
+            p->idle_total++;
+        }
+        else
+        {
+            drop = c;
+        }
+    }
+    if (drop && k)
+        k->open--;
+    pthread_cond_broadcast(&p->cv);
+    pthread_mutex_unlock(&p->mu);
+
+    yai_sdk_client_close(drop);
+    yai_sdk_client_close(evicted);
+}
+
+void yai_sdk_pool_get_stats(yai_sdk_pool_t *p, yai_sdk_pool_stats_t *out)
+{
+    if (!out)
+        return;
+    memset(out, 0, sizeof(*out));
+    if (!p)
+        return;
+    pthread_mutex_lock(&p->mu);
+    out->idle = p->idle_total;
+    out->leased = p->leased_total;
+    out->opened = p->opened;
+    out->reused = p->reused;
+    out->health_failures = p->health_failures;
+    pthread_mutex_unlock(&p->mu);
+}
@@ -0,0 +1,318 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include <yai_sdk/reply_view.h>
+#include <yai_sdk/errors.h>
+
+#include "client_internal.h"
+#include "../protocol/reply_map.h"
+#include "../protocol/reply_scan.h"
+
+#include <yai_protocol_ids.h>
+
+#include <stdint.h>
+#include <string.h>
+
+#define VIEW_LIT(s) ((yai_sdk_str_t){(s), sizeof(s) - 1})
+
+static yai_sdk_str_t view_cstr(const char *s)
+{
+    yai_sdk_str_t v = {s, strlen(s)};
+    return v;
+}
+
+static void view_zero(yai_sdk_reply_view_t *out)
+{
+    memset(out, 0, sizeof(*out));
+    out->raw = VIEW_LIT("");
+    out->status = VIEW_LIT("error");
+    out->code = VIEW_LIT("INTERNAL_ERROR");
+    out->reason = VIEW_LIT("internal_error");
+    out->summary = VIEW_LIT("Command failed.");
+    out->details = VIEW_LIT("");
+    out->command_id = VIEW_LIT("yai.unknown.unknown");
+    out->trace_id = VIEW_LIT("");
+    out->target_plane = VIEW_LIT("kernel");
+}
+
+static int view_alloc_failed(yai_sdk_reply_view_t *out)
+{
+    view_zero(out);
+    out->reason = VIEW_LIT("alloc_failed");
+    out->summary = VIEW_LIT("Reply allocation failed.");
+    return YAI_SDK_IO;
+}
+
+/* Borrows the string in place unless it has escapes; those go to the arena. */
+static int view_take(yai_sdk_arena_t *arena,
+                     yai_sdk_str_t *dst,
+                     const yai_jspan_t *s,
+                     const char *if_absent,
+                     const char *if_empty)
+{
+    if (s->kind == YAI_JSPAN_STRING && s->len > 0) {
+        if (!s->escaped) {
+            dst->ptr = s->p;
+            dst->len = s->len;
+            return 0;
+        }
+        char *buf = (char *)yai_sdk_arena_alloc(arena, s->len + 1);
+        if (!buf) {
+            return -1;
+        }
+        size_t n = yai_jspan_copy(s, buf, s->len + 1);
+        if (n > 0) {
+            dst->ptr = buf;
+            dst->len = n;
+            return 0;
+        }
+    }
+    *dst = view_cstr(s->kind == YAI_JSPAN_STRING ? if_empty : if_absent);
+    return 0;
+}
+
+static int view_dup(yai_sdk_arena_t *arena, yai_sdk_str_t *dst, const char *s)
+{
+    size_t n = strlen(s);
+    char *buf = (char *)yai_sdk_arena_alloc(arena, n + 1);
+    if (!buf) {
+        return -1;
+    }
+    memcpy(buf, s, n + 1);
+    dst->ptr = buf;
+    dst->len = n;
+    return 0;
+}
+
+/* Views over a fixed-size reply (error paths and the cJSON fallback). */
+static int view_from_reply(yai_sdk_arena_t *arena, const yai_sdk_reply_t *r, yai_sdk_reply_view_t *out)
+{
+    yai_sdk_str_t *hints = NULL;
+
+    if (r->hint_count > 0) {
+        hints = (yai_sdk_str_t *)yai_sdk_arena_alloc(arena, (size_t)r->hint_count * sizeof(*hints));
+        if (!hints) {
+            return -1;
+        }
+        for (int i = 0; i < r->hint_count; i++) {
+            if (view_dup(arena, &hints[i], r->hints[i]) != 0) {
+                return -1;
+            }
+        }
+    }
+    if (view_dup(arena, &out->status, r->status) != 0 || view_dup(arena, &out->code, r->code) != 0 ||
+        view_dup(arena, &out->reason, r->reason) != 0 || view_dup(arena, &out->summary, r->summary) != 0 ||
+        view_dup(arena, &out->details, r->details) != 0 || view_dup(arena, &out->command_id, r->command_id) != 0 ||
+        view_dup(arena, &out->trace_id, r->trace_id) != 0 ||
+        view_dup(arena, &out->target_plane, r->target_plane) != 0) {
+        return -1;
+    }
+    out->hints = hints;
+    out->hint_count = (size_t)r->hint_count;
+    return 0;
+}
+
+/* NUL-terminated copy of a short view for the code/status lookups. */
+static const char *view_key(const yai_sdk_str_t *v, char *buf, size_t cap)
+{
+    size_t n = (v->len < cap - 1) ? v->len : cap - 1;
+    memcpy(buf, v->ptr, n);
+    buf[n] = '\0';
+    return buf;
+}
+
+static int view_hints(yai_sdk_arena_t *arena, const yai_jspan_t *harr, yai_sdk_reply_view_t *out)
+{
+    yai_sdk_str_t *hints;
+    yai_jspan_t h;
+    size_t pos = 0;
+    size_t n = 0;
+
+    while (yai_jspan_array_next(harr, &pos, &h) == 0) {
+        n += (h.kind == YAI_JSPAN_STRING && h.len > 0);
+    }
+    if (n == 0) {
+        return 0;
+    }
+    hints = (yai_sdk_str_t *)yai_sdk_arena_alloc(arena, n * sizeof(*hints));
+    if (!hints) {
+        return -1;
+    }
+    pos = 0;
+    n = 0;
+    while (yai_jspan_array_next(harr, &pos, &h) == 0) {
+        if (h.kind != YAI_JSPAN_STRING || h.len == 0) {
+            continue;
+        }
+        if (view_take(arena, &hints[n], &h, "", "") != 0) {
+            return -1;
+        }
+        n += (hints[n].len > 0);
+    }
+    out->hints = hints;
+    out->hint_count = n;
+    return 0;
+}
+
+static int view_decode(const char *json,
+                       size_t len,
+                       yai_sdk_arena_t *arena,
+                       const char *fallback_command_id,
+                       yai_sdk_reply_view_t *out)
+{
+    yai_reply_scan_t s;
+    char status[8];
+    char code[64];
+
+    view_zero(out);
+    out->raw.ptr = json;
+    out->raw.len = len;
+
+    if (yai_reply_scan(json, len, &s) != 0 || !yai_jspan_equals(&s.type, "yai.exec.reply.v1")) {
+        /* rare: let the fixed-size decoder produce the error or tree fallback */
+        yai_sdk_reply_t tmp;
+        int rc = yai_client_reply_decode_bytes(&tmp, json, len, fallback_command_id);
+        return (view_from_reply(arena, &tmp, out) == 0) ? rc : view_alloc_failed(out);
+    }
+
+    if (view_take(arena, &out->status, &s.status, "error", "error") != 0 ||
+        view_take(arena, &out->code, &s.code, "PROTOCOL_ERROR", "INTERNAL_ERROR") != 0 ||
+        view_take(arena, &out->reason, &s.reason, "missing_reason", "internal_error") != 0) {
+        return view_alloc_failed(out);
+    }
+    view_key(&out->status, status, sizeof(status));
+    view_key(&out->code, code, sizeof(code));
+    const char *dflt_summary = yai_client_summary_for_code(code);
+    if (view_take(arena, &out->summary, &s.summary, dflt_summary, dflt_summary) != 0 ||
+        view_take(arena, &out->command_id, &s.command_id,
+                  (fallback_command_id && fallback_command_id[0]) ? fallback_command_id : "yai.unknown.unknown",
+                  "yai.unknown.unknown") != 0 ||
+        view_take(arena, &out->trace_id, &s.trace_id, "", "") != 0 ||
+        view_take(arena, &out->target_plane, &s.target_plane, "kernel", "kernel") != 0) {
+        return view_alloc_failed(out);
+    }
+    if (out->command_id.ptr == fallback_command_id && view_dup(arena, &out->command_id, fallback_command_id) != 0) {
+        return view_alloc_failed(out);
+    }
+
+    const yai_jspan_t *harr = (s.hints.kind == YAI_JSPAN_ARRAY) ? &s.hints
+                              : (s.hint.kind == YAI_JSPAN_ARRAY) ? &s.hint
+                                                                 : NULL;
+    if (harr && view_hints(arena, harr, out) != 0) {
+        return view_alloc_failed(out);
+    }
+    if (s.details.kind == YAI_JSPAN_OBJECT) {
+        out->details.ptr = s.details.p;
+        out->details.len = s.details.len;
+    }
+    return yai_reply_map_rc(status, code);
+}
+
+int yai_sdk_reply_view_parse(const char *exec_reply_json,
+                             size_t len,
+                             yai_sdk_arena_t *arena,
+                             yai_sdk_reply_view_t *out)
+{
+    if (!exec_reply_json || !arena || !out) {
+        return YAI_SDK_BAD_ARGS;
+    }
+    return view_decode(exec_reply_json, len, arena, NULL, out);
+}
+
+/* Whole-reply collector into the arena, sized from the envelope. */
+typedef struct view_collect {
+    yai_sdk_arena_t *arena;
+    char *buf;
+    int oom;
+} view_collect_t;
+
+static int view_collect_chunk(void *user, const void *chunk, size_t len, size_t offset, uint32_t total)
+{
+    view_collect_t *col = (view_collect_t *)user;
+    if (!col->buf) {
+        if (total > YAI_SDK_MAX_REPLY_BYTES) {
+            return 1;
+        }
+        col->buf = (char *)yai_sdk_arena_alloc(col->arena, (size_t)total + 1);
+        if (!col->buf) {
+            col->oom = 1;
+            return 1;
+        }
+    }
+    memcpy(col->buf + offset, chunk, len);
+    return 0;
+}
+
+static int call_view(yai_sdk_client_t *c,
+                     const char *control_call_json,
+                     yai_sdk_arena_t *arena,
+                     yai_sdk_reply_view_t *out,
+                     const char *fallback_command_id)
+{
+    yai_sdk_reply_t err;
+
+    if (!arena) {
+        if (!c->reply_arena && yai_sdk_arena_create(&c->reply_arena, 0) != YAI_SDK_OK) {
+            return view_alloc_failed(out);
+        }
+        arena = c->reply_arena;
+        yai_sdk_arena_reset(arena);
+    }
+
+    view_zero(out);
+
+    view_collect_t col = {arena, NULL, 0};
+    uint32_t out_len = 0;
+    int rc;
+    for (int attempt = 0;; attempt++) {
+        yai_client_reply_zero(&err);
+        rc = yai_client_prepare_call(c, &err, fallback_command_id, "kernel");
+        if (rc == YAI_SDK_OK) {
+            int trc = yai_rpc_call_stream(&c->rpc,
+                                          YAI_CMD_CONTROL_CALL,
+                                          control_call_json,
+                                          (uint32_t)strlen(control_call_json),
+                                          view_collect_chunk,
+                                          &col,
+                                          &out_len);
+            yai_client_note_rpc(c);
+            if (trc == 0) {
+                break;
+            }
+            if (col.oom) {
+                return view_alloc_failed(out);
+            }
+            rc = yai_client_call_failed(c, trc, &err, fallback_command_id);
+        }
+        if (!yai_client_retry_backoff(c, rc, fallback_command_id, attempt)) {
+            return (view_from_reply(arena, &err, out) == 0) ? rc : view_alloc_failed(out);
+        }
+        col.buf = NULL; /* a partial reply stays in the arena until its reset */
+    }
+    uint64_t t0 = yai_metrics_now_ns();
+    if (!col.buf) {
+        /* empty payload */
+        rc = view_decode("", 0, arena, fallback_command_id, out);
+    } else {
+        col.buf[out_len] = '\0';
+        rc = view_decode(col.buf, out_len, arena, fallback_command_id, out);
+    }
+    yai_client_phase(c, YAI_SDK_PHASE_PARSE, t0, yai_metrics_now_ns() - t0);
+    return rc;
+}
+
+int yai_sdk_client_call_view(yai_sdk_client_t *c,
+                             const char *control_call_json,
+                             yai_sdk_arena_t *arena,
+                             yai_sdk_reply_view_t *out)
+{
+    char fallback_command_id[128];
+
+    if (!c || !control_call_json || !control_call_json[0] || !out) {
+        return YAI_SDK_BAD_ARGS;
+    }
+    yai_client_request_command_id(control_call_json, fallback_command_id, sizeof(fallback_command_id));
+    uint64_t t0 = yai_client_call_begin(c, fallback_command_id);
+    int rc = call_view(c, control_call_json, arena, out, fallback_command_id);
+    out->duration_ns = yai_client_call_end(c, fallback_command_id, rc, t0);
+    return rc;
+}
@@ -0,0 +1,722 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <yai_sdk/shared_client.h>
+#include <yai_sdk/errors.h>
+#include <yai_sdk/rpc.h>
+
+#include "client_internal.h"
+#include "../platform/log_internal.h"
+
+#include <yai_protocol_ids.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define SHARED_DEFAULT_WINDOW 128
+#define SHARED_ETIMEDOUT (-15) /* rpc deadline code */
+
+/*
+ * One blocked caller. Lives on the caller's stack; the I/O thread only
+ * touches it between dequeue and sem_post.
+ */
+typedef struct shared_req {
+    _Atomic(struct shared_req *) next; /* submission queue link */
+    struct shared_req *backlog_next;   /* I/O thread: waiting for a window slot */
+    const char *json;
+    uint32_t len;
+    uint64_t deadline;
+    sem_t done;
+    int rc;
+    char *reply;
+    uint32_t reply_len;
+} shared_req_t;
+
+/*
+ * In-flight entry, the async cookie. Outlives its request when the caller
+ * times out (req == NULL): the reply still has to be consumed.
+ */
+typedef struct shared_ticket {
+    shared_req_t *req;
+    struct shared_ticket *prev;
+    struct shared_ticket *next;
+} shared_ticket_t;
+
+typedef struct shared_conn {
+    yai_rpc_client_async_t *a;
+    shared_ticket_t *head;
+    size_t in_flight;
+    size_t orphans; /* tickets whose caller already timed out */
+} shared_conn_t;
+
+struct yai_sdk_shared_client {
+    char ws_id[128];
+    char role[32];
+    char correlation_id[64];
+    int arming;
+    int connect_timeout_ms;
+    int handshake_timeout_ms;
+    int call_timeout_ms;
+    size_t window;
+
+    shared_conn_t *conns;
+    size_t nconns;
+
+    /*
+     * Connections are opened by callers, never by the I/O thread: a caller
+     * that finds one down claims `opening`, connects and handshakes on its
+     * own thread, and leaves the result in `handoff` for the I/O thread to
+     * install. `live` counts installed connections.
+     */
+    atomic_size_t live;
+    atomic_int opening;
+    _Atomic(yai_rpc_client_async_t *) handoff;
+
+    /* Intrusive MPSC queue (Vyukov): callers push, the I/O thread pops. */
+    _Atomic(shared_req_t *) tail;
+    shared_req_t *head;
+    shared_req_t stub;
+
+    /* I/O thread only */
+    shared_req_t *backlog_head;
+    shared_req_t *backlog_tail;
+
+    atomic_int wake_pending;
+    int wake_rd;
+    int wake_wr;
+    atomic_int stopping;
+    pthread_t io;
+
+    atomic_ullong calls;
+    atomic_ullong connects;
+    atomic_ullong failures;
+};
+
+static uint64_t now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u;
+}
+
+/* ============================================================
+   SUBMISSION QUEUE
+   ============================================================ */
+
+static void queue_push(yai_sdk_shared_client_t *c, shared_req_t *r)
+{
+    shared_req_t *prev;
+    atomic_store_explicit(&r->next, NULL, memory_order_relaxed);
+    prev = atomic_exchange_explicit(&c->tail, r, memory_order_acq_rel);
+    atomic_store_explicit(&prev->next, r, memory_order_release);
+}
+
+/* NULL when empty or while a push is half-way; the pusher wakes us again. */
+static shared_req_t *queue_pop(yai_sdk_shared_client_t *c)
+{
+    shared_req_t *head = c->head;
+    shared_req_t *next = atomic_load_explicit(&head->next, memory_order_acquire);
+
+    if (head == &c->stub)
+    {
+        if (!next)
+            return NULL;
+        c->head = next;
+        head = next;
+        next = atomic_load_explicit(&next->next, memory_order_acquire);
+    }
+    if (next)
+    {
+        c->head = next;
+        return head;
+    }
+    if (head != atomic_load_explicit(&c->tail, memory_order_acquire))
+        return NULL;
+    queue_push(c, &c->stub);
+    next = atomic_load_explicit(&head->next, memory_order_acquire);
+    if (next)
+    {
+        c->head = next;
+        return head;
+    }
+    return NULL;
+}
+
+static void wake_io(yai_sdk_shared_client_t *c)
+{
+    if (atomic_exchange(&c->wake_pending, 1) == 0)
+    {
+        char b = 1;
+        while (write(c->wake_wr, &b, 1) < 0 && errno == EINTR)
+        {
+        }
+    }
+}
+
+/* ============================================================
+   I/O THREAD
+   ============================================================ */
+
+static void req_finish(yai_sdk_shared_client_t *c, shared_req_t *r, int rc)
+{
+    r->rc = rc;
+    atomic_fetch_add(&c->calls, 1);
+    sem_post(&r->done);
+}
+
+static void ticket_unlink(shared_conn_t *cn, shared_ticket_t *t)
+{
+    if (t->prev)
+        t->prev->next = t->next;
+    else
+        cn->head = t->next;
+    if (t->next)
+        t->next->prev = t->prev;
+    cn->in_flight--;
+    if (!t->req)
+        cn->orphans--;
+    free(t);
+}
+
+/* Fails everything in flight on cn and drops the connection. */
+static void conn_fail(yai_sdk_shared_client_t *c, shared_conn_t *cn, int rc)
+{
+    while (cn->head)
+    {
+        shared_ticket_t *t = cn->head;
+        if (t->req)
+            req_finish(c, t->req, rc);
+        ticket_unlink(cn, t);
+    }
+    yai_rpc_async_close(cn->a);
+    cn->a = NULL;
+    atomic_fetch_sub(&c->live, 1);
+    atomic_fetch_add(&c->failures, 1);
+    YAI_LOG(YAI_SDK_LOG_WARN, "shared_client", "connection dropped",
+            YAI_LOG_STR("ws_id", c->ws_id), YAI_LOG_STR("correlation_id", c->correlation_id),
+            YAI_LOG_INT("rc", rc));
+}
+
+/* Connects and handshakes one connection; blocks, so never on the I/O thread. */
+static int conn_open(yai_sdk_shared_client_t *c, yai_rpc_client_async_t **out)
+{
+    yai_rpc_client_t rpc;
+    int rc = yai_rpc_connect_timeout(&rpc, c->ws_id, c->connect_timeout_ms);
+    if (rc != 0)
+        return rc;
+    yai_rpc_set_authority(&rpc, c->arming, c->role);
+    yai_rpc_set_correlation_id(&rpc, c->correlation_id);
+    yai_rpc_set_timeout(&rpc, c->handshake_timeout_ms);
+    rc = yai_rpc_handshake(&rpc);
+    if (rc == 0)
+        rc = yai_rpc_async_open(out, &rpc, c->window);
+    if (rc != 0)
+    {
+        yai_rpc_close(&rpc);
+        return rc;
+    }
+    atomic_fetch_add(&c->connects, 1);
+    return 0;
+}
+
+/* Maps a conn_open failure to an SDK error. */
+static int open_err(int orc)
+{
+    if (orc == SHARED_ETIMEDOUT)
+        return YAI_SDK_TIMEOUT;
+    if (orc == -5)
+        return YAI_SDK_SERVER_OFF;
+    if (orc == -99)
+        return YAI_SDK_BAD_ARGS;
+    return YAI_SDK_RUNTIME_NOT_READY;
+}
+
+/*
+ * Caller side: replaces a dropped connection before submitting. 0 when
+ * nothing was to be done, another caller is already at it, or the new
+ * connection was handed over; else the conn_open error.
+ */
+static int conn_refill(yai_sdk_shared_client_t *c)
+{
+    yai_rpc_client_async_t *a = NULL;
+    int rc;
+
+    if (atomic_load(&c->live) >= c->nconns || atomic_exchange(&c->opening, 1) != 0)
+        return 0;
+    rc = conn_open(c, &a);
+    if (rc != 0)
+    {
+        /* callers queued behind this attempt are failed by the I/O thread */
+        atomic_store(&c->opening, 0);
+        wake_io(c);
+        return rc;
+    }
+    /* `opening` stays claimed until the I/O thread has installed it */
+    atomic_store(&c->handoff, a);
+    wake_io(c);
+    return 0;
+}
+
+/* I/O thread: installs a connection a caller opened, if any. */
+static void conn_adopt(yai_sdk_shared_client_t *c)
+{
+    yai_rpc_client_async_t *a = atomic_exchange(&c->handoff, NULL);
+
+    if (!a)
+        return;
+    for (size_t i = 0; i < c->nconns; i++)
+    {
+        if (!c->conns[i].a)
+        {
+            c->conns[i].a = a;
+            a = NULL;
+            atomic_fetch_add(&c->live, 1);
+            break;
+        }
+    }
+    yai_rpc_async_close(a);
+    atomic_store(&c->opening, 0);
+}
+
+/* Least-loaded live connection with a free slot; a connection without
+   pipelining granted has a window of one. */
+static shared_conn_t *conn_pick(yai_sdk_shared_client_t *c)
+{
+    shared_conn_t *best = NULL;
+
+    for (size_t i = 0; i < c->nconns; i++)
+    {
+        shared_conn_t *cn = &c->conns[i];
+        if (cn->a && cn->in_flight < yai_rpc_async_window(cn->a) && (!best || cn->in_flight < best->in_flight))
+            best = cn;
+    }
+    return best;
+}
+
+/* 0 submitted, 1 no window slot anywhere (stays queued), <0 failed. */
+static int dispatch(yai_sdk_shared_client_t *c, shared_req_t *r)
+{
+    int rc;
+    shared_conn_t *cn = conn_pick(c);
+    shared_ticket_t *t;
+
+    if (!cn)
+    {
+        /* every connection is down: wait for one a caller is opening */
+        if (atomic_load(&c->live) == 0 && !atomic_load(&c->opening))
+            return -5;
+        return 1;
+    }
+
+    t = (shared_ticket_t *)calloc(1, sizeof(*t));
+    if (!t)
+        return -2;
+    t->req = r;
+    rc = yai_rpc_async_submit(cn->a, YAI_CMD_CONTROL_CALL, r->json, r->len, t);
+    if (rc != 0)
+    {
+        free(t);
+        if (rc == -13)
+            return 1;
+        conn_fail(c, cn, -5);
+        return rc;
+    }
+    t->next = cn->head;
+    if (cn->head)
+        cn->head->prev = t;
+    cn->head = t;
+    cn->in_flight++;
+    return 0;
+}
+
+static void backlog_append(yai_sdk_shared_client_t *c, shared_req_t *r)
+{
+    r->backlog_next = NULL;
+    if (c->backlog_tail)
+        c->backlog_tail->backlog_next = r;
+    else
+        c->backlog_head = r;
+    c->backlog_tail = r;
+}
+
+static void submit_pending(yai_sdk_shared_client_t *c)
+{
+    shared_req_t *r;
+
+    conn_adopt(c);
+
+    /* earlier arrivals first, so a full window does not reorder callers */
+    while ((r = c->backlog_head) != NULL)
+    {
+        int rc = dispatch(c, r);
+        if (rc == 1)
+            return;
+        c->backlog_head = r->backlog_next;
+        if (!c->backlog_head)
+            c->backlog_tail = NULL;
+        if (rc < 0)
+            req_finish(c, r, rc);
+    }
+    while ((r = queue_pop(c)) != NULL)
+    {
+        int rc = c->backlog_head ? 1 : dispatch(c, r);
+        if (rc == 1)
+            backlog_append(c, r);
+        else if (rc < 0)
+            req_finish(c, r, rc);
+    }
+}
+
+static void drain_completions(yai_sdk_shared_client_t *c, shared_conn_t *cn)
+{
+    yai_rpc_reply_t rep;
+    int rc = 1;
+
+    /* a reply over the negotiated size (-8 with its ticket) fails its caller
+       only; an oversized frame head (-8 without one) drops the connection */
+    while (cn->a && ((rc = yai_rpc_async_poll_completion(cn->a, &rep)) == 0 || (rc == -8 && rep.cookie)))
+    {
+        shared_ticket_t *t = (shared_ticket_t *)rep.cookie;
+        shared_req_t *r = t->req;
+        if (r && rc != 0)
+            req_finish(c, r, rc);
+        else if (r)
+        {
+            r->reply = (char *)malloc((size_t)rep.payload_len + 1);
+            if (r->reply)
+            {
+                if (rep.payload_len)
+                    memcpy(r->reply, rep.payload, rep.payload_len);
+                r->reply[rep.payload_len] = '\0';
+                r->reply_len = rep.payload_len;
+            }
+            req_finish(c, r, r->reply ? 0 : -2);
+        }
+        ticket_unlink(cn, t);
+    }
+    if (cn->a && rc < 0)
+        conn_fail(c, cn, rc);
+}
+
+/* Times out overdue callers; returns the poll timeout until the next deadline. */
+static int expire(yai_sdk_shared_client_t *c)
+{
+    uint64_t now = now_ms();
+    uint64_t next = 0;
+    shared_req_t **pp = &c->backlog_head;
+
+    c->backlog_tail = NULL;
+    while (*pp)
+    {
+        shared_req_t *r = *pp;
+        if (r->deadline && now >= r->deadline)
+        {
+            *pp = r->backlog_next;
+            req_finish(c, r, SHARED_ETIMEDOUT);
+            continue;
+        }
+        if (r->deadline && (!next || r->deadline < next))
+            next = r->deadline;
+        c->backlog_tail = r;
+        pp = &r->backlog_next;
+    }
+
+    for (size_t i = 0; i < c->nconns; i++)
+    {
+        shared_conn_t *cn = &c->conns[i];
+        for (shared_ticket_t *t = cn->head; t; t = t->next)
+        {
+            shared_req_t *r = t->req;
+            if (!r || !r->deadline)
+                continue;
+            if (now >= r->deadline)
+            {
+                /* the reply may still come; the ticket stays to absorb it */
+                t->req = NULL;
+                cn->orphans++;
+                req_finish(c, r, SHARED_ETIMEDOUT);
+                continue;
+            }
+            if (!next || r->deadline < next)
+                next = r->deadline;
+        }
+        /* a window clogged by replies that never came is recycled */
+        if (cn->a && cn->orphans == yai_rpc_async_window(cn->a))
+            conn_fail(c, cn, -5);
+    }
+    return next ? (int)(next - now) : -1;
+}
+
+/* Fails every waiting caller: the backlog, then the submission queue. */
+static void fail_queued(yai_sdk_shared_client_t *c)
+{
+    shared_req_t *r;
+
+    while ((r = c->backlog_head) != NULL)
+    {
+        c->backlog_head = r->backlog_next;
+        req_finish(c, r, -1);
+    }
+    c->backlog_tail = NULL;
+    while ((r = queue_pop(c)) != NULL)
+        req_finish(c, r, -1);
+}
+
+static void *io_main(void *arg)
+{
+    yai_sdk_shared_client_t *c = (yai_sdk_shared_client_t *)arg;
+    struct pollfd *pfd = (struct pollfd *)calloc(c->nconns + 1, sizeof(*pfd));
+
+    while (pfd && !atomic_load(&c->stopping))
+    {
+        int timeout;
+
+        /* cleared before draining: a push after this point wakes us again */
+        atomic_store(&c->wake_pending, 0);
+        submit_pending(c);
+        timeout = expire(c);
+
+        /* optimistic write: everything queued since the last pass in one go */
+        for (size_t i = 0; i < c->nconns; i++)
+        {
+            shared_conn_t *cn = &c->conns[i];
+            if (cn->a && (yai_rpc_async_want(cn->a) & YAI_RPC_WANT_WRITE) &&
+                yai_rpc_async_on_writable(cn->a) != 0)
+                conn_fail(c, cn, -5);
+        }
+
+        pfd[0].fd = c->wake_rd;
+        pfd[0].events = POLLIN;
+        pfd[0].revents = 0;
+        for (size_t i = 0; i < c->nconns; i++)
+        {
+            shared_conn_t *cn = &c->conns[i];
+            unsigned want = cn->a ? yai_rpc_async_want(cn->a) : 0;
+            pfd[i + 1].fd = want ? yai_rpc_async_fd(cn->a) : -1;
+            pfd[i + 1].events = (short)(((want & YAI_RPC_WANT_READ) ? POLLIN : 0) |
+                                        ((want & YAI_RPC_WANT_WRITE) ? POLLOUT : 0));
+            pfd[i + 1].revents = 0;
+        }
+
+        if (poll(pfd, (nfds_t)(c->nconns + 1), timeout) < 0 && errno != EINTR)
+            break;
+
+        if (pfd[0].revents & POLLIN)
+        {
+            char buf[64];
+            while (read(c->wake_rd, buf, sizeof(buf)) > 0)
+            {
+            }
+        }
+        for (size_t i = 0; i < c->nconns; i++)
+        {
+            shared_conn_t *cn = &c->conns[i];
+            short ev = pfd[i + 1].revents;
+            if (!cn->a || !ev)
+                continue;
+            if ((ev & POLLOUT) && yai_rpc_async_on_writable(cn->a) != 0)
+            {
+                conn_fail(c, cn, -5);
+                continue;
+            }
+            if (ev & (POLLIN | POLLHUP | POLLERR))
+            {
+                int rc = yai_rpc_async_on_readable(cn->a);
+                drain_completions(c, cn);
+                if (rc != 0 && cn->a)
+                    conn_fail(c, cn, rc);
+            }
+        }
+    }
+
+    /* shutting down: nobody may be waiting, but never strand a caller */
+    for (size_t i = 0; i < c->nconns; i++)
+    {
+        if (c->conns[i].a)
+            conn_fail(c, &c->conns[i], -1);
+    }
+    yai_rpc_async_close(atomic_exchange(&c->handoff, NULL));
+    fail_queued(c);
+    free(pfd);
+
+    if (!atomic_load(&c->stopping))
+    {
+        /* out of memory or poll failed: fail every later call until close */
+        YAI_LOG(YAI_SDK_LOG_ERROR, "shared_client", "I/O loop stopped, failing calls",
+                YAI_LOG_STR("ws_id", c->ws_id), YAI_LOG_STR("correlation_id", c->correlation_id),
+                YAI_LOG_INT("errno", errno));
+        while (!atomic_load(&c->stopping))
+        {
+            struct pollfd wake = {.fd = c->wake_rd, .events = POLLIN};
+            char buf[64];
+
+            atomic_store(&c->wake_pending, 0);
+            fail_queued(c);
+            if (poll(&wake, 1, 1000) > 0)
+            {
+                while (read(c->wake_rd, buf, sizeof(buf)) > 0)
+                {
+                }
+            }
+        }
+        fail_queued(c);
+    }
+    return NULL;
+}
+
+/* ============================================================
+   PUBLIC API
+   ============================================================ */
+
+int yai_sdk_shared_client_open(yai_sdk_shared_client_t **out, const yai_sdk_shared_client_opts_t *opts)
+{
+    yai_sdk_shared_client_t *c;
+    int pipefd[2];
+    int rc = YAI_SDK_OK;
+
+    if (!out)
+        return YAI_SDK_BAD_ARGS;
+    *out = NULL;
+
+    c = (yai_sdk_shared_client_t *)calloc(1, sizeof(*c));
+    if (!c)
+        return YAI_SDK_IO;
+    snprintf(c->ws_id, sizeof(c->ws_id), "%s",
+             (opts && opts->ws_id && opts->ws_id[0]) ? opts->ws_id : "default");
+    snprintf(c->role, sizeof(c->role), "%s",
+             (opts && opts->role && opts->role[0]) ? opts->role : "operator");
+    snprintf(c->correlation_id, sizeof(c->correlation_id), "%s",
+             (opts && opts->correlation_id && opts->correlation_id[0]) ? opts->correlation_id : "sdk");
+    c->arming = (opts && opts->arming) ? 1 : 0;
+    c->connect_timeout_ms = (opts && opts->connect_timeout_ms > 0) ? opts->connect_timeout_ms : 0;
+    c->handshake_timeout_ms = (opts && opts->handshake_timeout_ms > 0) ? opts->handshake_timeout_ms : 0;
+    c->call_timeout_ms = (opts && opts->call_timeout_ms > 0) ? opts->call_timeout_ms : 0;
+    c->window = (opts && opts->window) ? opts->window : SHARED_DEFAULT_WINDOW;
+    c->nconns = (opts && opts->connections) ? opts->connections : 1;
+
+    atomic_init(&c->tail, &c->stub);
+    c->head = &c->stub;
+    c->wake_rd = c->wake_wr = -1;
+
+    c->conns = (shared_conn_t *)calloc(c->nconns, sizeof(*c->conns));
+    if (!c->conns || pipe(pipefd) != 0)
+    {
+        free(c->conns);
+        free(c);
+        return YAI_SDK_IO;
+    }
+    c->wake_rd = pipefd[0];
+    c->wake_wr = pipefd[1];
+    (void)fcntl(c->wake_rd, F_SETFL, fcntl(c->wake_rd, F_GETFL, 0) | O_NONBLOCK);
+    (void)fcntl(c->wake_wr, F_SETFL, fcntl(c->wake_wr, F_GETFL, 0) | O_NONBLOCK);
+
+    for (size_t i = 0; i < c->nconns && rc == YAI_SDK_OK; i++)
+    {
+        int orc = conn_open(c, &c->conns[i].a);
+        if (orc != 0)
+            rc = open_err(orc);
+    }
+    atomic_init(&c->live, c->nconns);
+    atomic_init(&c->opening, 0);
+    atomic_init(&c->handoff, NULL);
+    if (rc == YAI_SDK_OK && pthread_create(&c->io, NULL, io_main, c) != 0)
+        rc = YAI_SDK_IO;
+    if (rc != YAI_SDK_OK)
+    {
+        YAI_LOG(YAI_SDK_LOG_ERROR, "shared_client", "open failed",
+                YAI_LOG_STR("ws_id", c->ws_id), YAI_LOG_STR("correlation_id", c->correlation_id),
+                YAI_LOG_INT("rc", rc));
+        for (size_t i = 0; i < c->nconns; i++)
+            yai_rpc_async_close(c->conns[i].a);
+        close(c->wake_rd);
+        close(c->wake_wr);
+        free(c->conns);
+        free(c);
+        return rc;
+    }
+    *out = c;
+    return YAI_SDK_OK;
+}
+
+void yai_sdk_shared_client_close(yai_sdk_shared_client_t *c)
+{
+    if (!c)
+        return;
+    atomic_store(&c->stopping, 1);
+    atomic_store(&c->wake_pending, 0);
+    wake_io(c);
+    pthread_join(c->io, NULL);
+    close(c->wake_rd);
+    close(c->wake_wr);
+    free(c->conns);
+    free(c);
+}
+
+int yai_sdk_shared_client_call_json(yai_sdk_shared_client_t *c, const char *control_call_json, yai_sdk_reply_t *out)
+{
+    char fallback_command_id[128];
+    shared_req_t r;
+    int rc;
+
+    if (!c || !control_call_json || !control_call_json[0] || !out)
+        return YAI_SDK_BAD_ARGS;
+
+    yai_client_reply_zero(out);
+    yai_client_request_command_id(control_call_json, fallback_command_id, sizeof(fallback_command_id));
+
+    memset(&r, 0, sizeof(r));
+    r.json = control_call_json;
+    r.len = (uint32_t)strlen(control_call_json);
+    r.deadline = c->call_timeout_ms > 0 ? now_ms() + (uint64_t)c->call_timeout_ms : 0;
+    if (sem_init(&r.done, 0, 0) != 0)
+        return YAI_SDK_IO;
+
+    rc = conn_refill(c);
+    if (rc != 0 && atomic_load(&c->live) == 0)
+    {
+        sem_destroy(&r.done);
+        rc = open_err(rc);
+        yai_client_reply_transport_error(out, rc, fallback_command_id, "kernel");
+        return rc;
+    }
+    queue_push(c, &r);
+    wake_io(c);
+    while (sem_wait(&r.done) != 0 && errno == EINTR)
+    {
+    }
+    sem_destroy(&r.done);
+
+    if (r.rc != 0)
+    {
+        free(r.reply);
+        rc = (r.rc == SHARED_ETIMEDOUT) ? YAI_SDK_TIMEOUT
+             : (r.rc == -5)              ? YAI_SDK_SERVER_OFF
+                                         : YAI_SDK_RPC;
+        yai_client_reply_transport_error(out, rc, fallback_command_id, "kernel");
+        return rc;
+    }
+    out->exec_reply_json = r.reply;
+    return yai_client_reply_decode(out, r.reply_len, fallback_command_id);
+}
+
+void yai_sdk_shared_client_get_stats(yai_sdk_shared_client_t *c, yai_sdk_shared_client_stats_t *out)
+{
+    if (!out)
+        return;
+    memset(out, 0, sizeof(*out));
+    if (!c)
+        return;
+    out->calls = atomic_load(&c->calls);
+    out->connects = atomic_load(&c->connects);
+    out->failures = atomic_load(&c->failures);
+}
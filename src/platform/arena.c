@@ -0,0 +1,116 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include <yai_sdk/reply_view.h>
+#include <yai_sdk/errors.h>
+
+#include <stdalign.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define ARENA_DEFAULT_BYTES 4096u
+#define ARENA_ALIGN alignof(max_align_t)
+
+typedef struct arena_chunk {
+    struct arena_chunk *next;
+    size_t cap;
+    size_t used;
+    alignas(max_align_t) unsigned char data[];
+} arena_chunk_t;
+
+struct yai_sdk_arena {
+    /* newest chunk first; only the head has free space worth using */
+    arena_chunk_t *head;
+    size_t initial;
+};
+
+static arena_chunk_t *chunk_new(size_t cap)
+{
+    arena_chunk_t *ch = (arena_chunk_t *)malloc(sizeof(*ch) + cap);
+    if (!ch) {
+        return NULL;
+    }
+    ch->next = NULL;
+    ch->cap = cap;
+    ch->used = 0;
+    return ch;
+}
+
+static void chunks_free(arena_chunk_t *ch)
+{
+    while (ch) {
+        arena_chunk_t *next = ch->next;
+        free(ch);
+        ch = next;
+    }
+}
+
+int yai_sdk_arena_create(yai_sdk_arena_t **out, size_t initial_bytes)
+{
+    if (!out) {
+        return YAI_SDK_BAD_ARGS;
+    }
+    *out = NULL;
+    yai_sdk_arena_t *a = (yai_sdk_arena_t *)calloc(1, sizeof(*a));
+    if (!a) {
+        return YAI_SDK_IO;
+    }
+    a->initial = initial_bytes ? initial_bytes : ARENA_DEFAULT_BYTES;
+    a->head = chunk_new(a->initial);
+    if (!a->head) {
+        free(a);
+        return YAI_SDK_IO;
+    }
+    *out = a;
+    return YAI_SDK_OK;
+}
+
+void *yai_sdk_arena_alloc(yai_sdk_arena_t *a, size_t n)
+{
+    if (!a || n > SIZE_MAX / 2) {
+        return NULL;
+    }
+    n = (n + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+    if (!a->head || a->head->cap - a->head->used < n) {
+        size_t cap = a->head ? a->head->cap * 2 : a->initial;
+        if (cap < n) {
+            cap = n;
+        }
+        arena_chunk_t *ch = chunk_new(cap);
+        if (!ch) {
+            return NULL;
+        }
+        ch->next = a->head;
+        a->head = ch;
+    }
+    void *p = a->head->data + a->head->used;
+    a->head->used += n;
+    return p;
+}
+
+void yai_sdk_arena_reset(yai_sdk_arena_t *a)
+{
+    if (!a || !a->head) {
+        return;
+    }
+    if (a->head->next) {
+        /* fold the chunks into one so the same load fits without growing */
+        size_t total = 0;
+        for (arena_chunk_t *ch = a->head; ch; ch = ch->next) {
+            total += ch->cap;
+        }
+        chunks_free(a->head);
+        a->head = chunk_new(total);
+        return;
+    }
+    a->head->used = 0;
+}
+
+void yai_sdk_arena_destroy(yai_sdk_arena_t *a)
+{
+    if (!a) {
+        return;
+    }
+    chunks_free(a->head);
+    free(a);
+}
@@ -183,6 +183,25 @@ int yai_sdk_context_resolve_workspace(
 }
 
 int yai_sdk_workspace_describe(const char *ws_id, yai_sdk_workspace_info_t *out)
+{
+    return yai_sdk_workspace_describe_with(NULL, ws_id, out);
+}
+
+/* Transport failures leave the connection unfit for reuse. */
+static void release_client(yai_sdk_pool_t *pool, yai_sdk_client_t *client, int rc)
+{
+    if (!pool)
+    {
+        yai_sdk_client_close(client);
+        return;
+    }
+    yai_sdk_pool_release(pool, client,
+                         rc != YAI_SDK_SERVER_OFF && rc != YAI_SDK_TIMEOUT && rc != YAI_SDK_RPC);
+}
+
+int yai_sdk_workspace_describe_with(yai_sdk_pool_t *pool,
+                                    const char *ws_id,
+                                    yai_sdk_workspace_info_t *out)
 {
     yai_sdk_client_t *client = NULL;
     yai_sdk_client_opts_t opts = {0};
@@ -201,7 +220,10 @@ int yai_sdk_workspace_describe(const char *ws_id, yai_sdk_workspace_info_t *out)
     opts.role = "operator";
     opts.auto_handshake = 1;
 
-    rc = yai_sdk_client_open(&client, &opts);
+    if (pool)
+        rc = yai_sdk_pool_acquire(pool, ws_id, opts.role, opts.arming, &client);
+    else
+        rc = yai_sdk_client_open(&client, &opts);
     if (rc != 0)
         return rc;
 
@@ -210,12 +232,12 @@ int yai_sdk_workspace_describe(const char *ws_id, yai_sdk_workspace_info_t *out)
                  "{\"type\":\"yai.control.call.v1\",\"target_plane\":\"kernel\",\"command_id\":\"yai.kernel.ws_status\",\"argv\":[\"--ws-id\",\"%s\"]}",
                  ws_id) <= 0)
     {
-        yai_sdk_client_close(client);
+        release_client(pool, client, YAI_SDK_OK);
         return YAI_SDK_IO;
     }
 
     rc = yai_sdk_client_call_json(client, req_json, &reply);
-    yai_sdk_client_close(client);
+    release_client(pool, client, rc);
     if (rc != 0)
     {
         yai_sdk_reply_free(&reply);
@@ -0,0 +1,282 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include "crc32c.h"
+
+#include <pthread.h>
+#include <string.h>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define CRC32C_HAVE_SSE42 1
+#include <nmmintrin.h>
+#endif
+
+#if defined(__aarch64__) && (defined(__GNUC__) || defined(__clang__))
+#define CRC32C_HAVE_ARMV8 1
+#include <arm_acle.h>
+#if defined(__linux__)
+#include <sys/auxv.h>
+#ifndef HWCAP_CRC32
+#define HWCAP_CRC32 (1u << 7)
+#endif
+#endif
+#if defined(__clang__)
+#define CRC32C_TARGET_ARMV8 __attribute__((target("crc")))
+#else
+#define CRC32C_TARGET_ARMV8 __attribute__((target("+crc")))
+#endif
+#endif
+
+#define CRC32C_POLY 0x82F63B78u /* reflected Castagnoli polynomial */
+
+/* Bytes per stream in the three-way hardware loop. */
+#define CRC32C_LANE 512u
+
+/*
+ * The kernels below work on the raw register (no pre/post inversion), so
+ * state after A||B is shift(state after A, |B|) ^ raw(0, B). g_shift is
+ * that shift over CRC32C_LANE zero bytes, split into byte tables.
+ */
+static uint32_t g_table[8][256];
+static uint32_t g_shift[4][256];
+static pthread_once_t g_once = PTHREAD_ONCE_INIT;
+static yai_crc32c_fn g_active;
+static const char *g_active_name;
+
+static uint32_t raw_bytewise(uint32_t crc, const uint8_t *p, size_t n)
+{
+    while (n-- > 0) {
+        crc = g_table[0][(crc ^ *p++) & 0xFFu] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+static uint32_t load32le(const uint8_t *p)
+{
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static uint32_t raw_slice8(uint32_t crc, const uint8_t *p, size_t n)
+{
+    while (n >= 8) {
+        uint32_t lo = load32le(p) ^ crc;
+        uint32_t hi = load32le(p + 4);
+        crc = g_table[7][lo & 0xFFu] ^ g_table[6][(lo >> 8) & 0xFFu] ^
+              g_table[5][(lo >> 16) & 0xFFu] ^ g_table[4][lo >> 24] ^
+              g_table[3][hi & 0xFFu] ^ g_table[2][(hi >> 8) & 0xFFu] ^
+              g_table[1][(hi >> 16) & 0xFFu] ^ g_table[0][hi >> 24];
+        p += 8;
+        n -= 8;
+    }
+    return raw_bytewise(crc, p, n);
+}
+
+#if defined(CRC32C_HAVE_SSE42) || defined(CRC32C_HAVE_ARMV8)
+static uint32_t shift_lane(uint32_t s)
+{
+    return g_shift[0][s & 0xFFu] ^ g_shift[1][(s >> 8) & 0xFFu] ^
+           g_shift[2][(s >> 16) & 0xFFu] ^ g_shift[3][s >> 24];
+}
+
+static uint64_t load64(const uint8_t *p)
+{
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+#endif
+
+#if defined(CRC32C_HAVE_SSE42)
+/* Three independent streams keep crc32q busy despite its 3-cycle latency. */
+__attribute__((target("sse4.2"))) static uint32_t raw_sse42(uint32_t crc, const uint8_t *p, size_t n)
+{
+    uint64_t c0 = crc;
+
+    while (n > 0 && ((uintptr_t)p & 7u) != 0) {
+        c0 = _mm_crc32_u8((uint32_t)c0, *p++);
+        n--;
+    }
+    while (n >= 3 * CRC32C_LANE) {
+        uint64_t c1 = 0;
+        uint64_t c2 = 0;
+        for (size_t i = 0; i < CRC32C_LANE; i += 8) {
+            c0 = _mm_crc32_u64(c0, load64(p + i));
+            c1 = _mm_crc32_u64(c1, load64(p + CRC32C_LANE + i));
+            c2 = _mm_crc32_u64(c2, load64(p + 2 * CRC32C_LANE + i));
+        }
+        c0 = shift_lane(shift_lane((uint32_t)c0) ^ (uint32_t)c1) ^ (uint32_t)c2;
+        p += 3 * CRC32C_LANE;
+        n -= 3 * CRC32C_LANE;
+    }
+    while (n >= 8) {
+        c0 = _mm_crc32_u64(c0, load64(p));
+        p += 8;
+        n -= 8;
+    }
+    while (n > 0) {
+        c0 = _mm_crc32_u8((uint32_t)c0, *p++);
+        n--;
+    }
+    return (uint32_t)c0;
+}
+
+static int have_sse42(void)
+{
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse4.2");
+}
+#endif
+
+#if defined(CRC32C_HAVE_ARMV8)
+CRC32C_TARGET_ARMV8 static uint32_t raw_armv8(uint32_t crc, const uint8_t *p, size_t n)
+{
+    while (n > 0 && ((uintptr_t)p & 7u) != 0) {
+        crc = __crc32cb(crc, *p++);
+        n--;
+    }
+    while (n >= 3 * CRC32C_LANE) {
+        uint32_t c1 = 0;
+        uint32_t c2 = 0;
+        for (size_t i = 0; i < CRC32C_LANE; i += 8) {
+            crc = __crc32cd(crc, load64(p + i));
+            c1 = __crc32cd(c1, load64(p + CRC32C_LANE + i));
+            c2 = __crc32cd(c2, load64(p + 2 * CRC32C_LANE + i));
+        }
+        crc = shift_lane(shift_lane(crc) ^ c1) ^ c2;
+        p += 3 * CRC32C_LANE;
+        n -= 3 * CRC32C_LANE;
+    }
+    while (n >= 8) {
+        crc = __crc32cd(crc, load64(p));
+        p += 8;
+        n -= 8;
+    }
+    while (n > 0) {
+        crc = __crc32cb(crc, *p++);
+        n--;
+    }
+    return crc;
+}
+
+static int have_armv8(void)
+{
+#if defined(__ARM_FEATURE_CRC32)
+    return 1;
+#elif defined(__linux__)
+    return (getauxval(AT_HWCAP) & HWCAP_CRC32) != 0;
+#else
+    return 0;
+#endif
+}
+#endif
+
+static uint32_t crc32c_bytewise(uint32_t crc, const void *p, size_t n)
+{
+    return ~raw_bytewise(~crc, (const uint8_t *)p, n);
+}
+
+static uint32_t crc32c_slice8(uint32_t crc, const void *p, size_t n)
+{
+    return ~raw_slice8(~crc, (const uint8_t *)p, n);
+}
+
+#if defined(CRC32C_HAVE_SSE42)
+static uint32_t crc32c_sse42(uint32_t crc, const void *p, size_t n)
+{
+    return ~raw_sse42(~crc, (const uint8_t *)p, n);
+}
+#endif
+
+#if defined(CRC32C_HAVE_ARMV8)
+static uint32_t crc32c_armv8(uint32_t crc, const void *p, size_t n)
+{
+    return ~raw_armv8(~crc, (const uint8_t *)p, n);
+}
+#endif
+
+static void crc32c_init(void)
+{
+    static const uint8_t zeros[CRC32C_LANE];
+    uint32_t basis[32];
+
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; k++) {
+            c = (c & 1u) ? (c >> 1) ^ CRC32C_POLY : c >> 1;
+        }
+        g_table[0][i] = c;
+    }
+    for (uint32_t i = 0; i < 256; i++) {
+        for (int t = 1; t < 8; t++) {
+            uint32_t prev = g_table[t - 1][i];
+            g_table[t][i] = (prev >> 8) ^ g_table[0][prev & 0xFFu];
+        }
+    }
+
+    /* the lane shift is linear: image of each state bit, then byte tables */
+    for (int b = 0; b < 32; b++) {
+        basis[b] = raw_bytewise(1u << b, zeros, sizeof(zeros));
+    }
+    for (int t = 0; t < 4; t++) {
+        for (uint32_t v = 0; v < 256; v++) {
+            uint32_t s = 0;
+            for (int b = 0; b < 8; b++) {
+                if (v & (1u << b)) {
+                    s ^= basis[8 * t + b];
+                }
+            }
+            g_shift[t][v] = s;
+        }
+    }
+
+    g_active = crc32c_slice8;
+    g_active_name = "slice8";
+#if defined(CRC32C_HAVE_SSE42)
+    if (have_sse42()) {
+        g_active = crc32c_sse42;
+        g_active_name = "sse4.2";
+    }
+#endif
+#if defined(CRC32C_HAVE_ARMV8)
+    if (have_armv8()) {
+        g_active = crc32c_armv8;
+        g_active_name = "armv8";
+    }
+#endif
+}
+
+uint32_t yai_crc32c(uint32_t crc, const void *p, size_t n)
+{
+    pthread_once(&g_once, crc32c_init);
+    return g_active(crc, p, n);
+}
+
+const char *yai_crc32c_active(void)
+{
+    pthread_once(&g_once, crc32c_init);
+    return g_active_name;
+}
+
+yai_crc32c_fn yai_crc32c_kernel(const char *name)
+{
+    pthread_once(&g_once, crc32c_init);
+    if (!name) {
+        return NULL;
+    }
+    if (strcmp(name, "bytewise") == 0) {
+        return crc32c_bytewise;
+    }
+    if (strcmp(name, "slice8") == 0) {
+        return crc32c_slice8;
+    }
+#if defined(CRC32C_HAVE_SSE42)
+    if (strcmp(name, "sse4.2") == 0 && have_sse42()) {
+        return crc32c_sse42;
+    }
+#endif
+#if defined(CRC32C_HAVE_ARMV8)
+    if (strcmp(name, "armv8") == 0 && have_armv8()) {
+        return crc32c_armv8;
+    }
+#endif
+    return NULL;
+}
@@ -0,0 +1,24 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * CRC32C (Castagnoli), the envelope checksum of YAI_RPC_CAP_CHECKSUM.
+ * yai_crc32c(0, p, n) is the standard value ("123456789" -> 0xE3069283);
+ * passing a previous result continues it over more bytes.
+ *
+ * The kernel is picked once per process: SSE4.2 crc32q on x86-64, the
+ * ARMv8 CRC32 extension on aarch64, slice-by-8 tables otherwise.
+ */
+
+typedef uint32_t (*yai_crc32c_fn)(uint32_t crc, const void *p, size_t n);
+
+uint32_t yai_crc32c(uint32_t crc, const void *p, size_t n);
+
+/* Name of the kernel yai_crc32c runs ("sse4.2", "armv8" or "slice8"). */
+const char *yai_crc32c_active(void);
+
+/* A kernel by name (also "bytewise"), NULL if this CPU or build lacks it. */
+yai_crc32c_fn yai_crc32c_kernel(const char *name);
@@ -1,35 +1,403 @@
 /* SPDX-License-Identifier: Apache-2.0 */
 
 #include <yai_sdk/log.h>
+#include <yai_sdk/errors.h>
 
+#include "log_internal.h"
+
+#include <pthread.h>
 #include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define LOG_OFF (YAI_SDK_LOG_ERROR + 1)
+
+_Atomic int yai_log_threshold = LOG_OFF;
 
 static yai_sdk_log_handler_t g_log_handler = NULL;
 static void *g_log_user_data = NULL;
-static yai_sdk_log_level_t g_min_log_level = YAI_SDK_LOG_WARN;
+static yai_sdk_log_event_handler_t g_event_handler = NULL;
+static void *g_event_user_data = NULL;
+static _Atomic int g_min_log_level = YAI_SDK_LOG_WARN;
+
+static void update_threshold(void)
+{
+    int on = g_log_handler != NULL || g_event_handler != NULL;
+    atomic_store_explicit(&yai_log_threshold,
+                          on ? atomic_load_explicit(&g_min_log_level, memory_order_relaxed) : LOG_OFF,
+                          memory_order_relaxed);
+}
 
 void yai_sdk_set_log_handler(yai_sdk_log_handler_t handler, void *user_data)
 {
     g_log_handler = handler;
     g_log_user_data = user_data;
+    update_threshold();
+}
+
+void yai_sdk_set_log_event_handler(yai_sdk_log_event_handler_t handler, void *user_data)
+{
+    g_event_handler = handler;
+    g_event_user_data = user_data;
+    update_threshold();
 }
 
 void yai_sdk_set_log_level(yai_sdk_log_level_t level)
 {
-    g_min_log_level = level;
+    atomic_store_explicit(&g_min_log_level, (int)level, memory_order_relaxed);
+    update_threshold();
 }
 
 yai_sdk_log_level_t yai_sdk_get_log_level(void)
 {
-    return g_min_log_level;
+    return (yai_sdk_log_level_t)atomic_load_explicit(&g_min_log_level, memory_order_relaxed);
+}
+
+/* ============================================================
+   FORMAT
+   ============================================================ */
+
+typedef struct text_out {
+    char *buf;
+    size_t cap;
+    size_t len;
+} text_out_t;
+
+static void put_char(text_out_t *t, char ch)
+{
+    if (t->len + 1 < t->cap) {
+        t->buf[t->len] = ch;
+        t->buf[t->len + 1] = '\0';
+    }
+    t->len++;
+}
+
+static void put_str(text_out_t *t, const char *s)
+{
+    while (*s) put_char(t, *s++);
+}
+
+static void put_u64(text_out_t *t, uint64_t v)
+{
+    char digits[20];
+    int n = 0;
+    do {
+        digits[n++] = (char)('0' + v % 10u);
+        v /= 10u;
+    } while (v);
+    while (n > 0) put_char(t, digits[--n]);
+}
+
+static int needs_quotes(const char *s)
+{
+    if (!s[0]) return 1;
+    for (; *s; s++) {
+        if (*s == ' ' || *s == '"' || *s == '=' || *s == '\\' || (unsigned char)*s < 0x20) return 1;
+    }
+    return 0;
+}
+
+static void put_value(text_out_t *t, const yai_sdk_log_field_t *f)
+{
+    if (f->kind == YAI_SDK_LOG_FIELD_INT) {
+        if (f->v.i64 < 0) {
+            put_char(t, '-');
+            put_u64(t, (uint64_t)0 - (uint64_t)f->v.i64);
+        } else {
+            put_u64(t, (uint64_t)f->v.i64);
+        }
+        return;
+    }
+    if (f->kind == YAI_SDK_LOG_FIELD_UINT) {
+        put_u64(t, f->v.u64);
+        return;
+    }
+
+    const char *s = f->v.str ? f->v.str : "";
+    if (!needs_quotes(s)) {
+        put_str(t, s);
+        return;
+    }
+    put_char(t, '"');
+    for (; *s; s++) {
+        if (*s == '"' || *s == '\\') {
+            put_char(t, '\\');
+        }
+        put_char(t, ((unsigned char)*s < 0x20) ? ' ' : *s);
+    }
+    put_char(t, '"');
+}
+
+size_t yai_sdk_log_format(const yai_sdk_log_event_t *ev, char *buf, size_t cap)
+{
+    text_out_t t = {buf, buf ? cap : 0, 0};
+
+    if (t.cap > 0) t.buf[0] = '\0';
+    if (!ev) return 0;
+    put_str(&t, ev->message ? ev->message : "");
+    for (size_t i = 0; i < ev->field_count; i++) {
+        put_char(&t, ' ');
+        put_str(&t, ev->fields[i].key ? ev->fields[i].key : "?");
+        put_char(&t, '=');
+        put_value(&t, &ev->fields[i]);
+    }
+    return t.len;
+}
+
+/* Hands an event to whichever handler is set; the text is only built here. */
+static void deliver(const yai_sdk_log_event_t *ev)
+{
+    yai_sdk_log_event_handler_t eh = g_event_handler;
+    yai_sdk_log_handler_t sh = g_log_handler;
+
+    if (eh) {
+        eh(ev, g_event_user_data);
+        return;
+    }
+    if (!sh) return;
+    if (ev->field_count == 0) {
+        sh(ev->level, ev->component, ev->message, g_log_user_data);
+        return;
+    }
+    char text[512];
+    yai_sdk_log_format(ev, text, sizeof(text));
+    sh(ev->level, ev->component, text, g_log_user_data);
+}
+
+/* ============================================================
+   ASYNC SINK
+   ============================================================ */
+
+#define SLOT_FIELDS 8u
+#define SLOT_TEXT 256u
+#define RING_DEFAULT 256u
+#define DRAIN_IDLE_NS 1000000L
+
+typedef struct log_slot {
+    yai_sdk_log_level_t level;
+    uint32_t field_count;
+    uint64_t time_ns;
+    const char *component;
+    const char *message;
+    yai_sdk_log_field_t fields[SLOT_FIELDS];
+    /* component, message and string values, all pointing in here */
+    char text[SLOT_TEXT];
+} log_slot_t;
+
+/* Single producer (the owning thread), single consumer (the drain thread). */
+typedef struct log_ring {
+    struct log_ring *next;
+    _Atomic int orphaned;
+    size_t mask;
+    _Atomic size_t head;
+    char pad[64];
+    _Atomic size_t tail;
+    log_slot_t slots[];
+} log_ring_t;
+
+static _Atomic(log_ring_t *) g_rings = NULL;
+static _Atomic int g_async_on = 0;
+static _Atomic int g_async_run = 0;
+static _Atomic uint64_t g_dropped = 0;
+static size_t g_ring_events = RING_DEFAULT;
+static pthread_t g_drain_thread;
+static pthread_once_t g_key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t g_ring_key;
+static _Thread_local log_ring_t *t_ring = NULL;
+
+/* The thread is gone: the drain thread frees its ring once it is empty. */
+static void ring_orphan(void *p)
+{
+    t_ring = NULL; /* a later destructor that logs gets a fresh ring */
+    atomic_store_explicit(&((log_ring_t *)p)->orphaned, 1, memory_order_release);
+}
+
+static void ring_key_init(void)
+{
+    pthread_key_create(&g_ring_key, ring_orphan);
+}
+
+static log_ring_t *ring_attach(void)
+{
+    size_t n = g_ring_events;
+    log_ring_t *r = (log_ring_t *)calloc(1, sizeof(*r) + n * sizeof(log_slot_t));
+
+    if (!r) return NULL;
+    r->mask = n - 1u;
+    pthread_once(&g_key_once, ring_key_init);
+    pthread_setspecific(g_ring_key, r);
+    r->next = atomic_load_explicit(&g_rings, memory_order_relaxed);
+    while (!atomic_compare_exchange_weak_explicit(&g_rings, &r->next, r, memory_order_release,
+                                                  memory_order_relaxed)) {
+    }
+    t_ring = r;
+    return r;
+}
+
+/* Copies v into s->text at *used, truncated to what is left. */
+static const char *slot_text(log_slot_t *s, size_t *used, const char *v)
+{
+    char *out = s->text + *used;
+    size_t n = strlen(v ? v : "");
+    size_t room = SLOT_TEXT - 1u - *used;
+
+    if (n > room) n = room;
+    memcpy(out, v ? v : "", n);
+    out[n] = '\0';
+    *used += n;
+    if (*used < SLOT_TEXT - 1u) (*used)++;
+    return out;
+}
+
+/* Copies ev into the calling thread's ring; -1 when it has none. */
+static int ring_push(const yai_sdk_log_event_t *ev)
+{
+    log_ring_t *r = t_ring ? t_ring : ring_attach();
+    if (!r) return -1;
+
+    size_t head = atomic_load_explicit(&r->head, memory_order_relaxed);
+    if (head - atomic_load_explicit(&r->tail, memory_order_acquire) > r->mask) {
+        atomic_fetch_add_explicit(&g_dropped, 1, memory_order_relaxed);
+        return 0;
+    }
+
+    log_slot_t *s = &r->slots[head & r->mask];
+    size_t used = 0;
+    s->level = ev->level;
+    s->time_ns = ev->time_ns;
+    /* the caller's strings may be gone by the time the drain thread runs */
+    s->component = slot_text(s, &used, ev->component);
+    s->message = slot_text(s, &used, ev->message);
+    s->field_count = (uint32_t)((ev->field_count < SLOT_FIELDS) ? ev->field_count : SLOT_FIELDS);
+    for (uint32_t i = 0; i < s->field_count; i++) {
+        s->fields[i] = ev->fields[i];
+        if (ev->fields[i].kind != YAI_SDK_LOG_FIELD_STR) continue;
+        s->fields[i].v.str = slot_text(s, &used, ev->fields[i].v.str);
+    }
+    atomic_store_explicit(&r->head, head + 1u, memory_order_release);
+    return 0;
+}
+
+static size_t ring_drain(log_ring_t *r)
+{
+    size_t tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    size_t head = atomic_load_explicit(&r->head, memory_order_acquire);
+
+    for (size_t i = tail; i != head; i++) {
+        const log_slot_t *s = &r->slots[i & r->mask];
+        yai_sdk_log_event_t ev = {s->level, s->component, s->message, s->fields, s->field_count, s->time_ns};
+        deliver(&ev);
+        atomic_store_explicit(&r->tail, i + 1u, memory_order_release);
+    }
+    return head - tail;
+}
+
+static size_t drain_all(void)
+{
+    log_ring_t *prev = NULL;
+    log_ring_t *r = atomic_load_explicit(&g_rings, memory_order_acquire);
+    size_t n = 0;
+
+    while (r) {
+        log_ring_t *next = r->next;
+        int orphaned = atomic_load_explicit(&r->orphaned, memory_order_acquire);
+        n += ring_drain(r);
+        if (!orphaned) {
+            prev = r;
+            r = next;
+            continue;
+        }
+        /* unlink: only this thread edits links below the head; a ring
+           pushed meanwhile makes the head exchange fail, then try later */
+        if (prev) {
+            prev->next = next;
+            free(r);
+        } else {
+            log_ring_t *expect = r;
+            if (atomic_compare_exchange_strong_explicit(&g_rings, &expect, next, memory_order_acq_rel,
+                                                        memory_order_acquire)) {
+                free(r);
+            } else {
+                prev = r;
+            }
+        }
+        r = next;
+    }
+    return n;
+}
+
+static void *drain_main(void *arg)
+{
+    (void)arg;
+    while (atomic_load_explicit(&g_async_run, memory_order_acquire)) {
+        if (drain_all() == 0) {
+            struct timespec ts = {0, DRAIN_IDLE_NS};
+            nanosleep(&ts, NULL);
+        }
+    }
+    drain_all();
+    return NULL;
+}
+
+int yai_sdk_log_async_start(size_t ring_events)
+{
+    size_t n = 2;
+
+    if (atomic_load_explicit(&g_async_run, memory_order_acquire)) return YAI_SDK_BAD_ARGS;
+    if (ring_events == 0) ring_events = RING_DEFAULT;
+    while (n < ring_events && n < ((size_t)1 << 20)) n <<= 1;
+    g_ring_events = n;
+
+    atomic_store_explicit(&g_async_run, 1, memory_order_release);
+    if (pthread_create(&g_drain_thread, NULL, drain_main, NULL) != 0) {
+        atomic_store_explicit(&g_async_run, 0, memory_order_release);
+        return YAI_SDK_IO;
+    }
+    atomic_store_explicit(&g_async_on, 1, memory_order_release);
+    return YAI_SDK_OK;
+}
+
+void yai_sdk_log_async_stop(void)
+{
+    if (!atomic_load_explicit(&g_async_run, memory_order_acquire)) return;
+    atomic_store_explicit(&g_async_on, 0, memory_order_release);
+    atomic_store_explicit(&g_async_run, 0, memory_order_release);
+    pthread_join(g_drain_thread, NULL);
+}
+
+uint64_t yai_sdk_log_async_dropped(void)
+{
+    return atomic_load_explicit(&g_dropped, memory_order_relaxed);
+}
+
+/* ============================================================
+   EMIT
+   ============================================================ */
+
+void yai_log_event(yai_sdk_log_level_t level,
+                   const char *component,
+                   const char *message,
+                   const yai_sdk_log_field_t *fields,
+                   size_t field_count)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+
+    yai_sdk_log_event_t ev = {
+        level,
+        (component && component[0]) ? component : "sdk",
+        message ? message : "",
+        fields,
+        fields ? field_count : 0,
+        (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec,
+    };
+    if (atomic_load_explicit(&g_async_on, memory_order_acquire) && ring_push(&ev) == 0) return;
+    deliver(&ev);
 }
 
 void yai_sdk_log_emit(yai_sdk_log_level_t level, const char *component, const char *message)
 {
-    if (!g_log_handler) return;
-    if (level < g_min_log_level) return;
-    g_log_handler(level,
-                  (component && component[0]) ? component : "sdk",
-                  (message && message[0]) ? message : "",
-                  g_log_user_data);
+    if (!yai_log_enabled(level)) return;
+    yai_log_event(level, component, message, NULL, 0);
 }
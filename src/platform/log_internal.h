@@ -3,4 +3,43 @@
 
 #include <yai_sdk/log.h>
 
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Lowest level that reaches a handler, or above ERROR while none is set:
+ * one relaxed load decides whether an event is built at all.
+ */
+extern _Atomic int yai_log_threshold;
+
+static inline int yai_log_enabled(yai_sdk_log_level_t level)
+{
+    return (int)level >= atomic_load_explicit(&yai_log_threshold, memory_order_relaxed);
+}
+
+/*
+ * Emits one event. component, message and the field keys must be string
+ * literals (the async sink keeps the pointers); string values are copied.
+ */
+void yai_log_event(yai_sdk_log_level_t level,
+                   const char *component,
+                   const char *message,
+                   const yai_sdk_log_field_t *fields,
+                   size_t field_count);
+
 void yai_sdk_log_emit(yai_sdk_log_level_t level, const char *component, const char *message);
+
+#define YAI_LOG_STR(k, s) ((yai_sdk_log_field_t){.key = (k), .kind = YAI_SDK_LOG_FIELD_STR, .v.str = (s)})
+#define YAI_LOG_INT(k, n) ((yai_sdk_log_field_t){.key = (k), .kind = YAI_SDK_LOG_FIELD_INT, .v.i64 = (int64_t)(n)})
+#define YAI_LOG_UINT(k, n) ((yai_sdk_log_field_t){.key = (k), .kind = YAI_SDK_LOG_FIELD_UINT, .v.u64 = (uint64_t)(n)})
+
+/* Structured event; the fields are only evaluated when the level is enabled. */
+#define YAI_LOG(level, component, message, ...)                                      \
+    do {                                                                             \
+        if (yai_log_enabled(level)) {                                                \
+            const yai_sdk_log_field_t yai_log_fields_[] = {__VA_ARGS__};             \
+            yai_log_event((level), (component), (message), yai_log_fields_,          \
+                          sizeof(yai_log_fields_) / sizeof(yai_log_fields_[0]));     \
+        }                                                                            \
+    } while (0)
@@ -0,0 +1,440 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include "lz4_block.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Block layout: sequences of
+ *   token (literal length << 4 | match length - 4), literal length
+ *   extension bytes, literals, 16-bit LE match offset, match length
+ *   extension bytes,
+ * where a nibble of 15 continues in bytes of 255 plus a final remainder.
+ * The last sequence is literals only. Format rules: the last 5 bytes are
+ * literals and no match starts within the last 12 bytes.
+ */
+#define LZ4_MINMATCH 4u
+#define LZ4_LASTLITERALS 5u
+#define LZ4_MFLIMIT 12u
+#define LZ4_MAX_OFFSET 65535u
+#define LZ4_HASH_LOG 12u
+/* after 2^6 misses in a row the scan step grows, so noise is skipped fast */
+#define LZ4_SKIP_SHIFT 6u
+
+static uint32_t read32(const uint8_t *p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+/* Equal bytes at p and r, stopping at limit; a word at a time where it can. */
+static size_t count_match(const uint8_t *p, const uint8_t *r, const uint8_t *limit)
+{
+    const uint8_t *start = p;
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    while ((size_t)(limit - p) >= sizeof(uint64_t)) {
+        uint64_t a;
+        uint64_t b;
+        memcpy(&a, p, sizeof(a));
+        memcpy(&b, r, sizeof(b));
+        if (a != b) {
+            return (size_t)(p - start) + ((unsigned)__builtin_ctzll(a ^ b) >> 3);
+        }
+        p += sizeof(uint64_t);
+        r += sizeof(uint64_t);
+    }
+#endif
+    while (p < limit && *p == *r) {
+        p++;
+        r++;
+    }
+    return (size_t)(p - start);
+}
+
+static uint32_t lz4_hash(uint32_t v)
+{
+    return (v * 2654435761u) >> (32u - LZ4_HASH_LOG);
+}
+
+size_t yai_lz4_bound(size_t n)
+{
+    return n + n / 255u + 16u;
+}
+
+static uint8_t *put_length(uint8_t *op, size_t len)
+{
+    while (len >= 255u) {
+        *op++ = 255u;
+        len -= 255u;
+    }
+    *op++ = (uint8_t)len;
+    return op;
+}
+
+/* Room for one sequence with `lit` literals and a match of `mlen` extra bytes. */
+static int fits(const uint8_t *op, const uint8_t *oend, size_t lit, size_t mlen)
+{
+    return (size_t)(oend - op) >= 1u + lit / 255u + 1u + lit + 2u + mlen / 255u + 1u;
+}
+
+size_t yai_lz4_compress(const void *src_v, size_t n, void *dst_v, size_t cap)
+{
+    const uint8_t *src = (const uint8_t *)src_v;
+    const uint8_t *end = src + n;
+    const uint8_t *anchor = src;
+    uint8_t *op = (uint8_t *)dst_v;
+    uint8_t *oend = op + cap;
+    uint32_t table[1u << LZ4_HASH_LOG];
+
+    if (!src_v || !dst_v || n > UINT32_MAX) {
+        return 0;
+    }
+    if (n > LZ4_MFLIMIT) {
+        const uint8_t *mflimit = end - LZ4_MFLIMIT;
+        const uint8_t *matchlimit = end - LZ4_LASTLITERALS;
+        const uint8_t *ip = src + 1;
+
+        /* stale or empty slots are caught by the byte compare below */
+        memset(table, 0, sizeof(table));
+        while (ip < mflimit) {
+            uint32_t seq = read32(ip);
+            uint32_t h = lz4_hash(seq);
+            const uint8_t *ref = src + table[h];
+
+            table[h] = (uint32_t)(ip - src);
+            if (ref >= ip || (size_t)(ip - ref) > LZ4_MAX_OFFSET || read32(ref) != seq) {
+                ip += 1u + ((size_t)(ip - anchor) >> LZ4_SKIP_SHIFT);
+                continue;
+            }
+            while (ip > anchor && ref > src && ip[-1] == ref[-1]) {
+                ip--;
+                ref--;
+            }
+
+            const uint8_t *m = ip + LZ4_MINMATCH;
+            m += count_match(m, ref + LZ4_MINMATCH, matchlimit);
+
+            size_t lit = (size_t)(ip - anchor);
+            size_t mlen = (size_t)(m - ip) - LZ4_MINMATCH;
+            size_t off = (size_t)(ip - ref);
+            if (!fits(op, oend, lit, mlen)) {
+                return 0;
+            }
+            uint8_t *token = op++;
+            *token = (uint8_t)((lit >= 15u ? 15u : lit) << 4);
+            if (lit >= 15u) {
+                op = put_length(op, lit - 15u);
+            }
+            memcpy(op, anchor, lit);
+            op += lit;
+            *op++ = (uint8_t)(off & 0xFFu);
+            *op++ = (uint8_t)(off >> 8);
+            *token |= (uint8_t)(mlen >= 15u ? 15u : mlen);
+            if (mlen >= 15u) {
+                op = put_length(op, mlen - 15u);
+            }
+
+            ip = m;
+            anchor = ip;
+            if (ip < mflimit) {
+                /* seed the table inside the match so the next one is found sooner */
+                table[lz4_hash(read32(ip - 2))] = (uint32_t)(ip - 2 - src);
+            }
+        }
+    }
+
+    size_t lit = (size_t)(end - anchor);
+    if ((size_t)(oend - op) < 1u + lit / 255u + 1u + lit) {
+        return 0;
+    }
+    *op++ = (uint8_t)((lit >= 15u ? 15u : lit) << 4);
+    if (lit >= 15u) {
+        op = put_length(op, lit - 15u);
+    }
+    memcpy(op, anchor, lit);
+    op += lit;
+    return (size_t)(op - (uint8_t *)dst_v);
+}
+
+/* Adds extension bytes to a 15 nibble; -1 past the end of input. */
+static int get_length(const uint8_t **ip, const uint8_t *iend, size_t *len)
+{
+    uint8_t b;
+    do {
+        if (*ip >= iend) {
+            return -1;
+        }
+        b = *(*ip)++;
+        *len += b;
+    } while (b == 255u);
+    return 0;
+}
+
+/* Writes mlen bytes at op from `off` bytes back; the two may overlap. */
+static void copy_match(uint8_t *op, size_t off, size_t mlen)
+{
+    const uint8_t *m = op - off;
+
+    if (off >= mlen) {
+        memcpy(op, m, mlen);
+    } else if (off == 1) {
+        memset(op, *m, mlen);
+    } else {
+        /* overlapping copy repeats the last `off` bytes: each pass copies
+           whole periods from m, so source and destination never overlap
+           and the copy doubles */
+        size_t done = 0;
+        while (done < mlen) {
+            size_t step = off + done;
+            if (step > mlen - done) {
+                step = mlen - done;
+            }
+            memcpy(op + done, m, step);
+            done += step;
+        }
+    }
+}
+
+int yai_lz4_decompress(const void *src_v, size_t n, void *dst_v, size_t raw_len)
+{
+    const uint8_t *ip = (const uint8_t *)src_v;
+    const uint8_t *iend = ip + n;
+    uint8_t *dst = (uint8_t *)dst_v;
+    uint8_t *op = dst;
+    uint8_t *oend = dst + raw_len;
+
+    if (!src_v || (!dst_v && raw_len > 0)) {
+        return -1;
+    }
+    for (;;) {
+        if (ip >= iend) {
+            return -1;
+        }
+        unsigned token = *ip++;
+        size_t lit = token >> 4;
+        if (lit == 15u && get_length(&ip, iend, &lit) != 0) {
+            return -1;
+        }
+        if ((size_t)(iend - ip) < lit || (size_t)(oend - op) < lit) {
+            return -1;
+        }
+        memcpy(op, ip, lit);
+        op += lit;
+        ip += lit;
+        if (ip == iend) {
+            break; /* the last sequence has no match */
+        }
+
+        if (iend - ip < 2) {
+            return -1;
+        }
+        size_t off = (size_t)ip[0] | (size_t)ip[1] << 8;
+        ip += 2;
+        if (off == 0 || off > (size_t)(op - dst)) {
+            return -1;
+        }
+        size_t mlen = token & 15u;
+        if (mlen == 15u && get_length(&ip, iend, &mlen) != 0) {
+            return -1;
+        }
+        mlen += LZ4_MINMATCH;
+        if ((size_t)(oend - op) < mlen) {
+            return -1;
+        }
+
+        copy_match(op, off, mlen);
+        op += mlen;
+    }
+    return (op == oend) ? 0 : -1;
+}
+
+/* ============================================================
+   STREAMING DECODE
+   ============================================================ */
+
+#define LZ4_WINDOW 65536u
+
+enum {
+    LZ4S_TOKEN,
+    LZ4S_LIT_LEN,
+    LZ4S_LITERALS,
+    LZ4S_OFFSET,
+    LZ4S_MATCH_LEN,
+    LZ4S_MATCH,
+    LZ4S_DONE,
+};
+
+int yai_lz4_stream_init(yai_lz4_stream_t *s, size_t n, size_t raw_len, size_t flush, yai_lz4_sink_fn sink, void *user)
+{
+    memset(s, 0, sizeof(*s));
+    s->sink = sink;
+    s->user = user;
+    s->flush = flush ? flush : 1u;
+    s->raw_len = raw_len;
+    s->in_left = n;
+    s->cap = (raw_len < LZ4_WINDOW ? raw_len : LZ4_WINDOW) + s->flush;
+    s->buf = (uint8_t *)malloc(s->cap);
+    return s->buf ? 0 : -1;
+}
+
+void yai_lz4_stream_free(yai_lz4_stream_t *s)
+{
+    if (s) {
+        free(s->buf);
+        s->buf = NULL;
+    }
+}
+
+/* Hands pending output to the sink once a flush is due (or always, if all). */
+static int stream_emit(yai_lz4_stream_t *s, int all)
+{
+    size_t n = s->pos - s->emitted;
+
+    if (n == 0 || (!all && n < s->flush)) {
+        return 0;
+    }
+    s->emitted = s->pos;
+    return s->sink(s->user, s->buf + s->pos - n, n) != 0 ? 1 : 0;
+}
+
+/*
+ * Makes room for more output, keeping the match window, and returns how
+ * many bytes may be written before the next flush (0 when the sink stopped).
+ */
+static size_t stream_room(yai_lz4_stream_t *s)
+{
+    size_t keep;
+    size_t room;
+
+    if (stream_emit(s, s->pos == s->cap) != 0) {
+        return 0;
+    }
+    if (s->pos == s->cap) {
+        keep = s->pos < LZ4_WINDOW ? s->pos : LZ4_WINDOW;
+        memmove(s->buf, s->buf + s->pos - keep, keep);
+        s->pos = s->emitted = keep;
+    }
+    room = s->flush - (s->pos - s->emitted);
+    return (room < s->cap - s->pos) ? room : s->cap - s->pos;
+}
+
+/* Reads one length extension byte; 1 once the length is complete. */
+static int stream_len_byte(yai_lz4_stream_t *s, uint8_t b)
+{
+    s->len += b;
+    return b != 255u;
+}
+
+int yai_lz4_stream_feed(yai_lz4_stream_t *s, const void *in_v, size_t n)
+{
+    const uint8_t *ip = (const uint8_t *)in_v;
+    const uint8_t *iend = ip + n;
+
+    if (n > s->in_left) {
+        return -1;
+    }
+    s->in_left -= n;
+
+    while (ip < iend || s->state == LZ4S_MATCH || (s->state == LZ4S_LITERALS && s->len == 0)) {
+        switch (s->state) {
+        case LZ4S_TOKEN:
+            s->token = *ip++;
+            s->len = s->token >> 4;
+            s->state = (s->len == 15u) ? LZ4S_LIT_LEN : LZ4S_LITERALS;
+            break;
+        case LZ4S_LIT_LEN:
+            if (stream_len_byte(s, *ip++)) {
+                s->state = LZ4S_LITERALS;
+            }
+            break;
+        case LZ4S_LITERALS:
+            if (s->len > 0) {
+                size_t k = stream_room(s);
+                if (k == 0) {
+                    return 1;
+                }
+                if (k > (size_t)(iend - ip)) {
+                    k = (size_t)(iend - ip);
+                }
+                if (k > s->len) {
+                    k = s->len;
+                }
+                if (k > s->raw_len - s->produced) {
+                    return -1;
+                }
+                memcpy(s->buf + s->pos, ip, k);
+                ip += k;
+                s->pos += k;
+                s->produced += k;
+                s->len -= k;
+                if (s->len > 0) {
+                    break;
+                }
+            }
+            if (ip == iend && s->in_left == 0) {
+                /* the last sequence is literals only */
+                s->state = LZ4S_DONE;
+                return (s->produced == s->raw_len) ? stream_emit(s, 1) : -1;
+            }
+            s->state = LZ4S_OFFSET;
+            s->off = 0;
+            s->off_bytes = 0;
+            if (ip == iend) {
+                return stream_emit(s, 0);
+            }
+            break;
+        case LZ4S_OFFSET:
+            s->off |= (size_t)*ip++ << (8 * s->off_bytes);
+            if (++s->off_bytes < 2) {
+                break;
+            }
+            if (s->off == 0 || s->off > s->produced) {
+                return -1;
+            }
+            s->len = s->token & 15u;
+            s->state = (s->len == 15u) ? LZ4S_MATCH_LEN : LZ4S_MATCH;
+            if (s->state == LZ4S_MATCH) {
+                s->len += LZ4_MINMATCH;
+            }
+            break;
+        case LZ4S_MATCH_LEN:
+            if (stream_len_byte(s, *ip++)) {
+                s->len += LZ4_MINMATCH;
+                s->state = LZ4S_MATCH;
+            }
+            break;
+        case LZ4S_MATCH:
+            if (s->len > s->raw_len - s->produced) {
+                return -1;
+            }
+            while (s->len > 0) {
+                size_t k = stream_room(s);
+                if (k == 0) {
+                    return 1;
+                }
+                if (k > s->len) {
+                    k = s->len;
+                }
+                copy_match(s->buf + s->pos, s->off, k);
+                s->pos += k;
+                s->produced += k;
+                s->len -= k;
+            }
+            s->state = LZ4S_TOKEN;
+            if (stream_emit(s, 0) != 0) {
+                return 1;
+            }
+            break;
+        default:
+            return -1; /* input past the end of the block */
+        }
+    }
+    return stream_emit(s, 0);
+}
+
+int yai_lz4_stream_end(const yai_lz4_stream_t *s)
+{
+    return (s->state == LZ4S_DONE) ? 0 : -1;
+}
@@ -0,0 +1,59 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Dependency-free codec for the LZ4 block format (no frame header, no
+ * dictionary), used for YAI_RPC_FLAG_COMPRESSED payloads. Output decodes
+ * with any LZ4_decompress_safe, and blocks from LZ4_compress_default
+ * decode here. The compressor is the single-pass greedy kind: fast, with
+ * a ratio that pays off on repetitive JSON.
+ */
+
+/* Largest compressed size of n input bytes. */
+size_t yai_lz4_bound(size_t n);
+
+/* Compressed size, or 0 when it does not fit in cap. */
+size_t yai_lz4_compress(const void *src, size_t n, void *dst, size_t cap);
+
+/* 0 when src decodes to exactly raw_len bytes in dst, -1 when malformed. */
+int yai_lz4_decompress(const void *src, size_t n, void *dst, size_t raw_len);
+
+/*
+ * Incremental decoder for one block whose compressed and raw sizes are
+ * known up front. Input may arrive in pieces of any size; output goes to
+ * `sink` in pieces of about `flush` bytes. Only the 64 KiB match window and
+ * one flush are held, however large the block.
+ */
+typedef int (*yai_lz4_sink_fn)(void *user, const void *out, size_t len);
+
+typedef struct yai_lz4_stream {
+    yai_lz4_sink_fn sink;
+    void *user;
+    uint8_t *buf;     /* match window plus pending output */
+    size_t cap;
+    size_t flush;
+    size_t pos;       /* decoded bytes in buf */
+    size_t emitted;   /* of which the sink has seen */
+    uint64_t produced;
+    uint64_t raw_len;
+    size_t in_left;   /* compressed bytes still to come */
+    int state;
+    unsigned token;
+    size_t len;       /* literal or match length in progress */
+    size_t off;
+    int off_bytes;
+} yai_lz4_stream_t;
+
+/* 0, or -1 when out of memory. */
+int yai_lz4_stream_init(yai_lz4_stream_t *s, size_t n, size_t raw_len, size_t flush, yai_lz4_sink_fn sink, void *user);
+
+/* 0, -1 when malformed, 1 when the sink returned non-zero. */
+int yai_lz4_stream_feed(yai_lz4_stream_t *s, const void *in, size_t n);
+
+/* 0 once the whole block decoded to exactly raw_len bytes, else -1. */
+int yai_lz4_stream_end(const yai_lz4_stream_t *s);
+
+void yai_lz4_stream_free(yai_lz4_stream_t *s);
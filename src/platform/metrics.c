@@ -0,0 +1,400 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "metrics_internal.h"
+
+#include <yai_sdk/errors.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define RELAXED memory_order_relaxed
+
+/* Per-command table: open addressing, slots are claimed once and never freed. */
+#define CMD_SLOTS 1024u
+
+enum { SLOT_EMPTY = 0, SLOT_CLAIMING = 1, SLOT_READY = 2 };
+
+typedef struct cmd_slot {
+    _Atomic uint32_t state;
+    uint32_t hash;
+    char id[sizeof(((yai_sdk_command_metrics_t *)0)->command_id)];
+} cmd_slot_t;
+
+typedef struct cmd_count {
+    _Atomic uint64_t calls[YAI_SDK_CALL_CLASS_COUNT];
+    _Atomic uint64_t bytes_sent;
+    _Atomic uint64_t bytes_received;
+    _Atomic uint64_t call_ns;
+} cmd_count_t;
+
+/* Process counters are split in shards so threads calling at once mostly
+   add to different cache lines; a thread sticks to the shard it first drew.
+   Pages of shards no thread drew are never touched. */
+#define SHARDS 8u
+
+static yai_metrics_t g_totals[SHARDS];
+static cmd_slot_t g_cmds[CMD_SLOTS];
+/* slot CMD_SLOTS counts the ids that found the table full, as "(other)" */
+static cmd_count_t g_cmd_counts[SHARDS][CMD_SLOTS + 1u];
+static _Atomic unsigned g_next_shard;
+static _Thread_local unsigned t_shard = SHARDS;
+
+static unsigned shard(void)
+{
+    if (t_shard == SHARDS)
+        t_shard = atomic_fetch_add_explicit(&g_next_shard, 1, RELAXED) % SHARDS;
+    return t_shard;
+}
+
+uint64_t yai_metrics_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static size_t bucket_of(uint64_t v)
+{
+    if (v < 4u)
+        return (size_t)v;
+    unsigned e = 63u - (unsigned)__builtin_clzll(v);
+    size_t i = (size_t)(e - 1u) * 4u + (size_t)((v >> (e - 2u)) & 3u);
+    return (i < YAI_SDK_HIST_BUCKETS) ? i : YAI_SDK_HIST_BUCKETS - 1u;
+}
+
+uint64_t yai_sdk_histogram_bucket_max(size_t i)
+{
+    if (i < 4u)
+        return (uint64_t)i;
+    if (i >= YAI_SDK_HIST_BUCKETS - 1u)
+        return UINT64_MAX;
+    unsigned e = (unsigned)(i / 4u) + 1u;
+    uint64_t width = (uint64_t)1 << (e - 2u);
+    return (uint64_t)(4u + i % 4u) * width + width - 1u;
+}
+
+/* Single writer: a plain load and store, still tear-free for readers. */
+static void bump(_Atomic uint64_t *a, uint64_t n)
+{
+    atomic_store_explicit(a, atomic_load_explicit(a, RELAXED) + n, RELAXED);
+}
+
+static void raise_max_local(_Atomic uint64_t *a, uint64_t v)
+{
+    if (v > atomic_load_explicit(a, RELAXED))
+        atomic_store_explicit(a, v, RELAXED);
+}
+
+static void raise_max_shared(_Atomic uint64_t *a, uint64_t v)
+{
+    uint64_t cur = atomic_load_explicit(a, RELAXED);
+    while (v > cur && !atomic_compare_exchange_weak_explicit(a, &cur, v, RELAXED, RELAXED)) {
+    }
+}
+
+void yai_metrics_phase(yai_metrics_t *m, yai_sdk_phase_t phase, uint64_t ns)
+{
+    size_t b = bucket_of(ns);
+    yai_hist_t *g = &g_totals[shard()].phase[phase];
+
+    if (m) {
+        yai_hist_t *h = &m->phase[phase];
+        bump(&h->count, 1);
+        bump(&h->sum_ns, ns);
+        bump(&h->buckets[b], 1);
+        raise_max_local(&h->max_ns, ns);
+    }
+    atomic_fetch_add_explicit(&g->count, 1, RELAXED);
+    atomic_fetch_add_explicit(&g->sum_ns, ns, RELAXED);
+    atomic_fetch_add_explicit(&g->buckets[b], 1, RELAXED);
+    raise_max_shared(&g->max_ns, ns);
+}
+
+static yai_sdk_call_class_t class_of(int rc)
+{
+    switch (rc) {
+    case YAI_SDK_OK:
+        return YAI_SDK_CALL_OK;
+    case YAI_SDK_BAD_ARGS:
+        return YAI_SDK_CALL_BAD_ARGS;
+    case YAI_SDK_UNAUTHORIZED:
+        return YAI_SDK_CALL_UNAUTHORIZED;
+    case YAI_SDK_RUNTIME_NOT_READY:
+        return YAI_SDK_CALL_NOT_READY;
+    case YAI_SDK_SERVER_OFF:
+        return YAI_SDK_CALL_SERVER_OFF;
+    case YAI_SDK_TIMEOUT:
+        return YAI_SDK_CALL_TIMEOUT;
+    case YAI_SDK_PROTOCOL:
+        return YAI_SDK_CALL_PROTOCOL;
+    case YAI_SDK_RPC:
+        return YAI_SDK_CALL_RPC;
+    case YAI_SDK_IO:
+        return YAI_SDK_CALL_IO;
+    default:
+        return YAI_SDK_CALL_OTHER;
+    }
+}
+
+static uint32_t fnv1a(const char *s, size_t n)
+{
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < n; i++) {
+        h ^= (uint8_t)s[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static size_t cmd_slot(const char *command_id)
+{
+    const char *id = (command_id && command_id[0]) ? command_id : "yai.unknown.unknown";
+    size_t n = strlen(id);
+    if (n >= sizeof(g_cmds[0].id))
+        n = sizeof(g_cmds[0].id) - 1u; /* longer ids share their prefix's slot */
+    uint32_t h = fnv1a(id, n);
+
+    for (uint32_t probe = 0; probe < CMD_SLOTS; probe++) {
+        size_t i = (h + probe) & (CMD_SLOTS - 1u);
+        cmd_slot_t *s = &g_cmds[i];
+        uint32_t st = atomic_load_explicit(&s->state, memory_order_acquire);
+        if (st == SLOT_EMPTY) {
+            uint32_t expect = SLOT_EMPTY;
+            if (atomic_compare_exchange_strong_explicit(&s->state, &expect, SLOT_CLAIMING,
+                                                        memory_order_acq_rel, memory_order_acquire)) {
+                s->hash = h;
+                memcpy(s->id, id, n);
+                s->id[n] = '\0';
+                atomic_store_explicit(&s->state, SLOT_READY, memory_order_release);
+                return i;
+            }
+            st = expect;
+        }
+        /* another thread is writing this slot's id: it may be ours */
+        while (st == SLOT_CLAIMING)
+            st = atomic_load_explicit(&s->state, memory_order_acquire);
+        if (s->hash == h && strncmp(s->id, id, n) == 0 && s->id[n] == '\0')
+            return i;
+    }
+    return CMD_SLOTS;
+}
+
+void yai_metrics_call(yai_metrics_t *m,
+                      const char *command_id,
+                      int rc,
+                      uint64_t call_ns,
+                      uint64_t sent,
+                      uint64_t received)
+{
+    yai_sdk_call_class_t cls = class_of(rc);
+    unsigned sh = shard();
+    yai_metrics_t *g = &g_totals[sh];
+    cmd_count_t *s = &g_cmd_counts[sh][cmd_slot(command_id)];
+
+    if (m) {
+        bump(&m->calls[cls], 1);
+        bump(&m->bytes_sent, sent);
+        bump(&m->bytes_received, received);
+    }
+    atomic_fetch_add_explicit(&g->calls[cls], 1, RELAXED);
+    atomic_fetch_add_explicit(&g->bytes_sent, sent, RELAXED);
+    atomic_fetch_add_explicit(&g->bytes_received, received, RELAXED);
+    atomic_fetch_add_explicit(&s->calls[cls], 1, RELAXED);
+    atomic_fetch_add_explicit(&s->bytes_sent, sent, RELAXED);
+    atomic_fetch_add_explicit(&s->bytes_received, received, RELAXED);
+    atomic_fetch_add_explicit(&s->call_ns, call_ns, RELAXED);
+}
+
+void yai_metrics_bytes(yai_metrics_t *m, uint64_t sent, uint64_t received)
+{
+    if (m) {
+        bump(&m->bytes_sent, sent);
+        bump(&m->bytes_received, received);
+    }
+    yai_metrics_t *g = &g_totals[shard()];
+    atomic_fetch_add_explicit(&g->bytes_sent, sent, RELAXED);
+    atomic_fetch_add_explicit(&g->bytes_received, received, RELAXED);
+}
+
+void yai_metrics_snapshot(const yai_metrics_t *m, yai_sdk_metrics_t *out)
+{
+    yai_metrics_t *src = (yai_metrics_t *)m;
+
+    for (size_t p = 0; p < YAI_SDK_PHASE_COUNT; p++) {
+        out->phase[p].count = atomic_load_explicit(&src->phase[p].count, RELAXED);
+        out->phase[p].sum_ns = atomic_load_explicit(&src->phase[p].sum_ns, RELAXED);
+        out->phase[p].max_ns = atomic_load_explicit(&src->phase[p].max_ns, RELAXED);
+        for (size_t b = 0; b < YAI_SDK_HIST_BUCKETS; b++)
+            out->phase[p].buckets[b] = atomic_load_explicit(&src->phase[p].buckets[b], RELAXED);
+    }
+    for (size_t c = 0; c < YAI_SDK_CALL_CLASS_COUNT; c++)
+        out->calls[c] = atomic_load_explicit(&src->calls[c], RELAXED);
+    out->bytes_sent = atomic_load_explicit(&src->bytes_sent, RELAXED);
+    out->bytes_received = atomic_load_explicit(&src->bytes_received, RELAXED);
+}
+
+void yai_sdk_metrics_global(yai_sdk_metrics_t *out)
+{
+    yai_sdk_metrics_t *shard;
+
+    if (!out)
+        return;
+    yai_metrics_snapshot(&g_totals[0], out);
+    shard = (yai_sdk_metrics_t *)malloc(sizeof(*shard));
+    if (!shard)
+        return;
+    for (size_t i = 1; i < SHARDS; i++) {
+        yai_metrics_snapshot(&g_totals[i], shard);
+        for (size_t p = 0; p < YAI_SDK_PHASE_COUNT; p++) {
+            yai_sdk_histogram_t *h = &out->phase[p];
+            h->count += shard->phase[p].count;
+            h->sum_ns += shard->phase[p].sum_ns;
+            if (shard->phase[p].max_ns > h->max_ns)
+                h->max_ns = shard->phase[p].max_ns;
+            for (size_t b = 0; b < YAI_SDK_HIST_BUCKETS; b++)
+                h->buckets[b] += shard->phase[p].buckets[b];
+        }
+        for (size_t c = 0; c < YAI_SDK_CALL_CLASS_COUNT; c++)
+            out->calls[c] += shard->calls[c];
+        out->bytes_sent += shard->bytes_sent;
+        out->bytes_received += shard->bytes_received;
+    }
+    free(shard);
+}
+
+static void copy_slot(size_t i, const char *id, yai_sdk_command_metrics_t *out)
+{
+    memset(out, 0, sizeof(*out));
+    snprintf(out->command_id, sizeof(out->command_id), "%s", id);
+    for (size_t sh = 0; sh < SHARDS; sh++) {
+        cmd_count_t *s = &g_cmd_counts[sh][i];
+        for (size_t c = 0; c < YAI_SDK_CALL_CLASS_COUNT; c++)
+            out->calls[c] += atomic_load_explicit(&s->calls[c], RELAXED);
+        out->bytes_sent += atomic_load_explicit(&s->bytes_sent, RELAXED);
+        out->bytes_received += atomic_load_explicit(&s->bytes_received, RELAXED);
+        out->call_ns += atomic_load_explicit(&s->call_ns, RELAXED);
+    }
+}
+
+size_t yai_sdk_metrics_commands(yai_sdk_command_metrics_t *out, size_t cap)
+{
+    size_t n = 0;
+
+    for (size_t i = 0; i < CMD_SLOTS; i++) {
+        cmd_slot_t *s = &g_cmds[i];
+        if (atomic_load_explicit(&s->state, memory_order_acquire) != SLOT_READY)
+            continue;
+        if (out && n < cap)
+            copy_slot(i, s->id, &out[n]);
+        n++;
+    }
+    for (size_t sh = 0; sh < SHARDS; sh++) {
+        int used = 0;
+        for (size_t c = 0; c < YAI_SDK_CALL_CLASS_COUNT; c++)
+            used |= atomic_load_explicit(&g_cmd_counts[sh][CMD_SLOTS].calls[c], RELAXED) != 0;
+        if (used) {
+            if (out && n < cap)
+                copy_slot(CMD_SLOTS, "(other)", &out[n]);
+            n++;
+            break;
+        }
+    }
+    return n;
+}
+
+uint64_t yai_sdk_histogram_quantile(const yai_sdk_histogram_t *h, double q)
+{
+    uint64_t total = 0;
+    uint64_t seen = 0;
+    uint64_t rank;
+
+    if (!h)
+        return 0;
+    for (size_t b = 0; b < YAI_SDK_HIST_BUCKETS; b++)
+        total += h->buckets[b];
+    if (total == 0)
+        return 0;
+    if (q < 0.0)
+        q = 0.0;
+    if (q > 1.0)
+        q = 1.0;
+    rank = (uint64_t)(q * (double)total + 0.5);
+    if (rank == 0)
+        rank = 1;
+    for (size_t b = 0; b < YAI_SDK_HIST_BUCKETS; b++) {
+        seen += h->buckets[b];
+        if (seen >= rank) {
+            uint64_t top = yai_sdk_histogram_bucket_max(b);
+            return (h->max_ns != 0 && top > h->max_ns) ? h->max_ns : top;
+        }
+    }
+    return h->max_ns;
+}
+
+const char *yai_sdk_phase_name(yai_sdk_phase_t phase)
+{
+    static const char *names[YAI_SDK_PHASE_COUNT] = {"connect", "handshake", "send", "wait", "parse", "call"};
+    return ((unsigned)phase < YAI_SDK_PHASE_COUNT) ? names[phase] : "unknown";
+}
+
+const char *yai_sdk_call_class_name(yai_sdk_call_class_t cls)
+{
+    static const char *names[YAI_SDK_CALL_CLASS_COUNT] = {
+        "ok", "bad_args", "unauthorized", "not_ready", "server_off",
+        "timeout", "protocol", "rpc", "io", "other"};
+    return ((unsigned)cls < YAI_SDK_CALL_CLASS_COUNT) ? names[cls] : "unknown";
+}
+
+typedef struct text_out {
+    char *buf;
+    size_t cap;
+    size_t len;
+} text_out_t;
+
+static void put(text_out_t *t, const char *name, const char *labels, uint64_t v)
+{
+    char *dst = (t->len < t->cap) ? t->buf + t->len : NULL;
+    size_t room = (t->len < t->cap) ? t->cap - t->len : 0;
+    int n = snprintf(dst, room, "%s%s %llu\n", name, labels, (unsigned long long)v);
+    if (n > 0)
+        t->len += (size_t)n;
+}
+
+size_t yai_sdk_metrics_format(const yai_sdk_metrics_t *m, char *buf, size_t cap)
+{
+    static const struct {
+        const char *label;
+        double q;
+    } quantiles[] = {{"0.5", 0.5}, {"0.9", 0.9}, {"0.99", 0.99}};
+    text_out_t t = {buf, buf ? cap : 0, 0};
+    char labels[64];
+
+    if (!m)
+        return 0;
+    if (t.cap > 0)
+        t.buf[0] = '\0';
+    for (size_t c = 0; c < YAI_SDK_CALL_CLASS_COUNT; c++) {
+        snprintf(labels, sizeof(labels), "{class=\"%s\"}", yai_sdk_call_class_name((yai_sdk_call_class_t)c));
+        put(&t, "yai_sdk_calls_total", labels, m->calls[c]);
+    }
+    put(&t, "yai_sdk_bytes_sent_total", "", m->bytes_sent);
+    put(&t, "yai_sdk_bytes_received_total", "", m->bytes_received);
+    for (size_t p = 0; p < YAI_SDK_PHASE_COUNT; p++) {
+        const yai_sdk_histogram_t *h = &m->phase[p];
+        const char *name = yai_sdk_phase_name((yai_sdk_phase_t)p);
+        snprintf(labels, sizeof(labels), "{phase=\"%s\"}", name);
+        put(&t, "yai_sdk_phase_ns_count", labels, h->count);
+        put(&t, "yai_sdk_phase_ns_sum", labels, h->sum_ns);
+        for (size_t i = 0; i < sizeof(quantiles) / sizeof(quantiles[0]); i++) {
+            snprintf(labels, sizeof(labels), "{phase=\"%s\",quantile=\"%s\"}", name, quantiles[i].label);
+            put(&t, "yai_sdk_phase_ns", labels, yai_sdk_histogram_quantile(h, quantiles[i].q));
+        }
+        snprintf(labels, sizeof(labels), "{phase=\"%s\"}", name);
+        put(&t, "yai_sdk_phase_ns_max", labels, h->max_ns);
+    }
+    return t.len;
+}
@@ -0,0 +1,46 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+#pragma once
+
+#include <yai_sdk/metrics.h>
+
+#include <stdatomic.h>
+#include <stdint.h>
+
+/*
+ * Live counters behind yai_sdk_metrics_t. A client's block has a single
+ * writer (the client is not shared), so it is updated with relaxed
+ * load/store; the process-wide shards take relaxed atomic adds.
+ */
+typedef struct yai_hist {
+    _Atomic uint64_t count;
+    _Atomic uint64_t sum_ns;
+    _Atomic uint64_t max_ns;
+    _Atomic uint64_t buckets[YAI_SDK_HIST_BUCKETS];
+} yai_hist_t;
+
+typedef struct yai_metrics {
+    yai_hist_t phase[YAI_SDK_PHASE_COUNT];
+    _Atomic uint64_t calls[YAI_SDK_CALL_CLASS_COUNT];
+    _Atomic uint64_t bytes_sent;
+    _Atomic uint64_t bytes_received;
+} yai_metrics_t;
+
+uint64_t yai_metrics_now_ns(void);
+
+/* Records ns under phase in m (may be NULL) and in the process totals. */
+void yai_metrics_phase(yai_metrics_t *m, yai_sdk_phase_t phase, uint64_t ns);
+
+/* One finished public call: its class from rc and its wire bytes, in m, in
+ * the process totals and in the per-command table (which also sums call_ns).
+ * The CALL phase itself is recorded by the caller. */
+void yai_metrics_call(yai_metrics_t *m,
+                      const char *command_id,
+                      int rc,
+                      uint64_t call_ns,
+                      uint64_t sent,
+                      uint64_t received);
+
+/* Wire bytes outside any call (a handshake of its own). */
+void yai_metrics_bytes(yai_metrics_t *m, uint64_t sent, uint64_t received);
+
+void yai_metrics_snapshot(const yai_metrics_t *m, yai_sdk_metrics_t *out);
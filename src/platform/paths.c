@@ -4,8 +4,13 @@
 
 #include <yai_sdk/paths.h>
 
+#include "paths_internal.h"
+
 #include <ctype.h>
 #include <limits.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -130,6 +135,145 @@ static int search_path_for_exec(const char *name, char *out, size_t cap)
   return -1;
 }
 
+/* ============================================================
+   RESOLVED LOCATIONS CACHE
+   - one slot per location, filled on first use and shared process-wide
+   - a slot stays valid while the environment variables it was derived
+     from hash the same and yai_path_cache_invalidate was not called
+   - binaries are only cached once found: a missing one is probed again
+   - the lock only covers copies; resolving happens outside it
+   ============================================================ */
+
+typedef enum path_slot {
+  SLOT_RUNTIME_HOME = 0,
+  SLOT_INSTALL_ROOT,
+  SLOT_ROOT_SOCK,
+  SLOT_BOOT_BIN,
+  SLOT_ROOT_BIN,
+  SLOT_KERNEL_BIN,
+  SLOT_ENGINE_BIN,
+  SLOT_COUNT
+} path_slot_t;
+
+typedef struct path_entry {
+  int valid;
+  int rc;
+  uint64_t gen;
+  uint64_t env_sig;
+  char path[PATH_MAX];
+} path_entry_t;
+
+static pthread_mutex_t g_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+static path_entry_t g_cache[SLOT_COUNT];
+static uint64_t g_cache_gen = 1;
+/* the root socket's address, prebuilt for connect */
+static struct sockaddr_un g_root_addr;
+static socklen_t g_root_addr_len;
+
+static const char *const k_env_home[] = {"YAI_RUNTIME_HOME", "HOME", NULL};
+static const char *const k_env_install[] = {"YAI_INSTALL_ROOT", NULL};
+static const char *const k_env_sock[] = {"YAI_ROOT_SOCK", "YAI_RUNTIME_HOME", "HOME", NULL};
+static const char *const k_env_boot[] = {"YAI_BOOT_BIN", "YAI_INSTALL_ROOT", "PATH", NULL};
+static const char *const k_env_root[] = {"YAI_ROOT_BIN", "YAI_INSTALL_ROOT", "PATH", NULL};
+static const char *const k_env_kernel[] = {"YAI_KERNEL_BIN", "YAI_INSTALL_ROOT", "PATH", NULL};
+static const char *const k_env_engine[] = {"YAI_ENGINE_BIN", "YAI_INSTALL_ROOT", "PATH", NULL};
+
+static const char *const *const k_slot_env[SLOT_COUNT] = {
+  k_env_home, k_env_install, k_env_sock, k_env_boot, k_env_root, k_env_kernel, k_env_engine};
+
+/* FNV-1a over the values of keys; unset and empty hash differently. */
+static uint64_t env_sig(const char *const *keys)
+{
+  uint64_t h = 0xcbf29ce484222325ull;
+  for (; *keys; keys++) {
+    const char *v = getenv(*keys);
+    if (!v) {
+      h = (h ^ 0xffu) * 0x100000001b3ull;
+      continue;
+    }
+    for (; *v; v++) h = (h ^ (uint8_t)*v) * 0x100000001b3ull;
+    h = (h ^ 0xfeu) * 0x100000001b3ull;
+  }
+  return h;
+}
+
+static int copy_out(const char *path, char *out, size_t cap)
+{
+  size_t n = strlen(path);
+  if (n == 0 || n >= cap) return -1;
+  memcpy(out, path, n + 1);
+  return 0;
+}
+
+/* 1 with the cached result in *rc (and out on success), 0 on a miss. */
+static int cache_get(path_slot_t slot, uint64_t sig, char *out, size_t cap, int *rc)
+{
+  int hit;
+  pthread_mutex_lock(&g_cache_lock);
+  hit = g_cache[slot].valid && g_cache[slot].gen == g_cache_gen && g_cache[slot].env_sig == sig;
+  if (hit) *rc = (g_cache[slot].rc == 0) ? copy_out(g_cache[slot].path, out, cap) : g_cache[slot].rc;
+  pthread_mutex_unlock(&g_cache_lock);
+  return hit;
+}
+
+static void cache_put(path_slot_t slot, uint64_t gen, uint64_t sig, int rc, const char *path)
+{
+  pthread_mutex_lock(&g_cache_lock);
+  /* an invalidate while this was resolving wins */
+  if (gen == g_cache_gen && (rc != 0 || strlen(path) < sizeof(g_cache[slot].path))) {
+    path_entry_t *e = &g_cache[slot];
+    e->valid = 1;
+    e->rc = rc;
+    e->gen = gen;
+    e->env_sig = sig;
+    e->path[0] = '\0';
+    if (rc == 0) memcpy(e->path, path, strlen(path) + 1);
+    if (slot == SLOT_ROOT_SOCK) {
+      g_root_addr_len = 0;
+      if (rc == 0 && strlen(path) < sizeof(g_root_addr.sun_path)) {
+        memset(&g_root_addr, 0, sizeof(g_root_addr));
+        g_root_addr.sun_family = AF_UNIX;
+        memcpy(g_root_addr.sun_path, path, strlen(path) + 1);
+        g_root_addr_len = (socklen_t)(offsetof(struct sockaddr_un, sun_path) + strlen(path));
+      }
+    }
+  }
+  pthread_mutex_unlock(&g_cache_lock);
+}
+
+static uint64_t cache_gen(void)
+{
+  uint64_t gen;
+  pthread_mutex_lock(&g_cache_lock);
+  gen = g_cache_gen;
+  pthread_mutex_unlock(&g_cache_lock);
+  return gen;
+}
+
+void yai_path_cache_invalidate(void)
+{
+  pthread_mutex_lock(&g_cache_lock);
+  g_cache_gen++;
+  pthread_mutex_unlock(&g_cache_lock);
+}
+
+typedef int (*path_resolve_fn)(char *out, size_t cap);
+
+/* Cached front of resolve; cache_fail keeps failures too. */
+static int cached(path_slot_t slot, path_resolve_fn resolve, int cache_fail, char *out, size_t cap)
+{
+  char path[PATH_MAX];
+  uint64_t sig = env_sig(k_slot_env[slot]);
+  uint64_t gen;
+  int rc;
+
+  if (cache_get(slot, sig, out, cap, &rc)) return rc;
+  gen = cache_gen();
+  rc = resolve(path, sizeof(path));
+  if (rc == 0 || cache_fail) cache_put(slot, gen, sig, rc, path);
+  return (rc == 0) ? copy_out(path, out, cap) : rc;
+}
+
 static int resolve_runtime_binary(const char *env_key, const char *bin_name, char *out, size_t cap)
 {
   char install_root[PATH_MAX];
@@ -178,13 +322,12 @@ static int is_valid_ws_id(const char *ws_id)
   return 1;
 }
 
-int yai_path_runtime_home(char *out, size_t cap)
+static int runtime_home_resolve(char *out, size_t cap)
 {
   const char *override = env_non_empty("YAI_RUNTIME_HOME");
   char home[PATH_MAX];
   int n;
 
-  if (!out || cap < 16) return -1;
 
   if (override) {
     n = snprintf(out, cap, "%s", override);
@@ -196,11 +339,10 @@ int yai_path_runtime_home(char *out, size_t cap)
   return (n > 0 && (size_t)n < cap) ? 0 : -1;
 }
 
-int yai_path_install_root(char *out, size_t cap)
+static int install_root_resolve(char *out, size_t cap)
 {
   const char *override = env_non_empty("YAI_INSTALL_ROOT");
   int n;
-  if (!out || cap < 8) return -1;
   if (override) {
     n = snprintf(out, cap, "%s", override);
     return (n > 0 && (size_t)n < cap) ? 0 : -1;
@@ -208,6 +350,18 @@ int yai_path_install_root(char *out, size_t cap)
   return derive_root_from_exe(out, cap);
 }
 
+int yai_path_runtime_home(char *out, size_t cap)
+{
+  if (!out || cap < 16) return -1;
+  return cached(SLOT_RUNTIME_HOME, runtime_home_resolve, 1, out, cap);
+}
+
+int yai_path_install_root(char *out, size_t cap)
+{
+  if (!out || cap < 8) return -1;
+  return cached(SLOT_INSTALL_ROOT, install_root_resolve, 1, out, cap);
+}
+
 int yai_path_detect_deploy_mode(yai_runtime_deploy_mode_t *out_mode)
 {
   char install_root[PATH_MAX];
@@ -237,32 +391,55 @@ int yai_path_detect_deploy_mode(yai_runtime_deploy_mode_t *out_mode)
   return 0;
 }
 
-int yai_path_boot_bin(char *out, size_t cap)
+static int boot_bin_resolve(char *out, size_t cap)
 {
   return resolve_runtime_binary("YAI_BOOT_BIN", "yai-boot", out, cap);
 }
 
-int yai_path_root_bin(char *out, size_t cap)
+int yai_path_boot_bin(char *out, size_t cap)
+{
+  if (!out || cap == 0) return -1;
+  return cached(SLOT_BOOT_BIN, boot_bin_resolve, 0, out, cap);
+}
+
+static int root_bin_resolve(char *out, size_t cap)
 {
   return resolve_runtime_binary("YAI_ROOT_BIN", "yai-root-server", out, cap);
 }
 
-int yai_path_kernel_bin(char *out, size_t cap)
+int yai_path_root_bin(char *out, size_t cap)
+{
+  if (!out || cap == 0) return -1;
+  return cached(SLOT_ROOT_BIN, root_bin_resolve, 0, out, cap);
+}
+
+static int kernel_bin_resolve(char *out, size_t cap)
 {
   return resolve_runtime_binary("YAI_KERNEL_BIN", "yai-kernel", out, cap);
 }
 
-int yai_path_engine_bin(char *out, size_t cap)
+int yai_path_kernel_bin(char *out, size_t cap)
+{
+  if (!out || cap == 0) return -1;
+  return cached(SLOT_KERNEL_BIN, kernel_bin_resolve, 0, out, cap);
+}
+
+static int engine_bin_resolve(char *out, size_t cap)
 {
   return resolve_runtime_binary("YAI_ENGINE_BIN", "yai-engine", out, cap);
 }
 
-int yai_path_root_sock(char *out, size_t cap)
+int yai_path_engine_bin(char *out, size_t cap)
+{
+  if (!out || cap == 0) return -1;
+  return cached(SLOT_ENGINE_BIN, engine_bin_resolve, 0, out, cap);
+}
+
+static int root_sock_resolve(char *out, size_t cap)
 {
   const char *override = env_non_empty("YAI_ROOT_SOCK");
   char runtime_home[PATH_MAX];
   int n;
-  if (!out || cap < 32) return -1;
   if (override) {
     n = snprintf(out, cap, "%s", override);
     return (n > 0 && (size_t)n < cap) ? 0 : -1;
@@ -272,6 +449,44 @@ int yai_path_root_sock(char *out, size_t cap)
   return (n > 0 && (size_t)n < cap) ? 0 : -1;
 }
 
+int yai_path_root_sock(char *out, size_t cap)
+{
+  if (!out || cap < 32) return -1;
+  return cached(SLOT_ROOT_SOCK, root_sock_resolve, 1, out, cap);
+}
+
+int yai_path_root_sockaddr(struct sockaddr_un *out, socklen_t *out_len)
+{
+  char path[PATH_MAX];
+  uint64_t sig = env_sig(k_env_sock);
+  int rc;
+
+  if (!out || !out_len) return -1;
+  for (int pass = 0; pass < 2; pass++) {
+    pthread_mutex_lock(&g_cache_lock);
+    path_entry_t *e = &g_cache[SLOT_ROOT_SOCK];
+    int hit = e->valid && e->gen == g_cache_gen && e->env_sig == sig;
+    if (hit) {
+      rc = (e->rc != 0) ? -1 : (g_root_addr_len == 0) ? -2 : 0;
+      if (rc == 0) {
+        *out = g_root_addr;
+        *out_len = g_root_addr_len;
+      }
+    }
+    pthread_mutex_unlock(&g_cache_lock);
+    if (hit) return rc;
+    /* resolves and fills the slot (and the address) for the second pass */
+    if (yai_path_root_sock(path, sizeof(path)) != 0) return -1;
+  }
+  /* invalidated or changed in between: build it from the path just resolved */
+  if (strlen(path) >= sizeof(out->sun_path)) return -2;
+  memset(out, 0, sizeof(*out));
+  out->sun_family = AF_UNIX;
+  memcpy(out->sun_path, path, strlen(path) + 1);
+  *out_len = (socklen_t)(offsetof(struct sockaddr_un, sun_path) + strlen(path));
+  return 0;
+}
+
 int yai_path_ws_sock(const char *ws_id, char *out, size_t cap)
 {
   char runtime_home[PATH_MAX];
@@ -0,0 +1,13 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+#pragma once
+
+#include <yai_sdk/paths.h>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+
+/*
+ * yai_path_root_sock as a ready-to-connect address, from the same cache:
+ * -1 when it does not resolve, -2 when it is too long for sun_path.
+ */
+int yai_path_root_sockaddr(struct sockaddr_un *out, socklen_t *out_len);
@@ -0,0 +1,290 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <yai_sdk/trace.h>
+#include <yai_sdk/errors.h>
+
+#include "trace_internal.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+_Atomic int yai_trace_on = 0;
+
+/* A handler and its user data, published together and never changed. */
+typedef struct span_sink {
+    yai_sdk_span_fn fn;
+    void *user_data;
+    struct span_sink *retired;
+} span_sink_t;
+
+static _Atomic(span_sink_t *) g_span_sink = NULL;
+/* Replaced sinks stay allocated: an emit on another thread may still hold one. */
+static span_sink_t *g_span_retired = NULL;
+static pthread_mutex_t g_span_mu = PTHREAD_MUTEX_INITIALIZER;
+
+void yai_sdk_set_span_handler(yai_sdk_span_fn handler, void *user_data)
+{
+    span_sink_t *sink = NULL;
+
+    if (handler) {
+        sink = (span_sink_t *)calloc(1, sizeof(*sink));
+        if (!sink) return;
+        sink->fn = handler;
+        sink->user_data = user_data;
+    }
+    pthread_mutex_lock(&g_span_mu);
+    span_sink_t *old = atomic_exchange_explicit(&g_span_sink, sink, memory_order_acq_rel);
+    if (old) {
+        old->retired = g_span_retired;
+        g_span_retired = old;
+    }
+    atomic_store_explicit(&yai_trace_on, handler != NULL, memory_order_relaxed);
+    pthread_mutex_unlock(&g_span_mu);
+}
+
+void yai_trace_emit(const yai_sdk_span_t *span)
+{
+    const span_sink_t *sink = atomic_load_explicit(&g_span_sink, memory_order_acquire);
+    if (sink && span) {
+        sink->fn(span, sink->user_data);
+    }
+}
+
+/* ============================================================
+   IDS
+   - splitmix64 per thread: one add and three multiply-xorshifts a word
+   - seeded on first use from both clocks, the pid, the thread's own TLS
+     address and a process-wide sequence, so threads, processes and hosts
+     start from unrelated states
+   - a fork child reseeds: it would otherwise replay its parent's ids
+   ============================================================ */
+
+static _Thread_local uint64_t t_state;
+static _Thread_local uint64_t t_epoch; /* g_epoch when seeded; 0 unseeded */
+static _Atomic uint64_t g_epoch = 1;
+static _Atomic uint64_t g_seq = 0;
+static pthread_once_t g_fork_once = PTHREAD_ONCE_INIT;
+
+static void on_fork_child(void)
+{
+    atomic_fetch_add_explicit(&g_epoch, 1, memory_order_relaxed);
+}
+
+static void fork_hook_init(void)
+{
+    (void)pthread_atfork(NULL, NULL, on_fork_child);
+}
+
+static uint64_t mix64(uint64_t z)
+{
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+static void seed_thread(uint64_t epoch)
+{
+    struct timespec rt, mono;
+
+    pthread_once(&g_fork_once, fork_hook_init);
+    clock_gettime(CLOCK_REALTIME, &rt);
+    clock_gettime(CLOCK_MONOTONIC, &mono);
+    t_state = mix64((uint64_t)rt.tv_sec * 1000000000ull + (uint64_t)rt.tv_nsec);
+    t_state ^= mix64((uint64_t)mono.tv_sec * 1000000000ull + (uint64_t)mono.tv_nsec + ((uint64_t)getpid() << 32));
+    t_state ^= mix64((uint64_t)(uintptr_t)&t_state ^
+                     atomic_fetch_add_explicit(&g_seq, 0x9E3779B97F4A7C15ull, memory_order_relaxed));
+    t_epoch = epoch;
+}
+
+static uint64_t next64(void)
+{
+    uint64_t epoch = atomic_load_explicit(&g_epoch, memory_order_relaxed);
+    if (t_epoch != epoch) {
+        seed_thread(epoch);
+    }
+    t_state += 0x9E3779B97F4A7C15ull;
+    return mix64(t_state);
+}
+
+static int all_zero(const uint8_t *p, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        if (p[i]) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+void yai_trace_random(uint8_t *out, size_t n)
+{
+    do {
+        for (size_t i = 0; i < n; i += 8) {
+            uint64_t w = next64();
+            size_t k = (n - i < 8) ? n - i : 8;
+            memcpy(out + i, &w, k);
+        }
+    } while (all_zero(out, n));
+}
+
+void yai_trace_start(yai_sdk_trace_ctx_t *ctx, const yai_sdk_trace_ctx_t *parent)
+{
+    if (parent) {
+        memcpy(ctx->trace_id, parent->trace_id, sizeof(ctx->trace_id));
+        ctx->flags = parent->flags;
+    } else {
+        yai_trace_random(ctx->trace_id, sizeof(ctx->trace_id));
+        ctx->flags = 0x01; /* sampled */
+    }
+    yai_trace_random(ctx->span_id, sizeof(ctx->span_id));
+}
+
+/* ============================================================
+   TEXT FORMS
+   ============================================================ */
+
+static const char HEX[] = "0123456789abcdef";
+static const char B64URL[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+static char *put_hex(char *p, const uint8_t *b, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        *p++ = HEX[b[i] >> 4];
+        *p++ = HEX[b[i] & 15];
+    }
+    return p;
+}
+
+static int hex_val(char ch)
+{
+    if (ch >= '0' && ch <= '9') {
+        return ch - '0';
+    }
+    if (ch >= 'a' && ch <= 'f') {
+        return ch - 'a' + 10;
+    }
+    return -1; /* the spec only allows lowercase */
+}
+
+static int get_hex(const char *s, uint8_t *b, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        int hi = hex_val(s[2 * i]);
+        int lo = hex_val(s[2 * i + 1]);
+        if (hi < 0 || lo < 0) {
+            return -1;
+        }
+        b[i] = (uint8_t)(hi << 4 | lo);
+    }
+    return 0;
+}
+
+size_t yai_sdk_trace_format(const yai_sdk_trace_ctx_t *ctx, char *buf, size_t cap)
+{
+    char text[YAI_SDK_TRACEPARENT_LEN + 1];
+    char *p = text;
+
+    if (!ctx) {
+        if (buf && cap) {
+            buf[0] = '\0';
+        }
+        return 0;
+    }
+    *p++ = '0';
+    *p++ = '0';
+    *p++ = '-';
+    p = put_hex(p, ctx->trace_id, sizeof(ctx->trace_id));
+    *p++ = '-';
+    p = put_hex(p, ctx->span_id, sizeof(ctx->span_id));
+    *p++ = '-';
+    p = put_hex(p, &ctx->flags, 1);
+    *p = '\0';
+    if (buf && cap) {
+        size_t n = (cap - 1 < YAI_SDK_TRACEPARENT_LEN) ? cap - 1 : YAI_SDK_TRACEPARENT_LEN;
+        memcpy(buf, text, n);
+        buf[n] = '\0';
+    }
+    return YAI_SDK_TRACEPARENT_LEN;
+}
+
+int yai_sdk_trace_parse(const char *traceparent, yai_sdk_trace_ctx_t *out)
+{
+    const char *s = traceparent;
+    uint8_t version;
+    yai_sdk_trace_ctx_t ctx;
+
+    if (!s || !out || strlen(s) < YAI_SDK_TRACEPARENT_LEN) {
+        return YAI_SDK_BAD_ARGS;
+    }
+    if (get_hex(s, &version, 1) != 0 || version == 0xff || s[2] != '-' || s[35] != '-' || s[52] != '-') {
+        return YAI_SDK_BAD_ARGS;
+    }
+    /* version 00 is exactly 55 chars; later versions may append "-..." */
+    if ((version == 0 && s[55] != '\0') || (version != 0 && s[55] != '\0' && s[55] != '-')) {
+        return YAI_SDK_BAD_ARGS;
+    }
+    if (get_hex(s + 3, ctx.trace_id, sizeof(ctx.trace_id)) != 0 ||
+        get_hex(s + 36, ctx.span_id, sizeof(ctx.span_id)) != 0 || get_hex(s + 53, &ctx.flags, 1) != 0) {
+        return YAI_SDK_BAD_ARGS;
+    }
+    if (all_zero(ctx.trace_id, sizeof(ctx.trace_id)) || all_zero(ctx.span_id, sizeof(ctx.span_id))) {
+        return YAI_SDK_BAD_ARGS;
+    }
+    *out = ctx;
+    return YAI_SDK_OK;
+}
+
+/* trace id ‖ span id: 24 bytes, exactly 32 base64url chars */
+void yai_trace_to_wire(const yai_sdk_trace_ctx_t *ctx, char *out)
+{
+    uint8_t raw[24];
+
+    memcpy(raw, ctx->trace_id, 16);
+    memcpy(raw + 16, ctx->span_id, 8);
+    for (size_t i = 0; i < sizeof(raw); i += 3) {
+        uint32_t v = (uint32_t)raw[i] << 16 | (uint32_t)raw[i + 1] << 8 | raw[i + 2];
+        *out++ = B64URL[v >> 18];
+        *out++ = B64URL[(v >> 12) & 63];
+        *out++ = B64URL[(v >> 6) & 63];
+        *out++ = B64URL[v & 63];
+    }
+    *out = '\0';
+}
+
+static int b64_val(char ch)
+{
+    const char *p = (ch != '\0') ? strchr(B64URL, ch) : NULL;
+    return p ? (int)(p - B64URL) : -1;
+}
+
+int yai_sdk_trace_from_wire(const char *wire, yai_sdk_trace_ctx_t *out)
+{
+    uint8_t raw[24];
+
+    if (!wire || !out || strlen(wire) != YAI_SDK_TRACE_WIRE_LEN) {
+        return YAI_SDK_BAD_ARGS;
+    }
+    for (size_t i = 0, o = 0; i < YAI_SDK_TRACE_WIRE_LEN; i += 4, o += 3) {
+        uint32_t v = 0;
+        for (size_t k = 0; k < 4; k++) {
+            int d = b64_val(wire[i + k]);
+            if (d < 0) {
+                return YAI_SDK_BAD_ARGS;
+            }
+            v = v << 6 | (uint32_t)d;
+        }
+        raw[o] = (uint8_t)(v >> 16);
+        raw[o + 1] = (uint8_t)(v >> 8);
+        raw[o + 2] = (uint8_t)v;
+    }
+    memcpy(out->trace_id, raw, 16);
+    memcpy(out->span_id, raw + 16, 8);
+    out->flags = 0x01; /* the envelope only carries sampled traces */
+    return YAI_SDK_OK;
+}
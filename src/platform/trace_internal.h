@@ -0,0 +1,29 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+#pragma once
+
+#include <yai_sdk/trace.h>
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Non-zero while a span handler is set: spans are only built when it is. */
+extern _Atomic int yai_trace_on;
+
+static inline int yai_trace_enabled(void)
+{
+    return atomic_load_explicit(&yai_trace_on, memory_order_relaxed);
+}
+
+/* Fills out with PRNG bytes, never all zero. No system call once the
+   calling thread is seeded. */
+void yai_trace_random(uint8_t *out, size_t n);
+
+/* New span id in ctx; the trace id and flags are the parent's, or a new
+   sampled trace without one. */
+void yai_trace_start(yai_sdk_trace_ctx_t *ctx, const yai_sdk_trace_ctx_t *parent);
+
+/* Envelope trace_id form of ctx: YAI_SDK_TRACE_WIRE_LEN chars + NUL. */
+void yai_trace_to_wire(const yai_sdk_trace_ctx_t *ctx, char *out);
+
+void yai_trace_emit(const yai_sdk_span_t *span);
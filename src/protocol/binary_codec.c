@@ -0,0 +1,393 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include "binary_codec.h"
+
+#include <string.h>
+
+/* ============================================================
+   PRIMITIVES
+   ============================================================ */
+
+typedef struct bin_writer {
+    uint8_t *p;
+    size_t len;
+    size_t cap;
+    int overflow;
+} bin_writer_t;
+
+static void put_u8(bin_writer_t *w, uint8_t v)
+{
+    if (w->len >= w->cap) {
+        w->overflow = 1;
+        return;
+    }
+    w->p[w->len++] = v;
+}
+
+static void put_varint(bin_writer_t *w, size_t v)
+{
+    if (v > UINT32_MAX) {
+        w->overflow = 1;
+        return;
+    }
+    while (v >= 0x80u) {
+        put_u8(w, (uint8_t)(v | 0x80u));
+        v >>= 7;
+    }
+    put_u8(w, (uint8_t)v);
+}
+
+static void put_str(bin_writer_t *w, const yai_bin_str_t *s)
+{
+    size_t n = (s && s->p) ? s->len : 0;
+    put_varint(w, n);
+    if (n == 0) {
+        return;
+    }
+    if (w->cap - w->len < n || w->overflow) {
+        w->overflow = 1;
+        return;
+    }
+    memcpy(w->p + w->len, s->p, n);
+    w->len += n;
+}
+
+static int get_varint(const uint8_t **cur, const uint8_t *end, size_t *out)
+{
+    uint32_t v = 0;
+    for (unsigned shift = 0; shift < 35; shift += 7) {
+        if (*cur >= end) {
+            return -1;
+        }
+        uint8_t b = *(*cur)++;
+        v |= (uint32_t)(b & 0x7Fu) << shift;
+        if ((b & 0x80u) == 0) {
+            *out = v;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static int get_str(const uint8_t **cur, const uint8_t *end, yai_bin_str_t *out)
+{
+    size_t n;
+    if (get_varint(cur, end, &n) != 0 || (size_t)(end - *cur) < n) {
+        return -1;
+    }
+    out->p = (const char *)*cur;
+    out->len = n;
+    *cur += n;
+    return 0;
+}
+
+int yai_bin_next_str(const uint8_t **cur, const uint8_t *end, yai_bin_str_t *out)
+{
+    if (!cur || !*cur || *cur >= end) {
+        return 1;
+    }
+    return get_str(cur, end, out);
+}
+
+/* ============================================================
+   INTERNED COMMAND IDS
+   ============================================================ */
+
+void yai_bin_intern_reset(yai_bin_intern_t *t)
+{
+    if (t) {
+        t->count = 0;
+    }
+}
+
+static size_t intern_find(const yai_bin_intern_t *t, const yai_bin_str_t *id)
+{
+    if (!t) {
+        return 0;
+    }
+    for (size_t i = 0; i < t->count; i++) {
+        if (t->lens[i] == id->len && memcmp(t->ids[i], id->p, id->len) == 0) {
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+static void intern_add(yai_bin_intern_t *t, const yai_bin_str_t *id)
+{
+    if (!t || t->count >= YAI_BIN_INTERN_MAX || id->len == 0 || id->len >= YAI_BIN_ID_MAX) {
+        return;
+    }
+    memcpy(t->ids[t->count], id->p, id->len);
+    t->lens[t->count] = (uint8_t)id->len;
+    t->count++;
+}
+
+static void put_cmd(bin_writer_t *w, const yai_bin_str_t *id, yai_bin_intern_t *add_to, const yai_bin_intern_t *t)
+{
+    size_t ref = intern_find(t, id);
+    put_varint(w, ref);
+    if (ref != 0) {
+        return;
+    }
+    put_str(w, id);
+    intern_add(add_to, id);
+}
+
+static int get_cmd(const uint8_t **cur, const uint8_t *end, yai_bin_intern_t *add_to, const yai_bin_intern_t *t,
+                   yai_bin_str_t *out)
+{
+    size_t ref;
+    if (get_varint(cur, end, &ref) != 0) {
+        return -1;
+    }
+    if (ref == 0) {
+        if (get_str(cur, end, out) != 0) {
+            return -1;
+        }
+        intern_add(add_to, out);
+        return 0;
+    }
+    if (!t || ref > t->count) {
+        return -1;
+    }
+    out->p = t->ids[ref - 1];
+    out->len = t->lens[ref - 1];
+    return 0;
+}
+
+/* ============================================================
+   CALL / REPLY
+   ============================================================ */
+
+size_t yai_bin_call_encode(const yai_bin_call_t *call, yai_bin_intern_t *t, uint8_t *dst, size_t cap)
+{
+    bin_writer_t w = {dst, 0, cap, 0};
+
+    if (!call || !dst) {
+        return 0;
+    }
+    put_u8(&w, YAI_BIN_VERSION);
+    put_u8(&w, YAI_BIN_KIND_CALL);
+    /* the table only changes once the whole frame is known to fit */
+    put_cmd(&w, &call->command_id, NULL, t);
+    put_str(&w, &call->target_plane);
+    put_varint(&w, call->argc);
+    for (size_t i = 0; i < call->argc; i++) {
+        put_str(&w, &call->argv[i]);
+    }
+    if (w.overflow) {
+        return 0;
+    }
+    if (intern_find(t, &call->command_id) == 0) {
+        intern_add(t, &call->command_id);
+    }
+    return w.len;
+}
+
+int yai_bin_call_decode(const uint8_t *buf, size_t len, yai_bin_intern_t *t, yai_bin_call_t *out)
+{
+    const uint8_t *cur = buf;
+    const uint8_t *end = buf + len;
+
+    if (!buf || !out || len < 2 || buf[0] != YAI_BIN_VERSION || buf[1] != YAI_BIN_KIND_CALL) {
+        return -1;
+    }
+    memset(out, 0, sizeof(*out));
+    cur += 2;
+    if (get_cmd(&cur, end, t, t, &out->command_id) != 0 || get_str(&cur, end, &out->target_plane) != 0 ||
+        get_varint(&cur, end, &out->argc) != 0) {
+        return -1;
+    }
+    out->argv_raw = cur;
+    for (size_t i = 0; i < out->argc; i++) {
+        yai_bin_str_t a;
+        if (get_str(&cur, end, &a) != 0) {
+            return -1;
+        }
+    }
+    out->argv_end = cur;
+    return cur == end ? 0 : -1;
+}
+
+size_t yai_bin_reply_encode(const yai_bin_reply_t *reply, const yai_bin_intern_t *t, uint8_t *dst, size_t cap)
+{
+    bin_writer_t w = {dst, 0, cap, 0};
+
+    if (!reply || !dst) {
+        return 0;
+    }
+    put_u8(&w, YAI_BIN_VERSION);
+    put_u8(&w, YAI_BIN_KIND_REPLY);
+    put_str(&w, &reply->status);
+    put_str(&w, &reply->code);
+    put_str(&w, &reply->reason);
+    put_str(&w, &reply->summary);
+    put_cmd(&w, &reply->command_id, NULL, t);
+    put_str(&w, &reply->trace_id);
+    put_str(&w, &reply->target_plane);
+    put_varint(&w, reply->hint_count);
+    for (size_t i = 0; i < reply->hint_count; i++) {
+        put_str(&w, &reply->hints[i]);
+    }
+    put_str(&w, &reply->details);
+    put_str(&w, &reply->data);
+    return w.overflow ? 0 : w.len;
+}
+
+int yai_bin_reply_decode(const uint8_t *buf, size_t len, const yai_bin_intern_t *t, yai_bin_reply_t *out)
+{
+    const uint8_t *cur = buf;
+    const uint8_t *end = buf + len;
+
+    if (!buf || !out || len < 2 || buf[0] != YAI_BIN_VERSION || buf[1] != YAI_BIN_KIND_REPLY) {
+        return -1;
+    }
+    memset(out, 0, sizeof(*out));
+    cur += 2;
+    if (get_str(&cur, end, &out->status) != 0 || get_str(&cur, end, &out->code) != 0 ||
+        get_str(&cur, end, &out->reason) != 0 || get_str(&cur, end, &out->summary) != 0 ||
+        get_cmd(&cur, end, NULL, t, &out->command_id) != 0 || get_str(&cur, end, &out->trace_id) != 0 ||
+        get_str(&cur, end, &out->target_plane) != 0 || get_varint(&cur, end, &out->hint_count) != 0) {
+        return -1;
+    }
+    out->hints_raw = cur;
+    for (size_t i = 0; i < out->hint_count; i++) {
+        yai_bin_str_t h;
+        if (get_str(&cur, end, &h) != 0) {
+            return -1;
+        }
+    }
+    out->hints_end = cur;
+    if (get_str(&cur, end, &out->details) != 0 || get_str(&cur, end, &out->data) != 0) {
+        return -1;
+    }
+    return cur == end ? 0 : -1;
+}
+
+/* ============================================================
+   JSON TEXT
+   ============================================================ */
+
+#define JSON_KEY_OVERHEAD 32u
+
+size_t yai_bin_reply_json_size(const yai_bin_reply_t *r)
+{
+    /* every byte escapes to at most 6 ("\u00XX") */
+    size_t n = 64 + 8 * JSON_KEY_OVERHEAD;
+    n += 6 * (r->status.len + r->code.len + r->reason.len + r->summary.len + r->command_id.len +
+              r->trace_id.len + r->target_plane.len);
+    n += r->details.len + r->data.len + 2 * JSON_KEY_OVERHEAD;
+    if (r->hints_raw) {
+        n += 6 * (size_t)(r->hints_end - r->hints_raw) + 4 * r->hint_count;
+    } else {
+        for (size_t i = 0; i < r->hint_count; i++) {
+            n += 6 * r->hints[i].len + 4;
+        }
+    }
+    return n;
+}
+
+typedef struct json_out {
+    char *p;
+    size_t len;
+    size_t cap;
+} json_out_t;
+
+static void jput(json_out_t *o, const char *s, size_t n)
+{
+    if (o->cap - o->len <= n) {
+        n = (o->cap - o->len > 0) ? o->cap - o->len - 1 : 0;
+    }
+    memcpy(o->p + o->len, s, n);
+    o->len += n;
+}
+
+static void jput_escaped(json_out_t *o, const yai_bin_str_t *s)
+{
+    static const char hex[] = "0123456789abcdef";
+    size_t run = 0;
+
+    jput(o, "\"", 1);
+    for (size_t i = 0; i < s->len; i++) {
+        unsigned char ch = (unsigned char)s->p[i];
+        if (ch >= 0x20u && ch != '"' && ch != '\\') {
+            continue;
+        }
+        jput(o, s->p + run, i - run);
+        run = i + 1;
+        if (ch == '"' || ch == '\\') {
+            char esc[2] = {'\\', (char)ch};
+            jput(o, esc, 2);
+        } else {
+            char esc[6] = {'\\', 'u', '0', '0', hex[ch >> 4], hex[ch & 0xFu]};
+            jput(o, esc, 6);
+        }
+    }
+    jput(o, s->p + run, s->len - run);
+    jput(o, "\"", 1);
+}
+
+static void jput_member(json_out_t *o, const char *key, const yai_bin_str_t *s)
+{
+    if (s->len == 0) {
+        return;
+    }
+    jput(o, ",\"", 2);
+    jput(o, key, strlen(key));
+    jput(o, "\":", 2);
+    jput_escaped(o, s);
+}
+
+static void jput_raw_member(json_out_t *o, const char *key, const yai_bin_str_t *s)
+{
+    if (s->len == 0) {
+        return;
+    }
+    jput(o, ",\"", 2);
+    jput(o, key, strlen(key));
+    jput(o, "\":", 2);
+    jput(o, s->p, s->len);
+}
+
+size_t yai_bin_reply_to_json(const yai_bin_reply_t *r, char *dst, size_t cap)
+{
+    static const char k_head[] = "{\"type\":\"yai.exec.reply.v1\"";
+    json_out_t o = {dst, 0, cap};
+
+    if (!r || !dst || cap == 0) {
+        return 0;
+    }
+    jput(&o, k_head, sizeof(k_head) - 1);
+    jput_member(&o, "status", &r->status);
+    jput_member(&o, "code", &r->code);
+    jput_member(&o, "reason", &r->reason);
+    jput_member(&o, "summary", &r->summary);
+    jput_member(&o, "command_id", &r->command_id);
+    jput_member(&o, "trace_id", &r->trace_id);
+    jput_member(&o, "target_plane", &r->target_plane);
+    if (r->hint_count > 0) {
+        const uint8_t *cur = r->hints_raw;
+        jput(&o, ",\"hints\":[", 10);
+        for (size_t i = 0; i < r->hint_count; i++) {
+            yai_bin_str_t h;
+            if (r->hints_raw) {
+                if (yai_bin_next_str(&cur, r->hints_end, &h) != 0) {
+                    break;
+                }
+            } else {
+                h = r->hints[i];
+            }
+            if (i > 0) {
+                jput(&o, ",", 1);
+            }
+            jput_escaped(&o, &h);
+        }
+        jput(&o, "]", 1);
+    }
+    jput_raw_member(&o, "details", &r->details);
+    jput_raw_member(&o, "data", &r->data);
+    jput(&o, "}", 1);
+    o.p[o.len] = '\0';
+    return o.len;
+}
@@ -0,0 +1,90 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Compact binary form of yai.control.call.v1 and yai.exec.reply.v1, used
+ * on a connection whose handshake granted YAI_RPC_CAP_BINARY and flagged
+ * per frame with YAI_RPC_FLAG_BINARY.
+ *
+ * Layout (integers are unsigned LEB128 varints, strings are varint length
+ * then bytes, no terminator):
+ *
+ *   call:  u8 version, u8 kind=1, cmd, target_plane, argc, argv[argc]
+ *   reply: u8 version, u8 kind=2, status, code, reason, summary, cmd,
+ *          trace_id, target_plane, hint_count, hints[hint_count],
+ *          details (JSON object text), data (JSON text)
+ *
+ * cmd is a varint reference: k > 0 names entry k - 1 of the connection's
+ * intern table, 0 is followed by the id as a string. Inline ids in calls
+ * are appended to the table on both sides while it has room; replies only
+ * reference, so pipelined replies cannot reorder the table. An empty
+ * string stands for an absent member.
+ */
+
+#define YAI_BIN_VERSION 1u
+#define YAI_BIN_KIND_CALL 1u
+#define YAI_BIN_KIND_REPLY 2u
+
+#define YAI_BIN_INTERN_MAX 64u
+#define YAI_BIN_ID_MAX 128u
+
+typedef struct yai_bin_str {
+    const char *p;
+    size_t len;
+} yai_bin_str_t;
+
+/* Per-connection command id table; reset whenever the connection is. */
+typedef struct yai_bin_intern {
+    size_t count;
+    uint8_t lens[YAI_BIN_INTERN_MAX];
+    char ids[YAI_BIN_INTERN_MAX][YAI_BIN_ID_MAX];
+} yai_bin_intern_t;
+
+typedef struct yai_bin_call {
+    yai_bin_str_t command_id;
+    yai_bin_str_t target_plane;
+    size_t argc;
+    /* encode: argc entries; decode: the raw argv region, see yai_bin_next_str */
+    const yai_bin_str_t *argv;
+    const uint8_t *argv_raw;
+    const uint8_t *argv_end;
+} yai_bin_call_t;
+
+typedef struct yai_bin_reply {
+    yai_bin_str_t status;
+    yai_bin_str_t code;
+    yai_bin_str_t reason;
+    yai_bin_str_t summary;
+    yai_bin_str_t command_id;
+    yai_bin_str_t trace_id;
+    yai_bin_str_t target_plane;
+    size_t hint_count;
+    /* encode: hint_count entries; decode: the raw hint region */
+    const yai_bin_str_t *hints;
+    const uint8_t *hints_raw;
+    const uint8_t *hints_end;
+    yai_bin_str_t details;
+    yai_bin_str_t data;
+} yai_bin_reply_t;
+
+void yai_bin_intern_reset(yai_bin_intern_t *t);
+
+/* Bytes written, or 0 when dst is too small or a field is unencodable. */
+size_t yai_bin_call_encode(const yai_bin_call_t *call, yai_bin_intern_t *t, uint8_t *dst, size_t cap);
+size_t yai_bin_reply_encode(const yai_bin_reply_t *reply, const yai_bin_intern_t *t, uint8_t *dst, size_t cap);
+
+/* 0, or -1 when malformed. Decoded strings point into buf or the table. */
+int yai_bin_call_decode(const uint8_t *buf, size_t len, yai_bin_intern_t *t, yai_bin_call_t *out);
+int yai_bin_reply_decode(const uint8_t *buf, size_t len, const yai_bin_intern_t *t, yai_bin_reply_t *out);
+
+/* Next string of a decoded argv/hint region: 0, 1 at the end, -1 malformed. */
+int yai_bin_next_str(const uint8_t **cur, const uint8_t *end, yai_bin_str_t *out);
+
+/* Upper bound of yai_bin_reply_to_json output, terminator included. */
+size_t yai_bin_reply_json_size(const yai_bin_reply_t *reply);
+
+/* The equivalent yai.exec.reply.v1 JSON text (NUL-terminated); returns its length. */
+size_t yai_bin_reply_to_json(const yai_bin_reply_t *reply, char *dst, size_t cap);
@@ -32,6 +32,12 @@ int yai_reply_map_rc(const char *status, const char *code)
     if (strcmp(code, "SERVER_UNAVAILABLE") == 0) {
         return YAI_SDK_SERVER_OFF;
     }
+    if (strcmp(code, "TIMEOUT") == 0) {
+        return YAI_SDK_TIMEOUT;
+    }
+    if (strcmp(code, "NOT_SENT") == 0) {
+        return YAI_SDK_RPC;
+    }
     if (strcmp(code, "PROTOCOL_ERROR") == 0 ||
         strcmp(code, "INTERNAL_ERROR") == 0 ||
         strcmp(code, "INVALID_TARGET") == 0) {
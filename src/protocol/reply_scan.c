@@ -0,0 +1,611 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include "reply_scan.h"
+
+#include <stdint.h>
+#include <string.h>
+
+/* Nesting deeper than this is left to the cJSON fallback. */
+#define SCAN_MAX_DEPTH 64
+
+typedef struct scan_cur {
+    const char *p;
+    const char *end;
+} scan_cur_t;
+
+static void skip_ws(scan_cur_t *c)
+{
+    while (c->p < c->end && (*c->p == ' ' || *c->p == '\t' || *c->p == '\n' || *c->p == '\r'))
+        c->p++;
+}
+
+/* At the opening quote; leaves c->p past the closing one. */
+static int scan_string(scan_cur_t *c, yai_jspan_t *s)
+{
+    const char *start = ++c->p;
+    const char *q;
+
+    for (;;)
+    {
+        const char *b;
+        size_t slashes = 0;
+
+        q = (const char *)memchr(c->p, '"', (size_t)(c->end - c->p));
+        if (!q)
+            return -1;
+        for (b = q; b > start && b[-1] == '\\'; b--)
+            slashes++;
+        if ((slashes & 1u) == 0)
+            break;
+        c->p = q + 1;
+    }
+    s->p = start;
+    s->len = (size_t)(q - start);
+    s->kind = YAI_JSPAN_STRING;
+    s->escaped = memchr(start, '\\', s->len) != NULL;
+    c->p = q + 1;
+    return 0;
+}
+
+static int is_digit(char ch)
+{
+    return ch >= '0' && ch <= '9';
+}
+
+static const char *skip_digits(const char *p, const char *end)
+{
+    while (p < end && is_digit(*p))
+        p++;
+    return p;
+}
+
+/* true, false, null or a JSON number; leaves c->p past it. */
+static int scan_literal(scan_cur_t *c)
+{
+    static const char *const k_words[] = {"true", "false", "null"};
+    const char *p = c->p;
+    const char *end = c->end;
+
+    for (size_t i = 0; i < sizeof(k_words) / sizeof(k_words[0]); i++)
+    {
+        size_t n = strlen(k_words[i]);
+        if ((size_t)(end - p) >= n && memcmp(p, k_words[i], n) == 0)
+        {
+            c->p = p + n;
+            return 0;
+        }
+    }
+
+    if (p < end && *p == '-')
+        p++;
+    if (p < end && *p == '0')
+        p++;
+    else if (p < end && *p >= '1' && *p <= '9')
+        p = skip_digits(p, end);
+    else
+        return -1;
+    if (p < end && *p == '.')
+    {
+        if (++p == end || !is_digit(*p))
+            return -1;
+        p = skip_digits(p, end);
+    }
+    if (p < end && (*p == 'e' || *p == 'E'))
+    {
+        if (++p < end && (*p == '+' || *p == '-'))
+            p++;
+        if (p == end || !is_digit(*p))
+            return -1;
+        p = skip_digits(p, end);
+    }
+    c->p = p;
+    return 0;
+}
+
+/* Container parse states: what may come next. */
+enum { SCAN_VALUE, SCAN_KEY, SCAN_FIRST, SCAN_NEXT };
+
+/*
+ * Objects and arrays are walked with a bit stack for the open brackets and
+ * checked member by member, so anything that is not JSON goes to the cJSON
+ * fallback instead of being taken as a value.
+ */
+static int scan_container(scan_cur_t *c, yai_jspan_t *s)
+{
+    const char *start = c->p;
+    uint64_t is_obj = 0;
+    int depth = 0;
+    int state = SCAN_VALUE;
+
+    for (;;)
+    {
+        yai_jspan_t tmp;
+        char ch;
+
+        skip_ws(c);
+        if (c->p >= c->end)
+            return -1;
+        ch = *c->p;
+
+        switch (state)
+        {
+        case SCAN_FIRST:
+            if (ch != ((is_obj & 1u) ? '}' : ']'))
+            {
+                state = (is_obj & 1u) ? SCAN_KEY : SCAN_VALUE;
+                continue;
+            }
+            break;
+        case SCAN_KEY:
+            if (ch != '"' || scan_string(c, &tmp) != 0)
+                return -1;
+            skip_ws(c);
+            if (c->p >= c->end || *c->p != ':')
+                return -1;
+            c->p++;
+            state = SCAN_VALUE;
+            continue;
+        case SCAN_VALUE:
+            if (ch == '{' || ch == '[')
+            {
+                if (depth == SCAN_MAX_DEPTH)
+                    return -1;
+                is_obj = (is_obj << 1) | (ch == '{');
+                depth++;
+                c->p++;
+                state = SCAN_FIRST;
+                continue;
+            }
+            if ((ch == '"') ? scan_string(c, &tmp) != 0 : scan_literal(c) != 0)
+                return -1;
+            state = SCAN_NEXT;
+            continue;
+        default: /* SCAN_NEXT */
+            if (ch == ',')
+            {
+                c->p++;
+                state = (is_obj & 1u) ? SCAN_KEY : SCAN_VALUE;
+                continue;
+            }
+            if (ch != ((is_obj & 1u) ? '}' : ']'))
+                return -1;
+            break;
+        }
+
+        /* the innermost container closes */
+        c->p++;
+        is_obj >>= 1;
+        if (--depth == 0)
+        {
+            s->p = start;
+            s->len = (size_t)(c->p - start);
+            s->kind = (*start == '{') ? YAI_JSPAN_OBJECT : YAI_JSPAN_ARRAY;
+            s->escaped = 0;
+            return 0;
+        }
+        state = SCAN_NEXT;
+    }
+}
+
+static int scan_value(scan_cur_t *c, yai_jspan_t *s)
+{
+    const char *start;
+
+    skip_ws(c);
+    if (c->p >= c->end)
+        return -1;
+    if (*c->p == '"')
+        return scan_string(c, s);
+    if (*c->p == '{' || *c->p == '[')
+        return scan_container(c, s);
+
+    start = c->p;
+    if (scan_literal(c) != 0)
+        return -1;
+    s->p = start;
+    s->len = (size_t)(c->p - start);
+    s->kind = YAI_JSPAN_OTHER;
+    s->escaped = 0;
+    return 0;
+}
+
+static int key_is(const yai_jspan_t *key, const char *name, size_t name_len)
+{
+    if (key->escaped)
+        return yai_jspan_equals(key, name);
+    return key->len == name_len && memcmp(key->p, name, name_len) == 0;
+}
+
+/*
+ * Walks "{ key: value, ... }". on_member returns 1 to stop early, 0 to go
+ * on. Returns 0 at the closing brace or on an early stop, -1 if malformed.
+ */
+static int scan_object(const char *json,
+                       size_t len,
+                       int (*on_member)(void *user, const yai_jspan_t *key, const yai_jspan_t *val),
+                       void *user)
+{
+    scan_cur_t c = {json, json + len};
+
+    skip_ws(&c);
+    if (c.p >= c.end || *c.p != '{')
+        return -1;
+    c.p++;
+    skip_ws(&c);
+    if (c.p < c.end && *c.p == '}')
+        return 0;
+
+    for (;;)
+    {
+        yai_jspan_t key;
+        yai_jspan_t val;
+
+        skip_ws(&c);
+        if (c.p >= c.end || *c.p != '"' || scan_string(&c, &key) != 0)
+            return -1;
+        skip_ws(&c);
+        if (c.p >= c.end || *c.p != ':')
+            return -1;
+        c.p++;
+        if (scan_value(&c, &val) != 0)
+            return -1;
+        if (on_member(user, &key, &val))
+            return 0;
+        skip_ws(&c);
+        if (c.p >= c.end)
+            return -1;
+        if (*c.p == '}')
+            return 0;
+        if (*c.p != ',')
+            return -1;
+        c.p++;
+    }
+}
+
+/* ============================================================
+   REPLY FIELDS
+   ============================================================ */
+
+#define REPLY_FIELD(name) {#name, sizeof(#name) - 1, offsetof(yai_reply_scan_t, name)}
+
+static const struct {
+    const char *name;
+    size_t len;
+    size_t off;
+} k_reply_fields[] = {
+    REPLY_FIELD(type),
+    REPLY_FIELD(status),
+    REPLY_FIELD(code),
+    REPLY_FIELD(reason),
+    REPLY_FIELD(summary),
+    REPLY_FIELD(command_id),
+    REPLY_FIELD(trace_id),
+    REPLY_FIELD(target_plane),
+    REPLY_FIELD(hint),
+    REPLY_FIELD(hints),
+    REPLY_FIELD(details),
+};
+
+static int on_reply_member(void *user, const yai_jspan_t *key, const yai_jspan_t *val)
+{
+    yai_reply_scan_t *out = (yai_reply_scan_t *)user;
+
+    for (size_t i = 0; i < sizeof(k_reply_fields) / sizeof(k_reply_fields[0]); i++)
+    {
+        if (key_is(key, k_reply_fields[i].name, k_reply_fields[i].len))
+        {
+            yai_jspan_t *dst = (yai_jspan_t *)((char *)out + k_reply_fields[i].off);
+            if (dst->kind == YAI_JSPAN_ABSENT)
+                *dst = *val;
+            break;
+        }
+    }
+    return 0;
+}
+
+int yai_reply_scan(const char *json, size_t len, yai_reply_scan_t *out)
+{
+    if (!json || !out)
+        return -1;
+    memset(out, 0, sizeof(*out));
+    return scan_object(json, len, on_reply_member, out);
+}
+
+int yai_jspan_each(const char *json,
+                   size_t len,
+                   int (*on_member)(void *user, const yai_jspan_t *key, const yai_jspan_t *val),
+                   void *user)
+{
+    if (!json || !on_member)
+        return -1;
+    return scan_object(json, len, on_member, user);
+}
+
+typedef struct find_ctx {
+    const char *key;
+    size_t key_len;
+    yai_jspan_t *out;
+    int found;
+} find_ctx_t;
+
+static int on_find_member(void *user, const yai_jspan_t *key, const yai_jspan_t *val)
+{
+    find_ctx_t *f = (find_ctx_t *)user;
+    if (!key_is(key, f->key, f->key_len))
+        return 0;
+    *f->out = *val;
+    f->found = 1;
+    return 1;
+}
+
+int yai_jspan_find(const char *json, size_t len, const char *key, yai_jspan_t *out)
+{
+    find_ctx_t f;
+
+    if (!json || !key || !out)
+        return -1;
+    memset(out, 0, sizeof(*out));
+    f.key = key;
+    f.key_len = strlen(key);
+    f.out = out;
+    f.found = 0;
+    if (scan_object(json, len, on_find_member, &f) != 0)
+        return -1;
+    return f.found ? 0 : 1;
+}
+
+int yai_jspan_array_next(const yai_jspan_t *arr, size_t *pos, yai_jspan_t *out)
+{
+    scan_cur_t c;
+
+    if (!arr || !pos || !out || arr->kind != YAI_JSPAN_ARRAY)
+        return -1;
+    memset(out, 0, sizeof(*out));
+    c.p = arr->p + 1 + *pos;
+    c.end = arr->p + arr->len - 1;
+    skip_ws(&c);
+    if (c.p >= c.end)
+        return 1;
+    if (*pos != 0)
+    {
+        if (*c.p != ',')
+            return -1;
+        c.p++;
+    }
+    if (scan_value(&c, out) != 0)
+        return -1;
+    *pos = (size_t)(c.p - (arr->p + 1));
+    return 0;
+}
+
+int yai_jspan_array_item(const yai_jspan_t *arr, size_t idx, yai_jspan_t *out)
+{
+    size_t pos = 0;
+    int rc;
+
+    for (size_t i = 0;; i++)
+    {
+        rc = yai_jspan_array_next(arr, &pos, out);
+        if (rc != 0 || i == idx)
+            return rc;
+    }
+}
+
+/* ============================================================
+   COPY-OUT
+   ============================================================ */
+
+/* n, less a UTF-8 sequence that truncation cut short at the end of s[0..n). */
+static size_t utf8_whole(const char *s, size_t n)
+{
+    size_t i = n;
+    size_t need;
+    unsigned char lead;
+
+    while (i > 0 && n - i < 3 && ((unsigned char)s[i - 1] & 0xC0u) == 0x80u)
+        i--;
+    if (i == 0)
+        return n;
+    lead = (unsigned char)s[i - 1];
+    need = (lead >= 0xF0u) ? 4 : (lead >= 0xE0u) ? 3 : (lead >= 0xC0u) ? 2 : 1;
+    return (need > 1 && n - (i - 1) < need) ? i - 1 : n;
+}
+
+static int hex4(const char *p, unsigned *v)
+{
+    *v = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        char ch = p[i];
+        *v <<= 4;
+        if (ch >= '0' && ch <= '9')
+            *v |= (unsigned)(ch - '0');
+        else if (ch >= 'a' && ch <= 'f')
+            *v |= (unsigned)(ch - 'a' + 10);
+        else if (ch >= 'A' && ch <= 'F')
+            *v |= (unsigned)(ch - 'A' + 10);
+        else
+            return -1;
+    }
+    return 0;
+}
+
+/* Decodes the escape at *pp (just past the backslash) into buf; returns its byte count. */
+static size_t unescape_one(const char **pp, const char *end, char buf[4])
+{
+    const char *p = *pp;
+    unsigned cp;
+
+    if (p >= end)
+        return 0;
+    *pp = p + 1;
+    switch (*p)
+    {
+    case 'b': buf[0] = '\b'; return 1;
+    case 'f': buf[0] = '\f'; return 1;
+    case 'n': buf[0] = '\n'; return 1;
+    case 'r': buf[0] = '\r'; return 1;
+    case 't': buf[0] = '\t'; return 1;
+    case 'u':
+        break;
+    default:
+        buf[0] = *p; /* \" \\ \/ */
+        return 1;
+    }
+
+    if (end - p < 5 || hex4(p + 1, &cp) != 0)
+        return 0;
+    *pp = p + 5;
+    if (cp >= 0xD800u && cp <= 0xDBFFu)
+    {
+        unsigned lo;
+        if (end - *pp < 6 || (*pp)[0] != '\\' || (*pp)[1] != 'u' || hex4(*pp + 2, &lo) != 0 ||
+            lo < 0xDC00u || lo > 0xDFFFu)
+            return 0;
+        *pp += 6;
+        cp = 0x10000u + ((cp - 0xD800u) << 10) + (lo - 0xDC00u);
+    }
+    if (cp < 0x80u)
+    {
+        buf[0] = (char)cp;
+        return 1;
+    }
+    if (cp < 0x800u)
+    {
+        buf[0] = (char)(0xC0u | (cp >> 6));
+        buf[1] = (char)(0x80u | (cp & 0x3Fu));
+        return 2;
+    }
+    if (cp < 0x10000u)
+    {
+        buf[0] = (char)(0xE0u | (cp >> 12));
+        buf[1] = (char)(0x80u | ((cp >> 6) & 0x3Fu));
+        buf[2] = (char)(0x80u | (cp & 0x3Fu));
+        return 3;
+    }
+    buf[0] = (char)(0xF0u | (cp >> 18));
+    buf[1] = (char)(0x80u | ((cp >> 12) & 0x3Fu));
+    buf[2] = (char)(0x80u | ((cp >> 6) & 0x3Fu));
+    buf[3] = (char)(0x80u | (cp & 0x3Fu));
+    return 4;
+}
+
+size_t yai_jspan_copy(const yai_jspan_t *s, char *dst, size_t cap)
+{
+    const char *p;
+    const char *end;
+    size_t n = 0;
+
+    if (!dst || cap == 0)
+        return 0;
+    dst[0] = '\0';
+    if (!s || s->kind != YAI_JSPAN_STRING)
+        return 0;
+
+    if (!s->escaped)
+    {
+        n = (s->len < cap - 1) ? s->len : utf8_whole(s->p, cap - 1);
+        memcpy(dst, s->p, n);
+        dst[n] = '\0';
+        return n;
+    }
+
+    p = s->p;
+    end = s->p + s->len;
+    while (p < end && n < cap - 1)
+    {
+        if (*p != '\\')
+        {
+            dst[n++] = *p++;
+            continue;
+        }
+        char buf[4];
+        p++;
+        size_t k = unescape_one(&p, end, buf);
+        if (k == 0 || n + k > cap - 1)
+            break; /* an escaped code point goes in whole or not at all */
+        memcpy(dst + n, buf, k);
+        n += k;
+    }
+    if (p < end)
+        n = utf8_whole(dst, n);
+    dst[n] = '\0';
+    return n;
+}
+
+int yai_jspan_equals(const yai_jspan_t *s, const char *lit)
+{
+    size_t lit_len;
+    const char *p;
+    const char *end;
+
+    if (!s || !lit || s->kind != YAI_JSPAN_STRING)
+        return 0;
+    lit_len = strlen(lit);
+    if (!s->escaped)
+        return s->len == lit_len && memcmp(s->p, lit, lit_len) == 0;
+
+    p = s->p;
+    end = s->p + s->len;
+    while (p < end)
+    {
+        char buf[4];
+        size_t k;
+        if (*p != '\\')
+        {
+            buf[0] = *p++;
+            k = 1;
+        }
+        else
+        {
+            p++;
+            k = unescape_one(&p, end, buf);
+            if (k == 0)
+                return 0;
+        }
+        if (k > lit_len || memcmp(buf, lit, k) != 0)
+            return 0;
+        lit += k;
+        lit_len -= k;
+    }
+    return lit_len == 0;
+}
+
+size_t yai_jspan_copy_compact(const yai_jspan_t *s, char *dst, size_t cap)
+{
+    const char *p;
+    const char *end;
+    size_t n = 0;
+    int in_str = 0;
+
+    if (!dst || cap == 0)
+        return 0;
+    dst[0] = '\0';
+    if (!s || s->kind == YAI_JSPAN_ABSENT)
+        return 0;
+
+    p = s->p;
+    end = s->p + s->len;
+    while (p < end && n < cap - 1)
+    {
+        char ch = *p++;
+        if (in_str)
+        {
+            dst[n++] = ch;
+            if (ch == '\\' && p < end && n < cap - 1)
+                dst[n++] = *p++;
+            else if (ch == '"')
+                in_str = 0;
+            continue;
+        }
+        if (ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r')
+            continue;
+        if (ch == '"')
+            in_str = 1;
+        dst[n++] = ch;
+    }
+    if (p < end)
+        n = utf8_whole(dst, n);
+    dst[n] = '\0';
+    return n;
+}
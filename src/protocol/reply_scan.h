@@ -0,0 +1,70 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+#pragma once
+
+#include <stddef.h>
+
+/*
+ * Single-pass scanner for yai.exec.reply.v1 payloads. It walks the top-level
+ * object once and records where the known fields sit in the caller's buffer;
+ * nothing is allocated or copied until a span is asked for.
+ */
+
+typedef enum {
+    YAI_JSPAN_ABSENT = 0,
+    YAI_JSPAN_STRING,
+    YAI_JSPAN_OBJECT,
+    YAI_JSPAN_ARRAY,
+    YAI_JSPAN_OTHER /* number, true, false, null */
+} yai_jspan_kind_t;
+
+typedef struct yai_jspan {
+    /* strings: the raw bytes between the quotes; others: the whole value */
+    const char *p;
+    size_t len;
+    yai_jspan_kind_t kind;
+    /* string holds backslash escapes */
+    int escaped;
+} yai_jspan_t;
+
+typedef struct yai_reply_scan {
+    yai_jspan_t type;
+    yai_jspan_t status;
+    yai_jspan_t code;
+    yai_jspan_t reason;
+    yai_jspan_t summary;
+    yai_jspan_t command_id;
+    yai_jspan_t trace_id;
+    yai_jspan_t target_plane;
+    yai_jspan_t hint;
+    yai_jspan_t hints;
+    yai_jspan_t details;
+} yai_reply_scan_t;
+
+/* 0, or -1 when json is not a well-formed object (first key wins on duplicates). */
+int yai_reply_scan(const char *json, size_t len, yai_reply_scan_t *out);
+
+/* Calls on_member for each top-level member until it returns non-zero: 0, or -1 when malformed. */
+int yai_jspan_each(const char *json,
+                   size_t len,
+                   int (*on_member)(void *user, const yai_jspan_t *key, const yai_jspan_t *val),
+                   void *user);
+
+/* Top-level lookup of one key, stopping at the first hit: 0 found, 1 absent, -1 malformed. */
+int yai_jspan_find(const char *json, size_t len, const char *key, yai_jspan_t *out);
+
+/* Next element of an array span; *pos starts at 0. 0 item, 1 end, -1 malformed. */
+int yai_jspan_array_next(const yai_jspan_t *arr, size_t *pos, yai_jspan_t *out);
+
+/* Element idx of an array span: 0 found, 1 past the end, -1 malformed. */
+int yai_jspan_array_item(const yai_jspan_t *arr, size_t idx, yai_jspan_t *out);
+
+/* Unescaped string into dst (always NUL-terminated, truncated to cap - 1
+ * without splitting a UTF-8 sequence). */
+size_t yai_jspan_copy(const yai_jspan_t *s, char *dst, size_t cap);
+
+/* Non-zero when the string span unescapes to lit. */
+int yai_jspan_equals(const yai_jspan_t *s, const char *lit);
+
+/* Raw JSON value without insignificant whitespace (NUL-terminated, truncated
+ * like yai_jspan_copy). */
+size_t yai_jspan_copy_compact(const yai_jspan_t *s, char *dst, size_t cap);
@@ -5,45 +5,49 @@
 #include "yai_sdk/registry/registry_cache.h"
 #include "yai_sdk/registry/registry_validate.h"
 
+#include <pthread.h>
 #include <stddef.h>
 #include <stdio.h>
 
 static yai_law_registry_cache_t g_cache;
 static const yai_law_registry_t* g_reg = NULL;
-static int g_inited = 0;
 static int g_init_rc = 1;
+static pthread_once_t g_init_once = PTHREAD_ONCE_INIT;
 
-int yai_law_registry_init(void)
+/* Runs once per process; later callers see its result. */
+static void registry_load_once(void)
 {
-    if (g_inited) return g_init_rc;
-    g_inited = 1;
-
     yai_law_registry_cache_init(&g_cache);
 
     /* 1) Load registry into cache (generated/embedded or from file, depending on your impl) */
     if (yai_law_registry_cache_load(&g_cache) != 0) {
         g_reg = NULL;
         g_init_rc = 1;
-        return g_init_rc;
+        return;
     }
 
     const yai_law_registry_t* reg = yai_law_registry_cache_get(&g_cache);
     if (!reg) {
         g_reg = NULL;
         g_init_rc = 1;
-        return g_init_rc;
+        return;
     }
 
     /* 2) Validate (structural checks; no IO) */
     if (yai_law_registry_validate_all(reg) != 0) {
         g_reg = NULL;
         g_init_rc = 1;
-        return g_init_rc;
+        return;
     }
 
     /* 3) Publish */
     g_reg = reg;
     g_init_rc = 0;
+}
+
+int yai_law_registry_init(void)
+{
+    pthread_once(&g_init_once, registry_load_once);
     return g_init_rc;
 }
 
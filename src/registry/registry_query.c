@@ -8,6 +8,7 @@
 
 #include "yai_sdk/registry/registry_registry.h"
 
+#include <pthread.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stddef.h>
@@ -26,6 +27,7 @@ typedef struct group_entry {
 } group_entry_t;
 
 static int g_inited = 0;
+static pthread_once_t g_query_once = PTHREAD_ONCE_INIT;
 
 static idx_entry_t* g_id_index = NULL;
 static size_t g_id_index_len = 0;
@@ -105,9 +107,7 @@ static int ensure_group_items_capacity(group_entry_t* ge, size_t need) {
  * Build indexes once, using the published registry.
  * This assumes registry_load.c already knows how to init/cache the registry.
  */
-static int registry_query_init(void) {
-  if (g_inited) return 0;
-
+static int registry_query_build(void) {
   /* ensure registry is available */
   if (yai_law_registry_init() != 0) return 1;
 
@@ -203,13 +203,21 @@ static int registry_query_init(void) {
   return 0;
 }
 
+static void registry_query_once(void) {
+  (void)registry_query_build();
+}
+
+/* Safe from any thread: the first caller builds, the others wait for it. */
+static int registry_query_init(void) {
+  pthread_once(&g_query_once, registry_query_once);
+  return g_inited ? 0 : 1;
+}
+
 /* ---- Public query API (declared in registry_registry.h) ---- */
 
 const yai_law_command_t* yai_law_cmd_by_id(const char* id) {
   if (!id) return NULL;
-  if (!g_inited) {
-    if (registry_query_init() != 0) return NULL;
-  }
+  if (registry_query_init() != 0) return NULL;
   const idx_entry_t* e = bsearch_id(id);
   return e ? e->cmd : NULL;
 }
@@ -218,9 +226,7 @@ yai_law_cmd_list_t yai_law_cmds_by_group(const char* group) {
   yai_law_cmd_list_t out = (yai_law_cmd_list_t){ .items = NULL, .len = 0 };
 
   if (!group) return out;
-  if (!g_inited) {
-    if (registry_query_init() != 0) return out;
-  }
+  if (registry_query_init() != 0) return out;
 
   for (size_t i = 0; i < g_groups_len; i++) {
     if (g_groups[i].group && strcmp(g_groups[i].group, group) == 0) {
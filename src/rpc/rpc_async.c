@@ -0,0 +1,243 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+// src/rpc/rpc_async.c
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <yai_sdk/rpc.h>
+
+#include "rpc_internal.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+/* Reads are sized so a burst of small replies lands in one syscall. */
+#define ASYNC_READ_CHUNK (16u * 1024u)
+
+struct yai_rpc_client_async {
+    yai_rpc_client_t c;
+    yai_rpc_slots_t slots;
+    yai_rpc_tx_t tx;
+    yai_rpc_rx_t rx;
+    int err; /* sticky transport error, 0 while healthy */
+    /* compressed requests and inflated replies */
+    uint8_t *ztx;
+    size_t ztx_cap;
+    uint8_t *zrx;
+    size_t zrx_cap;
+};
+
+int yai_rpc_async_open(yai_rpc_client_async_t **out, yai_rpc_client_t *c, size_t window)
+{
+    yai_rpc_client_async_t *a;
+    int flags;
+    int rc;
+
+    if (!out)
+        return -1;
+    *out = NULL;
+    if (!c || c->fd < 0 || window == 0)
+        return -1;
+    rc = yai_rpc_handshake_settle(c);
+    if (rc != 0)
+        return rc;
+    window = yai_rpc_window(c, window);
+
+    flags = fcntl(c->fd, F_GETFL, 0);
+    if (flags < 0 || fcntl(c->fd, F_SETFL, flags | O_NONBLOCK) != 0)
+        return -3;
+
+    a = (yai_rpc_client_async_t *)calloc(1, sizeof(*a));
+    if (!a)
+        return -2;
+    if (yai_rpc_slots_init(&a->slots, window) != 0)
+    {
+        free(a);
+        return -2;
+    }
+    yai_rpc_rx_init(&a->rx);
+    a->c = *c;
+    c->fd = -1;
+    *out = a;
+    return 0;
+}
+
+void yai_rpc_async_close(yai_rpc_client_async_t *a)
+{
+    if (!a)
+        return;
+    yai_rpc_close(&a->c);
+    yai_rpc_rx_free(&a->rx);
+    yai_rpc_tx_free(&a->tx);
+    yai_rpc_slots_free(&a->slots);
+    free(a->ztx);
+    free(a->zrx);
+    free(a);
+}
+
+int yai_rpc_async_fd(const yai_rpc_client_async_t *a)
+{
+    return a ? a->c.fd : -1;
+}
+
+unsigned yai_rpc_async_want(const yai_rpc_client_async_t *a)
+{
+    unsigned want = 0;
+
+    if (!a || a->err != 0)
+        return 0;
+    if (a->tx.off < a->tx.len)
+        want |= YAI_RPC_WANT_WRITE;
+    if (a->slots.live > 0)
+        want |= YAI_RPC_WANT_READ;
+    return want;
+}
+
+size_t yai_rpc_async_in_flight(const yai_rpc_client_async_t *a)
+{
+    return a ? a->slots.live : 0;
+}
+
+size_t yai_rpc_async_window(const yai_rpc_client_async_t *a)
+{
+    return a ? a->slots.window : 0;
+}
+
+int yai_rpc_async_submit(
+    yai_rpc_client_async_t *a,
+    uint32_t command_id,
+    const void *payload,
+    uint32_t payload_len,
+    void *cookie)
+{
+    yai_rpc_envelope_t env;
+
+    if (!a || a->c.fd < 0)
+        return -1;
+    if (a->err != 0)
+        return a->err;
+    if (payload_len > 0 && !payload)
+        return -2;
+    if (a->slots.used == a->slots.window)
+        return -13;
+
+    if (yai_rpc_envelope_init(&a->c, &env, command_id, payload_len) != 0)
+        return -11;
+    payload = yai_rpc_deflate(&a->c, &env, payload, &a->ztx, &a->ztx_cap);
+    yai_rpc_envelope_seal(&a->c, &env, payload);
+    if (yai_rpc_tx_append(&a->tx, &env, sizeof(env), payload, env.payload_len) != 0)
+        return -2;
+
+    yai_rpc_slots_push(&a->slots, &env, cookie);
+    return 0;
+}
+
+int yai_rpc_async_on_writable(yai_rpc_client_async_t *a)
+{
+    if (!a || a->c.fd < 0)
+        return -1;
+    if (a->err != 0)
+        return a->err;
+
+    while (a->tx.off < a->tx.len)
+    {
+        /* MSG_NOSIGNAL: a dead peer must surface as -3, not SIGPIPE */
+        ssize_t w = send(a->c.fd, a->tx.data + a->tx.off, a->tx.len - a->tx.off, MSG_NOSIGNAL);
+        if (w < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                return 0;
+            a->err = -3;
+            return a->err;
+        }
+        a->tx.off += (size_t)w;
+    }
+    a->tx.off = 0;
+    a->tx.len = 0;
+    return 0;
+}
+
+int yai_rpc_async_on_readable(yai_rpc_client_async_t *a)
+{
+    if (!a || a->c.fd < 0)
+        return -1;
+    if (a->err != 0)
+        return a->err;
+
+    for (;;)
+    {
+        uint8_t *w = NULL;
+        size_t avail = 0;
+        ssize_t r;
+
+        if (yai_rpc_rx_space(&a->rx, ASYNC_READ_CHUNK, &w, &avail) != 0)
+            return -2;
+        r = read(a->c.fd, w, avail);
+        if (r < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                return 0;
+            a->err = -5;
+            return a->err;
+        }
+        if (r == 0)
+        {
+            a->err = -5; /* EOF */
+            return a->err;
+        }
+        yai_rpc_rx_commit(&a->rx, (size_t)r);
+        if ((size_t)r < avail)
+            return 0; /* short read: socket drained */
+    }
+}
+
+int yai_rpc_async_poll_completion(yai_rpc_client_async_t *a, yai_rpc_reply_t *out)
+{
+    yai_rpc_envelope_t env;
+    const uint8_t *payload = NULL;
+    int rc;
+
+    if (!a || !out)
+        return -1;
+    memset(out, 0, sizeof(*out));
+
+    rc = yai_rpc_rx_frame(&a->rx, &env, &payload, NULL);
+    if (rc < 0)
+    {
+        a->err = rc; /* stream is out of sync; the connection is unusable */
+        return rc;
+    }
+    if (rc == 0)
+        return 1;
+
+    rc = yai_rpc_envelope_verify(&a->c, &env, payload);
+    if (rc == 0)
+        rc = yai_rpc_reply_flags_check(&a->c, &env);
+    if (rc == 0)
+        rc = yai_rpc_slots_take(&a->slots, &env, out);
+    if (rc != 0)
+    {
+        a->err = rc;
+        return rc;
+    }
+    if (env.payload_len > yai_rpc_reply_limit(&a->c))
+        return -8; /* larger than negotiated; the stream is still in step */
+    out->payload = payload;
+    out->payload_len = env.payload_len;
+    if (env._pad & YAI_RPC_FLAG_COMPRESSED)
+    {
+        rc = yai_rpc_inflate(payload, env.payload_len, yai_rpc_reply_limit(&a->c), &a->zrx, &a->zrx_cap,
+                             &out->payload_len);
+        out->payload = a->zrx;
+        if (rc == YAI_RPC_ECOMPRESS)
+            a->err = rc; /* a peer sending undecodable blocks is not trusted further */
+    }
+    return rc;
+}
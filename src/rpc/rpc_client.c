@@ -11,7 +11,10 @@
 #include <yai_protocol_ids.h> /* YAI_PROTOCOL_IDS_VERSION + command ids */
 #include <roles.h>            /* YAI_ROLE_* */
 
+#include <fcntl.h>
+#include <poll.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <sys/un.h>
 #include <unistd.h>
 #include <string.h>
@@ -19,56 +22,321 @@
 #include <errno.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <ctype.h>
+#include <time.h>
 
+#include "../platform/crc32c.h"
+#include "../platform/lz4_block.h"
 #include "../platform/log_internal.h"
+#include "../platform/paths_internal.h"
+#include "../platform/trace_internal.h"
+#include "rpc_internal.h"
 
 /* ============================================================
    INTERNAL IO (STRICT)
    ============================================================ */
 
-static int write_all(int fd, const void *buf, size_t n)
+static uint64_t now_ms(void)
 {
-    const uint8_t *p = (const uint8_t *)buf;
-    size_t off = 0;
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u;
+}
 
-    while (off < n)
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+uint64_t yai_rpc_deadline(int timeout_ms)
+{
+    return (timeout_ms > 0) ? now_ms() + (uint64_t)timeout_ms : 0;
+}
+
+/* Polls until ready; a zero deadline waits forever. */
+int yai_rpc_wait_fd(int fd, short events, uint64_t deadline)
+{
+    for (;;)
+    {
+        struct pollfd pfd;
+        int wait_ms = -1;
+        int r;
+
+        if (deadline != 0)
+        {
+            uint64_t now = now_ms();
+            if (now >= deadline)
+                return YAI_RPC_ETIMEDOUT;
+            wait_ms = (int)(deadline - now);
+        }
+
+        pfd.fd = fd;
+        pfd.events = events;
+        pfd.revents = 0;
+        r = poll(&pfd, 1, wait_ms);
+        if (r < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+        if (r > 0)
+            return 0; /* ready, or POLLERR/POLLHUP for the syscall to report */
+    }
+}
+
+/*
+ * Sockets stay blocking so the no-deadline path costs exactly one syscall
+ * per transfer. With a deadline, transfers use MSG_DONTWAIT and wait out
+ * EAGAIN in poll(), so no single syscall can outlive the budget. Sends use
+ * MSG_NOSIGNAL: a peer that went away (e.g. a stale pooled connection)
+ * must surface as an error, not SIGPIPE.
+ */
+static ssize_t xfer(int fd, struct iovec *iov, int iovcnt, int sending, uint64_t deadline)
+{
+    struct msghdr msg;
+    int flags = (deadline != 0) ? MSG_DONTWAIT : 0;
+
+    if (!sending && deadline == 0)
+        return readv(fd, iov, iovcnt);
+
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = (size_t)iovcnt;
+    return sending ? sendmsg(fd, &msg, flags | MSG_NOSIGNAL) : recvmsg(fd, &msg, flags);
+}
+
+/*
+ * Gather-write an iovec list. A short write resumes at the exact byte it
+ * stopped on, which may sit inside any element of the list.
+ */
+int yai_rpc_writev_all(int fd, struct iovec *iov, int iovcnt, uint64_t deadline)
+{
+    while (iovcnt > 0)
     {
-        ssize_t w = write(fd, p + off, n - off);
+        ssize_t w = xfer(fd, iov, iovcnt, 1, deadline);
         if (w < 0)
         {
             if (errno == EINTR)
                 continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                int rc = yai_rpc_wait_fd(fd, POLLOUT, deadline);
+                if (rc != 0)
+                    return rc;
+                continue;
+            }
             return -1;
         }
         if (w == 0)
             return -1;
-        off += (size_t)w;
+
+        size_t done = (size_t)w;
+        while (iovcnt > 0 && done >= iov->iov_len)
+        {
+            done -= iov->iov_len;
+            iov++;
+            iovcnt--;
+        }
+        if (iovcnt > 0)
+        {
+            iov->iov_base = (uint8_t *)iov->iov_base + done;
+            iov->iov_len -= done;
+        }
     }
     return 0;
 }
 
-static int read_all(int fd, void *buf, size_t n)
+ssize_t yai_rpc_readv_some(int fd, struct iovec *iov, int iovcnt, uint64_t deadline)
+{
+    for (;;)
+    {
+        ssize_t r;
+
+        /* a reply is rarely queued yet: wait first instead of eating an EAGAIN */
+        if (deadline != 0)
+        {
+            int rc = yai_rpc_wait_fd(fd, POLLIN, deadline);
+            if (rc != 0)
+                return rc;
+        }
+        r = xfer(fd, iov, iovcnt, 0, deadline);
+        if (r >= 0)
+            return r;
+        if (errno != EINTR && errno != EAGAIN && errno != EWOULDBLOCK)
+            return -1;
+    }
+}
+
+/* 0 on success, -1 on error or EOF, YAI_RPC_ETIMEDOUT past the deadline. */
+static int read_all(int fd, void *buf, size_t n, uint64_t deadline)
 {
     uint8_t *p = (uint8_t *)buf;
     size_t off = 0;
 
     while (off < n)
     {
-        ssize_t r = read(fd, p + off, n - off);
-        if (r < 0)
-        {
-            if (errno == EINTR)
-                continue;
-            return -1;
-        }
-        if (r == 0)
-            return -1; /* EOF */
+        struct iovec iov;
+        ssize_t r;
+
+        iov.iov_base = p + off;
+        iov.iov_len = n - off;
+        r = yai_rpc_readv_some(fd, &iov, 1, deadline);
+        if (r == YAI_RPC_ETIMEDOUT)
+            return YAI_RPC_ETIMEDOUT;
+        if (r <= 0)
+            return -1; /* error or EOF */
         off += (size_t)r;
     }
     return 0;
 }
 
+/* Reads and throws away n payload bytes so the next frame starts in sync. */
+static int discard(int fd, size_t n, uint64_t deadline)
+{
+    uint8_t scratch[YAI_RPC_STREAM_CHUNK];
+
+    while (n > 0)
+    {
+        struct iovec iov;
+        ssize_t r;
+
+        iov.iov_base = scratch;
+        iov.iov_len = n < sizeof(scratch) ? n : sizeof(scratch);
+        r = yai_rpc_readv_some(fd, &iov, 1, deadline);
+        if (r == YAI_RPC_ETIMEDOUT)
+            return YAI_RPC_ETIMEDOUT;
+        if (r <= 0)
+            return -1;
+        n -= (size_t)r;
+    }
+    return 0;
+}
+
+/*
+ * First read of a reply: envelope plus whatever payload bytes are already
+ * queued, straight into the caller's span. Returns the payload bytes landed
+ * in (buf, cap), or <0. The reply is the only frame in flight, so anything
+ * past payload_len is a peer protocol violation.
+ */
+static ssize_t read_head(int fd, yai_rpc_envelope_t *env, void *buf, size_t cap, uint64_t deadline)
+{
+    struct iovec iov[2];
+    size_t got;
+    ssize_t r;
+    int rc;
+
+    iov[0].iov_base = env;
+    iov[0].iov_len = sizeof(*env);
+    iov[1].iov_base = buf;
+    iov[1].iov_len = buf ? cap : 0;
+
+    r = yai_rpc_readv_some(fd, iov, 2, deadline);
+    if (r == YAI_RPC_ETIMEDOUT)
+        return YAI_RPC_ETIMEDOUT;
+    if (r <= 0)
+        return -5; /* error or EOF */
+    got = (size_t)r;
+
+    if (got < sizeof(*env))
+    {
+        rc = read_all(fd, (uint8_t *)env + got, sizeof(*env) - got, deadline);
+        if (rc != 0)
+            return (rc == YAI_RPC_ETIMEDOUT) ? rc : -5;
+        got = sizeof(*env);
+    }
+
+    if (env->magic != YAI_FRAME_MAGIC)
+        return -6;
+    if (env->version != YAI_PROTOCOL_IDS_VERSION)
+        return -7;
+    if (got - sizeof(*env) > env->payload_len)
+        return -12; /* trailing bytes beyond the reply frame */
+    return (ssize_t)(got - sizeof(*env));
+}
+
+/*
+ * Scatter-read one reply frame into out_buf. A small reply costs a single
+ * syscall. A reply larger than out_cap is drained before returning -8, so
+ * the connection stays usable.
+ */
+static int read_frame(int fd, yai_rpc_envelope_t *env, void *out_buf, size_t out_cap, uint64_t deadline)
+{
+    ssize_t head = read_head(fd, env, out_buf, out_cap, deadline);
+    size_t have;
+    int rc;
+
+    if (head < 0)
+        return (int)head;
+    have = (size_t)head;
+
+    if (env->payload_len > (uint32_t)out_cap || (env->payload_len > 0 && !out_buf))
+    {
+        rc = discard(fd, env->payload_len - have, deadline);
+        if (rc != 0)
+            return (rc == YAI_RPC_ETIMEDOUT) ? rc : -10;
+        return out_buf ? -8 : -9;
+    }
+    if (have < env->payload_len)
+    {
+        rc = read_all(fd, (uint8_t *)out_buf + have, env->payload_len - have, deadline);
+        if (rc != 0)
+            return (rc == YAI_RPC_ETIMEDOUT) ? rc : -10;
+    }
+    return 0;
+}
+
+/*
+ * Streams one reply frame through a fixed chunk buffer, so peak memory does
+ * not depend on the reply size. If the sink gives up, the rest is drained
+ * and -16 is returned.
+ */
+static int read_frame_stream(int fd,
+                             yai_rpc_envelope_t *env,
+                             yai_rpc_chunk_fn on_chunk,
+                             void *user,
+                             uint64_t deadline)
+{
+    uint8_t chunk[YAI_RPC_STREAM_CHUNK];
+    ssize_t head = read_head(fd, env, chunk, sizeof(chunk), deadline);
+    size_t off = 0;
+    size_t have;
+
+    if (head < 0)
+        return (int)head;
+    have = (size_t)head;
+
+    for (;;)
+    {
+        if (have > 0 && on_chunk(user, chunk, have, off, env->payload_len) != 0)
+        {
+            int rc = discard(fd, env->payload_len - off - have, deadline);
+            if (rc != 0)
+                return (rc == YAI_RPC_ETIMEDOUT) ? rc : -10;
+            return -16;
+        }
+        off += have;
+        if (off == env->payload_len)
+            return 0;
+
+        struct iovec iov;
+        size_t left = env->payload_len - off;
+        ssize_t r;
+
+        iov.iov_base = chunk;
+        iov.iov_len = left < sizeof(chunk) ? left : sizeof(chunk);
+        r = yai_rpc_readv_some(fd, &iov, 1, deadline);
+        if (r == YAI_RPC_ETIMEDOUT)
+            return YAI_RPC_ETIMEDOUT;
+        if (r <= 0)
+            return -10;
+        have = (size_t)r;
+    }
+}
+
 /* ============================================================
    WS_ID VALIDATION (STRICT, PATH-SAFE)
    - must fit envelope ws_id field (typically 36 bytes incl NUL)
@@ -105,76 +373,117 @@ static int is_valid_ws_id(const char *ws_id)
 }
 
 /* ============================================================
-   TRACE ID (deterministic enough for local debug)
-   NOTE: envelope trace_id is typically 36 bytes -> keep short
+   TRACE ID
+   W3C trace id + span id, base64url: the hex traceparent does not fit
+   the envelope's trace_id field, this does and loses nothing
    ============================================================ */
 
+_Static_assert(sizeof(((yai_rpc_envelope_t *)0)->trace_id) > YAI_SDK_TRACE_WIRE_LEN,
+               "envelope trace_id too short for the wire trace context");
+
 static void set_trace_id(yai_rpc_client_t *c, yai_rpc_envelope_t *env)
 {
-    const char *prefix = "sdk";
-    uint32_t ctr = 0;
-    unsigned long pid = 0;
+    yai_sdk_trace_ctx_t ctx;
 
     if (!c || !env)
         return;
 
-    if (c->correlation_id[0])
-        prefix = c->correlation_id;
-
-    c->trace_seq++;
-    ctr = c->trace_seq;
-    pid = (unsigned long)getpid();
-
-    (void)snprintf(env->trace_id, sizeof(env->trace_id), "%.16s-%lu-%u",
-                   prefix, pid, ctr);
+    if (c->next_trace_set)
+    {
+        ctx = c->next_trace;
+        c->next_trace_set = 0;
+    }
+    else
+    {
+        yai_trace_start(&ctx, NULL);
+    }
+    yai_trace_to_wire(&ctx, env->trace_id);
 }
 
 /* ============================================================
    CONNECT / CLOSE
    ============================================================ */
 
+/*
+ * Connect with the socket temporarily non-blocking, bounded by the deadline. A Unix socket whose listen
+ * backlog is full fails with EAGAIN instead of EINPROGRESS and cannot be
+ * waited on, so that case is retried with a short backoff.
+ */
+static int connect_deadline(int fd, const struct sockaddr *addr, socklen_t len, uint64_t deadline)
+{
+    int backoff_ms = 1;
+
+    for (;;)
+    {
+        if (connect(fd, addr, len) == 0)
+            return 0;
+        if (errno == EINTR)
+            continue;
+        if (errno == EINPROGRESS)
+        {
+            int err = 0;
+            socklen_t elen = (socklen_t)sizeof(err);
+            int rc = yai_rpc_wait_fd(fd, POLLOUT, deadline);
+            if (rc != 0)
+                return rc;
+            if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &elen) != 0 || err != 0)
+                return -1;
+            return 0;
+        }
+        if (errno != EAGAIN)
+            return -1;
+        if (deadline != 0 && now_ms() >= deadline)
+            return YAI_RPC_ETIMEDOUT;
+        (void)poll(NULL, 0, backoff_ms);
+        if (backoff_ms < 32)
+            backoff_ms *= 2;
+    }
+}
+
 int yai_rpc_connect(yai_rpc_client_t *c, const char *ws_id)
+{
+    return yai_rpc_connect_timeout(c, ws_id, 0);
+}
+
+int yai_rpc_connect_timeout(yai_rpc_client_t *c, const char *ws_id, int timeout_ms)
 {
     if (!c)
         return -1;
     if (!is_valid_ws_id(ws_id))
         return -99;
 
+    uint64_t deadline = yai_rpc_deadline(timeout_ms);
+
     memset(c, 0, sizeof(*c));
     c->fd = -1;
     c->trace_seq = 0;
 
-    char sock_path[512];
-    if (yai_path_root_sock(sock_path, sizeof(sock_path)) != 0)
-        return -2;
+    struct sockaddr_un addr;
+    socklen_t len = 0;
+    int arc = yai_path_root_sockaddr(&addr, &len);
+    if (arc != 0)
+        return (arc == -2) ? -4 : -2; /* -4: path too long for AF_UNIX */
 
     int fd = socket(AF_UNIX, SOCK_STREAM, 0);
     if (fd < 0)
         return -3;
 
-    struct sockaddr_un addr;
-    memset(&addr, 0, sizeof(addr));
-    addr.sun_family = AF_UNIX;
-
-    if (strlen(sock_path) >= sizeof(addr.sun_path))
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) != 0)
     {
         close(fd);
-        return -4; /* path too long for AF_UNIX */
-    }
-    if (snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", sock_path) < 0)
-    {
-        close(fd);
-        return -4;
+        return -3;
     }
 
-    socklen_t len =
-        (socklen_t)(offsetof(struct sockaddr_un, sun_path) + strlen(addr.sun_path));
-
-    if (connect(fd, (struct sockaddr *)&addr, len) < 0)
+    int rc = connect_deadline(fd, (struct sockaddr *)&addr, len, deadline);
+    if (rc == 0 && fcntl(fd, F_SETFL, flags) != 0)
+        rc = -1;
+    if (rc != 0)
     {
-        yai_sdk_log_emit(YAI_SDK_LOG_ERROR, "rpc", "connect failed");
+        YAI_LOG(YAI_SDK_LOG_ERROR, "rpc", rc == YAI_RPC_ETIMEDOUT ? "connect timed out" : "connect failed",
+                YAI_LOG_STR("endpoint", addr.sun_path), YAI_LOG_INT("errno", errno));
         close(fd);
-        return -5;
+        return (rc == YAI_RPC_ETIMEDOUT) ? rc : -5;
     }
 
     c->fd = fd;
@@ -186,6 +495,15 @@ int yai_rpc_connect(yai_rpc_client_t *c, const char *ws_id)
         return -2;
     }
 
+    (void)snprintf(c->endpoint, sizeof(c->endpoint), "%s", addr.sun_path);
+    c->caps_requested = YAI_RPC_CAPS_DEFAULT;
+    c->caps_granted = 0;
+    c->hs_deferred = 0;
+    c->hs_defer = 0;
+    c->next_flags = 0;
+    c->reply_flags = 0;
+    c->compress_min = YAI_RPC_COMPRESS_MIN_DEFAULT;
+
     /* default authority (explicitly NONE) */
     c->role = YAI_ROLE_NONE;
     c->arming = 0;
@@ -203,6 +521,28 @@ void yai_rpc_close(yai_rpc_client_t *c)
     }
 }
 
+void yai_rpc_set_timeout(yai_rpc_client_t *c, int timeout_ms)
+{
+    if (c)
+        c->timeout_ms = (timeout_ms > 0) ? timeout_ms : 0;
+}
+
+void yai_rpc_set_compression_min(yai_rpc_client_t *c, uint32_t min_bytes)
+{
+    if (c)
+        c->compress_min = min_bytes;
+}
+
+int yai_rpc_set_ws(yai_rpc_client_t *c, const char *ws_id)
+{
+    if (!c)
+        return -1;
+    if (!is_valid_ws_id(ws_id))
+        return -99;
+    (void)snprintf(c->ws_id, sizeof(c->ws_id), "%s", ws_id);
+    return 0;
+}
+
 /* ============================================================
    AUTHORITY
    ============================================================ */
@@ -240,119 +580,385 @@ void yai_rpc_set_authority(yai_rpc_client_t *c, int arming, const char *role_str
 }
 
 /* ============================================================
-   RAW CALL (envelope + payload, strict)
+   ENVELOPE
    ============================================================ */
 
-int yai_rpc_call_raw(
-    yai_rpc_client_t *c,
-    uint32_t command_id,
-    const void *payload,
-    uint32_t payload_len,
-    void *out_buf,
-    size_t out_cap,
-    uint32_t *out_len)
+int yai_rpc_envelope_init(yai_rpc_client_t *c,
+                          yai_rpc_envelope_t *env,
+                          uint32_t command_id,
+                          uint32_t payload_len)
 {
-    if (!c || c->fd < 0)
+    if (!c || !env)
         return -1;
-    if (payload_len > 0 && !payload)
-        return -2;
 
-    yai_rpc_envelope_t env;
-    memset(&env, 0, sizeof(env));
+    memset(env, 0, sizeof(*env));
 
-    env.magic = YAI_FRAME_MAGIC;
-    env.version = YAI_PROTOCOL_IDS_VERSION;
-    env.command_id = command_id;
-    env.payload_len = payload_len;
+    env->magic = YAI_FRAME_MAGIC;
+    env->version = YAI_PROTOCOL_IDS_VERSION;
+    env->command_id = command_id;
+    env->payload_len = payload_len;
 
     /* AUTHORITY (THIS IS THE FIX) */
-    env.role = c->role;
-    env.arming = c->arming;
+    env->role = c->role;
+    env->arming = c->arming;
 
-    /* reserved; keep deterministic */
-    env.checksum = 0;
+    /* stamped by yai_rpc_envelope_seal once checksums are granted */
+    env->checksum = 0;
 
-    if (snprintf(env.ws_id, sizeof(env.ws_id), "%.*s", (int)sizeof(env.ws_id) - 1, c->ws_id) < 0)
-        return -11;
-    set_trace_id(c, &env);
+    if (snprintf(env->ws_id, sizeof(env->ws_id), "%.*s", (int)sizeof(env->ws_id) - 1, c->ws_id) < 0)
+        return -1;
+    set_trace_id(c, env);
+    return 0;
+}
 
-    if (write_all(c->fd, &env, sizeof(env)) != 0)
-        return -3;
+static int checksummed(const yai_rpc_client_t *c, const yai_rpc_envelope_t *env)
+{
+    /* the handshake itself is what turns checksums on, so it never carries one */
+    return (c->caps_granted & YAI_RPC_CAP_CHECKSUM) && env->command_id != YAI_CMD_HANDSHAKE;
+}
 
-    if (payload_len > 0)
-    {
-        if (write_all(c->fd, payload, payload_len) != 0)
-            return -4;
-    }
+void yai_rpc_envelope_seal(const yai_rpc_client_t *c, yai_rpc_envelope_t *env, const void *payload)
+{
+    if (c && env && checksummed(c, env))
+        env->checksum = yai_crc32c(0, payload, env->payload_len);
+}
 
-    yai_rpc_envelope_t resp;
-    memset(&resp, 0, sizeof(resp));
+int yai_rpc_envelope_verify(const yai_rpc_client_t *c, const yai_rpc_envelope_t *env, const void *payload)
+{
+    if (!c || !env || !checksummed(c, env))
+        return 0;
+    return (yai_crc32c(0, payload, env->payload_len) == env->checksum) ? 0 : YAI_RPC_EBADSUM;
+}
 
-    if (read_all(c->fd, &resp, sizeof(resp)) != 0)
-        return -5;
+/* ============================================================
+   RAW CALL (envelope + payload, strict)
+   - request goes out as one gathered write
+   - reply comes back through read_frame() or read_frame_stream()
+   - write and read share one deadline (c->timeout_ms)
+   ============================================================ */
 
-    if (resp.magic != YAI_FRAME_MAGIC)
-        return -6;
+typedef struct reply_sink {
+    /* buffered: out_buf/out_cap; streamed: on_chunk/user */
+    void *out_buf;
+    size_t out_cap;
+    yai_rpc_chunk_fn on_chunk;
+    void *user;
+    const yai_rpc_client_t *c;
+    /* largest reply the connection negotiated, raw bytes */
+    uint32_t limit;
+    /* streamed replies, checked as they arrive */
+    const yai_rpc_envelope_t *resp;
+    int sum;
+    uint32_t crc;
+    /* compressed: the u32 raw-length header, then the block, inflated as
+       it arrives so memory stays bounded by the LZ4 window */
+    uint8_t zhdr[4];
+    size_t zhdr_len;
+    uint32_t zraw;
+    size_t zoff;
+    int zopen;
+    yai_lz4_stream_t z;
+    int zerr;
+} reply_sink_t;
+
+static int inflated_chunk(void *user, const void *out, size_t len)
+{
+    reply_sink_t *sink = (reply_sink_t *)user;
+    int rc = sink->on_chunk(sink->user, out, len, sink->zoff, sink->zraw);
 
-    if (resp.version != YAI_PROTOCOL_IDS_VERSION)
-        return -7;
+    sink->zoff += len;
+    return rc;
+}
 
-    if (resp.payload_len > (uint32_t)out_cap)
-        return -8;
+static int wire_chunk(void *user, const void *chunk, size_t len, size_t offset, uint32_t total)
+{
+    reply_sink_t *sink = (reply_sink_t *)user;
+    const uint8_t *p = (const uint8_t *)chunk;
+    int rc;
 
-    if (resp.payload_len > 0)
+    if (offset == 0)
     {
-        if (!out_buf)
-            return -9;
-        if (read_all(c->fd, out_buf, resp.payload_len) != 0)
-            return -10;
+        /* the sink sees nothing of a frame the connection did not negotiate */
+        sink->zerr = yai_rpc_reply_flags_check(sink->c, sink->resp);
+        if (sink->zerr == 0 && total > sink->limit && !(sink->resp->_pad & YAI_RPC_FLAG_COMPRESSED))
+            sink->zerr = -8;
+        if (sink->zerr != 0)
+            return 1;
     }
+    if (sink->sum)
+        sink->crc = yai_crc32c(sink->crc, chunk, len);
+    if (!(sink->resp->_pad & YAI_RPC_FLAG_COMPRESSED))
+        return sink->on_chunk(sink->user, chunk, len, offset, total);
 
-    if (out_len)
-        *out_len = resp.payload_len;
-    return 0;
+    while (sink->zhdr_len < sizeof(sink->zhdr) && len > 0)
+    {
+        sink->zhdr[sink->zhdr_len++] = *p++;
+        len--;
+    }
+    if (sink->zhdr_len < sizeof(sink->zhdr))
+        return 0;
+    if (!sink->zopen)
+    {
+        sink->zraw = (uint32_t)sink->zhdr[0] | (uint32_t)sink->zhdr[1] << 8 |
+                     (uint32_t)sink->zhdr[2] << 16 | (uint32_t)sink->zhdr[3] << 24;
+        if (sink->zraw > sink->limit)
+        {
+            sink->zerr = -8;
+            return 1;
+        }
+        if (yai_lz4_stream_init(&sink->z, total - sizeof(sink->zhdr), sink->zraw, YAI_RPC_STREAM_CHUNK,
+                                inflated_chunk, sink) != 0)
+        {
+            sink->zerr = -2;
+            return 1;
+        }
+        sink->zopen = 1;
+    }
+    rc = yai_lz4_stream_feed(&sink->z, p, len);
+    if (rc < 0)
+        sink->zerr = YAI_RPC_ECOMPRESS;
+    return rc != 0;
 }
 
-/* ============================================================
-   HANDSHAKE (protocol.h structs)
-   ============================================================ */
+/* Buffered reply: inflated over the compressed bytes in out_buf. */
+static int inflate_in_place(reply_sink_t *sink, const yai_rpc_envelope_t *resp, uint32_t *raw_len)
+{
+    uint8_t *raw = NULL;
+    size_t cap = 0;
+    int rc = yai_rpc_inflate(sink->out_buf, resp->payload_len, sink->limit, &raw, &cap, raw_len);
+
+    if (rc == 0 && *raw_len > sink->out_cap)
+        rc = -8;
+    if (rc == 0)
+        memcpy(sink->out_buf, raw, *raw_len);
+    free(raw);
+    return rc;
+}
 
-int yai_rpc_handshake(yai_rpc_client_t *c)
+/* Reads the reply to `req`, checking and inflating it as negotiated. */
+static int read_reply(yai_rpc_client_t *c,
+                      const yai_rpc_envelope_t *req,
+                      reply_sink_t *sink,
+                      yai_rpc_envelope_t *resp,
+                      uint32_t *raw_len,
+                      uint64_t deadline)
 {
-    if (!c || c->fd < 0)
+    int rc;
+
+    memset(resp, 0, sizeof(*resp));
+    *raw_len = 0;
+    sink->c = c;
+    sink->limit = yai_rpc_reply_limit(c);
+    if (!sink->on_chunk)
+    {
+        size_t cap = sink->out_cap < sink->limit ? sink->out_cap : sink->limit;
+
+        rc = read_frame(c->fd, resp, sink->out_buf, cap, deadline);
+        *raw_len = resp->payload_len;
+        if (rc == 0)
+            rc = yai_rpc_envelope_verify(c, resp, sink->out_buf);
+        if (rc == 0)
+            rc = yai_rpc_reply_flags_check(c, resp);
+        if (rc == 0 && (resp->_pad & YAI_RPC_FLAG_COMPRESSED))
+            rc = inflate_in_place(sink, resp, raw_len);
+        return rc;
+    }
+
+    /* streamed replies: flags and size limit are checked on the first chunk,
+       checksums once complete, after the sink saw the bytes */
+    sink->resp = resp;
+    sink->sum = checksummed(c, req);
+    sink->crc = 0;
+    sink->zhdr_len = 0;
+    sink->zoff = 0;
+    sink->zopen = 0;
+    sink->zerr = 0;
+    rc = read_frame_stream(c->fd, resp, wire_chunk, sink, deadline);
+    *raw_len = resp->payload_len;
+    if (rc == -16 && sink->zerr != 0)
+        rc = sink->zerr;
+    if (rc == 0 && resp->payload_len == 0)
+        rc = yai_rpc_reply_flags_check(c, resp);
+    if (sink->zopen)
+        *raw_len = sink->zraw;
+    if (rc == 0 && (resp->_pad & YAI_RPC_FLAG_COMPRESSED))
+    {
+        if (!sink->zopen || yai_lz4_stream_end(&sink->z) != 0)
+            rc = YAI_RPC_ECOMPRESS;
+    }
+    if (rc == 0 && sink->sum && sink->crc != resp->checksum)
+        rc = YAI_RPC_EBADSUM;
+    if (sink->zopen)
+        yai_lz4_stream_free(&sink->z);
+    return rc;
+}
+
+static int call_common(
+    yai_rpc_client_t *c,
+    uint32_t command_id,
+    const void *payload,
+    uint32_t payload_len,
+    reply_sink_t *sink,
+    uint32_t *out_len)
+{
+    if (!c)
         return -1;
+    c->last_send_ns = 0;
+    c->last_wait_ns = 0;
+    c->last_tx_bytes = 0;
+    c->last_rx_bytes = 0;
+    if (c->fd < 0)
+        return -1;
+    if (payload_len > 0 && !payload)
+        return -2;
 
-    yai_handshake_req_t req;
-    memset(&req, 0, sizeof(req));
-    req.client_version = YAI_PROTOCOL_IDS_VERSION;
-    req.capabilities_requested = 0;
-    (void)snprintf(req.client_name, sizeof(req.client_name), "%s", "yai-cli");
+    /* the flags byte is only used for what the server granted */
+    if ((c->next_flags & ~YAI_RPC_FLAG_BINARY) ||
+        ((c->next_flags & YAI_RPC_FLAG_BINARY) && !(c->caps_granted & YAI_RPC_CAP_BINARY)))
+    {
+        c->next_flags = 0;
+        return YAI_RPC_EFLAGS;
+    }
 
-    yai_handshake_ack_t ack;
-    memset(&ack, 0, sizeof(ack));
+    yai_rpc_envelope_t env;
+    if (yai_rpc_envelope_init(c, &env, command_id, payload_len) != 0)
+        return -11;
+    env._pad = c->next_flags;
+    c->next_flags = 0;
+    c->reply_flags = 0;
+
+    uint8_t *zbuf = NULL;
+    size_t zcap = 0;
+    payload = yai_rpc_deflate(c, &env, payload, &zbuf, &zcap);
+    payload_len = env.payload_len;
+    yai_rpc_envelope_seal(c, &env, payload);
+
+    /* a deferred (cached) handshake goes out in front of the request */
+    yai_rpc_envelope_t hs_env;
+    yai_handshake_req_t hs_req;
+    struct iovec iov[4];
+    int iovcnt = 0;
+    int hs = c->hs_deferred && command_id != YAI_CMD_HANDSHAKE;
+
+    if (hs)
+    {
+        /* nothing is granted until the ack, so the request was sealed
+           without features; a checksum costs nothing where it is ignored and
+           is what a server that grants checksums will verify */
+        env.checksum = yai_crc32c(0, payload, payload_len);
+        yai_rpc_handshake_req_init(c, &hs_req);
+        if (yai_rpc_envelope_init(c, &hs_env, YAI_CMD_HANDSHAKE, (uint32_t)sizeof(hs_req)) != 0)
+        {
+            free(zbuf);
+            return -11;
+        }
+        iov[iovcnt].iov_base = &hs_env;
+        iov[iovcnt++].iov_len = sizeof(hs_env);
+        iov[iovcnt].iov_base = &hs_req;
+        iov[iovcnt++].iov_len = sizeof(hs_req);
+    }
+    iov[iovcnt].iov_base = &env;
+    iov[iovcnt++].iov_len = sizeof(env);
+    if (payload_len > 0)
+    {
+        iov[iovcnt].iov_base = (void *)payload;
+        iov[iovcnt++].iov_len = payload_len;
+    }
 
-    uint32_t out_len = 0;
+    uint64_t deadline = yai_rpc_deadline(c->timeout_ms);
+    uint64_t t0 = now_ns();
+    int rc = yai_rpc_writev_all(c->fd, iov, iovcnt, deadline);
+    uint64_t t1 = now_ns();
+    free(zbuf);
+    c->last_start_ns = t0;
+    c->last_send_ns = t1 - t0;
+    for (int i = 0; i < iovcnt; i++)
+        c->last_tx_bytes += iov[i].iov_len;
+    if (rc == 0 && hs)
+    {
+        yai_rpc_envelope_t ack_env;
+        yai_handshake_ack_t ack;
+        memset(&ack, 0, sizeof(ack));
+        rc = read_frame(c->fd, &ack_env, &ack, sizeof(ack), deadline);
+        if (rc == 0)
+            c->last_rx_bytes += sizeof(ack_env) + ack_env.payload_len;
+        if (rc == 0)
+            rc = yai_rpc_reply_flags_check(c, &ack_env);
+        if (rc == 0)
+            rc = yai_rpc_handshake_accept(c, &ack, ack_env.payload_len);
+        c->hs_deferred = 0;
+        if (rc != 0 && rc != YAI_RPC_ETIMEDOUT)
+        {
+            /* the request already went out behind a refused handshake */
+            c->last_wait_ns = now_ns() - t1;
+            yai_rpc_close(c);
+            return rc;
+        }
+    }
+    if (rc == 0)
+    {
+        yai_rpc_envelope_t resp;
+        uint32_t raw_len = 0;
+        rc = read_reply(c, &env, sink, &resp, &raw_len, deadline);
+        c->last_wait_ns = now_ns() - t1;
+        if (resp.magic != 0)
+            c->last_rx_bytes += sizeof(resp) + resp.payload_len;
+        if (out_len && (rc == 0 || rc == -8 || rc == -16 || rc == YAI_RPC_EBADSUM))
+            *out_len = raw_len;
+        c->reply_flags = resp._pad;
+    }
+    else if (rc != YAI_RPC_ETIMEDOUT)
+    {
+        rc = -3;
+    }
 
-    int rc = yai_rpc_call_raw(
-        c,
-        YAI_CMD_HANDSHAKE,
-        &req,
-        (uint32_t)sizeof(req),
-        &ack,
-        sizeof(ack),
-        &out_len);
+    /* a late reply, a framing error or a corrupted or undecodable frame
+       leaves the stream out of sync: nothing more on it can be trusted */
+    if (yai_rpc_desynced(rc))
+        yai_rpc_close(c);
+
+    YAI_LOG(YAI_SDK_LOG_DEBUG, "rpc", "call",
+            YAI_LOG_UINT("command", command_id), YAI_LOG_STR("trace_id", env.trace_id),
+            YAI_LOG_STR("ws_id", c->ws_id), YAI_LOG_STR("correlation_id", c->correlation_id),
+            YAI_LOG_INT("rc", rc), YAI_LOG_UINT("tx_bytes", c->last_tx_bytes), YAI_LOG_UINT("rx_bytes", c->last_rx_bytes),
+            YAI_LOG_UINT("wait_ns", c->last_wait_ns));
+    return rc;
+}
 
-    if (rc != 0)
-        return rc;
-    if (out_len != (uint32_t)sizeof(ack))
-        return -20;
-    if (ack.server_version != YAI_PROTOCOL_IDS_VERSION)
-        return -21;
-    if (ack.status != YAI_PROTO_STATE_READY)
-        return -22;
+int yai_rpc_call_raw(
+    yai_rpc_client_t *c,
+    uint32_t command_id,
+    const void *payload,
+    uint32_t payload_len,
+    void *out_buf,
+    size_t out_cap,
+    uint32_t *out_len)
+{
+    reply_sink_t sink;
+    memset(&sink, 0, sizeof(sink));
+    sink.out_buf = out_buf;
+    sink.out_cap = out_cap;
+    return call_common(c, command_id, payload, payload_len, &sink, out_len);
+}
 
-    return 0;
+int yai_rpc_call_stream(
+    yai_rpc_client_t *c,
+    uint32_t command_id,
+    const void *payload,
+    uint32_t payload_len,
+    yai_rpc_chunk_fn on_chunk,
+    void *user,
+    uint32_t *out_len)
+{
+    reply_sink_t sink;
+    if (!on_chunk)
+        return -2;
+    memset(&sink, 0, sizeof(sink));
+    sink.on_chunk = on_chunk;
+    sink.user = user;
+    return call_common(c, command_id, payload, payload_len, &sink, out_len);
 }
+
 void yai_rpc_set_correlation_id(yai_rpc_client_t *c, const char *correlation_id)
 {
     if (!c) return;
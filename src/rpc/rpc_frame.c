@@ -0,0 +1,325 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+// src/rpc/rpc_frame.c
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "rpc_internal.h"
+
+#include <yai_protocol_ids.h> /* YAI_PROTOCOL_IDS_VERSION */
+
+#include "../platform/lz4_block.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define RX_INITIAL_CAP (64u * 1024u)
+#define TX_INITIAL_CAP (64u * 1024u)
+
+/* Compressed payload header: raw length, u32 little-endian. */
+#define Z_HEADER 4u
+
+void yai_rpc_rx_init(yai_rpc_rx_t *rx)
+{
+    if (!rx)
+        return;
+    memset(rx, 0, sizeof(*rx));
+}
+
+void yai_rpc_rx_free(yai_rpc_rx_t *rx)
+{
+    if (!rx)
+        return;
+    free(rx->data);
+    memset(rx, 0, sizeof(*rx));
+}
+
+int yai_rpc_rx_space(yai_rpc_rx_t *rx, size_t want, uint8_t **out, size_t *avail)
+{
+    if (!rx || !out || !avail)
+        return -1;
+    if (want == 0)
+        want = 1;
+
+    /* compact: slide the unparsed tail to the front */
+    if (rx->head > 0)
+    {
+        size_t live = rx->tail - rx->head;
+        if (live > 0)
+            memmove(rx->data, rx->data + rx->head, live);
+        rx->head = 0;
+        rx->tail = live;
+    }
+
+    if (rx->cap - rx->tail < want)
+    {
+        size_t need = rx->tail + want;
+        size_t ncap = rx->cap ? rx->cap : RX_INITIAL_CAP;
+        while (ncap < need)
+            ncap *= 2;
+        uint8_t *nd = (uint8_t *)realloc(rx->data, ncap);
+        if (!nd)
+            return -1;
+        rx->data = nd;
+        rx->cap = ncap;
+    }
+
+    *out = rx->data + rx->tail;
+    *avail = rx->cap - rx->tail;
+    return 0;
+}
+
+void yai_rpc_rx_commit(yai_rpc_rx_t *rx, size_t n)
+{
+    if (rx)
+        rx->tail += n;
+}
+
+int yai_rpc_rx_frame(yai_rpc_rx_t *rx,
+                     yai_rpc_envelope_t *env,
+                     const uint8_t **payload,
+                     size_t *need)
+{
+    size_t live;
+
+    if (!rx || !env || !payload)
+        return -1;
+
+    live = rx->tail - rx->head;
+    if (live < sizeof(*env))
+    {
+        if (need)
+            *need = sizeof(*env) - live;
+        return 0;
+    }
+
+    memcpy(env, rx->data + rx->head, sizeof(*env));
+    if (env->magic != YAI_FRAME_MAGIC)
+        return -6;
+    if (env->version != YAI_PROTOCOL_IDS_VERSION)
+        return -7;
+    if (env->payload_len > YAI_RPC_MAX_FRAME_PAYLOAD)
+        return -8;
+
+    if (live - sizeof(*env) < env->payload_len)
+    {
+        if (need)
+            *need = env->payload_len - (live - sizeof(*env));
+        return 0;
+    }
+
+    *payload = rx->data + rx->head + sizeof(*env);
+    rx->head += sizeof(*env) + env->payload_len;
+    if (rx->head == rx->tail)
+    {
+        rx->head = 0;
+        rx->tail = 0;
+    }
+    if (need)
+        *need = 0;
+    return 1;
+}
+
+/* ============================================================
+   TX QUEUE
+   ============================================================ */
+
+int yai_rpc_tx_append(yai_rpc_tx_t *tx, const void *a, size_t an, const void *b, size_t bn)
+{
+    size_t need;
+
+    if (!tx)
+        return -1;
+
+    /* drop the already-written prefix before growing */
+    if (tx->off > 0)
+    {
+        size_t live = tx->len - tx->off;
+        if (live > 0)
+            memmove(tx->data, tx->data + tx->off, live);
+        tx->len = live;
+        tx->off = 0;
+    }
+
+    need = tx->len + an + bn;
+    if (need > tx->cap)
+    {
+        size_t ncap = tx->cap ? tx->cap : TX_INITIAL_CAP;
+        while (ncap < need)
+            ncap *= 2;
+        uint8_t *nd = (uint8_t *)realloc(tx->data, ncap);
+        if (!nd)
+            return -2;
+        tx->data = nd;
+        tx->cap = ncap;
+    }
+    if (an > 0)
+        memcpy(tx->data + tx->len, a, an);
+    if (bn > 0)
+        memcpy(tx->data + tx->len + an, b, bn);
+    tx->len = need;
+    return 0;
+}
+
+void yai_rpc_tx_free(yai_rpc_tx_t *tx)
+{
+    if (!tx)
+        return;
+    free(tx->data);
+    memset(tx, 0, sizeof(*tx));
+}
+
+/* ============================================================
+   IN-FLIGHT SLOTS
+   ============================================================ */
+
+int yai_rpc_slots_init(yai_rpc_slots_t *s, size_t window)
+{
+    if (!s || window == 0)
+        return -1;
+    memset(s, 0, sizeof(*s));
+    s->ring = (yai_rpc_slot_t *)calloc(window, sizeof(*s->ring));
+    if (!s->ring)
+        return -2;
+    s->window = window;
+    return 0;
+}
+
+void yai_rpc_slots_free(yai_rpc_slots_t *s)
+{
+    if (!s)
+        return;
+    free(s->ring);
+    memset(s, 0, sizeof(*s));
+}
+
+void yai_rpc_slots_push(yai_rpc_slots_t *s, const yai_rpc_envelope_t *env, void *cookie)
+{
+    yai_rpc_slot_t *slot = &s->ring[(s->head + s->used) % s->window];
+    memcpy(slot->trace_id, env->trace_id, sizeof(slot->trace_id));
+    slot->command_id = env->command_id;
+    slot->cookie = cookie;
+    slot->live = 1;
+    s->used++;
+    s->live++;
+}
+
+int yai_rpc_slots_take(yai_rpc_slots_t *s, const yai_rpc_envelope_t *env, yai_rpc_reply_t *out)
+{
+    yai_rpc_slot_t *slot = NULL;
+
+    /* in-order servers hit the oldest slot first */
+    for (size_t i = 0; i < s->used; i++)
+    {
+        yai_rpc_slot_t *cand = &s->ring[(s->head + i) % s->window];
+        if (cand->live && strncmp(cand->trace_id, env->trace_id, sizeof(cand->trace_id)) == 0)
+        {
+            slot = cand;
+            break;
+        }
+    }
+    if (!slot)
+        return -14; /* reply does not belong to any in-flight request */
+
+    out->command_id = slot->command_id;
+    out->cookie = slot->cookie;
+
+    slot->live = 0;
+    s->live--;
+    while (s->used > 0 && !s->ring[s->head].live)
+    {
+        s->head = (s->head + 1) % s->window;
+        s->used--;
+    }
+    return 0;
+}
+
+/* ============================================================
+   NEGOTIATED LIMITS
+   ============================================================ */
+
+uint32_t yai_rpc_reply_limit(const yai_rpc_client_t *c)
+{
+    if (c->caps_granted & YAI_RPC_CAP_LARGE_FRAMES)
+        return YAI_RPC_MAX_FRAME_PAYLOAD;
+    return YAI_RPC_SMALL_FRAME_PAYLOAD;
+}
+
+size_t yai_rpc_window(const yai_rpc_client_t *c, size_t window)
+{
+    /* a server that did not grant pipelining answers one request at a time */
+    return (c->caps_granted & YAI_RPC_CAP_PIPELINE) ? window : 1;
+}
+
+int yai_rpc_reply_flags_check(const yai_rpc_client_t *c, const yai_rpc_envelope_t *env)
+{
+    if (env->_pad & ~(YAI_RPC_FLAG_BINARY | YAI_RPC_FLAG_COMPRESSED))
+        return YAI_RPC_EFLAGS;
+    if ((env->_pad & YAI_RPC_FLAG_BINARY) && !(c->caps_granted & YAI_RPC_CAP_BINARY))
+        return YAI_RPC_EFLAGS;
+    /* only inflate what the connection agreed to receive compressed */
+    if ((env->_pad & YAI_RPC_FLAG_COMPRESSED) && !(c->caps_granted & YAI_RPC_CAP_COMPRESSION))
+        return YAI_RPC_ECOMPRESS;
+    return 0;
+}
+
+/* ============================================================
+   COMPRESSION
+   ============================================================ */
+
+static int grow(uint8_t **buf, size_t *cap, size_t need)
+{
+    if (*cap >= need)
+        return 0;
+    uint8_t *nb = (uint8_t *)realloc(*buf, need);
+    if (!nb)
+        return -2;
+    *buf = nb;
+    *cap = need;
+    return 0;
+}
+
+const void *yai_rpc_deflate(const yai_rpc_client_t *c,
+                            yai_rpc_envelope_t *env,
+                            const void *payload,
+                            uint8_t **buf,
+                            size_t *cap)
+{
+    uint32_t n = env->payload_len;
+    size_t z;
+
+    if (!(c->caps_granted & YAI_RPC_CAP_COMPRESSION) || c->compress_min == 0 || n < c->compress_min ||
+        env->command_id == YAI_CMD_HANDSHAKE)
+        return payload;
+    if (grow(buf, cap, Z_HEADER + yai_lz4_bound(n)) != 0)
+        return payload; /* sending it as is still works */
+
+    z = yai_lz4_compress(payload, n, *buf + Z_HEADER, *cap - Z_HEADER);
+    if (z == 0 || Z_HEADER + z >= n)
+        return payload; /* incompressible */
+    (*buf)[0] = (uint8_t)n;
+    (*buf)[1] = (uint8_t)(n >> 8);
+    (*buf)[2] = (uint8_t)(n >> 16);
+    (*buf)[3] = (uint8_t)(n >> 24);
+    env->payload_len = (uint32_t)(Z_HEADER + z);
+    env->_pad |= YAI_RPC_FLAG_COMPRESSED;
+    return *buf;
+}
+
+int yai_rpc_inflate(const void *payload, size_t len, uint32_t limit, uint8_t **buf, size_t *cap, uint32_t *raw_len)
+{
+    const uint8_t *p = (const uint8_t *)payload;
+    uint32_t n;
+
+    if (len < Z_HEADER)
+        return YAI_RPC_ECOMPRESS;
+    n = (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+    *raw_len = n;
+    if (n > limit)
+        return -8;
+    /* +1: never a zero-sized allocation */
+    if (grow(buf, cap, (size_t)n + 1) != 0)
+        return -2;
+    if (yai_lz4_decompress(p + Z_HEADER, len - Z_HEADER, *buf, n) != 0)
+        return YAI_RPC_ECOMPRESS;
+    return 0;
+}
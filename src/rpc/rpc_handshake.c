@@ -0,0 +1,242 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+// src/rpc/rpc_handshake.c
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <yai_sdk/rpc.h>
+
+#include <protocol.h>         /* yai_handshake_req_t / yai_handshake_ack_t */
+#include <yai_protocol_ids.h> /* YAI_PROTOCOL_IDS_VERSION + command ids */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "rpc_internal.h"
+
+/* ============================================================
+   PROCESS-WIDE HANDSHAKE CACHE
+   - keyed by (endpoint, protocol version, requested capabilities)
+   - a hit lets the next handshake ride along with the first call
+   ============================================================ */
+
+#define HS_CACHE_SLOTS 16
+#define HS_CACHE_DEFAULT_TTL_MS 30000
+
+typedef struct hs_entry {
+    char endpoint[sizeof(((yai_rpc_client_t *)0)->endpoint)];
+    uint32_t requested;
+    uint32_t granted;
+    uint64_t at_ms;
+    int used;
+} hs_entry_t;
+
+static pthread_mutex_t g_hs_mu = PTHREAD_MUTEX_INITIALIZER;
+static hs_entry_t g_hs[HS_CACHE_SLOTS];
+static int g_hs_ttl_ms = HS_CACHE_DEFAULT_TTL_MS;
+
+static uint64_t now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u;
+}
+
+static hs_entry_t *hs_find(const char *endpoint, uint32_t requested)
+{
+    for (size_t i = 0; i < HS_CACHE_SLOTS; i++)
+    {
+        if (g_hs[i].used && g_hs[i].requested == requested &&
+            strcmp(g_hs[i].endpoint, endpoint) == 0)
+            return &g_hs[i];
+    }
+    return NULL;
+}
+
+static int hs_cache_lookup(const yai_rpc_client_t *c, uint32_t *granted)
+{
+    int hit = 0;
+
+    if (!c->endpoint[0])
+        return 0;
+    pthread_mutex_lock(&g_hs_mu);
+    if (g_hs_ttl_ms > 0)
+    {
+        hs_entry_t *e = hs_find(c->endpoint, c->caps_requested);
+        if (e && now_ms() - e->at_ms < (uint64_t)g_hs_ttl_ms)
+        {
+            *granted = e->granted;
+            hit = 1;
+        }
+    }
+    pthread_mutex_unlock(&g_hs_mu);
+    return hit;
+}
+
+static void hs_cache_store(const yai_rpc_client_t *c)
+{
+    hs_entry_t *e;
+
+    if (!c->endpoint[0])
+        return;
+    pthread_mutex_lock(&g_hs_mu);
+    e = hs_find(c->endpoint, c->caps_requested);
+    if (!e)
+    {
+        /* free slot, else the oldest one */
+        e = &g_hs[0];
+        for (size_t i = 0; i < HS_CACHE_SLOTS; i++)
+        {
+            if (!g_hs[i].used)
+            {
+                e = &g_hs[i];
+                break;
+            }
+            if (g_hs[i].at_ms < e->at_ms)
+                e = &g_hs[i];
+        }
+    }
+    (void)snprintf(e->endpoint, sizeof(e->endpoint), "%s", c->endpoint);
+    e->requested = c->caps_requested;
+    e->granted = c->caps_granted;
+    e->at_ms = now_ms();
+    e->used = 1;
+    pthread_mutex_unlock(&g_hs_mu);
+}
+
+static void hs_cache_forget(const yai_rpc_client_t *c)
+{
+    pthread_mutex_lock(&g_hs_mu);
+    hs_entry_t *e = hs_find(c->endpoint, c->caps_requested);
+    if (e)
+        e->used = 0;
+    pthread_mutex_unlock(&g_hs_mu);
+}
+
+void yai_rpc_handshake_cache_set_ttl(int ttl_ms)
+{
+    pthread_mutex_lock(&g_hs_mu);
+    g_hs_ttl_ms = (ttl_ms > 0) ? ttl_ms : 0;
+    pthread_mutex_unlock(&g_hs_mu);
+}
+
+void yai_rpc_handshake_cache_clear(void)
+{
+    pthread_mutex_lock(&g_hs_mu);
+    memset(g_hs, 0, sizeof(g_hs));
+    pthread_mutex_unlock(&g_hs_mu);
+}
+
+/* ============================================================
+   HANDSHAKE (protocol.h structs)
+   ============================================================ */
+
+void yai_rpc_set_capabilities(yai_rpc_client_t *c, uint32_t caps)
+{
+    if (c)
+        c->caps_requested = caps;
+}
+
+void yai_rpc_set_handshake_defer(yai_rpc_client_t *c, int on)
+{
+    if (c)
+        c->hs_defer = on ? 1 : 0;
+}
+
+void yai_rpc_handshake_req_init(const yai_rpc_client_t *c, yai_handshake_req_t *req)
+{
+    memset(req, 0, sizeof(*req));
+    req->client_version = YAI_PROTOCOL_IDS_VERSION;
+    req->capabilities_requested = c->caps_requested;
+    (void)snprintf(req->client_name, sizeof(req->client_name), "%s", "yai-cli");
+}
+
+int yai_rpc_handshake_accept(yai_rpc_client_t *c, const yai_handshake_ack_t *ack, uint32_t ack_len)
+{
+    int rc = 0;
+
+    if (ack_len != (uint32_t)sizeof(*ack))
+        rc = -20;
+    else if (ack->server_version != YAI_PROTOCOL_IDS_VERSION)
+        rc = -21;
+    else if (ack->status != YAI_PROTO_STATE_READY)
+        rc = -22;
+
+    if (rc != 0)
+    {
+        c->caps_granted = 0;
+        hs_cache_forget(c);
+        return rc;
+    }
+
+    /* a server cannot turn on what was not asked for */
+    c->caps_granted = ack->capabilities_granted & c->caps_requested;
+    if (c->hs_deferred)
+    {
+        uint32_t cached = 0;
+        /* the server changed its grant since it was cached: next time, ask */
+        if (hs_cache_lookup(c, &cached) && cached != c->caps_granted)
+        {
+            hs_cache_forget(c);
+            return 0;
+        }
+    }
+    hs_cache_store(c);
+    return 0;
+}
+
+static int handshake_round_trip(yai_rpc_client_t *c)
+{
+    yai_handshake_req_t req;
+    yai_handshake_ack_t ack;
+    uint32_t out_len = 0;
+    int rc;
+
+    yai_rpc_handshake_req_init(c, &req);
+    memset(&ack, 0, sizeof(ack));
+
+    rc = yai_rpc_call_raw(
+        c,
+        YAI_CMD_HANDSHAKE,
+        &req,
+        (uint32_t)sizeof(req),
+        &ack,
+        sizeof(ack),
+        &out_len);
+    if (rc != 0)
+        return rc;
+    return yai_rpc_handshake_accept(c, &ack, out_len);
+}
+
+int yai_rpc_handshake(yai_rpc_client_t *c)
+{
+    uint32_t granted = 0;
+
+    if (!c || c->fd < 0)
+        return -1;
+
+    /*
+     * Cache hit, with deferral allowed: the endpoint accepted this exact
+     * request recently, so the handshake is sent in the same write as the
+     * next call. Its ack is still read and checked there. Nothing is
+     * granted until then: the grant may have changed, so the call riding
+     * behind the handshake uses no optional feature.
+     */
+    if (c->hs_defer && hs_cache_lookup(c, &granted))
+    {
+        c->caps_granted = 0;
+        c->hs_deferred = 1;
+        return 0;
+    }
+    c->hs_deferred = 0;
+    return handshake_round_trip(c);
+}
+
+int yai_rpc_handshake_settle(yai_rpc_client_t *c)
+{
+    if (!c || !c->hs_deferred)
+        return 0;
+    c->hs_deferred = 0;
+    return handshake_round_trip(c);
+}
@@ -0,0 +1,180 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+#pragma once
+
+#include <yai_sdk/rpc.h>
+
+#include <protocol.h>  /* yai_handshake_req_t / yai_handshake_ack_t */
+#include <transport.h> /* yai_rpc_envelope_t */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+/* Largest reply payload the buffered readers accept. */
+#define YAI_RPC_MAX_FRAME_PAYLOAD (16u * 1024u * 1024u)
+
+/* Reply payload limit, raw and on the wire, without YAI_RPC_CAP_LARGE_FRAMES. */
+#define YAI_RPC_SMALL_FRAME_PAYLOAD (4u * 1024u)
+
+/* Chunk size for streamed and discarded reply payloads. */
+#define YAI_RPC_STREAM_CHUNK (16u * 1024u)
+
+/* Deadline expired (connect, write or read); see yai_rpc_set_timeout. */
+#define YAI_RPC_ETIMEDOUT (-15)
+
+/* Received frame whose payload does not match its envelope checksum. */
+#define YAI_RPC_EBADSUM (-17)
+
+/* YAI_RPC_FLAG_COMPRESSED payload that does not decode. */
+#define YAI_RPC_ECOMPRESS (-18)
+
+/* Frame flags outside YAI_RPC_FLAG_* or without their capability granted. */
+#define YAI_RPC_EFLAGS (-19)
+
+/* Nonzero for a read failure after which the stream is out of sync: a
+ * truncated or foreign frame (-5, -6, -7, -10, -12), a late reply
+ * (YAI_RPC_ETIMEDOUT) or a frame that cannot be trusted (YAI_RPC_EBADSUM,
+ * YAI_RPC_ECOMPRESS, YAI_RPC_EFLAGS). The connection must be closed. */
+static inline int yai_rpc_desynced(int rc)
+{
+    switch (rc)
+    {
+    case -5: case -6: case -7: case -10: case -12:
+    case YAI_RPC_ETIMEDOUT: case YAI_RPC_EBADSUM: case YAI_RPC_ECOMPRESS: case YAI_RPC_EFLAGS:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+/* Largest reply payload the connection negotiated (YAI_RPC_CAP_LARGE_FRAMES). */
+uint32_t yai_rpc_reply_limit(const yai_rpc_client_t *c);
+
+/* Requests a connection may keep in flight: `window` once
+ * YAI_RPC_CAP_PIPELINE is granted, else one at a time. */
+size_t yai_rpc_window(const yai_rpc_client_t *c, size_t window);
+
+/* Checks a received frame's flags byte against the granted capabilities:
+ * 0, YAI_RPC_EFLAGS for an unknown bit or YAI_RPC_FLAG_BINARY without
+ * YAI_RPC_CAP_BINARY, YAI_RPC_ECOMPRESS for YAI_RPC_FLAG_COMPRESSED without
+ * YAI_RPC_CAP_COMPRESSION. */
+int yai_rpc_reply_flags_check(const yai_rpc_client_t *c, const yai_rpc_envelope_t *env);
+
+/* Absolute CLOCK_MONOTONIC deadline in ms; 0 (no deadline) for timeout_ms <= 0. */
+uint64_t yai_rpc_deadline(int timeout_ms);
+
+/* Polls fd for events until ready. 0 ready, YAI_RPC_ETIMEDOUT, -1 error. */
+int yai_rpc_wait_fd(int fd, short events, uint64_t deadline);
+
+/* Fills a request envelope (magic, version, authority, ws_id, fresh trace_id). */
+int yai_rpc_envelope_init(yai_rpc_client_t *c,
+                          yai_rpc_envelope_t *env,
+                          uint32_t command_id,
+                          uint32_t payload_len);
+
+/*
+ * Envelope checksums (YAI_RPC_CAP_CHECKSUM): once granted, every frame but
+ * the handshake carries the CRC32C of its payload. seal stamps an outgoing
+ * envelope; verify returns 0 or YAI_RPC_EBADSUM for a received one.
+ */
+void yai_rpc_envelope_seal(const yai_rpc_client_t *c, yai_rpc_envelope_t *env, const void *payload);
+int yai_rpc_envelope_verify(const yai_rpc_client_t *c, const yai_rpc_envelope_t *env, const void *payload);
+
+/*
+ * Payload compression (YAI_RPC_CAP_COMPRESSION). deflate returns the bytes
+ * to send for env's payload: the payload itself, or its compressed form in
+ * *buf (grown as needed, owned by the caller) with env->payload_len and
+ * YAI_RPC_FLAG_COMPRESSED updated. Runs before seal, so checksums cover the
+ * wire bytes.
+ */
+const void *yai_rpc_deflate(const yai_rpc_client_t *c,
+                            yai_rpc_envelope_t *env,
+                            const void *payload,
+                            uint8_t **buf,
+                            size_t *cap);
+
+/* Inflates a compressed payload into *buf (grown as needed). 0, -2,
+ * -8 when it would exceed `limit` raw bytes, or YAI_RPC_ECOMPRESS. */
+int yai_rpc_inflate(const void *payload, size_t len, uint32_t limit, uint8_t **buf, size_t *cap, uint32_t *raw_len);
+
+/* Handshake request carrying c->caps_requested. */
+void yai_rpc_handshake_req_init(const yai_rpc_client_t *c, yai_handshake_req_t *req);
+
+/* Validates an ack, records the granted caps and refreshes the cache (-20/-21/-22). */
+int yai_rpc_handshake_accept(yai_rpc_client_t *c, const yai_handshake_ack_t *ack, uint32_t ack_len);
+
+/* Completes a deferred handshake with its own round trip; paths that
+ * cannot carry it in front of a call (pipeline, async) settle it first. */
+int yai_rpc_handshake_settle(yai_rpc_client_t *c);
+
+/* Gathered write; iov is consumed (advanced) in place. A zero deadline
+ * blocks. 0, -1 on error, YAI_RPC_ETIMEDOUT past the deadline. */
+int yai_rpc_writev_all(int fd, struct iovec *iov, int iovcnt, uint64_t deadline);
+
+/* One scatter read; a zero deadline blocks. Bytes read, 0 on EOF, -1 on
+ * error, YAI_RPC_ETIMEDOUT past the deadline. */
+ssize_t yai_rpc_readv_some(int fd, struct iovec *iov, int iovcnt, uint64_t deadline);
+
+/*
+ * Receive buffer with an incremental envelope+payload frame parser.
+ * Bytes are appended with rx_space/rx_commit and frames are popped with
+ * rx_frame; a popped payload view stays valid until the next rx_space.
+ */
+typedef struct yai_rpc_rx {
+    uint8_t *data;
+    size_t cap;
+    size_t head;
+    size_t tail;
+} yai_rpc_rx_t;
+
+void yai_rpc_rx_init(yai_rpc_rx_t *rx);
+void yai_rpc_rx_free(yai_rpc_rx_t *rx);
+
+/* Returns a writable span of at least min(want, frame limit) bytes. */
+int yai_rpc_rx_space(yai_rpc_rx_t *rx, size_t want, uint8_t **out, size_t *avail);
+void yai_rpc_rx_commit(yai_rpc_rx_t *rx, size_t n);
+
+/* 1: frame popped, 0: *need more bytes required, <0: protocol error (-6/-7/-8). */
+int yai_rpc_rx_frame(yai_rpc_rx_t *rx,
+                     yai_rpc_envelope_t *env,
+                     const uint8_t **payload,
+                     size_t *need);
+
+/* Outgoing byte queue; bytes before `off` have already been written. */
+typedef struct yai_rpc_tx {
+    uint8_t *data;
+    size_t len;
+    size_t off;
+    size_t cap;
+} yai_rpc_tx_t;
+
+/* Appends a then b (either may be empty). Returns -2 on allocation failure. */
+int yai_rpc_tx_append(yai_rpc_tx_t *tx, const void *a, size_t an, const void *b, size_t bn);
+void yai_rpc_tx_free(yai_rpc_tx_t *tx);
+
+/*
+ * Submit-ordered ring of in-flight requests. Replies are matched back by
+ * envelope trace_id; completed slots stay as holes until the head passes.
+ */
+typedef struct yai_rpc_slot {
+    char trace_id[sizeof(((yai_rpc_envelope_t *)0)->trace_id)];
+    uint32_t command_id;
+    void *cookie;
+    int live;
+} yai_rpc_slot_t;
+
+typedef struct yai_rpc_slots {
+    yai_rpc_slot_t *ring;
+    size_t window;
+    size_t head;
+    size_t used;
+    size_t live;
+} yai_rpc_slots_t;
+
+int yai_rpc_slots_init(yai_rpc_slots_t *s, size_t window);
+void yai_rpc_slots_free(yai_rpc_slots_t *s);
+void yai_rpc_slots_push(yai_rpc_slots_t *s, const yai_rpc_envelope_t *env, void *cookie);
+
+/* Retires the slot owning env->trace_id into *out. -14 if none matches. */
+int yai_rpc_slots_take(yai_rpc_slots_t *s, const yai_rpc_envelope_t *env, yai_rpc_reply_t *out);
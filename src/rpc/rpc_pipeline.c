@@ -0,0 +1,214 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+// src/rpc/rpc_pipeline.c
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <yai_sdk/rpc.h>
+
+#include "rpc_internal.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* Queued requests are coalesced into one write up to this size. */
+#define PIPELINE_TX_FLUSH (64u * 1024u)
+
+struct yai_rpc_pipeline {
+    yai_rpc_client_t *c;
+    yai_rpc_slots_t slots;
+    yai_rpc_tx_t tx;
+    yai_rpc_rx_t rx;
+    /* compressed requests and inflated replies */
+    uint8_t *ztx;
+    size_t ztx_cap;
+    uint8_t *zrx;
+    size_t zrx_cap;
+};
+
+int yai_rpc_pipeline_open(yai_rpc_pipeline_t **out, yai_rpc_client_t *c, size_t window)
+{
+    yai_rpc_pipeline_t *p;
+    int rc;
+
+    if (!out)
+        return -1;
+    *out = NULL;
+    if (!c || c->fd < 0 || window == 0)
+        return -1;
+    rc = yai_rpc_handshake_settle(c);
+    if (rc != 0)
+        return rc;
+    window = yai_rpc_window(c, window);
+
+    p = (yai_rpc_pipeline_t *)calloc(1, sizeof(*p));
+    if (!p)
+        return -2;
+    if (yai_rpc_slots_init(&p->slots, window) != 0)
+    {
+        free(p);
+        return -2;
+    }
+    p->c = c;
+    yai_rpc_rx_init(&p->rx);
+    *out = p;
+    return 0;
+}
+
+void yai_rpc_pipeline_close(yai_rpc_pipeline_t *p)
+{
+    if (!p)
+        return;
+    yai_rpc_rx_free(&p->rx);
+    yai_rpc_tx_free(&p->tx);
+    yai_rpc_slots_free(&p->slots);
+    free(p->ztx);
+    free(p->zrx);
+    free(p);
+}
+
+size_t yai_rpc_pipeline_in_flight(const yai_rpc_pipeline_t *p)
+{
+    return p ? p->slots.live : 0;
+}
+
+static int flush_rc(int rc)
+{
+    if (rc == 0 || rc == YAI_RPC_ETIMEDOUT)
+        return rc;
+    return -3;
+}
+
+int yai_rpc_pipeline_flush(yai_rpc_pipeline_t *p)
+{
+    struct iovec iov;
+
+    if (!p || p->c->fd < 0)
+        return -1;
+    if (p->tx.len == 0)
+        return 0;
+
+    iov.iov_base = p->tx.data;
+    iov.iov_len = p->tx.len;
+    p->tx.len = 0;
+    return flush_rc(yai_rpc_writev_all(p->c->fd, &iov, 1, yai_rpc_deadline(p->c->timeout_ms)));
+}
+
+int yai_rpc_pipeline_submit(
+    yai_rpc_pipeline_t *p,
+    uint32_t command_id,
+    const void *payload,
+    uint32_t payload_len,
+    void *cookie)
+{
+    yai_rpc_envelope_t env;
+    size_t frame_len;
+
+    if (!p || p->c->fd < 0)
+        return -1;
+    if (payload_len > 0 && !payload)
+        return -2;
+    if (p->slots.used == p->slots.window)
+        return -13;
+
+    if (yai_rpc_envelope_init(p->c, &env, command_id, payload_len) != 0)
+        return -11;
+    payload = yai_rpc_deflate(p->c, &env, payload, &p->ztx, &p->ztx_cap);
+    payload_len = env.payload_len;
+    yai_rpc_envelope_seal(p->c, &env, payload);
+
+    frame_len = sizeof(env) + payload_len;
+    if (p->tx.len > 0 && p->tx.len + frame_len > PIPELINE_TX_FLUSH)
+    {
+        int rc = yai_rpc_pipeline_flush(p);
+        if (rc != 0)
+            return rc;
+    }
+
+    if (frame_len > PIPELINE_TX_FLUSH)
+    {
+        /* large frames skip the staging copy */
+        struct iovec iov[2];
+        iov[0].iov_base = &env;
+        iov[0].iov_len = sizeof(env);
+        iov[1].iov_base = (void *)payload;
+        iov[1].iov_len = payload_len;
+        int rc = flush_rc(yai_rpc_writev_all(p->c->fd, iov, 2, yai_rpc_deadline(p->c->timeout_ms)));
+        if (rc != 0)
+            return rc;
+    }
+    else if (yai_rpc_tx_append(&p->tx, &env, sizeof(env), payload, payload_len) != 0)
+    {
+        return -2;
+    }
+
+    yai_rpc_slots_push(&p->slots, &env, cookie);
+    return 0;
+}
+
+int yai_rpc_pipeline_next(yai_rpc_pipeline_t *p, yai_rpc_reply_t *out)
+{
+    yai_rpc_envelope_t env;
+    const uint8_t *payload = NULL;
+    uint64_t deadline;
+    int rc;
+
+    if (!p || !out)
+        return -1;
+    memset(out, 0, sizeof(*out));
+    if (p->slots.live == 0)
+        return 1;
+    rc = yai_rpc_pipeline_flush(p);
+    if (rc != 0)
+        return rc;
+
+    deadline = yai_rpc_deadline(p->c->timeout_ms);
+    for (;;)
+    {
+        size_t need = 0;
+        struct iovec iov;
+        ssize_t r;
+
+        rc = yai_rpc_rx_frame(&p->rx, &env, &payload, &need);
+        if (rc < 0)
+        {
+            /* a foreign or oversized head: the stream is out of sync */
+            yai_rpc_close(p->c);
+            return rc;
+        }
+        if (rc == 1)
+            break;
+        if (yai_rpc_rx_space(&p->rx, need, (uint8_t **)&iov.iov_base, &iov.iov_len) != 0)
+            return -2;
+        r = yai_rpc_readv_some(p->c->fd, &iov, 1, deadline);
+        if (r == YAI_RPC_ETIMEDOUT)
+            return YAI_RPC_ETIMEDOUT;
+        if (r <= 0)
+            return -5;
+        yai_rpc_rx_commit(&p->rx, (size_t)r);
+    }
+
+    rc = yai_rpc_envelope_verify(p->c, &env, payload);
+    if (rc == 0)
+        rc = yai_rpc_reply_flags_check(p->c, &env);
+    if (rc != 0)
+    {
+        yai_rpc_close(p->c);
+        return rc;
+    }
+    rc = yai_rpc_slots_take(&p->slots, &env, out);
+    if (rc != 0)
+        return rc;
+    if (env.payload_len > yai_rpc_reply_limit(p->c))
+        return -8; /* larger than negotiated; the stream is still in step */
+    out->payload = payload;
+    out->payload_len = env.payload_len;
+    if (env._pad & YAI_RPC_FLAG_COMPRESSED)
+    {
+        rc = yai_rpc_inflate(payload, env.payload_len, yai_rpc_reply_limit(p->c), &p->zrx, &p->zrx_cap,
+                             &out->payload_len);
+        out->payload = p->zrx;
+        if (rc == YAI_RPC_ECOMPRESS)
+            yai_rpc_close(p->c);
+    }
+    return rc;
+}
@@ -6,6 +6,256 @@
 
 #include "yai_sdk/public.h"
 
+/* Every indexed lookup answers what a scan of the same catalog does. */
+static int check_index_matches_scan(const yai_sdk_command_catalog_t *cat)
+{
+  yai_sdk_command_catalog_t scan = *cat;
+  yai_sdk_catalog_filter_t visible = {0};
+  yai_sdk_catalog_resolve_status_t s1, s2;
+
+  scan.index = NULL;
+  visible.surface_mask = YAI_SDK_CATALOG_SURFACE_SURFACE;
+  for (size_t i = 0; i < cat->command_count; i++) {
+    const yai_sdk_command_ref_t *c = cat->commands_sorted[i];
+    const char *tokens[3] = {c->entrypoint, c->topic, c->op};
+
+    if (yai_sdk_command_catalog_find_by_id(cat, c->id) != yai_sdk_command_catalog_find_by_id(&scan, c->id) ||
+        yai_sdk_command_catalog_find_group(cat, c->group) != yai_sdk_command_catalog_find_group(&scan, c->group) ||
+        yai_sdk_command_catalog_find_command(cat, c->group, c->name) !=
+            yai_sdk_command_catalog_find_command(&scan, c->group, c->name)) {
+      return 1;
+    }
+    if (yai_sdk_command_catalog_find_by_canonical_path(cat, c->canonical_path, NULL) !=
+            yai_sdk_command_catalog_find_by_canonical_path(&scan, c->canonical_path, NULL) ||
+        yai_sdk_command_catalog_find_by_canonical_path(cat, c->canonical_path, &visible) !=
+            yai_sdk_command_catalog_find_by_canonical_path(&scan, c->canonical_path, &visible)) {
+      return 2;
+    }
+    for (int mask = 0; mask <= YAI_SDK_CATALOG_SURFACE_ALL; mask++) {
+      if (yai_sdk_command_catalog_find_by_path(cat, c->entrypoint, c->topic, c->op, mask) !=
+              yai_sdk_command_catalog_find_by_path(&scan, c->entrypoint, c->topic, c->op, mask) ||
+          yai_sdk_command_catalog_find_by_path(cat, c->entrypoint, c->topic, NULL, mask) !=
+              yai_sdk_command_catalog_find_by_path(&scan, c->entrypoint, c->topic, NULL, mask) ||
+          yai_sdk_command_catalog_find_by_path(cat, c->entrypoint, NULL, c->op, mask) !=
+              yai_sdk_command_catalog_find_by_path(&scan, c->entrypoint, NULL, c->op, mask)) {
+        return 3;
+      }
+    }
+    for (size_t j = 0; j < c->aliases_len; j++) {
+      const char *alias = c->aliases[j];
+      int amb1 = -1, amb2 = -1;
+      if (!alias) continue;
+      if (yai_sdk_command_catalog_find_by_alias(cat, alias, &amb1) !=
+              yai_sdk_command_catalog_find_by_alias(&scan, alias, &amb2) ||
+          amb1 != amb2 || yai_sdk_command_catalog_resolve_path(cat, &alias, 1, NULL, &s1) !=
+                              yai_sdk_command_catalog_resolve_path(&scan, &alias, 1, NULL, &s2) ||
+          s1 != s2) {
+        return 6;
+      }
+    }
+    {
+      const yai_sdk_command_ref_t *got1[16], *got2[16];
+      yai_sdk_catalog_filter_t by_topic = visible;
+      size_t n1, n2;
+      by_topic.topic = c->topic;
+      n1 = yai_sdk_command_catalog_query(cat, &by_topic, got1, 16);
+      n2 = yai_sdk_command_catalog_query(&scan, &by_topic, got2, 16);
+      if (n1 != n2) return 9;
+      for (size_t k = 0; k < n1 && k < 16; k++) {
+        if (got1[k] != got2[k]) return 9;
+      }
+    }
+    for (size_t depth = 0; depth < 3; depth++) {
+      const char *tok = tokens[depth];
+      for (size_t len = 0; len <= strlen(tok); len++) {
+        const char *got1[32], *got2[32];
+        char prefix[64];
+        size_t n1, n2;
+        snprintf(prefix, sizeof(prefix), "%.*s", (int)len, tok);
+        n1 = yai_sdk_command_catalog_complete(cat, tokens, depth, prefix, &visible, got1, 32);
+        n2 = yai_sdk_command_catalog_complete(&scan, tokens, depth, prefix, &visible, got2, 32);
+        if (n1 != n2) return 7;
+        for (size_t k = 0; k < n1 && k < 32; k++) {
+          if (strcmp(got1[k], got2[k]) != 0 || strncmp(got1[k], prefix, len) != 0) return 7;
+        }
+      }
+    }
+    for (size_t n = 1; n <= 3; n++) {
+      if (yai_sdk_command_catalog_resolve_path(cat, tokens, n, &visible, &s1) !=
+              yai_sdk_command_catalog_resolve_path(&scan, tokens, n, &visible, &s2) ||
+          s1 != s2) {
+        return 4;
+      }
+    }
+  }
+  {
+    const char *tokens[3] = {"run", "no-such-topic", "ping"};
+    if (yai_sdk_command_catalog_find_by_id(cat, "yai.no.such") || yai_sdk_command_catalog_find_group(cat, "no-such") ||
+        yai_sdk_command_catalog_find_by_canonical_path(cat, "no such path", NULL) ||
+        yai_sdk_command_catalog_find_by_path(cat, "no-such", NULL, NULL, 0) ||
+        yai_sdk_command_catalog_find_by_alias(cat, "no-such-alias", NULL) ||
+        yai_sdk_command_catalog_resolve_path(cat, tokens, 3, NULL, &s1) !=
+            yai_sdk_command_catalog_resolve_path(&scan, tokens, 3, NULL, &s2) ||
+        s1 != s2) {
+      return 5;
+    }
+  }
+  for (int combo = 0; combo < 8 * 16 * 4; combo++) {
+    const yai_sdk_command_ref_t *got1[64], *got2[64];
+    const char *eps[8];
+    size_t ep_count = yai_sdk_command_catalog_collect_entrypoints(cat, 0, eps, 8);
+    yai_sdk_catalog_filter_t f = {0};
+
+    f.surface_mask = combo & 7;
+    f.stability_mask = (combo >> 3) & 15;
+    f.include_hidden = (combo >> 7) & 1;
+    f.include_deprecated = (combo >> 8) & 1;
+    for (size_t e = 0; e <= ep_count && e <= 8; e++) {
+      size_t n1, n2;
+      f.entrypoint = (e < ep_count) ? eps[e] : NULL;
+      n1 = yai_sdk_command_catalog_query(cat, &f, got1, 64);
+      n2 = yai_sdk_command_catalog_query(&scan, &f, got2, 64);
+      if (n1 != n2 || yai_sdk_command_catalog_query(cat, &f, NULL, 0) != n2) return 9;
+      if (n1 > 0 && (yai_sdk_command_catalog_query(cat, &f, got1, 1) != n2 || got1[0] != got2[0])) return 9;
+      for (size_t k = 0; k < n1 && k < 64; k++) {
+        if (got1[k] != got2[k]) return 9;
+      }
+    }
+  }
+  {
+    const char *bad_ep[3] = {"no-such", "root", "ping"};
+    const char *bad_topic[3] = {"run", "no-such-topic", "ping"};
+    const char *bad_op[3] = {"run", "root", "no-such-op"};
+    const char *eps[8];
+    size_t n = yai_sdk_command_catalog_complete(cat, NULL, 0, "ru", NULL, eps, 8);
+    if (yai_sdk_command_catalog_resolve_path(cat, bad_ep, 3, NULL, &s1) ||
+        s1 != YAI_SDK_CATALOG_RESOLVE_UNKNOWN_ENTRYPOINT ||
+        yai_sdk_command_catalog_resolve_path(cat, bad_topic, 3, NULL, &s1) ||
+        s1 != YAI_SDK_CATALOG_RESOLVE_UNKNOWN_TOPIC || yai_sdk_command_catalog_resolve_path(cat, bad_op, 3, NULL, &s1) ||
+        s1 != YAI_SDK_CATALOG_RESOLVE_UNKNOWN_OP || n != 1 || strcmp(eps[0], "run") != 0 ||
+        yai_sdk_command_catalog_complete(cat, bad_topic, 2, NULL, NULL, eps, 8) != 0) {
+      return 8;
+    }
+  }
+  return 0;
+}
+
+/* Refs with the same contents: a compact catalog fills in its own. */
+static int same_ref(const yai_sdk_command_ref_t *a, const yai_sdk_command_ref_t *b)
+{
+  if (!a || !b) return a == b;
+  return memcmp(a, b, sizeof(*a)) == 0;
+}
+
+static size_t filled_groups(const yai_sdk_command_catalog_t *cat)
+{
+  size_t n = 0;
+  for (size_t g = 0; g < cat->group_count; g++) {
+    if (cat->groups[g].commands) n++;
+  }
+  return n;
+}
+
+/* A compact catalog answers what the full one does, filling in refs only
+   for the groups a lookup hands out. */
+static int compact_answers(const yai_sdk_command_catalog_t *cat, const yai_sdk_command_catalog_t *cx)
+{
+  yai_sdk_catalog_filter_t f = {0};
+  const yai_sdk_command_group_t *groups = NULL;
+  const yai_sdk_command_ref_t *got1[64], *got2[64];
+  const char *eps1[8], *eps2[8];
+  size_t n1, n2;
+
+  if (cx->commands_sorted || cx->command_count != cat->command_count || cx->group_count != cat->group_count) {
+    return 2;
+  }
+
+  /* counting, completion and entrypoints read no refs */
+  f.include_hidden = 1;
+  n1 = yai_sdk_command_catalog_collect_entrypoints(cx, 0, eps1, 8);
+  n2 = yai_sdk_command_catalog_collect_entrypoints(cat, 0, eps2, 8);
+  if (n1 != n2 || yai_sdk_command_catalog_query(cx, &f, NULL, 0) != yai_sdk_command_catalog_query(cat, &f, NULL, 0) ||
+      yai_sdk_command_catalog_complete(cx, NULL, 0, NULL, NULL, NULL, 0) !=
+          yai_sdk_command_catalog_complete(cat, NULL, 0, NULL, NULL, NULL, 0) ||
+      filled_groups(cx) != 0) {
+    return 3;
+  }
+  for (size_t e = 0; e < n1 && e < 8; e++) {
+    if (strcmp(eps1[e], eps2[e]) != 0) {
+      return 3;
+    }
+  }
+
+  /* one lookup fills in one group */
+  if (!same_ref(yai_sdk_command_catalog_find_by_id(cx, cat->commands_sorted[0]->id), cat->commands_sorted[0]) ||
+      filled_groups(cx) != 1) {
+    return 4;
+  }
+
+  for (size_t i = 0; i < cat->command_count; i++) {
+    const yai_sdk_command_ref_t *c = cat->commands_sorted[i];
+    const char *tokens[3] = {c->entrypoint, c->topic, c->op};
+
+    if (!same_ref(yai_sdk_command_catalog_find_by_id(cx, c->id), yai_sdk_command_catalog_find_by_id(cat, c->id)) ||
+        !same_ref(yai_sdk_command_catalog_find_command(cx, c->group, c->name),
+                  yai_sdk_command_catalog_find_command(cat, c->group, c->name)) ||
+        !same_ref(yai_sdk_command_catalog_find_by_canonical_path(cx, c->canonical_path, NULL),
+                  yai_sdk_command_catalog_find_by_canonical_path(cat, c->canonical_path, NULL)) ||
+        !same_ref(yai_sdk_command_catalog_find_by_path(cx, c->entrypoint, c->topic, c->op, 0),
+                  yai_sdk_command_catalog_find_by_path(cat, c->entrypoint, c->topic, c->op, 0)) ||
+        !same_ref(yai_sdk_command_catalog_resolve_path(cx, tokens, 3, NULL, NULL),
+                  yai_sdk_command_catalog_resolve_path(cat, tokens, 3, NULL, NULL))) {
+      return 5;
+    }
+    for (size_t j = 0; j < c->aliases_len; j++) {
+      int amb1 = 0, amb2 = 0;
+      if (!same_ref(yai_sdk_command_catalog_find_by_alias(cx, c->aliases[j], &amb1),
+                    yai_sdk_command_catalog_find_by_alias(cat, c->aliases[j], &amb2)) ||
+          amb1 != amb2) {
+        return 6;
+      }
+    }
+  }
+
+  n1 = yai_sdk_command_catalog_query(cx, &f, got1, 64);
+  n2 = yai_sdk_command_catalog_query(cat, &f, got2, 64);
+  if (n1 != n2) {
+    return 7;
+  }
+  for (size_t k = 0; k < n1 && k < 64; k++) {
+    if (!same_ref(got1[k], got2[k])) {
+      return 7;
+    }
+  }
+
+  if (yai_catalog_list_groups(cx, &groups) != cat->group_count || filled_groups(cx) != cx->group_count) {
+    return 8;
+  }
+  for (size_t g = 0; g < cx->group_count; g++) {
+    if (strcmp(groups[g].group, cat->groups[g].group) != 0 ||
+        groups[g].command_count != cat->groups[g].command_count) {
+      return 9;
+    }
+    for (size_t j = 0; j < groups[g].command_count; j++) {
+      if (!same_ref(&groups[g].commands[j], &cat->groups[g].commands[j])) {
+        return 9;
+      }
+    }
+  }
+  return 0;
+}
+
+static int check_compact_matches(const yai_sdk_command_catalog_t *cat)
+{
+  yai_sdk_command_catalog_t cx = {0};
+  int rc;
+
+  if (yai_sdk_command_catalog_load_compact(&cx) != 0) return 1;
+  rc = compact_answers(cat, &cx);
+  yai_sdk_command_catalog_free(&cx);
+  return rc;
+}
+
 int main(void)
 {
   yai_sdk_command_catalog_t cat = {0};
@@ -81,6 +331,20 @@ int main(void)
     }
   }
 
+  rc = check_index_matches_scan(&cat);
+  if (rc != 0) {
+    fprintf(stderr, "catalog_smoke: indexed lookup differs from a scan (%d)\n", rc);
+    yai_sdk_command_catalog_free(&cat);
+    return 8;
+  }
+
+  rc = check_compact_matches(&cat);
+  if (rc != 0) {
+    fprintf(stderr, "catalog_smoke: compact catalog differs from the full one (%d)\n", rc);
+    yai_sdk_command_catalog_free(&cat);
+    return 9;
+  }
+
   yai_sdk_command_catalog_free(&cat);
   puts("catalog_smoke: ok");
   return 0;
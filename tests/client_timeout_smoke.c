@@ -0,0 +1,402 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "yai_sdk/public.h"
+#include "support/stub_server.h"
+#include "../src/platform/log_internal.h"
+
+static const char *k_req =
+    "{\"type\":\"yai.control.call.v1\",\"target_plane\":\"kernel\","
+    "\"command_id\":\"yai.kernel.ws_status\",\"argv\":[]}";
+
+static long elapsed_ms(const struct timespec *t0)
+{
+  struct timespec t1;
+  clock_gettime(CLOCK_MONOTONIC, &t1);
+  return (long)(t1.tv_sec - t0->tv_sec) * 1000L + (t1.tv_nsec - t0->tv_nsec) / 1000000L;
+}
+
+/* Stalled control call: bounded by call_timeout_ms, then the client reconnects. */
+static int check_call_timeout(void)
+{
+  stub_server_opts_t so = {.stall_ms = 400};
+  stub_server_t *srv = NULL;
+  yai_sdk_client_opts_t opts = {.ws_id = "ws_timeout", .auto_handshake = 1, .call_timeout_ms = 60};
+  yai_sdk_client_t *c = NULL;
+  yai_sdk_reply_t r = {0};
+  struct timespec t0;
+  int rc;
+
+  if (stub_server_start(&srv, &so) != 0) return 1;
+  if (yai_sdk_client_open(&c, &opts) != YAI_SDK_OK) {
+    stub_server_stop(srv);
+    return 2;
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &t0);
+  rc = yai_sdk_client_call_json(c, k_req, &r);
+  if (rc != YAI_SDK_TIMEOUT || strcmp(r.code, "TIMEOUT") != 0) {
+    fprintf(stderr, "client_timeout_smoke: expected timeout, got rc=%d code=%s\n", rc, r.code);
+    rc = 3;
+    goto out;
+  }
+  if (elapsed_ms(&t0) > 300) {
+    fprintf(stderr, "client_timeout_smoke: timeout took %ldms\n", elapsed_ms(&t0));
+    rc = 4;
+    goto out;
+  }
+  yai_sdk_reply_free(&r);
+
+  /* The stalled call closed its socket; a ping opens a fresh connection. */
+  rc = yai_sdk_client_ping(c, NULL, &r);
+  if (rc != YAI_SDK_OK || stub_server_accepts(srv) != 2) {
+    fprintf(stderr, "client_timeout_smoke: reconnect rc=%d accepts=%llu\n",
+            rc, (unsigned long long)stub_server_accepts(srv));
+    rc = 5;
+    goto out;
+  }
+  rc = 0;
+
+out:
+  yai_sdk_reply_free(&r);
+  yai_sdk_client_close(c);
+  stub_server_stop(srv);
+  return rc;
+}
+
+static int check_handshake_timeout(void)
+{
+  stub_server_opts_t so = {.stall_handshake_ms = 400};
+  stub_server_t *srv = NULL;
+  yai_sdk_client_opts_t opts = {.ws_id = "ws_timeout", .auto_handshake = 1, .handshake_timeout_ms = 60};
+  yai_sdk_client_t *c = NULL;
+  yai_sdk_reply_t r = {0};
+  int rc;
+
+  if (stub_server_start(&srv, &so) != 0) return 10;
+  if (yai_sdk_client_open(&c, &opts) != YAI_SDK_OK) {
+    stub_server_stop(srv);
+    return 11;
+  }
+  rc = yai_sdk_client_call_json(c, k_req, &r);
+  if (rc != YAI_SDK_TIMEOUT || strcmp(r.reason, "deadline_exceeded") != 0) {
+    fprintf(stderr, "client_timeout_smoke: expected handshake timeout, got rc=%d\n", rc);
+    rc = 12;
+  } else {
+    rc = 0;
+  }
+  yai_sdk_reply_free(&r);
+  yai_sdk_client_close(c);
+  stub_server_stop(srv);
+  return rc;
+}
+
+/* Root restart: side-effect-free calls retry onto the new root, others fail once. */
+static int check_reconnect_retry(void)
+{
+  static const char *k_create =
+      "{\"type\":\"yai.control.call.v1\",\"target_plane\":\"kernel\","
+      "\"command_id\":\"yai.kernel.ws_create\",\"argv\":[]}";
+  stub_server_t *srv = NULL;
+  yai_sdk_client_opts_t opts = {.ws_id = "ws_retry",
+                                .auto_handshake = 1,
+                                .retry_max = 3,
+                                .retry_backoff_ms = 8,
+                                .retry_backoff_max_ms = 16};
+  yai_sdk_client_t *c = NULL;
+  yai_sdk_reply_t r = {0};
+  struct timespec t0;
+  long ms;
+  int rc = 0;
+
+  if (stub_server_start(&srv, NULL) != 0) return 30;
+  if (yai_sdk_client_open(&c, &opts) != YAI_SDK_OK) {
+    stub_server_stop(srv);
+    return 31;
+  }
+  if (yai_sdk_client_call_json(c, k_req, &r) != YAI_SDK_OK) rc = 32;
+  yai_sdk_reply_free(&r);
+
+  /* the next read sees EOF; ws_status has no side effects and goes again */
+  stub_server_stop(srv);
+  srv = NULL;
+  if (rc == 0 && stub_server_start(&srv, NULL) != 0) rc = 33;
+  if (rc == 0 && (yai_sdk_client_call_json(c, k_req, &r) != YAI_SDK_OK || stub_server_accepts(srv) != 1)) {
+    fprintf(stderr, "client_timeout_smoke: retry after restart code=%s\n", r.code);
+    rc = 34;
+  }
+  yai_sdk_reply_free(&r);
+
+  /* ws_create writes: it is not replayed, but the client is not left dead */
+  stub_server_stop(srv);
+  srv = NULL;
+  if (rc == 0 && stub_server_start(&srv, NULL) != 0) rc = 35;
+  if (rc == 0 && (yai_sdk_client_call_json(c, k_create, &r) != YAI_SDK_SERVER_OFF ||
+                  strcmp(r.code, "SERVER_UNAVAILABLE") != 0 || stub_server_frames(srv) != 0)) {
+    rc = 36;
+  }
+  yai_sdk_reply_free(&r);
+  if (rc == 0 && (yai_sdk_client_call_json(c, k_create, &r) != YAI_SDK_OK || stub_server_accepts(srv) != 1)) {
+    rc = 37;
+  }
+  yai_sdk_reply_free(&r);
+
+  /* no root at all: three backoffs of at least 4, 8 and 8 ms, then the error */
+  stub_server_stop(srv);
+  srv = NULL;
+  clock_gettime(CLOCK_MONOTONIC, &t0);
+  if (rc == 0 && yai_sdk_client_ping(c, NULL, &r) != YAI_SDK_SERVER_OFF) rc = 38;
+  ms = elapsed_ms(&t0);
+  if (rc == 0 && (ms < 19 || ms > 500)) {
+    fprintf(stderr, "client_timeout_smoke: retry budget took %ldms\n", ms);
+    rc = 39;
+  }
+  yai_sdk_reply_free(&r);
+
+  yai_sdk_client_close(c);
+  stub_server_stop(srv);
+  return rc;
+}
+
+/* Structured events: typed fields reach the event handler unformatted, the
+   string handler gets them as text, and the async ring loses nothing it
+   does not count. */
+typedef struct log_capture {
+  int calls;
+  int call_rc;
+  uint64_t call_tx;
+  char call_trace[128];
+  char call_corr[64];
+  char text[512];
+  int delivered;
+  int scratch;
+} log_capture_t;
+
+static log_capture_t g_cap;
+
+static const yai_sdk_log_field_t *log_field(const yai_sdk_log_event_t *ev, const char *key)
+{
+  for (size_t i = 0; i < ev->field_count; i++) {
+    if (strcmp(ev->fields[i].key, key) == 0) return &ev->fields[i];
+  }
+  return NULL;
+}
+
+static void on_log_event(const yai_sdk_log_event_t *ev, void *user)
+{
+  log_capture_t *cap = (log_capture_t *)user;
+  const yai_sdk_log_field_t *f;
+
+  cap->delivered++;
+  if (strcmp(ev->component, "stack") == 0 && strcmp(ev->message, "scratch") == 0) cap->scratch++;
+  if (ev->level != YAI_SDK_LOG_DEBUG || strcmp(ev->component, "rpc") != 0 || strcmp(ev->message, "call") != 0) return;
+  cap->calls++;
+  if ((f = log_field(ev, "rc")) && f->kind == YAI_SDK_LOG_FIELD_INT) cap->call_rc = (int)f->v.i64;
+  if ((f = log_field(ev, "tx_bytes")) && f->kind == YAI_SDK_LOG_FIELD_UINT) cap->call_tx = f->v.u64;
+  if ((f = log_field(ev, "trace_id")) && f->kind == YAI_SDK_LOG_FIELD_STR) {
+    snprintf(cap->call_trace, sizeof(cap->call_trace), "%s", f->v.str);
+  }
+  if ((f = log_field(ev, "correlation_id")) && f->kind == YAI_SDK_LOG_FIELD_STR) {
+    snprintf(cap->call_corr, sizeof(cap->call_corr), "%s", f->v.str);
+  }
+}
+
+static void on_log_text(yai_sdk_log_level_t level, const char *component, const char *message, void *user)
+{
+  log_capture_t *cap = (log_capture_t *)user;
+  (void)level;
+  if (strcmp(component, "client") == 0 && strstr(message, "connect failed")) {
+    snprintf(cap->text, sizeof(cap->text), "%s", message);
+  }
+}
+
+static int check_structured_log(void)
+{
+  stub_server_t *srv = NULL;
+  yai_sdk_client_opts_t opts = {.ws_id = "ws_log", .correlation_id = "corr_log", .auto_handshake = 1};
+  yai_sdk_client_t *c = NULL;
+  yai_sdk_reply_t out;
+  yai_sdk_log_field_t fields[] = {YAI_LOG_STR("path", "a b\"c"), YAI_LOG_INT("rc", -3), YAI_LOG_UINT("n", 42)};
+  yai_sdk_log_event_t ev = {YAI_SDK_LOG_INFO, "t", "msg", fields, 3, 0};
+  char text[64];
+  int rc = 0;
+
+  if (yai_sdk_log_format(&ev, text, sizeof(text)) != strlen("msg path=\"a b\\\"c\" rc=-3 n=42") ||
+      strcmp(text, "msg path=\"a b\\\"c\" rc=-3 n=42") != 0) {
+    fprintf(stderr, "client_timeout_smoke: log format '%s'\n", text);
+    return 40;
+  }
+  /* no handler: nothing is enabled, whatever the level */
+  yai_sdk_set_log_level(YAI_SDK_LOG_DEBUG);
+  if (yai_log_enabled(YAI_SDK_LOG_ERROR)) rc = 41;
+
+  memset(&g_cap, 0, sizeof(g_cap));
+  yai_sdk_set_log_event_handler(on_log_event, &g_cap);
+  if (rc == 0 && stub_server_start(&srv, NULL) != 0) rc = 42;
+  if (rc == 0 && yai_sdk_client_open(&c, &opts) != YAI_SDK_OK) rc = 43;
+  if (rc == 0 && yai_sdk_client_call_json(c, k_req, &out) != YAI_SDK_OK) rc = 44;
+  yai_sdk_reply_free(&out);
+  if (rc == 0 && (g_cap.calls < 2 || g_cap.call_rc != 0 || g_cap.call_tx == 0 || strlen(g_cap.call_trace) != YAI_SDK_TRACE_WIRE_LEN ||
+                  strcmp(g_cap.call_corr, "corr_log") != 0)) {
+    rc = 45;
+  }
+  stub_server_stop(srv);
+
+  /* the string handler gets the fields formatted after the message */
+  yai_sdk_set_log_event_handler(NULL, NULL);
+  yai_sdk_set_log_handler(on_log_text, &g_cap);
+  yai_sdk_client_close(c);
+  c = NULL;
+  if (rc == 0 && yai_sdk_client_open(&c, &opts) != YAI_SDK_SERVER_OFF) rc = 46;
+  if (rc == 0 && !strstr(g_cap.text, "ws_id=ws_log")) rc = 47;
+  yai_sdk_set_log_handler(NULL, NULL);
+
+  /* async: every event is either delivered by the drain thread or counted */
+  if (rc == 0) {
+    uint64_t dropped = yai_sdk_log_async_dropped();
+    memset(&g_cap, 0, sizeof(g_cap));
+    yai_sdk_set_log_event_handler(on_log_event, &g_cap);
+    if (yai_sdk_log_async_start(4) != YAI_SDK_OK || yai_sdk_log_async_start(4) != YAI_SDK_BAD_ARGS) rc = 48;
+    /* the ring keeps its own copy of strings the caller reuses at once */
+    {
+      char comp[8] = "stack";
+      char msg[16] = "scratch";
+      yai_sdk_log_emit(YAI_SDK_LOG_INFO, comp, msg);
+      memset(comp, 'x', sizeof(comp) - 1u);
+      memset(msg, 'x', sizeof(msg) - 1u);
+    }
+    for (int i = 1; i < 200; i++) {
+      YAI_LOG(YAI_SDK_LOG_INFO, "test", "async", YAI_LOG_INT("i", i), YAI_LOG_STR("pad", k_req));
+    }
+    yai_sdk_log_async_stop();
+    if (rc == 0 && (uint64_t)g_cap.delivered + (yai_sdk_log_async_dropped() - dropped) != 200) {
+      fprintf(stderr, "client_timeout_smoke: async delivered=%d dropped=%llu\n", g_cap.delivered,
+              (unsigned long long)(yai_sdk_log_async_dropped() - dropped));
+      rc = 49;
+    }
+    if (rc == 0 && g_cap.scratch != 1) rc = 50;
+    yai_sdk_set_log_event_handler(NULL, NULL);
+  }
+  yai_sdk_set_log_level(YAI_SDK_LOG_WARN);
+  return rc;
+}
+
+typedef struct span_capture {
+  int n;
+  char name[16][16];
+  yai_sdk_trace_ctx_t ctx[16];
+  uint8_t parent[16][8];
+  uint64_t duration_ns[16];
+} span_capture_t;
+
+static span_capture_t g_spans;
+
+static void on_span(const yai_sdk_span_t *span, void *user)
+{
+  span_capture_t *cap = (span_capture_t *)user;
+  if (cap->n >= 16) return;
+  snprintf(cap->name[cap->n], sizeof(cap->name[0]), "%s", span->name);
+  cap->ctx[cap->n] = span->ctx;
+  memcpy(cap->parent[cap->n], span->parent_span_id, 8);
+  cap->duration_ns[cap->n] = span->duration_ns;
+  cap->n++;
+}
+
+static int find_span(const char *name)
+{
+  for (int i = 0; i < g_spans.n; i++) {
+    if (strcmp(g_spans.name[i], name) == 0) return i;
+  }
+  return -1;
+}
+
+/* W3C trace context: traceparent round trip, a parent the call joins, its
+   phase spans and the envelope trace_id the stub echoes back. */
+static int check_trace_spans(void)
+{
+  static const char *k_parent = "00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01";
+  stub_server_t *srv = NULL;
+  yai_sdk_client_opts_t opts = {.ws_id = "ws_trace", .auto_handshake = 1};
+  yai_sdk_client_t *c = NULL;
+  yai_sdk_trace_ctx_t parent, got, wire;
+  yai_sdk_reply_t out = {0};
+  char text[64];
+  int rc = 0;
+
+  if (yai_sdk_trace_parse(k_parent, &parent) != YAI_SDK_OK ||
+      yai_sdk_trace_format(&parent, text, sizeof(text)) != YAI_SDK_TRACEPARENT_LEN || strcmp(text, k_parent) != 0) {
+    return 50;
+  }
+  if (yai_sdk_trace_parse("00-00000000000000000000000000000000-00f067aa0ba902b7-01", &got) != YAI_SDK_BAD_ARGS ||
+      yai_sdk_trace_parse("00-4BF92F3577B34DA6A3CE929D0E0E4736-00f067aa0ba902b7-01", &got) != YAI_SDK_BAD_ARGS ||
+      yai_sdk_trace_parse("00-4bf92f3577b34da6a3ce929d0e0e4736-00f067aa0ba902b7-01-x", &got) != YAI_SDK_BAD_ARGS) {
+    return 51;
+  }
+
+  memset(&g_spans, 0, sizeof(g_spans));
+  yai_sdk_set_span_handler(on_span, &g_spans);
+  if (stub_server_start(&srv, NULL) != 0) rc = 52;
+  if (rc == 0 && yai_sdk_client_open(&c, &opts) != YAI_SDK_OK) rc = 52;
+  if (rc == 0 && yai_sdk_client_set_trace_parent(c, &parent) != YAI_SDK_OK) rc = 52;
+  memset(&g_spans, 0, sizeof(g_spans));
+  if (rc == 0 && yai_sdk_client_call_json(c, k_req, &out) != YAI_SDK_OK) rc = 53;
+  if (rc == 0) {
+    int call = find_span("call");
+    /* the reply carries the call span's traceparent, in the parent's trace */
+    if (yai_sdk_trace_parse(out.traceparent, &got) != YAI_SDK_OK || out.duration_ns == 0 || call < 0 ||
+        memcmp(got.trace_id, parent.trace_id, 16) != 0 || memcmp(got.span_id, g_spans.ctx[call].span_id, 8) != 0 ||
+        memcmp(g_spans.parent[call], parent.span_id, 8) != 0 || g_spans.duration_ns[call] != out.duration_ns) {
+      rc = 54;
+    }
+    /* every phase is a child of the call span */
+    for (int i = 0; rc == 0 && i < g_spans.n; i++) {
+      if (i != call && (memcmp(g_spans.ctx[i].trace_id, parent.trace_id, 16) != 0 ||
+                        memcmp(g_spans.parent[i], got.span_id, 8) != 0)) {
+        rc = 55;
+      }
+    }
+    if (rc == 0 && (find_span("send") < 0 || find_span("wait") < 0 || find_span("parse") < 0)) rc = 56;
+    /* the envelope carried the same context */
+    if (rc == 0 && (yai_sdk_trace_from_wire(out.trace_id, &wire) != YAI_SDK_OK ||
+                    memcmp(wire.trace_id, got.trace_id, 16) != 0 || memcmp(wire.span_id, got.span_id, 8) != 0)) {
+      rc = 57;
+    }
+  }
+  yai_sdk_reply_free(&out);
+
+  /* without a parent each call starts a trace of its own */
+  if (rc == 0) yai_sdk_client_set_trace_parent(c, NULL);
+  if (rc == 0 && yai_sdk_client_call_json(c, k_req, &out) != YAI_SDK_OK) rc = 58;
+  if (rc == 0 && (yai_sdk_trace_parse(out.traceparent, &got) != YAI_SDK_OK ||
+                  memcmp(got.trace_id, parent.trace_id, 16) == 0)) {
+    rc = 59;
+  }
+  yai_sdk_reply_free(&out);
+  yai_sdk_set_span_handler(NULL, NULL);
+  yai_sdk_client_close(c);
+  stub_server_stop(srv);
+  return rc;
+}
+
+int main(void)
+{
+  /* retries consult the registry for side effects */
+  const char *law_root = getenv("YAI_LAW_ROOT");
+  (void)setenv("YAI_REGISTRY_DIR", (law_root && law_root[0]) ? law_root : "../yai-law", 1);
+
+  int rc = check_call_timeout();
+  if (rc == 0) rc = check_handshake_timeout();
+  if (rc == 0) rc = check_reconnect_retry();
+  if (rc == 0) rc = check_structured_log();
+  if (rc == 0) rc = check_trace_spans();
+  if (rc == 0 && strcmp(yai_sdk_errstr(YAI_SDK_TIMEOUT), "timeout") != 0) rc = 20;
+  if (rc != 0) return rc;
+  puts("client_timeout_smoke: ok");
+  return 0;
+}
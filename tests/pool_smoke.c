@@ -0,0 +1,180 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "yai_sdk/public.h"
+#include "support/stub_server.h"
+
+#define THREADS 8
+#define CALLS_PER_THREAD 50
+
+static void sleep_ms(int ms)
+{
+  struct timespec ts = {ms / 1000, (long)(ms % 1000) * 1000000L};
+  nanosleep(&ts, NULL);
+}
+
+/* A cached handshake means opening does not wait on the server, so its
+ * accept thread may lag behind the clients; let it catch up. */
+static uint64_t settled_accepts(stub_server_t *srv, uint64_t at_least)
+{
+  for (int i = 0; i < 200 && stub_server_accepts(srv) < at_least; i++) sleep_ms(1);
+  return stub_server_accepts(srv);
+}
+
+static int check_reuse_and_keys(yai_sdk_pool_t *pool, stub_server_t *srv)
+{
+  yai_sdk_client_t *a = NULL;
+  yai_sdk_client_t *b = NULL;
+  yai_sdk_pool_stats_t st;
+
+  if (yai_sdk_pool_acquire(pool, "ws_pool", "operator", 1, &a) != YAI_SDK_OK) return 1;
+  yai_sdk_pool_release(pool, a, 1);
+  if (yai_sdk_pool_acquire(pool, "ws_pool", NULL, 1, &b) != YAI_SDK_OK || b != a) return 2;
+  yai_sdk_pool_release(pool, b, 1);
+  if (stub_server_accepts(srv) != 1) return 3;
+
+  /* a different authority is a different key */
+  if (yai_sdk_pool_acquire(pool, "ws_pool", "operator", 0, &b) != YAI_SDK_OK || b == a) return 4;
+  yai_sdk_pool_release(pool, b, 1);
+
+  /* max_per_key = 2: a third concurrent lease on one key is refused */
+  if (yai_sdk_pool_acquire(pool, "ws_pool", "operator", 1, &a) != YAI_SDK_OK) return 5;
+  if (yai_sdk_pool_acquire(pool, "ws_pool", "operator", 1, &b) != YAI_SDK_OK) return 6;
+  {
+    yai_sdk_client_t *c = NULL;
+    if (yai_sdk_pool_acquire(pool, "ws_pool", "operator", 1, &c) != YAI_SDK_TIMEOUT || c) return 7;
+  }
+  yai_sdk_pool_release(pool, a, 1);
+  yai_sdk_pool_release(pool, b, 0); /* not reusable: closed */
+
+  yai_sdk_pool_get_stats(pool, &st);
+  if (st.leased != 0 || st.idle != 2 || st.opened != 3) {
+    fprintf(stderr, "pool_smoke: stats idle=%zu leased=%zu opened=%llu\n", st.idle, st.leased, st.opened);
+    return 8;
+  }
+
+  /* a lessee that changed its authority does not go back under the old key */
+  if (yai_sdk_pool_acquire(pool, "ws_pool", "operator", 1, &a) != YAI_SDK_OK) return 9;
+  yai_sdk_client_set_authority(a, 0, "operator");
+  yai_sdk_pool_release(pool, a, 1);
+  yai_sdk_pool_get_stats(pool, &st);
+  if (st.idle != 1) return 10;
+  return 0;
+}
+
+static void *describe_worker(void *arg)
+{
+  yai_sdk_pool_t *pool = (yai_sdk_pool_t *)arg;
+  for (int i = 0; i < CALLS_PER_THREAD; i++) {
+    yai_sdk_workspace_info_t info;
+    char ws[32];
+    snprintf(ws, sizeof(ws), "ws_dash_%d", i % 4);
+    if (yai_sdk_workspace_describe_with(pool, ws, &info) != YAI_SDK_OK ||
+        !info.exists || strcmp(info.state, "ready") != 0) {
+      return (void *)1;
+    }
+  }
+  return NULL;
+}
+
+static int check_concurrent_describe(yai_sdk_pool_t *pool, stub_server_t *srv)
+{
+  pthread_t th[THREADS];
+  uint64_t before = settled_accepts(srv, 3);
+  int rc = 0;
+
+  for (int i = 0; i < THREADS; i++) pthread_create(&th[i], NULL, describe_worker, pool);
+  for (int i = 0; i < THREADS; i++) {
+    void *ret = NULL;
+    pthread_join(th[i], &ret);
+    if (ret) rc = 20;
+  }
+  /* 4 workspaces x max_per_key 2 bounds the sockets ever opened */
+  if (rc == 0 && stub_server_accepts(srv) - before > 8) {
+    fprintf(stderr, "pool_smoke: %llu connections for %d calls\n",
+            (unsigned long long)(stub_server_accepts(srv) - before), THREADS * CALLS_PER_THREAD);
+    rc = 21;
+  }
+  return rc;
+}
+
+/* An idle connection whose server went away fails its PING and is replaced. */
+static int check_health(void)
+{
+  yai_sdk_pool_opts_t po = {.max_per_key = 1, .health_check_after_ms = 1};
+  yai_sdk_pool_t *pool = NULL;
+  stub_server_t *s1 = NULL;
+  stub_server_t *s2 = NULL;
+  yai_sdk_client_t *c = NULL;
+  yai_sdk_pool_stats_t st;
+  int rc = 0;
+
+  if (stub_server_start(&s1, NULL) != 0 || yai_sdk_pool_create(&pool, &po) != YAI_SDK_OK) return 30;
+  if (yai_sdk_pool_acquire(pool, "ws_health", "operator", 1, &c) != YAI_SDK_OK) {
+    rc = 31;
+    goto out;
+  }
+  yai_sdk_pool_release(pool, c, 1);
+  stub_server_stop(s1);
+  s1 = NULL;
+  if (stub_server_start(&s2, NULL) != 0) {
+    rc = 32;
+    goto out;
+  }
+  sleep_ms(5);
+  if (yai_sdk_pool_acquire(pool, "ws_health", "operator", 1, &c) != YAI_SDK_OK) {
+    rc = 33;
+    goto out;
+  }
+  yai_sdk_pool_release(pool, c, 1);
+  yai_sdk_pool_get_stats(pool, &st);
+  if (st.health_failures != 1 || stub_server_accepts(s2) != 1) rc = 34;
+
+out:
+  yai_sdk_pool_destroy(pool);
+  stub_server_stop(s1);
+  stub_server_stop(s2);
+  return rc;
+}
+
+int main(void)
+{
+  yai_sdk_pool_opts_t po = {.max_per_key = 2, .acquire_timeout_ms = 0};
+  yai_sdk_pool_t *pool = NULL;
+  stub_server_t *srv = NULL;
+  int rc;
+
+  if (stub_server_start(&srv, NULL) != 0) {
+    fprintf(stderr, "pool_smoke: stub server start failed\n");
+    return 1;
+  }
+  if (yai_sdk_pool_create(&pool, &po) != YAI_SDK_OK) {
+    stub_server_stop(srv);
+    return 2;
+  }
+  rc = check_reuse_and_keys(pool, srv);
+  yai_sdk_pool_destroy(pool);
+
+  if (rc == 0) {
+    /* threads block for a free slot instead of failing */
+    po.acquire_timeout_ms = -1;
+    if (yai_sdk_pool_create(&pool, &po) != YAI_SDK_OK) rc = 3;
+    if (rc == 0) rc = check_concurrent_describe(pool, srv);
+    yai_sdk_pool_destroy(pool);
+  }
+  stub_server_stop(srv);
+  if (rc == 0) rc = check_health();
+
+  if (rc != 0) {
+    fprintf(stderr, "pool_smoke: failed rc=%d\n", rc);
+    return rc;
+  }
+  puts("pool_smoke: ok");
+  return 0;
+}
@@ -0,0 +1,1380 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <yai_protocol_ids.h>
+
+#include "yai_sdk/public.h"
+#include "support/stub_server.h"
+#include "../src/platform/crc32c.h"
+#include "../src/platform/lz4_block.h"
+#include "../src/protocol/binary_codec.h"
+#include "../src/rpc/rpc_internal.h"
+
+static int contains(const void *hay, size_t n, const char *needle)
+{
+  size_t k = strlen(needle);
+  const char *h = (const char *)hay;
+  for (size_t i = 0; k <= n && i <= n - k; i++) {
+    if (memcmp(h + i, needle, k) == 0) return 1;
+  }
+  return 0;
+}
+
+static int check_small_call(void)
+{
+  yai_rpc_client_t c;
+  char out[4096];
+  uint32_t out_len = 0;
+  const char *req =
+      "{\"type\":\"yai.control.call.v1\",\"target_plane\":\"kernel\","
+      "\"command_id\":\"yai.kernel.ws_status\",\"argv\":[]}";
+  int rc;
+
+  if (yai_rpc_connect(&c, "ws_rpc") != 0) {
+    fprintf(stderr, "rpc_transport_smoke: connect failed\n");
+    return 1;
+  }
+  rc = yai_rpc_handshake(&c);
+  if (rc != 0) {
+    fprintf(stderr, "rpc_transport_smoke: handshake rc=%d\n", rc);
+    yai_rpc_close(&c);
+    return 2;
+  }
+  rc = yai_rpc_call_raw(&c, YAI_CMD_CONTROL_CALL, req, (uint32_t)strlen(req),
+                        out, sizeof(out) - 1, &out_len);
+  if (rc != 0 || out_len == 0) {
+    fprintf(stderr, "rpc_transport_smoke: small call rc=%d len=%u\n", rc, out_len);
+    yai_rpc_close(&c);
+    return 3;
+  }
+  out[out_len] = '\0';
+  if (!strstr(out, "\"command_id\":\"yai.kernel.ws_status\"")) {
+    fprintf(stderr, "rpc_transport_smoke: unexpected reply %s\n", out);
+    yai_rpc_close(&c);
+    return 4;
+  }
+  yai_rpc_close(&c);
+  return 0;
+}
+
+/* Payload far larger than the socket buffer forces short gathered writes. */
+static int check_large_payload(void)
+{
+  const size_t pad = 512 * 1024;
+  yai_rpc_client_t c;
+  char out[4096];
+  uint32_t out_len = 0;
+  char *req;
+  int n;
+  int rc;
+
+  req = (char *)malloc(pad + 256);
+  if (!req) return 10;
+  n = snprintf(req, 256, "{\"type\":\"yai.control.call.v1\",\"command_id\":\"yai.root.ping\",\"pad\":\"");
+  memset(req + n, 'p', pad);
+  memcpy(req + n + pad, "\"}", 3);
+
+  if (yai_rpc_connect(&c, "ws_rpc") != 0) {
+    free(req);
+    return 11;
+  }
+  rc = yai_rpc_call_raw(&c, YAI_CMD_CONTROL_CALL, req, (uint32_t)strlen(req),
+                        out, sizeof(out) - 1, &out_len);
+  free(req);
+  yai_rpc_close(&c);
+  if (rc != 0) {
+    fprintf(stderr, "rpc_transport_smoke: large payload rc=%d\n", rc);
+    return 12;
+  }
+  out[out_len] = '\0';
+  if (!strstr(out, "\"command_id\":\"yai.root.ping\"")) {
+    fprintf(stderr, "rpc_transport_smoke: large payload reply mismatch\n");
+    return 13;
+  }
+  return 0;
+}
+
+static int check_reply_too_large(void)
+{
+  yai_rpc_client_t c;
+  char out[64];
+  uint32_t out_len = 0;
+  const char *req = "{\"type\":\"yai.control.call.v1\",\"command_id\":\"yai.root.ping\"}";
+  int rc;
+
+  if (yai_rpc_connect(&c, "ws_rpc") != 0) return 20;
+  rc = yai_rpc_call_raw(&c, YAI_CMD_CONTROL_CALL, req, (uint32_t)strlen(req),
+                        out, sizeof(out), &out_len);
+  if (rc != -8) {
+    fprintf(stderr, "rpc_transport_smoke: expected -8 for oversized reply, got %d\n", rc);
+    yai_rpc_close(&c);
+    return 21;
+  }
+  /* the oversized reply was drained: the next call on the socket is in sync */
+  rc = yai_rpc_call_raw(&c, YAI_CMD_PING, NULL, 0, out, sizeof(out), &out_len);
+  yai_rpc_close(&c);
+  if (rc != 0 || out_len != 4 || memcmp(out, "pong", 4) != 0) {
+    fprintf(stderr, "rpc_transport_smoke: stream out of sync after -8 (rc=%d)\n", rc);
+    return 22;
+  }
+  return 0;
+}
+
+/* Replies are matched back to their submit cookie via trace_id. */
+static int check_pipeline(void)
+{
+  enum { N = 100 };
+  yai_rpc_client_t c;
+  yai_rpc_pipeline_t *p = NULL;
+  char reqs[N][160];
+  int seen[N] = {0};
+  int submitted = 0;
+  int drained = 0;
+
+  if (yai_rpc_connect(&c, "ws_rpc") != 0) return 30;
+  if (yai_rpc_pipeline_open(&p, &c, 16) != 0) {
+    yai_rpc_close(&c);
+    return 31;
+  }
+
+  while (drained < N) {
+    yai_rpc_reply_t r;
+    int rc;
+    while (submitted < N) {
+      snprintf(reqs[submitted], sizeof(reqs[submitted]),
+               "{\"type\":\"yai.control.call.v1\",\"command_id\":\"yai.test.c%d\"}", submitted);
+      rc = yai_rpc_pipeline_submit(p, YAI_CMD_CONTROL_CALL, reqs[submitted],
+                                   (uint32_t)strlen(reqs[submitted]), &seen[submitted]);
+      if (rc == -13) break;
+      if (rc != 0) {
+        fprintf(stderr, "rpc_transport_smoke: pipeline submit rc=%d\n", rc);
+        goto fail;
+      }
+      submitted++;
+    }
+    if (yai_rpc_pipeline_in_flight(p) > 16) goto fail;
+    rc = yai_rpc_pipeline_next(p, &r);
+    if (rc != 0) {
+      fprintf(stderr, "rpc_transport_smoke: pipeline next rc=%d\n", rc);
+      goto fail;
+    }
+    {
+      int idx = (int)((int *)r.cookie - seen);
+      char expect[64];
+      snprintf(expect, sizeof(expect), "\"command_id\":\"yai.test.c%d\"", idx);
+      if (idx < 0 || idx >= N || seen[idx] ||
+          !contains(r.payload, r.payload_len, expect)) {
+        fprintf(stderr, "rpc_transport_smoke: pipeline reply mismatch idx=%d\n", idx);
+        goto fail;
+      }
+      seen[idx] = 1;
+    }
+    drained++;
+  }
+  if (yai_rpc_pipeline_next(p, &(yai_rpc_reply_t){0}) != 1) goto fail;
+
+  yai_rpc_pipeline_close(p);
+  yai_rpc_close(&c);
+  return 0;
+
+fail:
+  yai_rpc_pipeline_close(p);
+  yai_rpc_close(&c);
+  return 32;
+}
+
+typedef struct stream_probe {
+  size_t bytes;
+  size_t max_chunk;
+  size_t total;
+  size_t stop_after;
+  int in_order;
+} stream_probe_t;
+
+static int probe_chunk(void *user, const void *chunk, size_t len, size_t offset, size_t total)
+{
+  stream_probe_t *p = (stream_probe_t *)user;
+  (void)chunk;
+  if (offset != p->bytes) p->in_order = 0;
+  p->bytes += len;
+  p->total = total;
+  if (len > p->max_chunk) p->max_chunk = len;
+  return (p->stop_after && p->bytes >= p->stop_after) ? 1 : 0;
+}
+
+/* Multi-megabyte replies: buffered whole by call_json, chunked by call_stream. */
+static int check_large_reply(void)
+{
+  const size_t pad = 3u * 1024u * 1024u;
+  stub_server_opts_t so = {.reply_pad = pad};
+  stub_server_t *big = NULL;
+  yai_sdk_client_opts_t opts = {.ws_id = "ws_big", .auto_handshake = 1};
+  yai_sdk_client_t *c = NULL;
+  yai_sdk_reply_t r = {0};
+  stream_probe_t probe = {0, 0, 0, 0, 1};
+  int rc = 0;
+
+  if (stub_server_start(&big, &so) != 0) return 50;
+  if (yai_sdk_client_open(&c, &opts) != YAI_SDK_OK) {
+    rc = 51;
+    goto out;
+  }
+
+  if (yai_sdk_client_call_json(c, "{\"type\":\"yai.control.call.v1\",\"command_id\":\"yai.kernel.ws_status\"}", &r) != YAI_SDK_OK ||
+      !r.exec_reply_json || strlen(r.exec_reply_json) < pad || strcmp(r.command_id, "yai.kernel.ws_status") != 0) {
+    fprintf(stderr, "rpc_transport_smoke: large call_json failed code=%s\n", r.code);
+    rc = 52;
+    goto out;
+  }
+
+  if (yai_sdk_client_call_stream(c, "{\"type\":\"yai.control.call.v1\",\"command_id\":\"yai.kernel.ws_status\"}",
+                                 probe_chunk, &probe) != YAI_SDK_OK ||
+      probe.bytes != probe.total || probe.bytes < pad || !probe.in_order || probe.max_chunk > 64 * 1024) {
+    fprintf(stderr, "rpc_transport_smoke: stream bytes=%zu total=%zu max_chunk=%zu\n",
+            probe.bytes, probe.total, probe.max_chunk);
+    rc = 53;
+    goto out;
+  }
+
+  /* stopping early drains the remainder; the client keeps working */
+  memset(&probe, 0, sizeof(probe));
+  probe.in_order = 1;
+  probe.stop_after = 1;
+  if (yai_sdk_client_call_stream(c, "{\"type\":\"yai.control.call.v1\",\"command_id\":\"yai.kernel.ws_status\"}",
+                                 probe_chunk, &probe) != YAI_SDK_IO) {
+    rc = 54;
+    goto out;
+  }
+  yai_sdk_reply_free(&r);
+  if (yai_sdk_client_ping(c, NULL, &r) != YAI_SDK_OK || stub_server_accepts(big) != 1) {
+    fprintf(stderr, "rpc_transport_smoke: ping after stopped stream failed\n");
+    rc = 55;
+  }
+
+out:
+  yai_sdk_reply_free(&r);
+  yai_sdk_client_close(c);
+  stub_server_stop(big);
+  return rc;
+}
+
+/* One thread multiplexes several connections through the async step API. */
+static int check_async(void)
+{
+  enum { CONNS = 8, PER_CONN = 40, WINDOW = 8 };
+  yai_rpc_client_async_t *a[CONNS] = {0};
+  int sent[CONNS] = {0};
+  int done[CONNS] = {0};
+  int total = 0;
+  int rc = 0;
+
+  for (int i = 0; i < CONNS; i++) {
+    yai_rpc_client_t c;
+    if (yai_rpc_connect(&c, "ws_async") != 0 || yai_rpc_handshake(&c) != 0) {
+      yai_rpc_close(&c);
+      rc = 40;
+      goto out;
+    }
+    if (yai_rpc_async_open(&a[i], &c, WINDOW) != 0 || c.fd != -1) {
+      yai_rpc_close(&c);
+      rc = 41;
+      goto out;
+    }
+  }
+
+  while (total < CONNS * PER_CONN) {
+    struct pollfd pfd[CONNS];
+    for (int i = 0; i < CONNS; i++) {
+      unsigned want;
+      while (sent[i] < PER_CONN) {
+        char req[96];
+        int n = snprintf(req, sizeof(req),
+                         "{\"type\":\"yai.control.call.v1\",\"command_id\":\"yai.test.a%d\"}", sent[i]);
+        int src = yai_rpc_async_submit(a[i], YAI_CMD_CONTROL_CALL, req, (uint32_t)n, &sent[i]);
+        if (src == -13) break;
+        if (src != 0) {
+          rc = 42;
+          goto out;
+        }
+        sent[i]++;
+      }
+      want = yai_rpc_async_want(a[i]);
+      pfd[i].fd = yai_rpc_async_fd(a[i]);
+      pfd[i].events = (short)(((want & YAI_RPC_WANT_READ) ? POLLIN : 0) |
+                              ((want & YAI_RPC_WANT_WRITE) ? POLLOUT : 0));
+      pfd[i].revents = 0;
+    }
+    if (poll(pfd, CONNS, 5000) <= 0) {
+      fprintf(stderr, "rpc_transport_smoke: async poll stalled\n");
+      rc = 43;
+      goto out;
+    }
+    for (int i = 0; i < CONNS; i++) {
+      yai_rpc_reply_t r;
+      int prc;
+      if ((pfd[i].revents & POLLOUT) && yai_rpc_async_on_writable(a[i]) != 0) {
+        rc = 44;
+        goto out;
+      }
+      if ((pfd[i].revents & POLLIN) && yai_rpc_async_on_readable(a[i]) != 0) {
+        rc = 45;
+        goto out;
+      }
+      while ((prc = yai_rpc_async_poll_completion(a[i], &r)) == 0) {
+        char expect[64];
+        snprintf(expect, sizeof(expect), "\"command_id\":\"yai.test.a%d\"", done[i]);
+        /* the stand-in server answers in order on each connection */
+        if (r.cookie != &sent[i] || !contains(r.payload, r.payload_len, expect)) {
+          fprintf(stderr, "rpc_transport_smoke: async reply mismatch conn=%d n=%d\n", i, done[i]);
+          rc = 46;
+          goto out;
+        }
+        done[i]++;
+        total++;
+      }
+      if (prc < 0) {
+        rc = 47;
+        goto out;
+      }
+    }
+  }
+  for (int i = 0; i < CONNS; i++) {
+    if (yai_rpc_async_in_flight(a[i]) != 0 || yai_rpc_async_want(a[i]) != 0) rc = 48;
+  }
+
+out:
+  for (int i = 0; i < CONNS; i++) yai_rpc_async_close(a[i]);
+  return rc;
+}
+
+/*
+ * Granted caps are the requested ones minus what the server refuses. With
+ * deferral on, a cached handshake sends nothing by itself and rides along
+ * with the next call; without it, or once the TTL lapses, the handshake is
+ * a round trip again.
+ */
+static int check_handshake_cache(void)
+{
+  stub_server_opts_t so = {.caps_refused = YAI_RPC_CAP_COMPRESSION};
+  stub_server_t *hs = NULL;
+  yai_rpc_client_t c = {.fd = -1};
+  char out[64];
+  uint32_t out_len = 0;
+  int rc = 0;
+
+  if (stub_server_start(&hs, &so) != 0) return 80;
+  yai_rpc_handshake_cache_clear();
+
+  if (yai_rpc_connect(&c, "ws_hs") != 0) {
+    rc = 81;
+    goto out;
+  }
+  yai_rpc_set_capabilities(&c, YAI_RPC_CAPS_DEFAULT);
+  if (yai_rpc_handshake(&c) != 0 || stub_server_handshakes(hs) != 1 ||
+      c.caps_granted != (YAI_RPC_CAPS_DEFAULT & ~YAI_RPC_CAP_COMPRESSION)) {
+    fprintf(stderr, "rpc_transport_smoke: granted caps 0x%x\n", c.caps_granted);
+    rc = 82;
+    goto out;
+  }
+  yai_rpc_close(&c);
+
+  /* deferral is opt-in: a cache hit alone still waits for the ack */
+  if (yai_rpc_connect(&c, "ws_hs") != 0 || yai_rpc_handshake(&c) != 0 || stub_server_handshakes(hs) != 2 ||
+      c.caps_granted != (YAI_RPC_CAPS_DEFAULT & ~YAI_RPC_CAP_COMPRESSION)) {
+    rc = 79;
+    goto out;
+  }
+  yai_rpc_close(&c);
+
+  /* cache hit: no frame until the first call, which carries the handshake */
+  if (yai_rpc_connect(&c, "ws_hs") != 0) {
+    rc = 83;
+    goto out;
+  }
+  yai_rpc_set_capabilities(&c, YAI_RPC_CAPS_DEFAULT);
+  yai_rpc_set_handshake_defer(&c, 1);
+  if (yai_rpc_handshake(&c) != 0 || stub_server_handshakes(hs) != 2 || c.caps_granted != 0) {
+    rc = 84;
+    goto out;
+  }
+  if (yai_rpc_call_raw(&c, YAI_CMD_PING, NULL, 0, out, sizeof(out), &out_len) != 0 ||
+      out_len != 4 || memcmp(out, "pong", 4) != 0 || stub_server_handshakes(hs) != 3 ||
+      c.caps_granted != (YAI_RPC_CAPS_DEFAULT & ~YAI_RPC_CAP_COMPRESSION)) {
+    fprintf(stderr, "rpc_transport_smoke: coalesced handshake call failed\n");
+    rc = 85;
+    goto out;
+  }
+  yai_rpc_close(&c);
+
+  /* the grant changed behind the cache: the ack wins and the entry goes */
+  stub_server_set_caps_refused(hs, YAI_RPC_CAP_COMPRESSION | YAI_RPC_CAP_CHECKSUM);
+  if (yai_rpc_connect(&c, "ws_hs") != 0) {
+    rc = 88;
+    goto out;
+  }
+  yai_rpc_set_handshake_defer(&c, 1);
+  if (yai_rpc_handshake(&c) != 0 || stub_server_handshakes(hs) != 3 ||
+      yai_rpc_call_raw(&c, YAI_CMD_PING, NULL, 0, out, sizeof(out), &out_len) != 0 ||
+      c.caps_granted != (YAI_RPC_CAPS_DEFAULT & ~(YAI_RPC_CAP_COMPRESSION | YAI_RPC_CAP_CHECKSUM))) {
+    rc = 88;
+    goto out;
+  }
+  yai_rpc_close(&c);
+  if (yai_rpc_connect(&c, "ws_hs") != 0) {
+    rc = 89;
+    goto out;
+  }
+  yai_rpc_set_handshake_defer(&c, 1);
+  if (yai_rpc_handshake(&c) != 0 || stub_server_handshakes(hs) != 5) {
+    rc = 89;
+    goto out;
+  }
+  yai_rpc_close(&c);
+
+  /* a different request is a different cache key */
+  if (yai_rpc_connect(&c, "ws_hs") != 0) {
+    rc = 86;
+    goto out;
+  }
+  yai_rpc_set_capabilities(&c, YAI_RPC_CAP_PIPELINE);
+  yai_rpc_set_handshake_defer(&c, 1);
+  if (yai_rpc_handshake(&c) != 0 || stub_server_handshakes(hs) != 6) {
+    rc = 86;
+    goto out;
+  }
+  yai_rpc_close(&c);
+
+  yai_rpc_handshake_cache_set_ttl(0);
+  if (yai_rpc_connect(&c, "ws_hs") != 0) {
+    rc = 87;
+    goto out;
+  }
+  yai_rpc_set_handshake_defer(&c, 1);
+  if (yai_rpc_handshake(&c) != 0 || stub_server_handshakes(hs) != 7) {
+    rc = 87;
+    goto out;
+  }
+  yai_rpc_close(&c);
+
+  /* an SDK client reports no capabilities until its deferred ack is read */
+  yai_rpc_handshake_cache_set_ttl(30000);
+  for (int defer = 0; defer < 2 && rc == 0; defer++) {
+    yai_sdk_client_opts_t opts = {.ws_id = "ws_hs", .auto_handshake = 1, .handshake_defer = defer};
+    yai_sdk_client_t *sc = NULL;
+    yai_sdk_reply_t r = {0};
+    uint64_t before = stub_server_handshakes(hs);
+
+    if (yai_sdk_client_open(&sc, &opts) != YAI_SDK_OK || yai_sdk_client_handshake(sc) != YAI_SDK_OK) {
+      rc = 78;
+    } else if ((yai_sdk_client_capabilities(sc) == 0) != defer ||
+               stub_server_handshakes(hs) != before + (defer ? 0u : 1u)) {
+      fprintf(stderr, "rpc_transport_smoke: sdk defer=%d caps=0x%x\n", defer, yai_sdk_client_capabilities(sc));
+      rc = 77;
+    } else if (yai_sdk_client_ping(sc, NULL, &r) != YAI_SDK_OK ||
+               yai_sdk_client_capabilities(sc) !=
+                   (YAI_RPC_CAPS_DEFAULT & ~(YAI_RPC_CAP_COMPRESSION | YAI_RPC_CAP_CHECKSUM)) ||
+               stub_server_handshakes(hs) != before + 1u) {
+      rc = 76;
+    }
+    yai_sdk_reply_free(&r);
+    yai_sdk_client_close(sc);
+  }
+
+out:
+  yai_rpc_close(&c);
+  yai_rpc_handshake_cache_set_ttl(30000);
+  stub_server_stop(hs);
+  return rc;
+}
+
+/* In-place workspace switching reuses one handshaken root connection. */
+static int check_ws_switch(void)
+{
+  stub_server_t *ws = NULL;
+  yai_sdk_client_opts_t opts = {.ws_id = "ws_a", .auto_handshake = 1, .ws_switch_in_place = 1};
+  yai_sdk_client_t *c = NULL;
+  yai_sdk_reply_t r = {0};
+  const char *req = "{\"type\":\"yai.control.call.v1\",\"command_id\":\"yai.kernel.ws_status\"}";
+  int rc = 0;
+
+  if (stub_server_start(&ws, NULL) != 0) return 90;
+  if (yai_sdk_client_open(&c, &opts) != YAI_SDK_OK) {
+    rc = 91;
+    goto out;
+  }
+  for (int i = 0; i < 6 && rc == 0; i++) {
+    const char *id = (i % 2) ? "ws_b" : "ws_a";
+    char want[32];
+    snprintf(want, sizeof(want), "\"ws\":\"%s\"", id);
+    yai_sdk_reply_free(&r);
+    if (yai_sdk_client_set_ws(c, id) != YAI_SDK_OK ||
+        yai_sdk_client_call_json(c, req, &r) != YAI_SDK_OK ||
+        !r.exec_reply_json || !strstr(r.exec_reply_json, want)) {
+      fprintf(stderr, "rpc_transport_smoke: ws switch to %s failed\n", id);
+      rc = 92;
+    }
+  }
+  if (rc == 0 && (stub_server_accepts(ws) != 1 || stub_server_handshakes(ws) != 1)) {
+    fprintf(stderr, "rpc_transport_smoke: ws switch reconnected (accepts=%llu)\n",
+            (unsigned long long)stub_server_accepts(ws));
+    rc = 93;
+  }
+  /* a rejected ws_id leaves the current target alone */
+  if (rc == 0 && yai_sdk_client_set_ws(c, "../etc") != YAI_SDK_BAD_ARGS) rc = 94;
+
+out:
+  yai_sdk_reply_free(&r);
+  yai_sdk_client_close(c);
+  stub_server_stop(ws);
+  return rc;
+}
+
+/* Batches pipeline every item and honour the continue / fail-fast policy. */
+#define BATCH_N 1000
+#define BATCH_BAD 10
+
+static int check_call_batch(void)
+{
+  stub_server_opts_t so = {.fail_command_id = "yai.kernel.b10"};
+  stub_server_t *bs = NULL;
+  yai_sdk_client_opts_t opts = {.ws_id = "ws_batch", .auto_handshake = 1};
+  yai_sdk_client_t *c = NULL;
+  static char bufs[BATCH_N][96];
+  static const char *reqs[BATCH_N];
+  static yai_sdk_reply_t outs[BATCH_N];
+  static int rcs[BATCH_N];
+  int rc = 0;
+
+  for (int i = 0; i < BATCH_N; i++) {
+    snprintf(bufs[i], sizeof(bufs[i]), "{\"type\":\"yai.control.call.v1\",\"command_id\":\"yai.kernel.b%d\"}", i);
+    reqs[i] = bufs[i];
+  }
+  if (stub_server_start(&bs, &so) != 0) return 100;
+  if (yai_sdk_client_open(&c, &opts) != YAI_SDK_OK) {
+    stub_server_stop(bs);
+    return 101;
+  }
+
+  if (yai_sdk_client_call_batch_ex(c, reqs, BATCH_N, outs, rcs, YAI_SDK_BATCH_CONTINUE) != YAI_SDK_BAD_ARGS) rc = 102;
+  for (int i = 0; i < BATCH_N && rc == 0; i++) {
+    char want[32];
+    snprintf(want, sizeof(want), "yai.kernel.b%d", i);
+    if (strcmp(outs[i].command_id, want) != 0 ||
+        rcs[i] != (i == BATCH_BAD ? YAI_SDK_BAD_ARGS : YAI_SDK_OK)) {
+      fprintf(stderr, "rpc_transport_smoke: batch item %d command=%s rc=%d\n", i, outs[i].command_id, rcs[i]);
+      rc = 103;
+    }
+  }
+  for (int i = 0; i < BATCH_N; i++) yai_sdk_reply_free(&outs[i]);
+
+  /* fail fast: what was in flight completes, the rest is never sent */
+  if (rc == 0 && yai_sdk_client_call_batch_ex(c, reqs, BATCH_N, outs, rcs, YAI_SDK_BATCH_FAIL_FAST) != YAI_SDK_BAD_ARGS) rc = 104;
+  if (rc == 0 && (rcs[BATCH_BAD - 1] != YAI_SDK_OK || rcs[BATCH_N - 1] != YAI_SDK_RPC ||
+                  strcmp(outs[BATCH_N - 1].code, "NOT_SENT") != 0 || outs[BATCH_N - 1].exec_reply_json)) {
+    rc = 105;
+  }
+  for (int i = 0; i < BATCH_N; i++) yai_sdk_reply_free(&outs[i]);
+
+  /* the connection is still in step for plain calls */
+  if (rc == 0 && (yai_sdk_client_ping(c, NULL, &outs[0]) != YAI_SDK_OK || stub_server_accepts(bs) != 1)) rc = 106;
+  yai_sdk_reply_free(&outs[0]);
+
+  yai_sdk_client_close(c);
+  stub_server_stop(bs);
+  return rc;
+}
+
+static int view_is(yai_sdk_str_t v, const char *lit)
+{
+  return v.len == strlen(lit) && memcmp(v.ptr, lit, v.len) == 0;
+}
+
+static int check_call_view(void)
+{
+  stub_server_opts_t so = {.fail_command_id = "yai.kernel.bad"};
+  stub_server_t *vs = NULL;
+  yai_sdk_client_opts_t opts = {.ws_id = "ws_view", .auto_handshake = 1};
+  yai_sdk_client_t *c = NULL;
+  yai_sdk_arena_t *arena = NULL;
+  yai_sdk_reply_view_t v1;
+  yai_sdk_reply_view_t v2;
+  int rc = 0;
+
+  if (stub_server_start(&vs, &so) != 0) return 110;
+  if (yai_sdk_client_open(&c, &opts) != YAI_SDK_OK || yai_sdk_arena_create(&arena, 64) != YAI_SDK_OK) {
+    yai_sdk_client_close(c);
+    stub_server_stop(vs);
+    return 111;
+  }
+
+  /* client arena: each call recycles the previous one's memory */
+  for (int i = 0; i < 3 && rc == 0; i++) {
+    if (yai_sdk_client_call_view(c, "{\"type\":\"yai.control.call.v1\",\"command_id\":\"yai.kernel.ok\"}", NULL, &v1) != YAI_SDK_OK ||
+        !view_is(v1.status, "ok") || !view_is(v1.command_id, "yai.kernel.ok") ||
+        !contains(v1.details.ptr, v1.details.len, "ws_view") || v1.raw.ptr[v1.raw.len] != '\0' ||
+        !contains(v1.raw.ptr, v1.raw.len, "yai.exec.reply.v1")) {
+      rc = 112;
+    }
+  }
+
+  /* caller arena: both views stay valid until the caller resets it */
+  if (rc == 0 && (yai_sdk_client_call_view(c, "{\"command_id\":\"yai.kernel.ok\"}", arena, &v1) != YAI_SDK_OK ||
+                  yai_sdk_client_call_view(c, "{\"command_id\":\"yai.kernel.bad\"}", arena, &v2) != YAI_SDK_BAD_ARGS ||
+                  !view_is(v1.command_id, "yai.kernel.ok") || !view_is(v2.code, "BAD_ARGS") ||
+                  !view_is(v2.command_id, "yai.kernel.bad"))) {
+    rc = 113;
+  }
+  yai_sdk_arena_reset(arena);
+
+  /* transport errors still carry the request's command id */
+  stub_server_stop(vs);
+  vs = NULL;
+  if (rc == 0) {
+    yai_sdk_client_set_ws(c, "ws_view_gone");
+    if (yai_sdk_client_call_view(c, "{\"command_id\":\"yai.kernel.ok\"}", arena, &v1) != YAI_SDK_SERVER_OFF ||
+        !view_is(v1.code, "SERVER_UNAVAILABLE") || !view_is(v1.command_id, "yai.kernel.ok") || v1.raw.len != 0) {
+      rc = 114;
+    }
+  }
+
+  yai_sdk_arena_destroy(arena);
+  yai_sdk_client_close(c);
+  stub_server_stop(vs);
+  return rc;
+}
+
+static int check_binary_codec(void)
+{
+  static const yai_bin_str_t argv[2] = {{"--ws-id", 7}, {"a\"b", 3}};
+  yai_bin_intern_t tx, rx;
+  yai_bin_call_t call = {.command_id = {"yai.kernel.ws_status", 20}, .target_plane = {"kernel", 6}, .argc = 2, .argv = argv};
+  yai_bin_call_t got;
+  yai_bin_str_t a;
+  uint8_t buf[256];
+  size_t n1, n2;
+
+  /* the second call references the interned id instead of spelling it */
+  yai_bin_intern_reset(&tx);
+  yai_bin_intern_reset(&rx);
+  n1 = yai_bin_call_encode(&call, &tx, buf, sizeof(buf));
+  if (n1 == 0 || yai_bin_call_decode(buf, n1, &rx, &got) != 0 || got.argc != 2 || rx.count != 1) return 120;
+  n2 = yai_bin_call_encode(&call, &tx, buf, sizeof(buf));
+  if (n2 + 21 != n1 || yai_bin_call_decode(buf, n2, &rx, &got) != 0 ||
+      got.command_id.len != 20 || memcmp(got.command_id.p, "yai.kernel.ws_status", 20) != 0) return 121;
+  const uint8_t *cur = got.argv_raw;
+  if (yai_bin_next_str(&cur, got.argv_end, &a) != 0 || yai_bin_next_str(&cur, got.argv_end, &a) != 0 ||
+      a.len != 3 || memcmp(a.p, "a\"b", 3) != 0 || yai_bin_next_str(&cur, got.argv_end, &a) != 1) return 122;
+  /* truncated frames and unknown references are rejected */
+  if (yai_bin_call_decode(buf, n2 - 1, &rx, &got) == 0 || yai_bin_call_encode(&call, &tx, buf, 8) != 0) return 123;
+  yai_bin_intern_reset(&rx);
+  if (yai_bin_call_decode(buf, n2, &rx, &got) == 0) return 124;
+  return 0;
+}
+
+static int check_binary_calls(void)
+{
+  stub_server_opts_t refuse = {.caps_refused = YAI_RPC_CAP_BINARY, .fail_command_id = "yai.kernel.bad"};
+  stub_server_opts_t grant = {.fail_command_id = "yai.kernel.bad"};
+  const char *req = "{\"type\":\"yai.control.call.v1\",\"command_id\":\"yai.kernel.ok\",\"argv\":[\"--x\",\"q\\\"\\u00e9\"]}";
+  yai_sdk_client_opts_t opts = {.ws_id = "ws_bin", .auto_handshake = 1, .binary_codec = 1};
+  char json_reply[1024] = "";
+  int rc = 0;
+
+  for (int pass = 0; pass < 2 && rc == 0; pass++) {
+    stub_server_t *bs = NULL;
+    yai_sdk_client_t *c = NULL;
+    yai_sdk_reply_t out = {0};
+    int binary = (pass == 1);
+
+    if (stub_server_start(&bs, binary ? &grant : &refuse) != 0) return 130;
+    if (yai_sdk_client_open(&c, &opts) != YAI_SDK_OK) {
+      stub_server_stop(bs);
+      return 131;
+    }
+    for (int i = 0; i < 3 && rc == 0; i++) {
+      if (yai_sdk_client_call_json(c, req, &out) != YAI_SDK_OK || strcmp(out.command_id, "yai.kernel.ok") != 0 ||
+          out.hint_count != 2 || strcmp(out.hints[1], "second hint") != 0 || strcmp(out.details, "{\"ws\":\"ws_bin\"}") != 0 ||
+          !out.exec_reply_json || !strstr(out.exec_reply_json, "\"data\":{\"exists\":true")) {
+        fprintf(stderr, "rpc_transport_smoke: binary=%d call %d code=%s\n", binary, i, out.code);
+        rc = 132;
+      }
+      yai_sdk_reply_free(&out);
+    }
+    /* the binary reply still reads like the JSON one, field for field */
+    if (rc == 0 && yai_sdk_client_call_json(c, req, &out) == YAI_SDK_OK) {
+      yai_sdk_reply_t again;
+      if (binary && (yai_sdk_reply_parse(out.exec_reply_json, strlen(out.exec_reply_json), &again) != YAI_SDK_OK ||
+                     strcmp(again.summary, out.summary) != 0 || strcmp(again.trace_id, out.trace_id) != 0)) {
+        rc = 133;
+      }
+      if (!binary) snprintf(json_reply, sizeof(json_reply), "%s", strstr(out.exec_reply_json, "\"details\""));
+      else if (strcmp(json_reply, strstr(out.exec_reply_json, "\"details\"")) != 0) rc = 134;
+    }
+    yai_sdk_reply_free(&out);
+    if (rc == 0 && (yai_sdk_client_call_json(c, "{\"command_id\":\"yai.kernel.bad\"}", &out) != YAI_SDK_BAD_ARGS ||
+                    strcmp(out.command_id, "yai.kernel.bad") != 0)) {
+      rc = 135;
+    }
+    yai_sdk_reply_free(&out);
+    /* members the binary schema does not carry go out as JSON */
+    if (rc == 0 && yai_sdk_client_call_json(c, "{\"command_id\":\"yai.kernel.ok\",\"extra\":1}", &out) != YAI_SDK_OK) rc = 136;
+    yai_sdk_reply_free(&out);
+    if (rc == 0 && stub_server_binary_calls(bs) != (binary ? 5u : 0u)) {
+      fprintf(stderr, "rpc_transport_smoke: binary=%d binary calls %llu\n", binary,
+              (unsigned long long)stub_server_binary_calls(bs));
+      rc = 137;
+    }
+    yai_sdk_client_close(c);
+    stub_server_stop(bs);
+  }
+  return rc;
+}
+
+static int check_crc32c(void)
+{
+  static const char *kernels[] = {"bytewise", "slice8", "sse4.2", "armv8"};
+  static uint8_t buf[8192 + 16];
+  yai_crc32c_fn ref = yai_crc32c_kernel("bytewise");
+
+  if (yai_crc32c(0, "123456789", 9) != 0xE3069283u || yai_crc32c(0, "", 0) != 0 ||
+      yai_crc32c(yai_crc32c(0, "1234", 4), "56789", 5) != 0xE3069283u) {
+    return 140;
+  }
+  for (size_t i = 0; i < sizeof(buf); i++) buf[i] = (uint8_t)(i * 131u + (i >> 7));
+  /* every kernel agrees across alignments and the 3-lane block boundary */
+  for (size_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++) {
+    yai_crc32c_fn fn = yai_crc32c_kernel(kernels[k]);
+    if (!fn) continue;
+    for (size_t off = 0; off < 9; off++) {
+      for (size_t len = 0; len + off <= sizeof(buf); len += (len < 64) ? 1 : 509) {
+        if (fn(7, buf + off, len) != ref(7, buf + off, len)) {
+          fprintf(stderr, "rpc_transport_smoke: crc32c %s off=%zu len=%zu\n", kernels[k], off, len);
+          return 141;
+        }
+      }
+    }
+  }
+  return 0;
+}
+
+static int check_checksums(void)
+{
+  stub_server_opts_t bad = {.corrupt_checksum = 1};
+  stub_server_opts_t off = {.corrupt_checksum = 1, .caps_refused = YAI_RPC_CAP_CHECKSUM};
+  yai_sdk_client_opts_t opts = {.ws_id = "ws_sum", .auto_handshake = 1};
+  const char *req = "{\"type\":\"yai.control.call.v1\",\"command_id\":\"yai.kernel.ok\",\"argv\":[]}";
+  const char *batch[2] = {req, req};
+  yai_sdk_reply_t outs[2];
+  yai_sdk_reply_t out;
+  int rc = 0;
+
+  for (int pass = 0; pass < 2 && rc == 0; pass++) {
+    stub_server_t *bs = NULL;
+    yai_sdk_client_t *c = NULL;
+    int corrupt = (pass == 0);
+
+    if (stub_server_start(&bs, corrupt ? &bad : &off) != 0) return 150;
+    if (yai_sdk_client_open(&c, &opts) != YAI_SDK_OK) {
+      stub_server_stop(bs);
+      return 151;
+    }
+    /* a reply that fails its checksum is an error and costs the connection */
+    int crc = yai_sdk_client_call_json(c, req, &out);
+    if (corrupt ? (crc != YAI_SDK_PROTOCOL || strcmp(out.reason, "checksum_mismatch") != 0) : crc != YAI_SDK_OK) {
+      fprintf(stderr, "rpc_transport_smoke: checksum pass=%d rc=%d reason=%s\n", pass, crc, out.reason);
+      rc = 152;
+    }
+    yai_sdk_reply_free(&out);
+    if (rc == 0 && yai_sdk_client_call_json(c, req, &out) != crc) rc = 153;
+    yai_sdk_reply_free(&out);
+    if (rc == 0 && stub_server_accepts(bs) != (corrupt ? 2u : 1u)) rc = 154;
+    if (rc == 0) {
+      int brc = yai_sdk_client_call_batch(c, batch, 2, outs);
+      if ((brc == YAI_SDK_OK) == corrupt) rc = 155;
+      yai_sdk_reply_free(&outs[0]);
+      yai_sdk_reply_free(&outs[1]);
+    }
+    /* a ping maps the same failure the same way */
+    if (rc == 0) {
+      int prc = yai_sdk_client_ping(c, NULL, &out);
+      if (corrupt ? (prc != YAI_SDK_PROTOCOL || strcmp(out.reason, "checksum_mismatch") != 0) : prc != YAI_SDK_OK) {
+        fprintf(stderr, "rpc_transport_smoke: checksum ping pass=%d rc=%d reason=%s\n", pass, prc, out.reason);
+        rc = 169;
+      }
+      yai_sdk_reply_free(&out);
+    }
+    if (rc == 0 && stub_server_checksum_errors(bs) != 0) rc = 156;
+    yai_sdk_client_close(c);
+    stub_server_stop(bs);
+  }
+  return rc;
+}
+
+static int check_framing_errors(void)
+{
+  stub_server_opts_t so = {.corrupt_magic = 1};
+  yai_sdk_client_opts_t opts = {.ws_id = "ws_magic", .auto_handshake = 1};
+  const char *req = "{\"type\":\"yai.control.call.v1\",\"command_id\":\"yai.kernel.ok\",\"argv\":[]}";
+  stub_server_t *bs = NULL;
+  yai_sdk_client_t *c = NULL;
+  yai_sdk_reply_t out = {0};
+  int rc = 0;
+
+  if (stub_server_start(&bs, &so) != 0) return 157;
+  if (yai_sdk_client_open(&c, &opts) != YAI_SDK_OK) {
+    stub_server_stop(bs);
+    return 158;
+  }
+  /* a foreign frame leaves the stream out of sync: each call that meets one
+     drops the connection, and the next one reconnects */
+  for (int i = 0; i < 2 && rc == 0; i++) {
+    int crc = yai_sdk_client_call_json(c, req, &out);
+    if (crc != YAI_SDK_RPC) {
+      fprintf(stderr, "rpc_transport_smoke: framing call=%d rc=%d\n", i, crc);
+      rc = 159;
+    }
+    yai_sdk_reply_free(&out);
+  }
+  if (rc == 0 && stub_server_accepts(bs) != 2u) rc = 165;
+  yai_sdk_client_close(c);
+  stub_server_stop(bs);
+  return rc;
+}
+
+typedef struct lz4_collect {
+  uint8_t *dst;
+  size_t len;
+  size_t max_chunk;
+} lz4_collect_t;
+
+static int lz4_collect(void *user, const void *out, size_t len)
+{
+  lz4_collect_t *col = (lz4_collect_t *)user;
+  memcpy(col->dst + col->len, out, len);
+  col->len += len;
+  if (len > col->max_chunk) col->max_chunk = len;
+  return 0;
+}
+
+static int check_lz4(void)
+{
+  static uint8_t src[70000];
+  static uint8_t z[70000 + 70000 / 255 + 16];
+  static uint8_t back[70000];
+  static const size_t lens[] = {0, 1, 12, 13, 100, 4096, 65536, 70000};
+  uint8_t *buf = NULL;
+  size_t cap = 0;
+  uint32_t raw_len = 0;
+
+  /* runs, repeats beyond the 64 KiB window and noise, so every path is hit */
+  for (size_t i = 0; i < sizeof(src); i++) {
+    src[i] = (i % 3000 < 1500) ? (uint8_t)("{\"name\":\"yai\"}"[i % 14]) : (uint8_t)(i * 2654435761u >> 19);
+  }
+  for (size_t k = 0; k < sizeof(lens) / sizeof(lens[0]); k++) {
+    size_t n = lens[k];
+    size_t zn = yai_lz4_compress(src, n, z, yai_lz4_bound(n));
+    if (zn == 0 || zn > yai_lz4_bound(n) || yai_lz4_decompress(z, zn, back, n) != 0 || memcmp(src, back, n) != 0) {
+      fprintf(stderr, "rpc_transport_smoke: lz4 round trip n=%zu\n", n);
+      return 160;
+    }
+    /* truncated blocks and a wrong raw length are rejected, not overrun */
+    if (n > 0 && (yai_lz4_decompress(z, zn - 1, back, n) == 0 || yai_lz4_decompress(z, zn, back, n - 1) == 0)) {
+      return 161;
+    }
+  }
+  if (yai_lz4_compress(src, 4096, z, 8) != 0) return 162;
+
+  /* the streaming decoder, fed in odd pieces, flushes in bounded chunks */
+  for (size_t k = 0; k < sizeof(lens) / sizeof(lens[0]); k++) {
+    size_t n = lens[k];
+    size_t zn = yai_lz4_compress(src, n, z, yai_lz4_bound(n));
+    lz4_collect_t col = {back, 0, 0};
+    yai_lz4_stream_t st;
+    int frc = 0;
+
+    if (yai_lz4_stream_init(&st, zn, n, 1000, lz4_collect, &col) != 0) return 166;
+    for (size_t off = 0, step = 1; off < zn && frc == 0; off += step, step = step % 7 + 1) {
+      frc = yai_lz4_stream_feed(&st, z + off, (off + step <= zn) ? step : zn - off);
+    }
+    if (frc != 0 || yai_lz4_stream_end(&st) != 0 || col.len != n || col.max_chunk > 1000 ||
+        memcmp(src, back, n) != 0) {
+      fprintf(stderr, "rpc_transport_smoke: lz4 stream n=%zu got=%zu max_chunk=%zu\n", n, col.len, col.max_chunk);
+      yai_lz4_stream_free(&st);
+      return 167;
+    }
+    yai_lz4_stream_free(&st);
+
+    /* a block cut short never completes */
+    if (n > 0) {
+      col.len = 0;
+      if (yai_lz4_stream_init(&st, zn, n, 1000, lz4_collect, &col) != 0) return 166;
+      frc = yai_lz4_stream_feed(&st, z, zn - 1) == 0 && yai_lz4_stream_end(&st) == 0;
+      yai_lz4_stream_free(&st);
+      if (frc) return 168;
+    }
+  }
+
+  /* the wire form is a u32 LE raw length in front of the block */
+  {
+    size_t zn = yai_lz4_compress(src, 4096, z + 4, sizeof(z) - 4);
+    z[0] = 0x00;
+    z[1] = 0x10;
+    z[2] = 0;
+    z[3] = 0;
+    if (yai_rpc_inflate(z, zn + 4, YAI_RPC_MAX_FRAME_PAYLOAD, &buf, &cap, &raw_len) != 0 || raw_len != 4096 || memcmp(buf, src, 4096) != 0) {
+      free(buf);
+      return 163;
+    }
+    if (yai_rpc_inflate(z, 3, YAI_RPC_MAX_FRAME_PAYLOAD, &buf, &cap, &raw_len) != YAI_RPC_ECOMPRESS ||
+        yai_rpc_inflate(z, zn, YAI_RPC_MAX_FRAME_PAYLOAD, &buf, &cap, &raw_len) != YAI_RPC_ECOMPRESS) {
+      free(buf);
+      return 164;
+    }
+    /* the raw length is held to the negotiated limit before inflating */
+    if (yai_rpc_inflate(z, zn + 4, 4095, &buf, &cap, &raw_len) != -8) {
+      free(buf);
+      return 165;
+    }
+  }
+  free(buf);
+  return 0;
+}
+
+static int probe_rpc_chunk(void *user, const void *chunk, size_t len, size_t offset, uint32_t total)
+{
+  return probe_chunk(user, chunk, len, offset, total);
+}
+
+/* Large requests and replies travel compressed where granted, on every call path. */
+static int check_compression(void)
+{
+  const size_t pad = 256u * 1024u;
+  const char *small = "{\"type\":\"yai.control.call.v1\",\"command_id\":\"yai.kernel.zip\"}";
+  char *req;
+  char *out;
+  int n;
+  int rc = 0;
+
+  req = (char *)malloc(pad + 256);
+  out = (char *)malloc(2 * pad);
+  if (!req || !out) {
+    free(req);
+    free(out);
+    return 170;
+  }
+  n = snprintf(req, 256, "{\"type\":\"yai.control.call.v1\",\"command_id\":\"yai.kernel.zip\",\"pad\":\"");
+  memset(req + n, 'q', pad);
+  memcpy(req + n + pad, "\"}", 3);
+
+  for (int pass = 0; pass < 2 && rc == 0; pass++) {
+    int granted = (pass == 0);
+    stub_server_opts_t so = {.reply_pad = pad, .caps_refused = granted ? 0 : YAI_RPC_CAP_COMPRESSION};
+    stub_server_t *zs = NULL;
+    yai_rpc_client_t c;
+    yai_rpc_pipeline_t *p = NULL;
+    stream_probe_t probe = {0, 0, 0, 0, 1};
+    uint32_t out_len = 0;
+    uint64_t want = 0;
+
+    if (stub_server_start(&zs, &so) != 0) {
+      rc = 171;
+      break;
+    }
+    if (yai_rpc_connect(&c, "ws_zip") != 0 || yai_rpc_handshake(&c) != 0) {
+      stub_server_stop(zs);
+      rc = 172;
+      break;
+    }
+
+    /* a large request and its large reply: out_len counts inflated bytes */
+    if (yai_rpc_call_raw(&c, YAI_CMD_CONTROL_CALL, req, (uint32_t)strlen(req), out, 2 * pad, &out_len) != 0 ||
+        out_len < pad || !contains(out, out_len, "\"command_id\":\"yai.kernel.zip\"") ||
+        ((c.reply_flags & YAI_RPC_FLAG_COMPRESSED) != 0) != granted) {
+      fprintf(stderr, "rpc_transport_smoke: compressed call_raw pass=%d len=%u\n", pass, out_len);
+      rc = 173;
+    }
+    want += granted ? 2u : 0u;
+
+    /* streamed: the sink sees the raw reply, in order, in bounded chunks */
+    if (rc == 0 &&
+        (yai_rpc_call_stream(&c, YAI_CMD_CONTROL_CALL, small, (uint32_t)strlen(small), probe_rpc_chunk, &probe, &out_len) != 0 ||
+         probe.bytes != out_len || probe.total != out_len || out_len < pad || !probe.in_order ||
+         probe.max_chunk > 64 * 1024)) {
+      fprintf(stderr, "rpc_transport_smoke: compressed stream pass=%d bytes=%zu len=%u\n", pass, probe.bytes, out_len);
+      rc = 174;
+    }
+    want += granted ? 1u : 0u;
+
+    /* below the threshold the request goes out as is */
+    yai_rpc_set_compression_min(&c, 0);
+    if (rc == 0 && yai_rpc_call_raw(&c, YAI_CMD_CONTROL_CALL, req, (uint32_t)strlen(req), out, 2 * pad, &out_len) != 0)
+      rc = 175;
+    want += granted ? 1u : 0u;
+
+    if (rc == 0 && yai_rpc_pipeline_open(&p, &c, 4) != 0) rc = 176;
+    for (int i = 0; rc == 0 && i < 4; i++) {
+      if (yai_rpc_pipeline_submit(p, YAI_CMD_CONTROL_CALL, small, (uint32_t)strlen(small), NULL) != 0) rc = 177;
+    }
+    for (int i = 0; rc == 0 && i < 4; i++) {
+      yai_rpc_reply_t r;
+      if (yai_rpc_pipeline_next(p, &r) != 0 || r.payload_len < pad ||
+          !contains(r.payload, r.payload_len, "\"command_id\":\"yai.kernel.zip\"")) {
+        fprintf(stderr, "rpc_transport_smoke: compressed pipeline pass=%d\n", pass);
+        rc = 178;
+      }
+    }
+    want += granted ? 4u : 0u;
+    yai_rpc_pipeline_close(p);
+    yai_rpc_close(&c);
+
+    if (rc == 0 && (stub_server_compressed_frames(zs) != want || stub_server_checksum_errors(zs) != 0)) {
+      fprintf(stderr, "rpc_transport_smoke: compressed frames pass=%d got=%llu want=%llu\n", pass,
+              (unsigned long long)stub_server_compressed_frames(zs), (unsigned long long)want);
+      rc = 179;
+    }
+    stub_server_stop(zs);
+  }
+  free(req);
+  free(out);
+  return rc;
+}
+
+/*
+ * Refused capabilities narrow what the client does: without PIPELINE the
+ * window is one request, without LARGE_FRAMES a reply over 4 KiB is -8 on
+ * every path (compressed or not) and the connection stays in step.
+ */
+static int check_granted_caps(void)
+{
+  const char *req = "{\"type\":\"yai.control.call.v1\",\"command_id\":\"yai.kernel.caps\"}";
+  char *out = (char *)malloc(64 * 1024);
+  int rc = 0;
+
+  if (!out) return 56;
+  for (int pass = 0; pass < 2 && rc == 0; pass++) {
+    uint32_t refused = YAI_RPC_CAP_PIPELINE | YAI_RPC_CAP_LARGE_FRAMES | (pass ? YAI_RPC_CAP_COMPRESSION : 0);
+    stub_server_opts_t so = {.reply_pad = 8192, .caps_refused = refused};
+    stub_server_t *srv = NULL;
+    yai_rpc_client_t c;
+    yai_rpc_pipeline_t *p = NULL;
+    yai_rpc_client_async_t *a = NULL;
+    yai_rpc_reply_t r;
+    stream_probe_t probe = {0, 0, 0, 0, 1};
+    int marker = 0;
+    uint32_t out_len = 0;
+
+    if (stub_server_start(&srv, &so) != 0) {
+      rc = 57;
+      break;
+    }
+    if (yai_rpc_connect(&c, "ws_caps") != 0 || yai_rpc_handshake(&c) != 0 || (c.caps_granted & refused) != 0) {
+      rc = 58;
+      goto next;
+    }
+    if (yai_rpc_call_raw(&c, YAI_CMD_CONTROL_CALL, req, (uint32_t)strlen(req), out, 64 * 1024, &out_len) != -8 ||
+        yai_rpc_call_raw(&c, YAI_CMD_PING, NULL, 0, out, 64 * 1024, &out_len) != 0 || out_len != 4) {
+      fprintf(stderr, "rpc_transport_smoke: small-frame call_raw pass=%d\n", pass);
+      rc = 59;
+      goto next;
+    }
+    if (yai_rpc_call_stream(&c, YAI_CMD_CONTROL_CALL, req, (uint32_t)strlen(req), probe_rpc_chunk, &probe, &out_len) != -8 ||
+        probe.bytes != 0) {
+      fprintf(stderr, "rpc_transport_smoke: small-frame stream pass=%d bytes=%zu\n", pass, probe.bytes);
+      rc = 60;
+      goto next;
+    }
+
+    /* one request at a time; the oversized reply fails only itself */
+    if (yai_rpc_pipeline_open(&p, &c, 8) != 0 ||
+        yai_rpc_pipeline_submit(p, YAI_CMD_CONTROL_CALL, req, (uint32_t)strlen(req), &marker) != 0 ||
+        yai_rpc_pipeline_submit(p, YAI_CMD_PING, NULL, 0, NULL) != -13) {
+      rc = 61;
+      goto next;
+    }
+    if (yai_rpc_pipeline_next(p, &r) != -8 || r.cookie != &marker || c.fd < 0) {
+      rc = 62;
+      goto next;
+    }
+    if (yai_rpc_pipeline_submit(p, YAI_CMD_PING, NULL, 0, NULL) != 0 || yai_rpc_pipeline_next(p, &r) != 0 ||
+        r.payload_len != 4) {
+      rc = 63;
+      goto next;
+    }
+    yai_rpc_pipeline_close(p);
+    p = NULL;
+
+    if (yai_rpc_async_open(&a, &c, 8) != 0 || yai_rpc_async_window(a) != 1 ||
+        yai_rpc_async_submit(a, YAI_CMD_PING, NULL, 0, NULL) != 0 ||
+        yai_rpc_async_submit(a, YAI_CMD_PING, NULL, 0, NULL) != -13) {
+      rc = 64;
+    }
+
+  next:
+    yai_rpc_async_close(a);
+    yai_rpc_pipeline_close(p);
+    yai_rpc_close(&c);
+    stub_server_stop(srv);
+  }
+  free(out);
+  return rc;
+}
+
+/*
+ * The flags byte carries only what was negotiated: an unknown or ungranted
+ * reply flag is -19 on every path and costs the connection; an ungranted
+ * request flag is refused before anything is sent.
+ */
+static int check_frame_flags(void)
+{
+  stub_server_opts_t unknown = {.reply_flags = 0x80};
+  stub_server_opts_t binary = {.reply_flags = YAI_RPC_FLAG_BINARY, .caps_refused = YAI_RPC_CAP_BINARY};
+  yai_sdk_client_opts_t opts = {.ws_id = "ws_flags", .auto_handshake = 1};
+  const char *req = "{\"type\":\"yai.control.call.v1\",\"command_id\":\"yai.kernel.flags\"}";
+  stub_server_t *fs = NULL;
+  yai_rpc_client_t c;
+  yai_rpc_pipeline_t *p = NULL;
+  yai_rpc_reply_t r;
+  yai_sdk_client_t *sc = NULL;
+  yai_sdk_reply_t out = {0};
+  stream_probe_t probe = {0, 0, 0, 0, 1};
+  char buf[256];
+  uint32_t out_len = 0;
+  int rc = 0;
+
+  if (stub_server_start(&fs, &unknown) != 0) return 65;
+  if (yai_rpc_connect(&c, "ws_flags") != 0 || yai_rpc_handshake(&c) != 0 ||
+      yai_rpc_call_raw(&c, YAI_CMD_PING, NULL, 0, buf, sizeof(buf), &out_len) != YAI_RPC_EFLAGS || c.fd >= 0) {
+    rc = 66;
+  }
+  yai_rpc_close(&c);
+  if (rc == 0 &&
+      (yai_rpc_connect(&c, "ws_flags") != 0 || yai_rpc_handshake(&c) != 0 ||
+       yai_rpc_call_stream(&c, YAI_CMD_CONTROL_CALL, req, (uint32_t)strlen(req), probe_rpc_chunk, &probe, &out_len) !=
+           YAI_RPC_EFLAGS ||
+       probe.bytes != 0 || c.fd >= 0)) {
+    rc = 67;
+  }
+  yai_rpc_close(&c);
+  if (rc == 0 &&
+      (yai_rpc_connect(&c, "ws_flags") != 0 || yai_rpc_handshake(&c) != 0 || yai_rpc_pipeline_open(&p, &c, 4) != 0 ||
+       yai_rpc_pipeline_submit(p, YAI_CMD_PING, NULL, 0, NULL) != 0 || yai_rpc_pipeline_next(p, &r) != YAI_RPC_EFLAGS ||
+       c.fd >= 0)) {
+    rc = 68;
+  }
+  yai_rpc_pipeline_close(p);
+  yai_rpc_close(&c);
+  if (rc == 0 && yai_sdk_client_open(&sc, &opts) != YAI_SDK_OK) rc = 69;
+  if (rc == 0 && (yai_sdk_client_call_json(sc, req, &out) != YAI_SDK_PROTOCOL ||
+                  strcmp(out.reason, "bad_frame_flags") != 0)) {
+    fprintf(stderr, "rpc_transport_smoke: flags reason=%s\n", out.reason);
+    rc = 70;
+  }
+  yai_sdk_reply_free(&out);
+  yai_sdk_client_close(sc);
+  stub_server_stop(fs);
+  if (rc != 0) return rc;
+
+  /* binary was refused: neither side may use its flag */
+  if (stub_server_start(&fs, &binary) != 0) return 71;
+  if (yai_rpc_connect(&c, "ws_flags") != 0 || yai_rpc_handshake(&c) != 0) {
+    rc = 72;
+  } else {
+    c.next_flags = YAI_RPC_FLAG_BINARY;
+    if (yai_rpc_call_raw(&c, YAI_CMD_PING, NULL, 0, buf, sizeof(buf), &out_len) != YAI_RPC_EFLAGS || c.fd < 0 ||
+        c.next_flags != 0) {
+      rc = 73;
+    }
+    c.next_flags = YAI_RPC_FLAG_COMPRESSED;
+    if (rc == 0 && yai_rpc_call_raw(&c, YAI_CMD_PING, NULL, 0, buf, sizeof(buf), &out_len) != YAI_RPC_EFLAGS) rc = 74;
+    if (rc == 0 && (yai_rpc_call_raw(&c, YAI_CMD_PING, NULL, 0, buf, sizeof(buf), &out_len) != YAI_RPC_EFLAGS ||
+                    c.fd >= 0)) {
+      rc = 75;
+    }
+  }
+  yai_rpc_close(&c);
+  stub_server_stop(fs);
+  return rc;
+}
+
+/* A reply flagged compressed on a connection that refused compression is
+ * never inflated: -18 on every path, PROTOCOL_ERROR through the SDK. */
+static int check_compressed_ungranted(void)
+{
+  stub_server_opts_t so = {.reply_flags = YAI_RPC_FLAG_COMPRESSED, .caps_refused = YAI_RPC_CAP_COMPRESSION};
+  yai_sdk_client_opts_t opts = {.ws_id = "ws_zoff", .auto_handshake = 1};
+  const char *req = "{\"type\":\"yai.control.call.v1\",\"command_id\":\"yai.kernel.zoff\"}";
+  stub_server_t *zs = NULL;
+  yai_rpc_client_t c;
+  yai_rpc_pipeline_t *p = NULL;
+  yai_rpc_reply_t r;
+  yai_sdk_client_t *sc = NULL;
+  yai_sdk_reply_t out = {0};
+  stream_probe_t probe = {0, 0, 0, 0, 1};
+  char buf[1024];
+  uint32_t out_len = 0;
+  int rc = 0;
+
+  if (stub_server_start(&zs, &so) != 0) return 95;
+  if (yai_rpc_connect(&c, "ws_zoff") != 0 || yai_rpc_handshake(&c) != 0 ||
+      (c.caps_granted & YAI_RPC_CAP_COMPRESSION) != 0 ||
+      yai_rpc_call_raw(&c, YAI_CMD_CONTROL_CALL, req, (uint32_t)strlen(req), buf, sizeof(buf), &out_len) !=
+          YAI_RPC_ECOMPRESS ||
+      c.fd >= 0) {
+    rc = 96;
+  }
+  yai_rpc_close(&c);
+  if (rc == 0 &&
+      (yai_rpc_connect(&c, "ws_zoff") != 0 || yai_rpc_handshake(&c) != 0 ||
+       yai_rpc_call_stream(&c, YAI_CMD_CONTROL_CALL, req, (uint32_t)strlen(req), probe_rpc_chunk, &probe, &out_len) !=
+           YAI_RPC_ECOMPRESS ||
+       probe.bytes != 0)) {
+    rc = 97;
+  }
+  yai_rpc_close(&c);
+  if (rc == 0 &&
+      (yai_rpc_connect(&c, "ws_zoff") != 0 || yai_rpc_handshake(&c) != 0 || yai_rpc_pipeline_open(&p, &c, 4) != 0 ||
+       yai_rpc_pipeline_submit(p, YAI_CMD_CONTROL_CALL, req, (uint32_t)strlen(req), NULL) != 0 ||
+       yai_rpc_pipeline_next(p, &r) != YAI_RPC_ECOMPRESS || c.fd >= 0)) {
+    rc = 98;
+  }
+  yai_rpc_pipeline_close(p);
+  yai_rpc_close(&c);
+  if (rc == 0 && yai_sdk_client_open(&sc, &opts) != YAI_SDK_OK) rc = 99;
+  if (rc == 0 && (yai_sdk_client_call_json(sc, req, &out) != YAI_SDK_PROTOCOL ||
+                  strcmp(out.reason, "decompress_failed") != 0)) {
+    fprintf(stderr, "rpc_transport_smoke: ungranted compression reason=%s\n", out.reason);
+    rc = 107;
+  }
+  yai_sdk_reply_free(&out);
+  yai_sdk_client_close(sc);
+  stub_server_stop(zs);
+  return rc;
+}
+
+static int check_metrics(void)
+{
+  stub_server_opts_t so = {.fail_command_id = "yai.kernel.m_bad"};
+  stub_server_t *ms = NULL;
+  yai_sdk_client_opts_t opts = {.ws_id = "ws_metrics", .auto_handshake = 1};
+  yai_sdk_client_t *c = NULL;
+  yai_sdk_reply_t out;
+  static yai_sdk_metrics_t m;
+  static yai_sdk_command_metrics_t cmds[1024];
+  static char text[16384];
+  const char *ok_req = "{\"type\":\"yai.control.call.v1\",\"command_id\":\"yai.kernel.m_ok\"}";
+  const char *bad_req = "{\"type\":\"yai.control.call.v1\",\"command_id\":\"yai.kernel.m_bad\"}";
+  int rc = 0;
+
+  for (size_t i = 1; i < YAI_SDK_HIST_BUCKETS; i++) {
+    if (yai_sdk_histogram_bucket_max(i) <= yai_sdk_histogram_bucket_max(i - 1)) return 180;
+  }
+  if (stub_server_start(&ms, &so) != 0) return 181;
+  if (yai_sdk_client_open(&c, &opts) != YAI_SDK_OK) {
+    stub_server_stop(ms);
+    return 182;
+  }
+
+  for (int i = 0; i < 5 && rc == 0; i++) {
+    if (yai_sdk_client_call_json(c, ok_req, &out) != YAI_SDK_OK) rc = 183;
+    yai_sdk_reply_free(&out);
+  }
+  if (rc == 0 && yai_sdk_client_call_json(c, bad_req, &out) != YAI_SDK_BAD_ARGS) rc = 184;
+  yai_sdk_reply_free(&out);
+  if (rc == 0 && yai_sdk_client_ping(c, NULL, &out) != YAI_SDK_OK) rc = 185;
+  yai_sdk_reply_free(&out);
+  stub_server_stop(ms);
+  /* the root is gone: counted as a transport failure */
+  if (rc == 0 && yai_sdk_client_call_json(c, ok_req, &out) != YAI_SDK_SERVER_OFF) rc = 186;
+  yai_sdk_reply_free(&out);
+
+  if (rc == 0 && yai_sdk_client_metrics(c, &m) != YAI_SDK_OK) rc = 187;
+  if (rc == 0 && (m.calls[YAI_SDK_CALL_OK] != 6 || m.calls[YAI_SDK_CALL_BAD_ARGS] != 1 ||
+                  m.calls[YAI_SDK_CALL_SERVER_OFF] != 1 || m.phase[YAI_SDK_PHASE_CALL].count != 8 ||
+                  m.phase[YAI_SDK_PHASE_CONNECT].count < 1 || m.phase[YAI_SDK_PHASE_HANDSHAKE].count != 1 ||
+                  m.phase[YAI_SDK_PHASE_SEND].count < 7 || m.phase[YAI_SDK_PHASE_WAIT].count < 7 ||
+                  m.phase[YAI_SDK_PHASE_PARSE].count != 6 || m.bytes_sent == 0 || m.bytes_received == 0)) {
+    fprintf(stderr, "rpc_transport_smoke: metrics ok=%llu bad=%llu off=%llu calls=%llu\n",
+            (unsigned long long)m.calls[YAI_SDK_CALL_OK], (unsigned long long)m.calls[YAI_SDK_CALL_BAD_ARGS],
+            (unsigned long long)m.calls[YAI_SDK_CALL_SERVER_OFF],
+            (unsigned long long)m.phase[YAI_SDK_PHASE_CALL].count);
+    rc = 188;
+  }
+  if (rc == 0) {
+    const yai_sdk_histogram_t *h = &m.phase[YAI_SDK_PHASE_CALL];
+    uint64_t p50 = yai_sdk_histogram_quantile(h, 0.5);
+    uint64_t p99 = yai_sdk_histogram_quantile(h, 0.99);
+    if (p50 == 0 || p50 > p99 || p99 > h->max_ns || h->sum_ns < h->max_ns) rc = 189;
+  }
+
+  size_t n = (rc == 0) ? yai_sdk_metrics_commands(cmds, sizeof(cmds) / sizeof(cmds[0])) : 0;
+  int seen = 0;
+  for (size_t i = 0; i < n && i < sizeof(cmds) / sizeof(cmds[0]); i++) {
+    if (strcmp(cmds[i].command_id, "yai.kernel.m_ok") == 0) {
+      seen = cmds[i].calls[YAI_SDK_CALL_OK] == 5 && cmds[i].calls[YAI_SDK_CALL_SERVER_OFF] == 1 &&
+             cmds[i].bytes_sent > 0 && cmds[i].call_ns > 0;
+    }
+  }
+  if (rc == 0 && !seen) rc = 190;
+
+  if (rc == 0) {
+    size_t need = yai_sdk_metrics_format(&m, NULL, 0);
+    if (need == 0 || need >= sizeof(text) || yai_sdk_metrics_format(&m, text, sizeof(text)) != need ||
+        strlen(text) != need || !strstr(text, "yai_sdk_calls_total{class=\"bad_args\"} 1\n") ||
+        !strstr(text, "yai_sdk_phase_ns{phase=\"wait\",quantile=\"0.99\"}")) {
+      rc = 191;
+    }
+    /* truncated output stays terminated */
+    if (rc == 0 && (yai_sdk_metrics_format(&m, text, 8) != need || strlen(text) != 7)) rc = 192;
+  }
+
+  /* the process totals include this client */
+  yai_sdk_metrics_global(&m);
+  if (rc == 0 && m.calls[YAI_SDK_CALL_OK] < 6) rc = 193;
+
+  yai_sdk_client_close(c);
+  return rc;
+}
+
+int main(void)
+{
+  stub_server_t *srv = NULL;
+  int rc;
+
+  if (stub_server_start(&srv, NULL) != 0) {
+    fprintf(stderr, "rpc_transport_smoke: stub server start failed\n");
+    return 1;
+  }
+
+  rc = check_small_call();
+  if (rc == 0) rc = check_large_payload();
+  if (rc == 0) rc = check_reply_too_large();
+  if (rc == 0) rc = check_pipeline();
+  if (rc == 0) rc = check_async();
+  if (rc == 0) rc = check_large_reply();
+  if (rc == 0) rc = check_handshake_cache();
+  if (rc == 0) rc = check_ws_switch();
+  if (rc == 0) rc = check_call_batch();
+  if (rc == 0) rc = check_call_view();
+  if (rc == 0) rc = check_binary_codec();
+  if (rc == 0) rc = check_binary_calls();
+  if (rc == 0) rc = check_crc32c();
+  if (rc == 0) rc = check_checksums();
+  if (rc == 0) rc = check_framing_errors();
+  if (rc == 0) rc = check_lz4();
+  if (rc == 0) rc = check_compression();
+  if (rc == 0) rc = check_granted_caps();
+  if (rc == 0) rc = check_frame_flags();
+  if (rc == 0) rc = check_compressed_ungranted();
+  if (rc == 0) rc = check_metrics();
+  /* every request so far was sealed with the checksum the root expects */
+  if (rc == 0 && stub_server_checksum_errors(srv) != 0) rc = 157;
+
+  stub_server_stop(srv);
+  if (rc != 0) return rc;
+  puts("rpc_transport_smoke: ok");
+  return 0;
+}
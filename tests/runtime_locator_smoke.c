@@ -1,8 +1,14 @@
 /* SPDX-License-Identifier: Apache-2.0 */
 
+#define _POSIX_C_SOURCE 200809L
+
 #include <yai_sdk/paths.h>
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 int main(void)
 {
@@ -30,5 +36,59 @@ int main(void)
   (void)yai_path_kernel_bin(buf, sizeof(buf));
   (void)yai_path_engine_bin(buf, sizeof(buf));
 
+  /* cached locations follow the environment they were derived from */
+  setenv("YAI_RUNTIME_HOME", "/tmp/yai-locator-a", 1);
+  if (yai_path_root_sock(buf, sizeof(buf)) != 0 || strcmp(buf, "/tmp/yai-locator-a/root/root.sock") != 0) {
+    fprintf(stderr, "root socket did not follow YAI_RUNTIME_HOME: %s\n", buf);
+    return 1;
+  }
+  setenv("YAI_RUNTIME_HOME", "/tmp/yai-locator-b", 1);
+  if (yai_path_root_sock(buf, sizeof(buf)) != 0 || strcmp(buf, "/tmp/yai-locator-b/root/root.sock") != 0 ||
+      yai_path_ws_sock("ws1", buf, sizeof(buf)) != 0 || strcmp(buf, "/tmp/yai-locator-b/ws1/control.sock") != 0) {
+    fprintf(stderr, "cached location is stale after an env change: %s\n", buf);
+    return 1;
+  }
+  setenv("YAI_ROOT_SOCK", "/tmp/yai-locator.sock", 1);
+  yai_path_cache_invalidate();
+  if (yai_path_root_sock(buf, sizeof(buf)) != 0 || strcmp(buf, "/tmp/yai-locator.sock") != 0 ||
+      yai_path_root_sock(buf, 8) == 0) {
+    fprintf(stderr, "root socket override failed: %s\n", buf);
+    return 1;
+  }
+
+  /* a found binary stays cached until invalidated; a missing one is probed again */
+  {
+    char dir[] = "/tmp/yai-locator-XXXXXX";
+    char bin[64];
+    FILE *f;
+    if (!mkdtemp(dir)) return 1;
+    snprintf(bin, sizeof(bin), "%s/yai-engine", dir);
+    setenv("YAI_INSTALL_ROOT", "/nonexistent", 1);
+    setenv("PATH", dir, 1);
+    if (yai_path_engine_bin(buf, sizeof(buf)) == 0) {
+      fprintf(stderr, "engine binary resolved before it exists: %s\n", buf);
+      return 1;
+    }
+    f = fopen(bin, "w");
+    if (!f) return 1;
+    fclose(f);
+    chmod(bin, 0755);
+    if (yai_path_engine_bin(buf, sizeof(buf)) != 0 || strcmp(buf, bin) != 0) {
+      fprintf(stderr, "engine binary not found on PATH\n");
+      return 1;
+    }
+    unlink(bin);
+    if (yai_path_engine_bin(buf, sizeof(buf)) != 0) {
+      fprintf(stderr, "found engine binary was not cached\n");
+      return 1;
+    }
+    yai_path_cache_invalidate();
+    if (yai_path_engine_bin(buf, sizeof(buf)) == 0) {
+      fprintf(stderr, "invalidate kept a removed binary: %s\n", buf);
+      return 1;
+    }
+    rmdir(dir);
+  }
+
   return 0;
 }
@@ -66,6 +66,119 @@ int main(void)
     }
   }
 
+  {
+    /* exec reply decoding straight off a caller buffer */
+    static const char k_reply[] =
+        "{ \"type\" : \"yai.exec.reply.v1\", \"status\":\"error\", \"code\":\"BAD_ARGS\","
+        " \"reason\":\"bad \\\"arg\\\" \\u00e9\\ud83d\\ude00\", \"command_id\":\"yai.x.y\","
+        " \"trace_id\":\"t-1\", \"target_plane\":\"engine\", \"nested\":{\"type\":\"decoy\",\"a\":[1,{\"b\":\"}\"}]},"
+        " \"hints\":[\"h0\", \"\", \"h2\"], \"details\":{ \"ws\" : \"a b\", \"n\" : [ 1, 2 ] },"
+        " \"type\":\"ignored\" }";
+    yai_sdk_reply_t out;
+    int rc = yai_sdk_reply_parse(k_reply, sizeof(k_reply) - 1, &out);
+    if (rc != YAI_SDK_BAD_ARGS || strcmp(out.status, "error") != 0 || strcmp(out.code, "BAD_ARGS") != 0 ||
+        strcmp(out.reason, "bad \"arg\" \xc3\xa9\xf0\x9f\x98\x80") != 0 ||
+        strcmp(out.command_id, "yai.x.y") != 0 || strcmp(out.trace_id, "t-1") != 0 ||
+        strcmp(out.target_plane, "engine") != 0 || out.exec_reply_json != NULL)
+    {
+      fprintf(stderr, "sdk_smoke: reply_parse fields rc=%d reason=%s\n", rc, out.reason);
+      return 1;
+    }
+    if (out.hint_count != 1 || strcmp(out.hints[0], "h0") != 0 ||
+        strcmp(out.details, "{\"ws\":\"a b\",\"n\":[1,2]}") != 0 || out.summary[0] == '\0')
+    {
+      fprintf(stderr, "sdk_smoke: reply_parse hints/details hints=%d details=%s\n", out.hint_count, out.details);
+      return 1;
+    }
+    /* the length bounds the scan: the closing brace is outside it */
+    if (yai_sdk_reply_parse(k_reply, sizeof(k_reply) - 3, &out) != YAI_SDK_PROTOCOL ||
+        strcmp(out.reason, "response_parse_failed") != 0)
+    {
+      fprintf(stderr, "sdk_smoke: reply_parse truncated input not rejected\n");
+      return 1;
+    }
+    static const char k_wrong[] = "{\"type\":\"yai.exec.reply.v2\",\"status\":\"ok\",\"code\":\"OK\"}";
+    if (yai_sdk_reply_parse(k_wrong, sizeof(k_wrong) - 1, &out) != YAI_SDK_PROTOCOL ||
+        strcmp(out.reason, "bad_response_type") != 0)
+    {
+      fprintf(stderr, "sdk_smoke: reply_parse accepted wrong type\n");
+      return 1;
+    }
+    static const char k_ok[] = "{\"type\":\"yai.exec.reply.v1\",\"status\":\"ok\",\"code\":\"OK\",\"reason\":7,\"hint\":[\"only\"]}";
+    if (yai_sdk_reply_parse(k_ok, sizeof(k_ok) - 1, &out) != YAI_SDK_OK || strcmp(out.reason, "missing_reason") != 0 ||
+        strcmp(out.command_id, "yai.unknown.unknown") != 0 || out.hint_count != 1 || strcmp(out.hints[0], "only") != 0)
+    {
+      fprintf(stderr, "sdk_smoke: reply_parse defaults reason=%s\n", out.reason);
+      return 1;
+    }
+    /* values are checked against the JSON grammar, nested ones included */
+    static const char *const k_bad[] = {
+        "{\"type\":\"yai.exec.reply.v1\",\"status\":\"ok\",\"code\":\"OK\",\"n\":okay}",
+        "{\"type\":\"yai.exec.reply.v1\",\"status\":\"ok\",\"code\":\"OK\",\"n\":truex}",
+        "{\"type\":\"yai.exec.reply.v1\",\"status\":\"ok\",\"code\":\"OK\",\"details\":{\"a\" 1}}",
+        "{\"type\":\"yai.exec.reply.v1\",\"status\":\"ok\",\"code\":\"OK\",\"hints\":[\"a\",,nul]}",
+    };
+    for (size_t i = 0; i < sizeof(k_bad) / sizeof(k_bad[0]); i++)
+    {
+      if (yai_sdk_reply_parse(k_bad[i], strlen(k_bad[i]), &out) != YAI_SDK_PROTOCOL ||
+          strcmp(out.reason, "response_parse_failed") != 0)
+      {
+        fprintf(stderr, "sdk_smoke: reply_parse accepted malformed input %zu\n", i);
+        return 1;
+      }
+    }
+    static const char k_num[] =
+        "{\"type\":\"yai.exec.reply.v1\",\"status\":\"ok\",\"code\":\"OK\",\"n\":-1.5e+3,"
+        "\"details\":{\"a\":[0,true,null,{\"b\":false}]}}";
+    if (yai_sdk_reply_parse(k_num, sizeof(k_num) - 1, &out) != YAI_SDK_OK ||
+        strcmp(out.details, "{\"a\":[0,true,null,{\"b\":false}]}") != 0)
+    {
+      fprintf(stderr, "sdk_smoke: reply_parse literals details=%s\n", out.details);
+      return 1;
+    }
+    /* truncation drops a code point it would split */
+    {
+      char json[512];
+      char pad[sizeof(out.summary)];
+      memset(pad, 'a', sizeof(out.summary) - 2);
+      pad[sizeof(out.summary) - 2] = '\0';
+      int n = snprintf(json, sizeof(json),
+                       "{\"type\":\"yai.exec.reply.v1\",\"status\":\"ok\",\"code\":\"OK\",\"summary\":\"%s\xc3\xa9\"}", pad);
+      if (yai_sdk_reply_parse(json, (size_t)n, &out) != YAI_SDK_OK || strlen(out.summary) != sizeof(out.summary) - 2)
+      {
+        fprintf(stderr, "sdk_smoke: reply_parse split a UTF-8 sequence (%zu)\n", strlen(out.summary));
+        return 1;
+      }
+    }
+  }
+
+  {
+    /* reply views: no field limits, escaped strings land in the arena */
+    char big[1400];
+    char json[2048];
+    yai_sdk_arena_t *arena = NULL;
+    yai_sdk_reply_view_t v;
+    memset(big, 'd', sizeof(big) - 1);
+    big[sizeof(big) - 1] = '\0';
+    int n = snprintf(json, sizeof(json),
+                     "{\"type\":\"yai.exec.reply.v1\",\"status\":\"ok\",\"code\":\"OK\",\"reason\":\"a\\tb\","
+                     "\"hints\":[\"h0\",\"h1\",\"h\\u00e92\"],\"details\":{\"blob\":\"%s\"}}", big);
+    if (yai_sdk_arena_create(&arena, 0) != YAI_SDK_OK ||
+        yai_sdk_reply_view_parse(json, (size_t)n, arena, &v) != YAI_SDK_OK)
+    {
+      fprintf(stderr, "sdk_smoke: reply_view_parse failed\n");
+      return 1;
+    }
+    if (v.hint_count != 3 || v.hints[2].len != 4 || memcmp(v.hints[2].ptr, "h\xc3\xa9" "2", 4) != 0 ||
+        v.details.len != sizeof(big) - 1 + 11 || v.reason.len != 3 || memcmp(v.reason.ptr, "a\tb", 3) != 0 ||
+        v.command_id.len != 19 || v.raw.ptr != json || v.hints[0].ptr < json || v.hints[0].ptr >= json + n)
+    {
+      fprintf(stderr, "sdk_smoke: reply_view fields hints=%zu details=%zu\n", v.hint_count, v.details.len);
+      return 1;
+    }
+    yai_sdk_arena_destroy(arena);
+  }
+
   /* 1) Offline registry lookup must work */
   if (yai_law_registry_init() != 0)
   {
@@ -0,0 +1,207 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "yai_sdk/public.h"
+#include "support/stub_server.h"
+
+#define THREADS 16
+#define CALLS_PER_THREAD 200
+
+typedef struct worker {
+  yai_sdk_shared_client_t *client;
+  int id;
+  int failed;
+} worker_t;
+
+static uint64_t now_ms(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u;
+}
+
+/* Every caller must get back the reply to its own request. */
+static void *worker_main(void *arg)
+{
+  worker_t *w = (worker_t *)arg;
+  for (int i = 0; i < CALLS_PER_THREAD && !w->failed; i++) {
+    char req[160];
+    char want[64];
+    yai_sdk_reply_t r;
+    snprintf(want, sizeof(want), "yai.kernel.t%d_%d", w->id, i);
+    snprintf(req, sizeof(req), "{\"type\":\"yai.control.call.v1\",\"command_id\":\"%s\"}", want);
+    if (yai_sdk_shared_client_call_json(w->client, req, &r) != YAI_SDK_OK ||
+        strcmp(r.command_id, want) != 0) {
+      fprintf(stderr, "shared_client_smoke: thread %d call %d got %s\n", w->id, i, r.command_id);
+      w->failed = 1;
+    }
+    yai_sdk_reply_free(&r);
+  }
+  return NULL;
+}
+
+static int check_concurrent(void)
+{
+  yai_sdk_shared_client_opts_t opts = {.ws_id = "ws_shared", .connections = 2, .window = 8};
+  yai_sdk_shared_client_t *client = NULL;
+  yai_sdk_shared_client_stats_t st;
+  stub_server_t *srv = NULL;
+  pthread_t th[THREADS];
+  worker_t w[THREADS];
+  int rc = 0;
+
+  if (stub_server_start(&srv, NULL) != 0) return 1;
+  if (yai_sdk_shared_client_open(&client, &opts) != YAI_SDK_OK) {
+    stub_server_stop(srv);
+    return 2;
+  }
+  for (int i = 0; i < THREADS; i++) {
+    w[i].client = client;
+    w[i].id = i;
+    w[i].failed = 0;
+    pthread_create(&th[i], NULL, worker_main, &w[i]);
+  }
+  for (int i = 0; i < THREADS; i++) {
+    pthread_join(th[i], NULL);
+    if (w[i].failed) rc = 3;
+  }
+  yai_sdk_shared_client_get_stats(client, &st);
+  /* 16 callers, window 8 x 2: callers queue instead of opening sockets */
+  if (rc == 0 && (stub_server_accepts(srv) != 2 || st.connects != 2 ||
+                  st.calls != THREADS * CALLS_PER_THREAD || st.failures != 0)) {
+    fprintf(stderr, "shared_client_smoke: accepts=%llu calls=%llu\n",
+            (unsigned long long)stub_server_accepts(srv), st.calls);
+    rc = 4;
+  }
+  yai_sdk_shared_client_close(client);
+  stub_server_stop(srv);
+  return rc;
+}
+
+/*
+ * Without pipelining granted each connection carries one request at a time;
+ * without large frames an oversized reply fails its caller only.
+ */
+static int check_refused_caps(void)
+{
+  enum { WORKERS = 4 };
+  stub_server_opts_t serial = {.caps_refused = YAI_RPC_CAP_PIPELINE};
+  stub_server_opts_t small = {.reply_pad = 8192, .caps_refused = YAI_RPC_CAP_LARGE_FRAMES};
+  yai_sdk_shared_client_opts_t opts = {.ws_id = "ws_shared", .connections = 2, .window = 8};
+  yai_sdk_shared_client_t *client = NULL;
+  yai_sdk_shared_client_stats_t st;
+  stub_server_t *srv = NULL;
+  pthread_t th[WORKERS];
+  worker_t w[WORKERS];
+  yai_sdk_reply_t r = {0};
+  int rc = 0;
+
+  if (stub_server_start(&srv, &serial) != 0) return 20;
+  if (yai_sdk_shared_client_open(&client, &opts) != YAI_SDK_OK) {
+    stub_server_stop(srv);
+    return 21;
+  }
+  for (int i = 0; i < WORKERS; i++) {
+    w[i].client = client;
+    w[i].id = i;
+    w[i].failed = 0;
+    pthread_create(&th[i], NULL, worker_main, &w[i]);
+  }
+  for (int i = 0; i < WORKERS; i++) {
+    pthread_join(th[i], NULL);
+    if (w[i].failed) rc = 22;
+  }
+  yai_sdk_shared_client_get_stats(client, &st);
+  if (rc == 0 && (st.connects != 2 || st.failures != 0)) rc = 23;
+  yai_sdk_shared_client_close(client);
+  stub_server_stop(srv);
+  if (rc != 0) return rc;
+
+  client = NULL;
+  opts.connections = 1;
+  if (stub_server_start(&srv, &small) != 0) return 24;
+  if (yai_sdk_shared_client_open(&client, &opts) != YAI_SDK_OK) {
+    stub_server_stop(srv);
+    return 25;
+  }
+  for (int i = 0; i < 2 && rc == 0; i++) {
+    if (yai_sdk_shared_client_call_json(client, "{\"type\":\"yai.control.call.v1\",\"command_id\":\"yai.kernel.ws_status\"}",
+                                        &r) != YAI_SDK_RPC) {
+      rc = 26;
+    }
+    yai_sdk_reply_free(&r);
+  }
+  yai_sdk_shared_client_get_stats(client, &st);
+  if (rc == 0 && (st.connects != 1 || st.failures != 0 || stub_server_accepts(srv) != 1)) rc = 27;
+  yai_sdk_shared_client_close(client);
+  stub_server_stop(srv);
+  return rc;
+}
+
+/* A slow reply times out its own caller only; the connection survives. */
+static int check_timeout_and_server_off(void)
+{
+  stub_server_opts_t so = {.stall_ms = 300};
+  yai_sdk_shared_client_opts_t opts = {.ws_id = "ws_shared", .call_timeout_ms = 50};
+  yai_sdk_shared_client_t *client = NULL;
+  stub_server_t *srv = NULL;
+  yai_sdk_reply_t r;
+  uint64_t t0;
+  int rc = 0;
+
+  if (stub_server_start(&srv, &so) != 0) return 10;
+  if (yai_sdk_shared_client_open(&client, &opts) != YAI_SDK_OK) {
+    stub_server_stop(srv);
+    return 11;
+  }
+  t0 = now_ms();
+  if (yai_sdk_shared_client_call_json(client, "{\"type\":\"yai.control.call.v1\",\"command_id\":\"yai.kernel.ws_status\"}",
+                                      &r) != YAI_SDK_TIMEOUT ||
+      strcmp(r.code, "TIMEOUT") != 0 || now_ms() - t0 > 250) {
+    rc = 12;
+  }
+  yai_sdk_reply_free(&r);
+
+  stub_server_stop(srv);
+  if (rc == 0 &&
+      yai_sdk_shared_client_call_json(client, "{\"type\":\"yai.control.call.v1\",\"command_id\":\"yai.kernel.ws_status\"}",
+                                      &r) != YAI_SDK_SERVER_OFF) {
+    rc = 13;
+  }
+  yai_sdk_reply_free(&r);
+
+  /* the next caller reconnects, on its own thread, to the server's return */
+  if (rc == 0 && stub_server_start(&srv, NULL) != 0) rc = 14;
+  if (rc == 0) {
+    yai_sdk_shared_client_stats_t st;
+    if (yai_sdk_shared_client_call_json(client, "{\"type\":\"yai.control.call.v1\",\"command_id\":\"yai.kernel.ws_status\"}",
+                                        &r) != YAI_SDK_OK) {
+      rc = 15;
+    }
+    yai_sdk_reply_free(&r);
+    yai_sdk_shared_client_get_stats(client, &st);
+    if (rc == 0 && (st.connects != 2 || stub_server_accepts(srv) != 1)) rc = 16;
+    stub_server_stop(srv);
+  }
+  yai_sdk_shared_client_close(client);
+  return rc;
+}
+
+int main(void)
+{
+  int rc = check_concurrent();
+  if (rc == 0) rc = check_timeout_and_server_off();
+  if (rc == 0) rc = check_refused_caps();
+  if (rc != 0) {
+    fprintf(stderr, "shared_client_smoke: failed rc=%d\n", rc);
+    return rc;
+  }
+  puts("shared_client_smoke: ok");
+  return 0;
+}
@@ -0,0 +1,556 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "stub_server.h"
+
+#include <protocol.h>
+#include <transport.h>
+#include <yai_protocol_ids.h>
+
+#include <cJSON.h>
+#include <yai_sdk/rpc.h>
+
+#include "../../src/platform/crc32c.h"
+#include "../../src/platform/lz4_block.h"
+#include "../../src/protocol/binary_codec.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#define STUB_MAX_CONNS 256
+#define STUB_MAX_PAYLOAD (64u * 1024u * 1024u)
+
+typedef struct stub_conn {
+  stub_server_t *srv;
+  int fd;
+  pthread_t thread;
+  int used;
+  atomic_int done;
+} stub_conn_t;
+
+struct stub_server {
+  stub_server_opts_t opts;
+  char path[108];
+  int listen_fd;
+  pthread_t accept_thread;
+  atomic_int stopping;
+  atomic_uint_fast64_t frames;
+  atomic_uint_fast64_t accepts;
+  atomic_uint_fast64_t handshakes;
+  atomic_uint_fast64_t binary_calls;
+  atomic_uint_fast64_t checksum_errors;
+  atomic_uint_fast64_t compressed_frames;
+  atomic_uint_fast32_t caps_refused;
+  pthread_mutex_t mu;
+  stub_conn_t conns[STUB_MAX_CONNS];
+};
+
+/* Per-connection protocol state. */
+typedef struct stub_session {
+  yai_bin_intern_t intern;
+  /* granted by the last handshake on this connection */
+  uint32_t caps;
+} stub_session_t;
+
+/* MSG_NOSIGNAL: a client that hangs up early must not kill the test process. */
+static int io_sendv_all(int fd, struct iovec *iov, int iovcnt)
+{
+  while (iovcnt > 0) {
+    struct msghdr msg;
+    ssize_t w;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = (size_t)iovcnt;
+    w = sendmsg(fd, &msg, MSG_NOSIGNAL);
+    if (w < 0) {
+      if (errno == EINTR) continue;
+      return -1;
+    }
+    while (iovcnt > 0 && (size_t)w >= iov->iov_len) {
+      w -= (ssize_t)iov->iov_len;
+      iov++;
+      iovcnt--;
+    }
+    if (iovcnt > 0) {
+      iov->iov_base = (char *)iov->iov_base + w;
+      iov->iov_len -= (size_t)w;
+    }
+  }
+  return 0;
+}
+
+static void sleep_ms(int ms)
+{
+  struct timespec ts;
+  if (ms <= 0) return;
+  ts.tv_sec = ms / 1000;
+  ts.tv_nsec = (long)(ms % 1000) * 1000000L;
+  while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {
+  }
+}
+
+static int checksummed(const stub_session_t *sess, const yai_rpc_envelope_t *env)
+{
+  return (sess->caps & YAI_RPC_CAP_CHECKSUM) && env->command_id != YAI_CMD_HANDSHAKE;
+}
+
+/* Large replies go out as a u32 LE raw length plus an LZ4 block when negotiated. */
+static uint8_t *compress_reply(stub_server_t *s,
+                               const stub_session_t *sess,
+                               const yai_rpc_envelope_t *req,
+                               const void *payload,
+                               uint32_t *len)
+{
+  size_t min = s->opts.compress_min ? s->opts.compress_min : YAI_RPC_COMPRESS_MIN_DEFAULT;
+  size_t bound;
+  size_t zn;
+  uint8_t *z;
+
+  if (!(sess->caps & YAI_RPC_CAP_COMPRESSION) || req->command_id == YAI_CMD_HANDSHAKE || *len < min) {
+    return NULL;
+  }
+  bound = yai_lz4_bound(*len);
+  z = (uint8_t *)malloc(4 + bound);
+  if (!z) return NULL;
+  zn = yai_lz4_compress(payload, *len, z + 4, bound);
+  if (zn == 0 || zn + 4 >= *len) {
+    free(z);
+    return NULL;
+  }
+  z[0] = (uint8_t)(*len & 0xFFu);
+  z[1] = (uint8_t)((*len >> 8) & 0xFFu);
+  z[2] = (uint8_t)((*len >> 16) & 0xFFu);
+  z[3] = (uint8_t)(*len >> 24);
+  *len = (uint32_t)(zn + 4);
+  atomic_fetch_add(&s->compressed_frames, 1);
+  return z;
+}
+
+static int send_frame(stub_server_t *s,
+                      const stub_session_t *sess,
+                      int fd,
+                      const yai_rpc_envelope_t *req,
+                      const void *payload,
+                      uint32_t len)
+{
+  yai_rpc_envelope_t resp;
+  struct iovec iov[2];
+  uint8_t *z;
+  int rc;
+  memcpy(&resp, req, sizeof(resp));
+  resp._pad = (uint8_t)(req->_pad & ~YAI_RPC_FLAG_COMPRESSED);
+  z = compress_reply(s, sess, req, payload, &len);
+  if (z) {
+    payload = z;
+    resp._pad |= YAI_RPC_FLAG_COMPRESSED;
+  }
+  if (req->command_id != YAI_CMD_HANDSHAKE) {
+    resp._pad |= s->opts.reply_flags;
+  }
+  resp.payload_len = len;
+  resp.checksum = 0;
+  if (checksummed(sess, req)) {
+    resp.checksum = yai_crc32c(0, payload, len) ^ (s->opts.corrupt_checksum ? 1u : 0u);
+  }
+  if (s->opts.corrupt_magic && req->command_id == YAI_CMD_CONTROL_CALL) {
+    resp.magic ^= 1u;
+  }
+  iov[0].iov_base = &resp;
+  iov[0].iov_len = sizeof(resp);
+  iov[1].iov_base = (void *)payload;
+  iov[1].iov_len = len;
+  rc = io_sendv_all(fd, iov, len > 0 ? 2 : 1);
+  free(z);
+  return rc;
+}
+
+/* Binary (YAI_RPC_FLAG_BINARY) form of the same reply. */
+static char *build_exec_reply_binary(const stub_server_t *s,
+                                     const yai_rpc_envelope_t *env,
+                                     const char *command_id,
+                                     const char *trace_id,
+                                     int fail,
+                                     const yai_bin_intern_t *intern,
+                                     size_t *out_len)
+{
+  static const yai_bin_str_t hints[2] = {{"first hint", 10}, {"second hint", 11}};
+  char details[96];
+  char *data;
+  char *out;
+  size_t data_len;
+  size_t cap;
+  yai_bin_reply_t r;
+  int dn;
+
+  dn = snprintf(details, sizeof(details), "{\"ws\":\"%.*s\"}",
+                (int)strnlen(env->ws_id, sizeof(env->ws_id)), env->ws_id);
+  data = (char *)malloc(128 + s->opts.reply_pad);
+  if (!data) return NULL;
+  data_len = (size_t)snprintf(data, 128, "{\"exists\":true,\"state\":\"ready\",\"root_path\":\"/tmp/stub\",\"pad\":\"");
+  memset(data + data_len, 'x', s->opts.reply_pad);
+  data_len += s->opts.reply_pad;
+  memcpy(data + data_len, "\"}", 2);
+  data_len += 2;
+
+  memset(&r, 0, sizeof(r));
+  r.status = (yai_bin_str_t){fail ? "error" : "ok", fail ? 5u : 2u};
+  r.code = (yai_bin_str_t){fail ? "BAD_ARGS" : "OK", fail ? 8u : 2u};
+  r.reason = (yai_bin_str_t){"stub_ok", 7};
+  r.summary = (yai_bin_str_t){"Stub reply.", 11};
+  r.command_id = (yai_bin_str_t){command_id, strlen(command_id)};
+  r.trace_id = (yai_bin_str_t){trace_id, strlen(trace_id)};
+  r.target_plane = (yai_bin_str_t){"kernel", 6};
+  r.hint_count = 2;
+  r.hints = hints;
+  r.details = (yai_bin_str_t){details, (size_t)dn};
+  r.data = (yai_bin_str_t){data, data_len};
+
+  cap = 512 + data_len + strlen(command_id);
+  out = (char *)malloc(cap);
+  if (out) {
+    *out_len = yai_bin_reply_encode(&r, intern, (uint8_t *)out, cap);
+    if (*out_len == 0) {
+      free(out);
+      out = NULL;
+    }
+  }
+  free(data);
+  return out;
+}
+
+static char *build_exec_reply(stub_server_t *s,
+                              const yai_rpc_envelope_t *env,
+                              const char *payload,
+                              uint32_t len,
+                              yai_bin_intern_t *intern,
+                              size_t *out_len)
+{
+  char command_id[128] = "yai.unknown.unknown";
+  char trace_id[sizeof(env->trace_id) + 1];
+  int binary = (env->_pad & YAI_RPC_FLAG_BINARY) != 0;
+  int fail;
+  cJSON *req;
+  char *out;
+  size_t cap;
+  int n;
+
+  if (binary) {
+    yai_bin_call_t call;
+    if (yai_bin_call_decode((const uint8_t *)payload, len, intern, &call) != 0) return NULL;
+    atomic_fetch_add(&s->binary_calls, 1);
+    snprintf(command_id, sizeof(command_id), "%.*s", (int)call.command_id.len, call.command_id.p);
+  } else {
+    req = cJSON_ParseWithLength(payload, len);
+    if (req) {
+      const cJSON *cid = cJSON_GetObjectItemCaseSensitive(req, "command_id");
+      if (cJSON_IsString(cid) && cid->valuestring) {
+        snprintf(command_id, sizeof(command_id), "%s", cid->valuestring);
+      }
+      cJSON_Delete(req);
+    }
+  }
+  fail = s->opts.fail_command_id && strcmp(command_id, s->opts.fail_command_id) == 0;
+  memcpy(trace_id, env->trace_id, sizeof(env->trace_id));
+  trace_id[sizeof(env->trace_id)] = '\0';
+  if (binary) {
+    return build_exec_reply_binary(s, env, command_id, trace_id, fail, intern, out_len);
+  }
+
+  cap = 512 + strlen(command_id) + strlen(trace_id) + s->opts.reply_pad;
+  out = (char *)malloc(cap);
+  if (!out) return NULL;
+  n = snprintf(out, cap,
+               "{\"type\":\"yai.exec.reply.v1\",\"status\":\"%s\",\"code\":\"%s\","
+               "\"reason\":\"stub_ok\",\"summary\":\"Stub reply.\","
+               "\"command_id\":\"%s\",\"trace_id\":\"%s\",\"target_plane\":\"kernel\","
+               "\"hints\":[\"first hint\",\"second hint\"],"
+               "\"details\":{\"ws\":\"%.*s\"},"
+               "\"data\":{\"exists\":true,\"state\":\"ready\",\"root_path\":\"/tmp/stub\",\"pad\":\"",
+               fail ? "error" : "ok", fail ? "BAD_ARGS" : "OK",
+               command_id, trace_id, (int)strnlen(env->ws_id, sizeof(env->ws_id)), env->ws_id);
+  if (n < 0 || (size_t)n >= cap) {
+    free(out);
+    return NULL;
+  }
+  memset(out + n, 'x', s->opts.reply_pad);
+  n += (int)s->opts.reply_pad;
+  memcpy(out + n, "\"}}", 4);
+  *out_len = (size_t)n + 3;
+  return out;
+}
+
+static int answer_frame(stub_server_t *s, int fd, const yai_rpc_envelope_t *env, const char *payload, stub_session_t *sess)
+{
+  if (env->command_id == YAI_CMD_HANDSHAKE) {
+    yai_handshake_ack_t ack;
+    yai_handshake_req_t req;
+    sleep_ms(s->opts.stall_handshake_ms);
+    memset(&req, 0, sizeof(req));
+    memcpy(&req, payload, env->payload_len < sizeof(req) ? env->payload_len : sizeof(req));
+    memset(&ack, 0, sizeof(ack));
+    ack.server_version = YAI_PROTOCOL_IDS_VERSION;
+    ack.capabilities_granted = req.capabilities_requested & ~(uint32_t)atomic_load(&s->caps_refused);
+    ack.status = YAI_PROTO_STATE_READY;
+    sess->caps = ack.capabilities_granted;
+    atomic_fetch_add(&s->handshakes, 1);
+    return send_frame(s, sess, fd, env, &ack, (uint32_t)sizeof(ack));
+  }
+  if (env->command_id == YAI_CMD_PING) {
+    return send_frame(s, sess, fd, env, "pong", 4);
+  }
+  if (env->command_id == YAI_CMD_CONTROL_CALL) {
+    size_t n = 0;
+    char *reply;
+    int rc;
+    sleep_ms(s->opts.stall_ms);
+    reply = build_exec_reply(s, env, payload, env->payload_len, &sess->intern, &n);
+    if (!reply) return -1;
+    rc = send_frame(s, sess, fd, env, reply, (uint32_t)n);
+    free(reply);
+    return rc;
+  }
+  return send_frame(s, sess, fd, env, NULL, 0);
+}
+
+/* Checks the wire bytes, then inflates compressed requests before answering. */
+static int handle_frame(stub_server_t *s, int fd, const yai_rpc_envelope_t *env, const char *payload, stub_session_t *sess)
+{
+  yai_rpc_envelope_t plain;
+  const uint8_t *p = (const uint8_t *)payload;
+  uint32_t raw_len;
+  char *raw;
+  int rc;
+
+  if (checksummed(sess, env) && yai_crc32c(0, payload, env->payload_len) != env->checksum) {
+    atomic_fetch_add(&s->checksum_errors, 1);
+    return -1; /* drop the connection, as a real root would */
+  }
+  if (!(env->_pad & YAI_RPC_FLAG_COMPRESSED)) {
+    return answer_frame(s, fd, env, payload, sess);
+  }
+  if (env->payload_len < 4) return -1;
+  raw_len = (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+  if (raw_len > STUB_MAX_PAYLOAD) return -1;
+  raw = (char *)malloc((size_t)raw_len + 1);
+  if (!raw) return -1;
+  if (yai_lz4_decompress(p + 4, env->payload_len - 4, raw, raw_len) != 0) {
+    free(raw);
+    return -1;
+  }
+  raw[raw_len] = '\0';
+  atomic_fetch_add(&s->compressed_frames, 1);
+  plain = *env;
+  plain.payload_len = raw_len;
+  plain._pad = (uint8_t)(env->_pad & ~YAI_RPC_FLAG_COMPRESSED);
+  rc = answer_frame(s, fd, &plain, raw, sess);
+  free(raw);
+  return rc;
+}
+
+/* Buffered reader: one read() may carry many pipelined frames. */
+static void *conn_main(void *arg)
+{
+  stub_conn_t *conn = (stub_conn_t *)arg;
+  stub_server_t *s = conn->srv;
+  size_t cap = 64 * 1024;
+  size_t head = 0;
+  size_t tail = 0;
+  char *buf = (char *)malloc(cap + 1);
+  stub_session_t sess;
+
+  memset(&sess, 0, sizeof(sess));
+  while (buf && !atomic_load(&s->stopping)) {
+    yai_rpc_envelope_t env;
+    size_t frame;
+    ssize_t r;
+
+    if (tail - head >= sizeof(env)) {
+      memcpy(&env, buf + head, sizeof(env));
+      if (env.magic != YAI_FRAME_MAGIC || env.payload_len > STUB_MAX_PAYLOAD) break;
+      frame = sizeof(env) + env.payload_len;
+      if (tail - head >= frame) {
+        char *payload = buf + head + sizeof(env);
+        char saved = payload[env.payload_len];
+        payload[env.payload_len] = '\0';
+        if (handle_frame(s, conn->fd, &env, payload, &sess) != 0) break;
+        payload[env.payload_len] = saved;
+        atomic_fetch_add(&s->frames, 1);
+        head += frame;
+        continue;
+      }
+      if (frame > cap) {
+        char *nb = (char *)realloc(buf, frame + 1);
+        if (!nb) break;
+        buf = nb;
+        cap = frame;
+      }
+    }
+    if (head > 0) {
+      memmove(buf, buf + head, tail - head);
+      tail -= head;
+      head = 0;
+    }
+    r = read(conn->fd, buf + tail, cap - tail);
+    if (r < 0 && errno == EINTR) continue;
+    if (r <= 0) break;
+    tail += (size_t)r;
+  }
+  free(buf);
+  shutdown(conn->fd, SHUT_RDWR);
+  atomic_store(&conn->done, 1);
+  return NULL;
+}
+
+static void *accept_main(void *arg)
+{
+  stub_server_t *s = (stub_server_t *)arg;
+  while (!atomic_load(&s->stopping)) {
+    int fd = accept(s->listen_fd, NULL, NULL);
+    stub_conn_t *slot = NULL;
+    if (fd < 0) {
+      if (errno == EINTR) continue;
+      break;
+    }
+    pthread_mutex_lock(&s->mu);
+    for (size_t i = 0; i < STUB_MAX_CONNS; i++) {
+      stub_conn_t *cn = &s->conns[i];
+      if (cn->used && atomic_load(&cn->done)) {
+        /* reap a finished connection so reconnect loops do not run out */
+        pthread_join(cn->thread, NULL);
+        close(cn->fd);
+        cn->used = 0;
+      }
+      if (!cn->used) {
+        slot = cn;
+        slot->used = 1;
+        atomic_store(&slot->done, 0);
+        break;
+      }
+    }
+    pthread_mutex_unlock(&s->mu);
+    if (!slot) {
+      close(fd);
+      continue;
+    }
+    slot->srv = s;
+    slot->fd = fd;
+    atomic_fetch_add(&s->accepts, 1);
+    if (pthread_create(&slot->thread, NULL, conn_main, slot) != 0) {
+      close(fd);
+      pthread_mutex_lock(&s->mu);
+      slot->used = 0;
+      pthread_mutex_unlock(&s->mu);
+    }
+  }
+  return NULL;
+}
+
+int stub_server_start(stub_server_t **out, const stub_server_opts_t *opts)
+{
+  static atomic_int seq;
+  stub_server_t *s;
+  struct sockaddr_un addr;
+
+  if (!out) return -1;
+  *out = NULL;
+  s = (stub_server_t *)calloc(1, sizeof(*s));
+  if (!s) return -1;
+  if (opts) s->opts = *opts;
+  atomic_init(&s->caps_refused, s->opts.caps_refused);
+  pthread_mutex_init(&s->mu, NULL);
+  snprintf(s->path, sizeof(s->path), "/tmp/yai-sdk-stub-%ld-%d.sock",
+           (long)getpid(), atomic_fetch_add(&seq, 1));
+  (void)unlink(s->path);
+
+  s->listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (s->listen_fd < 0) {
+    free(s);
+    return -1;
+  }
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", s->path);
+  if (bind(s->listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+      listen(s->listen_fd, 128) != 0) {
+    close(s->listen_fd);
+    free(s);
+    return -1;
+  }
+  if (pthread_create(&s->accept_thread, NULL, accept_main, s) != 0) {
+    close(s->listen_fd);
+    (void)unlink(s->path);
+    free(s);
+    return -1;
+  }
+  (void)setenv("YAI_ROOT_SOCK", s->path, 1);
+  *out = s;
+  return 0;
+}
+
+void stub_server_stop(stub_server_t *s)
+{
+  if (!s) return;
+  atomic_store(&s->stopping, 1);
+  shutdown(s->listen_fd, SHUT_RDWR);
+  pthread_join(s->accept_thread, NULL);
+  close(s->listen_fd);
+  for (size_t i = 0; i < STUB_MAX_CONNS; i++) {
+    if (!s->conns[i].used) continue;
+    shutdown(s->conns[i].fd, SHUT_RDWR);
+    pthread_join(s->conns[i].thread, NULL);
+    close(s->conns[i].fd);
+  }
+  (void)unlink(s->path);
+  pthread_mutex_destroy(&s->mu);
+  free(s);
+}
+
+const char *stub_server_path(const stub_server_t *s)
+{
+  return s ? s->path : NULL;
+}
+
+uint64_t stub_server_frames(const stub_server_t *s)
+{
+  return s ? (uint64_t)atomic_load(&((stub_server_t *)s)->frames) : 0;
+}
+
+uint64_t stub_server_accepts(const stub_server_t *s)
+{
+  return s ? (uint64_t)atomic_load(&((stub_server_t *)s)->accepts) : 0;
+}
+
+uint64_t stub_server_handshakes(const stub_server_t *s)
+{
+  return s ? (uint64_t)atomic_load(&((stub_server_t *)s)->handshakes) : 0;
+}
+
+uint64_t stub_server_binary_calls(const stub_server_t *s)
+{
+  return s ? (uint64_t)atomic_load(&((stub_server_t *)s)->binary_calls) : 0;
+}
+
+void stub_server_set_caps_refused(stub_server_t *s, uint32_t caps)
+{
+  if (s) atomic_store(&s->caps_refused, caps);
+}
+
+uint64_t stub_server_checksum_errors(const stub_server_t *s)
+{
+  return s ? (uint64_t)atomic_load(&((stub_server_t *)s)->checksum_errors) : 0;
+}
+
+uint64_t stub_server_compressed_frames(const stub_server_t *s)
+{
+  return s ? (uint64_t)atomic_load(&((stub_server_t *)s)->compressed_frames) : 0;
+}
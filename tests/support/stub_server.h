@@ -0,0 +1,66 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+#pragma once
+
+/*
+ * In-process stand-in for the root server, used by socket tests and benches.
+ * Speaks the envelope framing on a private Unix socket and answers
+ * handshake, ping and control calls with canned yai.exec.reply.v1 payloads.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct stub_server_opts {
+  /* Delay before each control-call reply (0 = answer immediately). */
+  int stall_ms;
+  /* Delay before each handshake ack (0 = answer immediately). */
+  int stall_handshake_ms;
+  /* Bytes of filler added to each control-call reply under data.pad. */
+  size_t reply_pad;
+  /* Capability bits never granted, whatever the client asks for. */
+  uint32_t caps_refused;
+  /* Control calls with this command_id get an error reply with code BAD_ARGS. */
+  const char *fail_command_id;
+  /* Replies carry a wrong checksum on connections that negotiated checksums. */
+  int corrupt_checksum;
+  /* Control-call replies carry a foreign frame magic. */
+  int corrupt_magic;
+  /* Replies at least this large are compressed on connections that negotiated
+   * compression (0 = YAI_RPC_COMPRESS_MIN_DEFAULT). */
+  size_t compress_min;
+  /* Flag bits ORed into every reply but the handshake ack, granted or not. */
+  uint8_t reply_flags;
+} stub_server_opts_t;
+
+typedef struct stub_server stub_server_t;
+
+/* Starts the server on a fresh socket path and exports it as YAI_ROOT_SOCK.
+ * Returns 0 on success. */
+int stub_server_start(stub_server_t **out, const stub_server_opts_t *opts);
+void stub_server_stop(stub_server_t *s);
+
+const char *stub_server_path(const stub_server_t *s);
+
+/* Replaces caps_refused for handshakes from now on. */
+void stub_server_set_caps_refused(stub_server_t *s, uint32_t caps);
+
+/* Frames answered since start (all connections, all command ids). */
+uint64_t stub_server_frames(const stub_server_t *s);
+/* Connections accepted since start. */
+uint64_t stub_server_accepts(const stub_server_t *s);
+/* Handshake frames answered since start. */
+uint64_t stub_server_handshakes(const stub_server_t *s);
+/* Control calls that arrived in the binary encoding. */
+uint64_t stub_server_binary_calls(const stub_server_t *s);
+/* Request frames dropped because their checksum did not match. */
+uint64_t stub_server_checksum_errors(const stub_server_t *s);
+/* Frames that travelled compressed, requests and replies alike. */
+uint64_t stub_server_compressed_frames(const stub_server_t *s);
+
+#ifdef __cplusplus
+}
+#endif